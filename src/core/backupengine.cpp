@@ -0,0 +1,215 @@
+#include "backupengine.h"
+#include "databasemanager.h"
+
+#include <QThread>
+#include <QMetaObject>
+#include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include <atomic>
+
+namespace {
+QString storeDir(const QString &backupDir)
+{
+    return backupDir + QStringLiteral("/store");
+}
+
+// 每次备份使用独立命名连接，同步调用与后台线程互不干扰
+std::atomic<int> g_connectionSerial{0};
+}
+
+BackupEngine::BackupEngine(QObject *parent)
+    : QObject(parent)
+{
+    // 任务计数只在本对象所在线程（GUI）维护；结果信号由备份线程发出，这里排队执行
+    auto done = [this]() { --m_pendingJobs; };
+    connect(this, &BackupEngine::finished, this, done, Qt::QueuedConnection);
+    connect(this, &BackupEngine::restored, this, done, Qt::QueuedConnection);
+    connect(this, &BackupEngine::verified, this, done, Qt::QueuedConnection);
+}
+
+BackupEngine::~BackupEngine()
+{
+    stop();
+}
+
+void BackupEngine::start(const QString &dbPath, const QString &backupDir)
+{
+    if (m_thread) {
+        return;
+    }
+    m_dbPath = dbPath;
+    m_backupDir = backupDir;
+
+    m_thread = new QThread(this);
+    m_thread->setObjectName(QStringLiteral("BackupEngine"));
+    m_context = new QObject();
+    m_context->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+    m_thread->start(QThread::LowPriority);
+}
+
+void BackupEngine::stop()
+{
+    if (!m_thread) {
+        return;
+    }
+    // 退出命令排在队列末尾：已投递的备份先做完
+    QMetaObject::invokeMethod(m_context, []() {
+        QThread::currentThread()->quit();
+    }, Qt::QueuedConnection);
+    m_thread->wait();
+
+    delete m_thread;
+    m_thread = nullptr;
+    m_context = nullptr;   // 已随 finished 信号 deleteLater
+}
+
+int BackupEngine::post(const std::function<void(int)> &job)
+{
+    if (!m_thread) {
+        return 0;
+    }
+    const int jobId = m_nextJobId++;
+    ++m_pendingJobs;
+    QMetaObject::invokeMethod(m_context, [job, jobId]() { job(jobId); }, Qt::QueuedConnection);
+    return jobId;
+}
+
+int BackupEngine::backup(const QString &reason)
+{
+    const QString dbPath = m_dbPath;
+    const QString backupDir = m_backupDir;
+    return post([this, dbPath, backupDir, reason](int jobId) {
+        QString error;
+        const QString id = runBackup(dbPath, backupDir, reason, &error, [this, jobId](int percent) {
+            emit progress(jobId, percent);
+        });
+        emit finished(jobId, !id.isEmpty(), id, error);
+    });
+}
+
+int BackupEngine::restore(const QString &snapshotId)
+{
+    const QString backupDir = m_backupDir;
+    return post([this, backupDir, snapshotId](int jobId) {
+        // 先重组到临时文件，再用临时连接读出；替换现有数据由调用方在 GUI 线程完成
+        const QString temp = backupDir + QStringLiteral("/restore_%1.db.part").arg(jobId);
+        QString error;
+        QList<TodoFolder> folders;
+        emit progress(jobId, 0);
+        bool ok = BackupStore(storeDir(backupDir)).restoreTo(snapshotId, temp, &error);
+        if (ok) {
+            emit progress(jobId, 60);
+            ok = DatabaseManager::loadFromFile(temp, &folders, &error);
+        }
+        QFile::remove(temp);
+        emit progress(jobId, 100);
+        emit restored(jobId, ok, folders, error);
+    });
+}
+
+int BackupEngine::verify()
+{
+    const QString backupDir = m_backupDir;
+    return post([this, backupDir](int jobId) {
+        int checked = 0;
+        const QStringList problems = BackupStore(storeDir(backupDir)).verifyAll(&checked);
+        emit verified(jobId, checked, problems);
+    });
+}
+
+QList<BackupStore::Snapshot> BackupEngine::snapshots() const
+{
+    if (m_backupDir.isEmpty()) {
+        return {};
+    }
+    return BackupStore(storeDir(m_backupDir)).snapshots();
+}
+
+QString BackupEngine::runBackup(const QString &dbPath, const QString &backupDir, const QString &reason,
+                                QString *error, const std::function<void(int)> &onProgress)
+{
+    auto report = [&onProgress](int percent) {
+        if (onProgress) onProgress(percent);
+    };
+    auto fail = [error](const QString &message) {
+        if (error) *error = message;
+        qWarning() << "[BackupEngine]" << message;
+        return QString();
+    };
+
+    report(0);
+    if (dbPath.isEmpty() || !QFile::exists(dbPath)) {
+        return fail(QStringLiteral("数据库文件不存在"));
+    }
+
+    QDir dir(backupDir);
+    if (!dir.exists() && !dir.mkpath(QStringLiteral("."))) {
+        return fail(QStringLiteral("无法创建备份目录"));
+    }
+
+    const int serial = g_connectionSerial.fetch_add(1);
+    const QString partial = dir.absoluteFilePath(QStringLiteral("snapshot_%1.db.part").arg(serial));
+    QFile::remove(partial);
+
+    // VACUUM INTO 在一个读事务内把当前快照写成紧凑的新库；WAL 下不阻塞其他连接的写入。
+    // 临时副本校验通过后才入库
+    QString message;
+    const QString connectionName = QStringLiteral("todolist_backup_%1").arg(serial);
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName);
+        db.setDatabaseName(dbPath);
+        db.setConnectOptions(QStringLiteral("QSQLITE_BUSY_TIMEOUT=3000"));
+        if (!db.open()) {
+            message = QStringLiteral("无法打开数据库: %1").arg(db.lastError().text());
+        } else {
+            QSqlQuery query(db);
+            query.prepare(QStringLiteral("VACUUM INTO ?"));
+            query.addBindValue(partial);
+            if (!query.exec()) {
+                message = QStringLiteral("备份失败: %1").arg(query.lastError().text());
+            } else {
+                report(40);
+                query.prepare(QStringLiteral("ATTACH DATABASE ? AS snapshot"));
+                query.addBindValue(partial);
+                if (!query.exec() || !query.exec(QStringLiteral("PRAGMA snapshot.quick_check"))
+                    || !query.next() || query.value(0).toString() != QLatin1String("ok")) {
+                    message = QStringLiteral("备份校验失败: %1").arg(query.lastError().text());
+                }
+                query.finish();
+                query.exec(QStringLiteral("DETACH DATABASE snapshot"));
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (!message.isEmpty()) {
+        QFile::remove(partial);
+        return fail(message);
+    }
+    report(60);
+
+    BackupStore store(storeDir(backupDir));
+    const QString snapshotId = store.addSnapshot(partial, reason, &message);
+    QFile::remove(partial);
+    if (snapshotId.isEmpty()) {
+        return fail(message);
+    }
+    report(90);
+
+    // 旧版整库备份收编进仓库，随分层保留一起淘汰；再回收无主块
+    store.adoptLegacyBackups(backupDir);
+    const int expired = store.applyRetention();
+    if (expired > 0) {
+        store.collectGarbage();
+    }
+
+    report(100);
+    return snapshotId;
+}
@@ -0,0 +1,58 @@
+#ifndef BACKUPENGINE_H
+#define BACKUPENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <functional>
+#include "backupstore.h"
+#include "todofolder.h"
+
+class QThread;
+
+// 在线备份：后台线程用独立连接执行 VACUUM INTO 生成一致性快照，再存入去重仓库（BackupStore）。
+// WAL 模式下备份只持有读快照，前台与写线程的提交不受阻塞；
+// 仓库的写入、恢复、校验全部排在同一后台线程串行执行，
+// 进度与结果通过信号回传（跨线程排队投递到接收者所在线程）。
+class BackupEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BackupEngine(QObject *parent = nullptr);
+    ~BackupEngine() override;
+
+    void start(const QString &dbPath, const QString &backupDir);
+    void stop();                              // 等待已排队的备份完成后结束线程
+
+    // 以下投递接口返回任务号；未启动返回 0
+    int backup(const QString &reason);
+    int restore(const QString &snapshotId);   // 重组快照并读出数据，由 restored 信号交回
+    int verify();                             // 校验仓库中的全部快照
+    bool isBusy() const { return m_pendingJobs > 0; }
+
+    QList<BackupStore::Snapshot> snapshots() const;   // 只读清单，可在 GUI 线程调用
+
+    // 在调用线程上同步完成一次备份，成功返回快照 id（供启动迁移前使用）
+    static QString runBackup(const QString &dbPath, const QString &backupDir, const QString &reason,
+                             QString *error, const std::function<void(int)> &onProgress = {});
+
+signals:
+    void progress(int jobId, int percent);
+    void finished(int jobId, bool ok, const QString &snapshotId, const QString &error);
+    void restored(int jobId, bool ok, const QList<TodoFolder> &folders, const QString &error);
+    void verified(int jobId, int checked, const QStringList &problems);
+
+private:
+    int post(const std::function<void(int jobId)> &job);
+
+    QThread *m_thread = nullptr;
+    QObject *m_context = nullptr;             // 驻留备份线程的投递目标
+    QString m_dbPath;
+    QString m_backupDir;
+    int m_nextJobId = 1;
+    int m_pendingJobs = 0;                    // 仅在 GUI 线程读写
+};
+
+#endif // BACKUPENGINE_H
@@ -0,0 +1,428 @@
+#include "backupstore.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+#include <array>
+
+namespace {
+constexpr int kManifestFormat = 1;
+constexpr int kCompressionLevel = 6;
+
+// 内容定义分块：Gear 滚动哈希的高 16 位全零处切分，平均块长约 64 KiB。
+// 边界只取决于附近内容，VACUUM 后页整体平移时未改动的区域仍切出相同的块
+constexpr qsizetype kMinChunk = 16 * 1024;
+constexpr qsizetype kMaxChunk = 256 * 1024;
+constexpr quint64 kBoundaryMask = 0xFFFFull << 48;
+
+// 保留策略
+constexpr int kHourlyWindowHours = 24;
+constexpr int kDailyWindowDays = 14;
+constexpr int kWeeklyWindowWeeks = 8;
+constexpr int kPinnedReasonDays = 7;
+
+const std::array<quint64, 256> &gearTable()
+{
+    // splitmix64 生成的固定表：块边界必须跨版本稳定，不能用运行时随机数
+    static const std::array<quint64, 256> table = []() {
+        std::array<quint64, 256> values{};
+        quint64 state = 0x9E3779B97F4A7C15ull;
+        for (quint64 &value : values) {
+            state += 0x9E3779B97F4A7C15ull;
+            quint64 z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            value = z ^ (z >> 31);
+        }
+        return values;
+    }();
+    return table;
+}
+
+qsizetype nextChunkLength(const uchar *data, qsizetype available)
+{
+    if (available <= kMinChunk) {
+        return available;
+    }
+    const auto &gear = gearTable();
+    const qsizetype limit = std::min(available, kMaxChunk);
+    quint64 hash = 0;
+    for (qsizetype i = kMinChunk; i < limit; ++i) {
+        hash = (hash << 1) + gear[data[i]];
+        if ((hash & kBoundaryMask) == 0) {
+            return i + 1;
+        }
+    }
+    return limit;
+}
+
+QString sha256Hex(QByteArrayView data)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
+
+bool isPinnedReason(const QString &reason)
+{
+    return reason == QLatin1String("manual")
+        || reason == QLatin1String("pre_import")
+        || reason == QLatin1String("pre_restore")
+        || reason == QLatin1String("pre_migration");
+}
+}
+
+BackupStore::BackupStore(const QString &rootDir)
+    : m_root(QDir(rootDir).absolutePath())
+{
+}
+
+QString BackupStore::chunkPath(const QString &hash) const
+{
+    return m_root + QStringLiteral("/chunks/") + hash.left(2) + QLatin1Char('/') + hash;
+}
+
+QString BackupStore::manifestPath(const QString &id) const
+{
+    return m_root + QStringLiteral("/snapshots/") + id + QStringLiteral(".json");
+}
+
+QString BackupStore::addSnapshot(const QString &filePath, const QString &reason, QString *error,
+                                 const QDateTime &created)
+{
+    auto fail = [error](const QString &message) {
+        if (error) *error = message;
+        return QString();
+    };
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(QStringLiteral("无法读取快照源文件"));
+    }
+    const qint64 size = file.size();
+
+    // 优先映射文件，避免整库读入一份堆内存
+    QByteArray buffer;
+    const uchar *data = size > 0 ? file.map(0, size) : nullptr;
+    if (!data && size > 0) {
+        buffer = file.readAll();
+        data = reinterpret_cast<const uchar *>(buffer.constData());
+    }
+
+    Manifest manifest;
+    manifest.info.created = created;
+    manifest.info.reason = reason;
+    manifest.info.size = size;
+    manifest.info.id = manifest.info.created.toString(QStringLiteral("yyyyMMdd_HHmmsszzz_")) + reason;
+
+    QCryptographicHash whole(QCryptographicHash::Sha256);
+    for (qint64 offset = 0; offset < size;) {
+        const qsizetype length = nextChunkLength(data + offset, size - offset);
+        const QByteArrayView chunk(data + offset, length);
+        const QString hash = sha256Hex(chunk);
+        whole.addData(chunk);
+
+        bool written = false;
+        QString chunkError;
+        if (!writeChunk(chunk.toByteArray(), hash, &written, &chunkError)) {
+            return fail(chunkError);
+        }
+        manifest.chunks.append({hash, length});
+        offset += length;
+    }
+    manifest.sha256 = QString::fromLatin1(whole.result().toHex());
+    manifest.info.chunkCount = manifest.chunks.size();
+
+    QJsonArray chunks;
+    for (const ChunkRef &ref : manifest.chunks) {
+        chunks.append(QJsonObject{{QStringLiteral("hash"), ref.hash},
+                                  {QStringLiteral("size"), ref.size}});
+    }
+    const QJsonObject root{
+        {QStringLiteral("format"), kManifestFormat},
+        {QStringLiteral("id"), manifest.info.id},
+        {QStringLiteral("created"), manifest.info.created.toMSecsSinceEpoch()},
+        {QStringLiteral("reason"), reason},
+        {QStringLiteral("size"), size},
+        {QStringLiteral("sha256"), manifest.sha256},
+        {QStringLiteral("chunks"), chunks},
+    };
+
+    // 块全部落盘后才写清单：中途失败只会留下无主块，由下次 GC 回收
+    QDir().mkpath(m_root + QStringLiteral("/snapshots"));
+    QSaveFile out(manifestPath(manifest.info.id));
+    if (!out.open(QIODevice::WriteOnly)
+        || out.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0
+        || !out.commit()) {
+        return fail(QStringLiteral("无法写入快照清单"));
+    }
+
+    return manifest.info.id;
+}
+
+int BackupStore::adoptLegacyBackups(const QString &dir)
+{
+    const QDir legacy(dir);
+    const QStringList files = legacy.entryList({QStringLiteral("todolist_*.db")}, QDir::Files, QDir::Name);
+    int adopted = 0;
+    for (const QString &name : files) {
+        // todolist_20250101_120000_startup.db -> 20250101_120000 / startup
+        const QString stem = QFileInfo(name).completeBaseName().mid(9);
+        const QDateTime created = QDateTime::fromString(stem.left(15), QStringLiteral("yyyyMMdd_HHmmss"));
+        const QString reason = stem.mid(16);
+        if (!created.isValid() || reason.isEmpty()) {
+            continue;
+        }
+        const QString path = legacy.absoluteFilePath(name);
+        QString error;
+        if (addSnapshot(path, reason, &error, created).isEmpty()) {
+            qWarning() << "[BackupStore] keep legacy backup" << name << ":" << error;
+            continue;
+        }
+        if (QFile::remove(path)) {
+            ++adopted;
+        }
+    }
+    return adopted;
+}
+
+bool BackupStore::writeChunk(const QByteArray &data, const QString &hash, bool *written, QString *error)
+{
+    *written = false;
+    const QString path = chunkPath(hash);
+    if (QFile::exists(path)) {
+        return true;   // 内容寻址：同哈希即同内容
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)
+        || out.write(qCompress(data, kCompressionLevel)) < 0
+        || !out.commit()) {
+        if (error) *error = QStringLiteral("无法写入备份块");
+        return false;
+    }
+    *written = true;
+    return true;
+}
+
+bool BackupStore::readChunk(const ChunkRef &ref, QByteArray *data, QString *error) const
+{
+    QFile file(chunkPath(ref.hash));
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QStringLiteral("缺少块 %1").arg(ref.hash.left(12));
+        return false;
+    }
+    *data = qUncompress(file.readAll());
+    if (data->size() != ref.size || sha256Hex(*data) != ref.hash) {
+        if (error) *error = QStringLiteral("块 %1 已损坏").arg(ref.hash.left(12));
+        return false;
+    }
+    return true;
+}
+
+bool BackupStore::readManifest(const QString &id, Manifest *manifest, QString *error) const
+{
+    QFile file(manifestPath(id));
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QStringLiteral("无法读取清单");
+        return false;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QStringLiteral("format")).toInt() != kManifestFormat) {
+        if (error) *error = QStringLiteral("清单格式不受支持");
+        return false;
+    }
+
+    manifest->info.id = id;
+    manifest->info.created = QDateTime::fromMSecsSinceEpoch(root.value(QStringLiteral("created")).toInteger());
+    manifest->info.reason = root.value(QStringLiteral("reason")).toString();
+    manifest->info.size = root.value(QStringLiteral("size")).toInteger();
+    manifest->sha256 = root.value(QStringLiteral("sha256")).toString();
+    manifest->chunks.clear();
+    const QJsonArray chunks = root.value(QStringLiteral("chunks")).toArray();
+    for (const QJsonValue &value : chunks) {
+        const QJsonObject chunk = value.toObject();
+        manifest->chunks.append({chunk.value(QStringLiteral("hash")).toString(),
+                                 chunk.value(QStringLiteral("size")).toInteger()});
+    }
+    manifest->info.chunkCount = manifest->chunks.size();
+    return true;
+}
+
+QList<BackupStore::Snapshot> BackupStore::snapshots() const
+{
+    QList<Snapshot> result;
+    const QDir dir(m_root + QStringLiteral("/snapshots"));
+    const QStringList files = dir.entryList({QStringLiteral("*.json")}, QDir::Files);
+    for (const QString &name : files) {
+        Manifest manifest;
+        if (readManifest(QFileInfo(name).completeBaseName(), &manifest, nullptr)) {
+            result.append(manifest.info);
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Snapshot &a, const Snapshot &b) {
+        return a.created > b.created;
+    });
+    return result;
+}
+
+bool BackupStore::restoreTo(const QString &snapshotId, const QString &targetPath, QString *error) const
+{
+    Manifest manifest;
+    if (!readManifest(snapshotId, &manifest, error)) {
+        return false;
+    }
+
+    QSaveFile out(targetPath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        if (error) *error = QStringLiteral("无法创建恢复文件");
+        return false;
+    }
+    QCryptographicHash whole(QCryptographicHash::Sha256);
+    QByteArray data;
+    for (const ChunkRef &ref : manifest.chunks) {
+        if (!readChunk(ref, &data, error)) {
+            out.cancelWriting();
+            return false;
+        }
+        whole.addData(data);
+        if (out.write(data) != data.size()) {
+            out.cancelWriting();
+            if (error) *error = QStringLiteral("写入恢复文件失败");
+            return false;
+        }
+    }
+    if (QString::fromLatin1(whole.result().toHex()) != manifest.sha256) {
+        out.cancelWriting();
+        if (error) *error = QStringLiteral("快照整体校验失败");
+        return false;
+    }
+    if (!out.commit()) {
+        if (error) *error = QStringLiteral("写入恢复文件失败");
+        return false;
+    }
+    return true;
+}
+
+int BackupStore::applyRetention(const QDateTime &now)
+{
+    const QList<Snapshot> all = snapshots();
+    if (all.isEmpty()) {
+        return 0;
+    }
+
+    // 新的在前遍历：每个时间桶第一次出现的就是桶内最新的一份
+    QSet<QString> keep;
+    QSet<QString> hours;
+    QSet<QString> days;
+    QSet<QString> weeks;
+    keep.insert(all.first().id);   // 最新一份无条件保留
+    for (const Snapshot &snap : all) {
+        const qint64 ageSecs = snap.created.secsTo(now);
+        if (isPinnedReason(snap.reason) && ageSecs < qint64(kPinnedReasonDays) * 86400) {
+            keep.insert(snap.id);
+        }
+        if (ageSecs < qint64(kHourlyWindowHours) * 3600) {
+            const QString bucket = snap.created.toString(QStringLiteral("yyyyMMddHH"));
+            if (!hours.contains(bucket)) {
+                hours.insert(bucket);
+                keep.insert(snap.id);
+            }
+        }
+        if (ageSecs < qint64(kDailyWindowDays) * 86400) {
+            const QString bucket = snap.created.date().toString(QStringLiteral("yyyyMMdd"));
+            if (!days.contains(bucket)) {
+                days.insert(bucket);
+                keep.insert(snap.id);
+            }
+        }
+        if (ageSecs < qint64(kWeeklyWindowWeeks) * 7 * 86400) {
+            int weekYear = 0;
+            const int week = snap.created.date().weekNumber(&weekYear);
+            const QString bucket = QStringLiteral("%1-%2").arg(weekYear).arg(week);
+            if (!weeks.contains(bucket)) {
+                weeks.insert(bucket);
+                keep.insert(snap.id);
+            }
+        }
+    }
+
+    int removed = 0;
+    for (const Snapshot &snap : all) {
+        if (!keep.contains(snap.id) && QFile::remove(manifestPath(snap.id))) {
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+int BackupStore::collectGarbage()
+{
+    // 任一清单读不出来就放弃本轮回收，宁可多占空间也不能删掉仍被引用的块
+    QSet<QString> referenced;
+    const QDir dir(m_root + QStringLiteral("/snapshots"));
+    const QStringList files = dir.entryList({QStringLiteral("*.json")}, QDir::Files);
+    for (const QString &name : files) {
+        Manifest manifest;
+        if (!readManifest(QFileInfo(name).completeBaseName(), &manifest, nullptr)) {
+            qWarning() << "[BackupStore] skip gc, unreadable manifest" << name;
+            return 0;
+        }
+        for (const ChunkRef &ref : manifest.chunks) {
+            referenced.insert(ref.hash);
+        }
+    }
+
+    int removed = 0;
+    QDirIterator it(m_root + QStringLiteral("/chunks"), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        if (!referenced.contains(it.fileName()) && QFile::remove(path)) {
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+QStringList BackupStore::verifyAll(int *checked) const
+{
+    QStringList problems;
+    int count = 0;
+    const QDir dir(m_root + QStringLiteral("/snapshots"));
+    const QStringList files = dir.entryList({QStringLiteral("*.json")}, QDir::Files, QDir::Name);
+    QByteArray data;
+    for (const QString &name : files) {
+        const QString id = QFileInfo(name).completeBaseName();
+        ++count;
+
+        Manifest manifest;
+        QString error;
+        if (!readManifest(id, &manifest, &error)) {
+            problems.append(QStringLiteral("%1：%2").arg(id, error));
+            continue;
+        }
+        QCryptographicHash whole(QCryptographicHash::Sha256);
+        bool ok = true;
+        for (const ChunkRef &ref : manifest.chunks) {
+            if (!readChunk(ref, &data, &error)) {
+                problems.append(QStringLiteral("%1：%2").arg(id, error));
+                ok = false;
+                break;
+            }
+            whole.addData(data);
+        }
+        if (ok && QString::fromLatin1(whole.result().toHex()) != manifest.sha256) {
+            problems.append(QStringLiteral("%1：快照整体校验失败").arg(id));
+        }
+    }
+    if (checked) *checked = count;
+    return problems;
+}
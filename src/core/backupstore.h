@@ -0,0 +1,73 @@
+#ifndef BACKUPSTORE_H
+#define BACKUPSTORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QList>
+
+// 去重备份仓库：快照按内容定义分块（CDC），块以 SHA-256 寻址、zlib 压缩后只存一份；
+// 每个快照只是一份按序列出块哈希的清单。相邻快照绝大部分块相同，新增占用只有变化部分。
+//
+// 目录结构：
+//   <root>/chunks/ab/abcdef...   压缩后的块
+//   <root>/snapshots/<id>.json   快照清单
+//
+// 非线程安全：同一仓库的写操作（add / retention / gc）只在备份线程串行执行。
+class BackupStore
+{
+public:
+    struct Snapshot {
+        QString id;
+        QDateTime created;
+        QString reason;
+        qint64 size = 0;
+        int chunkCount = 0;
+    };
+
+    explicit BackupStore(const QString &rootDir);
+
+    QString rootDir() const { return m_root; }
+
+    // 把数据库文件存为新快照，返回快照 id；失败返回空串
+    QString addSnapshot(const QString &filePath, const QString &reason, QString *error,
+                        const QDateTime &created = QDateTime::currentDateTime());
+
+    // 旧版整库复制的备份（dir/todolist_yyyyMMdd_HHmmss_<reason>.db）按原时间存为快照后删除，
+    // 此后与其他快照一起参加分层保留。返回收编的份数
+    int adoptLegacyBackups(const QString &dir);
+
+    QList<Snapshot> snapshots() const;        // 新的在前
+
+    // 按清单重组为文件并校验整体哈希
+    bool restoreTo(const QString &snapshotId, const QString &targetPath, QString *error) const;
+
+    // 祖父-父-子保留：24 小时内每小时留最新一份，14 天内每天一份，8 周内每周一份；
+    // 手动 / 导入前 / 恢复前 / 迁移前快照至少保留 7 天。返回删除的快照数
+    int applyRetention(const QDateTime &now = QDateTime::currentDateTime());
+    int collectGarbage();                     // 删除不再被任何清单引用的块，返回删除数
+
+    // 逐个快照校验：块存在、可解压、内容哈希与文件名一致、整体哈希与清单一致
+    QStringList verifyAll(int *checked = nullptr) const;
+
+private:
+    struct ChunkRef {
+        QString hash;
+        qint64 size = 0;
+    };
+    struct Manifest {
+        Snapshot info;
+        QString sha256;
+        QList<ChunkRef> chunks;
+    };
+
+    QString chunkPath(const QString &hash) const;
+    QString manifestPath(const QString &id) const;
+    bool readManifest(const QString &id, Manifest *manifest, QString *error) const;
+    bool writeChunk(const QByteArray &data, const QString &hash, bool *written, QString *error);
+    bool readChunk(const ChunkRef &ref, QByteArray *data, QString *error) const;
+
+    QString m_root;
+};
+
+#endif // BACKUPSTORE_H
@@ -0,0 +1,46 @@
+# 核心模型、存储与搜索：应用与 tests/ 下的测试共用
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/todoitem.cpp \
+    $$PWD/todofolder.cpp \
+    $$PWD/databasemanager.cpp \
+    $$PWD/databasewriter.cpp \
+    $$PWD/backupengine.cpp \
+    $$PWD/backupstore.cpp \
+    $$PWD/importengine.cpp \
+    $$PWD/exportengine.cpp \
+    $$PWD/modelsnapshot.cpp \
+    $$PWD/searchengine.cpp \
+    $$PWD/searchquery.cpp \
+    $$PWD/fuzzymatcher.cpp \
+    $$PWD/palettecorpus.cpp \
+    $$PWD/pinyinindex.cpp \
+    $$PWD/pinyintable.cpp \
+    $$PWD/todostore.cpp \
+    $$PWD/todolistmodel.cpp \
+    $$PWD/stringpool.cpp
+
+HEADERS += \
+    $$PWD/todoitem.h \
+    $$PWD/todofolder.h \
+    $$PWD/databasemanager.h \
+    $$PWD/databasewriter.h \
+    $$PWD/backupengine.h \
+    $$PWD/backupstore.h \
+    $$PWD/importengine.h \
+    $$PWD/exportengine.h \
+    $$PWD/modelsnapshot.h \
+    $$PWD/searchengine.h \
+    $$PWD/searchquery.h \
+    $$PWD/fuzzymatcher.h \
+    $$PWD/palettecorpus.h \
+    $$PWD/pinyinindex.h \
+    $$PWD/pinyintable.h \
+    $$PWD/todostore.h \
+    $$PWD/todosnapshot.h \
+    $$PWD/todochangefeed.h \
+    $$PWD/todolistmodel.h \
+    $$PWD/keyeddiff.h \
+    $$PWD/stringpool.h \
+    $$PWD/simdfind.h
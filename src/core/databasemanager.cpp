@@ -1,10 +1,12 @@
 #include "databasemanager.h"
+#include "backupengine.h"
 
 #include <QCoreApplication>
 #include <QStandardPaths>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QRandomGenerator>
 #include <QDateTime>
 #include <QSqlQuery>
 #include <QSqlError>
@@ -15,9 +17,160 @@
 #include <QUuid>
 #include <QDebug>
 #include <QSet>
+#include <QHash>
+#include <atomic>
+#include <functional>
+#include <iterator>
 
 namespace {
-constexpr int kMaxBackups = 12;
+// 事项查询的统一列顺序（itemFromQuery 按此下标取值）
+const QString kItemColumns = QStringLiteral(
+    "id, title, details, createdTime, completedTime, updatedTime, isCompleted, folderId, "
+    "plannedDate, dueDate, priority, tagColor, isPinned, remindAt");
+constexpr int kItemColumnCount = 14;
+
+// 二级索引（v2 引入）；批量替换时先删后建
+struct IndexDef {
+    const char *name;
+    const char *target;
+};
+const IndexDef kSecondaryIndexes[] = {
+    {"idx_items_folder_deleted", "items(folderId, deletedTime)"},
+    {"idx_items_deletedTime",    "items(deletedTime)"},
+    {"idx_item_tags_tagId",      "item_tags(tagId)"},
+    {"idx_items_dueDate",        "items(dueDate)"},
+};
+
+// 数据变更计数：任何一行增删改都由触发器把 meta.change_counter 加一，
+// 配合随库生成的 database_id 判断内存快照（ModelSnapshot）是否仍与库一致。
+// 不用 PRAGMA data_version：它只反映本连接打开之后其他连接的提交，跨进程重启后无从比较
+const char *const kChangeTables[] = {"folders", "items", "tags", "item_tags"};
+const char *const kChangeEvents[] = {"INSERT", "UPDATE", "DELETE"};
+const QString kBumpChangeCounter = QStringLiteral("UPDATE meta SET value = value + 1 WHERE key = 'change_counter'");
+
+QString changeTriggerName(const char *table, const char *event)
+{
+    return QStringLiteral("trg_%1_%2").arg(QLatin1String(table), QLatin1String(event).toLower());
+}
+
+// 全文索引 items_fts（v5）：rowid 与 items.rowid 一致，标题 / 详情 / 标签（空格拼接）三列，
+// 由以下触发器随写入同步。搜索改由内存索引（SearchEngine）承担后在 v6 连同触发器撤掉；
+// 这里的定义只供已发布的 v5 迁移原样执行
+#define TAGS_OF(itemId) "(SELECT group_concat(t.name, ' ') FROM item_tags it JOIN tags t ON t.id = it.tagId " \
+                        "WHERE it.itemId = " itemId ")"
+struct TriggerDef {
+    const char *name;
+    const char *body;
+};
+const TriggerDef kSearchTriggers[] = {
+    {"trg_fts_items_insert", "AFTER INSERT ON items BEGIN "
+        "INSERT INTO items_fts (rowid, title, details, tags) VALUES (NEW.rowid, NEW.title, NEW.details, ''); END"},
+    {"trg_fts_items_update", "AFTER UPDATE OF title, details ON items BEGIN "
+        "UPDATE items_fts SET title = NEW.title, details = NEW.details WHERE rowid = NEW.rowid; END"},
+    {"trg_fts_items_delete", "AFTER DELETE ON items BEGIN "
+        "DELETE FROM items_fts WHERE rowid = OLD.rowid; END"},
+    {"trg_fts_tags_insert", "AFTER INSERT ON item_tags BEGIN "
+        "UPDATE items_fts SET tags = " TAGS_OF("NEW.itemId") " "
+        "WHERE rowid = (SELECT rowid FROM items WHERE id = NEW.itemId); END"},
+    {"trg_fts_tags_delete", "AFTER DELETE ON item_tags BEGIN "
+        "UPDATE items_fts SET tags = " TAGS_OF("OLD.itemId") " "
+        "WHERE rowid = (SELECT rowid FROM items WHERE id = OLD.itemId); END"},
+};
+const char *const kRebuildSearchIndex =
+    "INSERT INTO items_fts (rowid, title, details, tags) "
+    "SELECT i.rowid, i.title, i.details, " TAGS_OF("i.id") " FROM items i";
+#undef TAGS_OF
+
+// ON CONFLICT 更新 id 以外的全部列：行原地更新、rowid 不变，
+// deletedTime 置空与原先 INSERT OR REPLACE 的效果一致
+QString itemUpsertAssignments()
+{
+    QStringList assignments;
+    for (const QString &column : kItemColumns.split(QStringLiteral(", "))) {
+        if (column != QLatin1String("id")) {
+            assignments << QStringLiteral("%1 = excluded.%1").arg(column);
+        }
+    }
+    assignments << QStringLiteral("deletedTime = NULL");
+    return assignments.join(QStringLiteral(", "));
+}
+
+// 多行 INSERT：每条语句 kBulkRows 行，参数总数控制在 SQLite 旧版上限 999 以内
+constexpr int kBulkRows = 64;
+const QString kFolderInsertHead = QStringLiteral("INSERT INTO folders (id, name, createdTime, isPinned, color) VALUES ");
+const QString kItemInsertHead = QStringLiteral("INSERT INTO items (%1) VALUES ").arg(kItemColumns);
+const QString kLinkInsertHead = QStringLiteral("INSERT OR IGNORE INTO item_tags (itemId, tagId) VALUES ");
+
+QString multiRowValues(int columns, int rows)
+{
+    QStringList placeholders(columns, QStringLiteral("?"));
+    const QString row = QLatin1Char('(') + placeholders.join(QStringLiteral(", ")) + QLatin1Char(')');
+    return QStringList(rows, row).join(QStringLiteral(", "));
+}
+
+// 时间列以整数存储：时间点为 epoch 毫秒，日期为儒略日数；无效值存 NULL
+QVariant toEpochMs(const QDateTime &time)
+{
+    return time.isValid() ? QVariant(time.toMSecsSinceEpoch()) : QVariant();
+}
+
+QVariant toDayNumber(const QDate &date)
+{
+    return date.isValid() ? QVariant(date.toJulianDay()) : QVariant();
+}
+
+QDateTime fromEpochMs(const QVariant &value)
+{
+    return value.isNull() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(value.toLongLong());
+}
+
+QDate fromDayNumber(const QVariant &value)
+{
+    return value.isNull() ? QDate() : QDate::fromJulianDay(value.toLongLong());
+}
+
+// v3 之前的 ISO 文本列
+QVariant isoTimeToEpochMs(const QVariant &value)
+{
+    return toEpochMs(QDateTime::fromString(value.toString(), Qt::ISODate));
+}
+
+QVariant isoDateToDayNumber(const QVariant &value)
+{
+    return toDayNumber(QDate::fromString(value.toString(), Qt::ISODate));
+}
+
+// 与 folders 插入语句列序一致
+void bindFolderRow(QSqlQuery &query, const TodoFolder &folder)
+{
+    query.addBindValue(folder.getId());
+    query.addBindValue(folder.getName());
+    query.addBindValue(toEpochMs(folder.getCreatedTime()));
+    query.addBindValue(folder.isPinned() ? 1 : 0);
+    query.addBindValue(folder.getColor());
+}
+
+// 与 kItemColumns 列序一致
+void bindItemRow(QSqlQuery &query, const TodoItem &item, const QString &folderId)
+{
+    query.addBindValue(item.getId());
+    query.addBindValue(item.getTitle());
+    query.addBindValue(item.getDetails());
+    query.addBindValue(toEpochMs(item.getCreatedTime()));
+    query.addBindValue(toEpochMs(item.getCompletedTime()));
+    query.addBindValue(toEpochMs(item.getUpdatedTime()));
+    query.addBindValue(item.isCompleted() ? 1 : 0);
+    query.addBindValue(folderId);
+    query.addBindValue(toDayNumber(item.getPlannedDate()));
+    query.addBindValue(toDayNumber(item.getDueDate()));
+    query.addBindValue(item.getPriority());
+    query.addBindValue(item.getTagColor());
+    query.addBindValue(item.isPinned() ? 1 : 0);
+    query.addBindValue(toEpochMs(item.getRemindAt()));
+}
+
+// 标签删除的全局代数：任一连接删掉标签后递增，其他连接据此丢弃过期的 name->id 缓存
+std::atomic<quint64> g_tagGeneration{0};
 }
 
 DatabaseManager& DatabaseManager::instance()
@@ -54,7 +207,7 @@ bool DatabaseManager::initialize()
     if (!createSchema()) {
         return false;
     }
-    if (!upgradeSchema()) {
+    if (!migrateSchema()) {
         return false;
     }
 
@@ -63,18 +216,17 @@ bool DatabaseManager::initialize()
     // 回收站滚动清理（30 天）
     purgeExpiredDeleted();
 
-    // 启动备份（保证任何一次启动前的数据都有快照）
-    backupNow(QStringLiteral("startup"));
+    // 启动备份改由 BackupEngine 在后台线程完成，不再阻塞启动
     m_open = true;
     return true;
 }
 
 bool DatabaseManager::openDatabase()
 {
-    if (QSqlDatabase::contains(QStringLiteral("qt_sql_default_connection"))) {
-        m_db = QSqlDatabase::database(QStringLiteral("qt_sql_default_connection"));
+    if (QSqlDatabase::contains(m_connectionName)) {
+        m_db = QSqlDatabase::database(m_connectionName);
     } else {
-        m_db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"));
+        m_db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), m_connectionName);
     }
     m_db.setDatabaseName(m_dbPath);
 
@@ -91,6 +243,45 @@ bool DatabaseManager::openDatabase()
     return true;
 }
 
+bool DatabaseManager::attach(const QString &dbPath)
+{
+    // 建表、迁移、备份均已由主连接在 initialize() 中完成，这里只开连接
+    m_dbPath = dbPath;
+    if (!openDatabase()) {
+        return false;
+    }
+    m_open = true;
+    return true;
+}
+
+void DatabaseManager::detach()
+{
+    m_open = false;
+    m_statements.clear();   // 语句必须先于连接释放
+    invalidateTagCache();
+    m_failedStatement = QSqlQuery();
+    m_db.close();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+bool DatabaseManager::loadFromFile(const QString &dbPath, QList<TodoFolder> *folders, QString *error)
+{
+    // 独立连接读取另一份库文件（备份快照）；旧版本的快照先就地迁移到当前表结构
+    static std::atomic<int> serial{0};
+    DatabaseManager reader(QStringLiteral("todolist_reader_%1").arg(serial.fetch_add(1)));
+    reader.m_snapshotBeforeMigration = false;
+
+    bool ok = reader.attach(dbPath) && reader.createSchema() && reader.migrateSchema();
+    if (ok) {
+        *folders = reader.loadAll();
+        ok = reader.m_lastError.isEmpty();
+    }
+    if (error) *error = reader.m_lastError;
+    reader.detach();
+    return ok;
+}
+
 bool DatabaseManager::createSchema()
 {
     QSqlQuery query(m_db);
@@ -146,9 +337,78 @@ bool DatabaseManager::createSchema()
     return true;
 }
 
-bool DatabaseManager::upgradeSchema()
+bool DatabaseManager::migrateSchema()
 {
-    // 列级增量迁移：老库缺少的列用 ALTER TABLE 补上，不动已有数据
+    // 按 PRAGMA user_version 依次执行未应用的迁移；每步一个事务，成功后写入新版本号。
+    // createSchema 只建初始表结构，新库同样从 0 开始走完全部迁移，表结构只有一个来源
+    using Step = bool (DatabaseManager::*)();
+    struct Migration {
+        int version;
+        Step apply;
+    };
+    static const Migration kMigrations[] = {
+        {1, &DatabaseManager::migrateToV1},
+        {2, &DatabaseManager::migrateToV2},
+        {3, &DatabaseManager::migrateToV3},
+        {4, &DatabaseManager::migrateToV4},
+        {5, &DatabaseManager::migrateToV5},
+        {6, &DatabaseManager::migrateToV6},
+    };
+
+    QSqlQuery query(m_db);
+    if (!query.exec(QStringLiteral("PRAGMA user_version")) || !query.next()) {
+        m_lastError = QStringLiteral("读取数据库版本失败: %1").arg(query.lastError().text());
+        return false;
+    }
+    const int current = query.value(0).toInt();
+    query.finish();
+
+    const int latest = kMigrations[std::size(kMigrations) - 1].version;
+    if (current > latest) {
+        qWarning() << "[DatabaseManager] database schema v" << current << "is newer than supported v" << latest;
+        return true;
+    }
+
+    // 有数据的库在迁移前留一份快照（v3 会重建整表）
+    if (m_snapshotBeforeMigration && current < latest
+        && query.exec(QStringLiteral("SELECT 1 FROM folders LIMIT 1")) && query.next()) {
+        query.finish();
+        QString error;
+        BackupEngine::runBackup(m_dbPath, backupDir(), QStringLiteral("pre_migration"), &error);
+    }
+
+    for (const Migration &migration : kMigrations) {
+        if (migration.version <= current) {
+            continue;
+        }
+        if (!m_db.transaction()) {
+            m_lastError = QStringLiteral("无法开启事务");
+            return false;
+        }
+        if (!(this->*migration.apply)()) {
+            m_db.rollback();
+            qWarning() << "[DatabaseManager] migration to v" << migration.version << "failed:" << m_lastError;
+            return false;
+        }
+        QSqlQuery bump(m_db);
+        if (!bump.exec(QStringLiteral("PRAGMA user_version = %1").arg(migration.version))) {
+            m_lastError = QStringLiteral("写入数据库版本失败: %1").arg(bump.lastError().text());
+            m_db.rollback();
+            return false;
+        }
+        if (!m_db.commit()) {
+            m_lastError = QStringLiteral("提交失败");
+            m_db.rollback();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::migrateToV1()
+{
+    // 列级增量迁移：老库缺少的列用 ALTER TABLE 补上，不动已有数据。
+    // 引入版本号之前的库可能已补过其中一部分，因此按 table_info 判断
     QSqlQuery query(m_db);
     if (!query.exec(QStringLiteral("PRAGMA table_info(items)"))) {
         m_lastError = QStringLiteral("读取表结构失败: %1").arg(query.lastError().text());
@@ -176,6 +436,228 @@ bool DatabaseManager::upgradeSchema()
     return true;
 }
 
+bool DatabaseManager::migrateToV2()
+{
+    // 热点查询的二级索引：按文件夹列出/移入回收站、回收站清理、按标签删除、按截止日期筛选
+    return createSecondaryIndexes();
+}
+
+bool DatabaseManager::createSecondaryIndexes()
+{
+    QSqlQuery query(m_db);
+    for (const IndexDef &index : kSecondaryIndexes) {
+        if (!query.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS %1 ON %2")
+                        .arg(QLatin1String(index.name), QLatin1String(index.target)))) {
+            m_lastError = QStringLiteral("创建索引失败: %1").arg(query.lastError().text());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::migrateToV3()
+{
+    // 时间列由 ISO 文本改为整数（epoch 毫秒 / 儒略日数）。SQLite 不能改列类型，
+    // 新建表后逐行转换复制再替换旧表；转换在 C++ 中按 Qt::ISODate 解析，
+    // 与旧版写入时的本地时间语义一致（SQLite 的 strftime 会按 UTC 解释）
+    QSqlQuery query(m_db);
+    if (!query.exec(QStringLiteral(
+            "CREATE TABLE folders_v3 ("
+            "id TEXT PRIMARY KEY, "
+            "name TEXT NOT NULL, "
+            "createdTime INTEGER, "
+            "isPinned INTEGER DEFAULT 0, "
+            "color TEXT DEFAULT '#3b82f6')"))
+        || !query.exec(QStringLiteral(
+            "CREATE TABLE items_v3 ("
+            "id TEXT PRIMARY KEY, "
+            "title TEXT NOT NULL, "
+            "details TEXT, "
+            "createdTime INTEGER, "
+            "completedTime INTEGER, "
+            "updatedTime INTEGER, "
+            "isCompleted INTEGER DEFAULT 0, "
+            "folderId TEXT, "
+            "plannedDate INTEGER, "
+            "dueDate INTEGER, "
+            "priority INTEGER DEFAULT 0, "
+            "tagColor TEXT DEFAULT '#3b82f6', "
+            "isPinned INTEGER DEFAULT 0, "
+            "remindAt INTEGER, "
+            "deletedTime INTEGER)"))) {
+        m_lastError = QStringLiteral("创建新表失败: %1").arg(query.lastError().text());
+        return false;
+    }
+
+    QSqlQuery insert(m_db);
+    query.setForwardOnly(true);
+    if (!query.exec(QStringLiteral("SELECT id, name, createdTime, isPinned, color FROM folders"))) {
+        m_lastError = QStringLiteral("读取文件夹失败: %1").arg(query.lastError().text());
+        return false;
+    }
+    insert.prepare(QStringLiteral("INSERT INTO folders_v3 (id, name, createdTime, isPinned, color) VALUES (?, ?, ?, ?, ?)"));
+    while (query.next()) {
+        insert.addBindValue(query.value(0));
+        insert.addBindValue(query.value(1));
+        insert.addBindValue(isoTimeToEpochMs(query.value(2)));
+        insert.addBindValue(query.value(3));
+        insert.addBindValue(query.value(4));
+        if (!execChecked(insert, QStringLiteral("转换文件夹"))) return false;
+    }
+
+    if (!query.exec(QStringLiteral("SELECT %1, deletedTime FROM items").arg(kItemColumns))) {
+        m_lastError = QStringLiteral("读取事项失败: %1").arg(query.lastError().text());
+        return false;
+    }
+    insert.prepare(QStringLiteral("INSERT INTO items_v3 (%1, deletedTime) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)").arg(kItemColumns));
+    while (query.next()) {
+        insert.addBindValue(query.value(0));
+        insert.addBindValue(query.value(1));
+        insert.addBindValue(query.value(2));
+        insert.addBindValue(isoTimeToEpochMs(query.value(3)));
+        insert.addBindValue(isoTimeToEpochMs(query.value(4)));
+        insert.addBindValue(isoTimeToEpochMs(query.value(5)));
+        insert.addBindValue(query.value(6));
+        insert.addBindValue(query.value(7));
+        insert.addBindValue(isoDateToDayNumber(query.value(8)));
+        insert.addBindValue(isoDateToDayNumber(query.value(9)));
+        insert.addBindValue(query.value(10));
+        insert.addBindValue(query.value(11));
+        insert.addBindValue(query.value(12));
+        insert.addBindValue(isoTimeToEpochMs(query.value(13)));
+        insert.addBindValue(isoTimeToEpochMs(query.value(14)));
+        if (!execChecked(insert, QStringLiteral("转换事项"))) return false;
+    }
+    query.finish();
+
+    if (!query.exec(QStringLiteral("DROP TABLE folders"))
+        || !query.exec(QStringLiteral("DROP TABLE items"))
+        || !query.exec(QStringLiteral("ALTER TABLE folders_v3 RENAME TO folders"))
+        || !query.exec(QStringLiteral("ALTER TABLE items_v3 RENAME TO items"))) {
+        m_lastError = QStringLiteral("替换旧表失败: %1").arg(query.lastError().text());
+        return false;
+    }
+
+    // 旧表上的索引随 DROP 一并删除，重新创建
+    return migrateToV2();
+}
+
+bool DatabaseManager::migrateToV4()
+{
+    // 变更计数表与触发器；database_id 随机生成，区分重建过的库
+    QSqlQuery query(m_db);
+    if (!query.exec(QStringLiteral("CREATE TABLE IF NOT EXISTS meta (key TEXT PRIMARY KEY, value INTEGER NOT NULL)"))) {
+        m_lastError = QStringLiteral("创建元数据表失败: %1").arg(query.lastError().text());
+        return false;
+    }
+    query.prepare(QStringLiteral("INSERT OR IGNORE INTO meta (key, value) VALUES ('database_id', ?), ('change_counter', 0)"));
+    query.addBindValue(qint64(QRandomGenerator::system()->generate64() >> 1));
+    if (!execChecked(query, QStringLiteral("写入元数据"))) {
+        return false;
+    }
+    return createChangeTriggers();
+}
+
+bool DatabaseManager::createChangeTriggers()
+{
+    QSqlQuery query(m_db);
+    for (const char *table : kChangeTables) {
+        for (const char *event : kChangeEvents) {
+            if (!query.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS %1 AFTER %2 ON %3 BEGIN %4; END")
+                            .arg(changeTriggerName(table, event), QLatin1String(event),
+                                 QLatin1String(table), kBumpChangeCounter))) {
+                m_lastError = QStringLiteral("创建触发器失败: %1").arg(query.lastError().text());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+DatabaseManager::ChangeStamp DatabaseManager::changeStamp()
+{
+    ChangeStamp stamp;
+    QSqlQuery query(m_db);
+    if (!query.exec(QStringLiteral("SELECT key, value FROM meta"))) {
+        return stamp;
+    }
+    bool hasId = false;
+    while (query.next()) {
+        const QString key = query.value(0).toString();
+        if (key == QLatin1String("database_id")) {
+            stamp.databaseId = query.value(1).toLongLong();
+            hasId = true;
+        } else if (key == QLatin1String("change_counter")) {
+            stamp.counter = query.value(1).toLongLong();
+        }
+    }
+    if (!hasId) {
+        stamp.counter = -1;
+    }
+    return stamp;
+}
+
+bool DatabaseManager::migrateToV5()
+{
+    // 全文索引：trigram 分词按三字滑窗切分，中日韩文本不依赖分词词典，任意子串都能命中索引。
+    // 运行库未编译 FTS5 / trigram 时只记录警告，搜索回退到内存扫描
+    QSqlQuery query(m_db);
+    if (!query.exec(QStringLiteral("CREATE VIRTUAL TABLE IF NOT EXISTS items_fts "
+                                   "USING fts5(title, details, tags, tokenize = 'trigram')"))) {
+        qWarning() << "[DatabaseManager] full-text index unavailable:" << query.lastError().text();
+        return true;
+    }
+    return createSearchTriggers() && rebuildSearchIndex();
+}
+
+bool DatabaseManager::createSearchTriggers()
+{
+    QSqlQuery query(m_db);
+    for (const TriggerDef &trigger : kSearchTriggers) {
+        if (!query.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS %1 %2")
+                        .arg(QLatin1String(trigger.name), QLatin1String(trigger.body)))) {
+            m_lastError = QStringLiteral("创建触发器失败: %1").arg(query.lastError().text());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::rebuildSearchIndex()
+{
+    QSqlQuery query(m_db);
+    if (!query.exec(QStringLiteral("DELETE FROM items_fts"))
+        || !query.exec(QLatin1String(kRebuildSearchIndex))) {
+        m_lastError = QStringLiteral("重建全文索引失败: %1").arg(query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::migrateToV6()
+{
+    // 撤掉全文索引：每次写入都要经触发器维护、批量替换还要整表重建，却已没有查询使用它。
+    // 新库同样先经 v5 建出再在此删掉：已发布的迁移不改写
+    QSqlQuery query(m_db);
+    for (const TriggerDef &trigger : kSearchTriggers) {
+        if (!query.exec(QStringLiteral("DROP TRIGGER IF EXISTS %1").arg(QLatin1String(trigger.name)))) {
+            m_lastError = QStringLiteral("删除触发器失败: %1").arg(query.lastError().text());
+            return false;
+        }
+    }
+    if (!query.exec(QStringLiteral("DROP TABLE IF EXISTS items_fts"))) {
+        m_lastError = QStringLiteral("删除全文索引失败: %1").arg(query.lastError().text());
+        return false;
+    }
+    return true;
+}
+
+QString DatabaseManager::snapshotPath() const
+{
+    const QFileInfo dbInfo(m_dbPath);
+    return dbInfo.absoluteDir().filePath(dbInfo.completeBaseName() + QStringLiteral(".snapshot"));
+}
+
 void DatabaseManager::migrateLegacyDatabase()
 {
     // 旧版本数据库位于 exe 同级 data/ 目录；迁移到标准应用数据目录
@@ -217,40 +699,25 @@ void DatabaseManager::migrateFromJson()
 
     QJsonArray foldersArray = doc.object()[QStringLiteral("folders")].toArray();
 
+    // 经由模型类解析，与当前表结构共用同一套写入路径（含时间列编码与标签）
     if (m_db.transaction()) {
-        QSqlQuery query(m_db);
+        bool ok = true;
         for (const QJsonValue &folderVal : foldersArray) {
-            QJsonObject folderObj = folderVal.toObject();
-
-            query.prepare(QStringLiteral("INSERT OR REPLACE INTO folders (id, name, createdTime, isPinned, color) VALUES (?, ?, ?, ?, ?)"));
-            query.addBindValue(folderObj[QStringLiteral("id")].toString());
-            query.addBindValue(folderObj[QStringLiteral("name")].toString());
-            query.addBindValue(folderObj[QStringLiteral("createdTime")].toString());
-            query.addBindValue(folderObj[QStringLiteral("isPinned")].toBool() ? 1 : 0);
-            query.addBindValue(folderObj[QStringLiteral("color")].toString(QStringLiteral("#3b82f6")));
-            query.exec();
-
-            QJsonArray itemsArray = folderObj[QStringLiteral("items")].toArray();
-            for (const QJsonValue &itemVal : itemsArray) {
-                QJsonObject itemObj = itemVal.toObject();
-                query.prepare(QStringLiteral("INSERT OR REPLACE INTO items (id, title, details, createdTime, completedTime, updatedTime, isCompleted, folderId, plannedDate, dueDate, priority, tagColor, isPinned) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
-                query.addBindValue(itemObj[QStringLiteral("id")].toString());
-                query.addBindValue(itemObj[QStringLiteral("title")].toString());
-                query.addBindValue(itemObj[QStringLiteral("details")].toString());
-                query.addBindValue(itemObj[QStringLiteral("createdTime")].toString());
-                query.addBindValue(itemObj[QStringLiteral("completedTime")].toString());
-                query.addBindValue(itemObj[QStringLiteral("updatedTime")].toString());
-                query.addBindValue(itemObj[QStringLiteral("isCompleted")].toBool() ? 1 : 0);
-                query.addBindValue(folderObj[QStringLiteral("id")].toString());
-                query.addBindValue(itemObj[QStringLiteral("plannedDate")].toString());
-                query.addBindValue(itemObj[QStringLiteral("dueDate")].toString());
-                query.addBindValue(itemObj[QStringLiteral("priority")].toInt(0));
-                query.addBindValue(itemObj[QStringLiteral("tagColor")].toString(QStringLiteral("#3b82f6")));
-                query.addBindValue(itemObj[QStringLiteral("isPinned")].toBool() ? 1 : 0);
-                query.exec();
+            const TodoFolder folder(folderVal.toObject());
+            ok = writeFolderRow(StmtUpsertFolder, folder, QStringLiteral("迁移文件夹"));
+            for (const TodoItem &item : folder.getItems()) {
+                if (!ok) break;
+                ok = writeItemRow(StmtUpsertItem, item, folder.getId(), QStringLiteral("迁移事项"))
+                     && syncItemTags(item.getId(), item.getTags(), false);
             }
+            if (!ok) break;
+        }
+        if (!ok || !m_db.commit()) {
+            m_db.rollback();
+            invalidateTagCache();
+            qWarning() << "[DatabaseManager] JSON migration failed:" << m_lastError;
+            return;   // 保留原 JSON，下次启动重试
         }
-        m_db.commit();
     }
 
     QString backupPath = jsonPath + QStringLiteral(".migrated.bak");
@@ -265,81 +732,67 @@ QList<TodoFolder> DatabaseManager::loadAll()
         return folders;
     }
 
-    QSqlQuery folderQuery(m_db);
-    if (!folderQuery.exec(QStringLiteral("SELECT id, name, createdTime, isPinned, color FROM folders ORDER BY isPinned DESC, createdTime DESC"))) {
+    // 固定三条集合查询：文件夹 / 全部标签关联 / 全部未删除事项，
+    // 内存中按 id 归组一次装配完成，语句数与事项数量无关
+    QSqlQuery &folderQuery = statement(StmtLoadFolders);
+    if (!folderQuery.exec()) {
         m_lastError = folderQuery.lastError().text();
         return folders;
     }
 
-    QSqlQuery itemQuery(m_db);
-    QSqlQuery tagQuery(m_db);
-
+    QHash<QString, int> folderIndex;
     while (folderQuery.next()) {
         TodoFolder folder;
         folder.setId(folderQuery.value(0).toString());
         folder.setName(folderQuery.value(1).toString());
-        folder.setCreatedTime(QDateTime::fromString(folderQuery.value(2).toString(), Qt::ISODate));
+        folder.setCreatedTime(fromEpochMs(folderQuery.value(2)));
         folder.setPinned(folderQuery.value(3).toInt() == 1);
         folder.setColor(folderQuery.value(4).toString());
+        folderIndex.insert(folder.getId(), folders.size());
+        folders.append(folder);
+    }
+    folderQuery.finish();
 
-        itemQuery.prepare(QStringLiteral("SELECT id, title, details, createdTime, completedTime, updatedTime, isCompleted, folderId, plannedDate, dueDate, priority, tagColor, isPinned, remindAt FROM items WHERE folderId = ? AND deletedTime IS NULL ORDER BY isPinned DESC, createdTime DESC"));
-        itemQuery.addBindValue(folder.getId());
-        if (!itemQuery.exec()) {
-            continue;
-        }
+    QHash<QString, QStringList> tagsByItem;
+    QSqlQuery &tagQuery = statement(StmtLoadItemTags);
+    if (!tagQuery.exec()) {
+        m_lastError = tagQuery.lastError().text();
+        return folders;
+    }
+    while (tagQuery.next()) {
+        tagsByItem[tagQuery.value(0).toString()].append(tagQuery.value(1).toString());
+    }
+    tagQuery.finish();
 
-        while (itemQuery.next()) {
-            TodoItem item;
-            item.setId(itemQuery.value(0).toString());
-            item.setTitle(itemQuery.value(1).toString());
-            item.setDetails(itemQuery.value(2).toString());
-            item.setCreatedTime(QDateTime::fromString(itemQuery.value(3).toString(), Qt::ISODate));
-            item.setCompletedTime(QDateTime::fromString(itemQuery.value(4).toString(), Qt::ISODate));
-            item.setUpdatedTime(QDateTime::fromString(itemQuery.value(5).toString(), Qt::ISODate));
-            item.setCompleted(itemQuery.value(6).toInt() == 1);
-            item.setFolderId(itemQuery.value(7).toString());
-            item.setPlannedDate(QDate::fromString(itemQuery.value(8).toString(), Qt::ISODate));
-            item.setDueDate(QDate::fromString(itemQuery.value(9).toString(), Qt::ISODate));
-            item.setPriority(itemQuery.value(10).toInt());
-            item.setTagColor(itemQuery.value(11).toString());
-            item.setPinned(itemQuery.value(12).toInt() == 1);
-            item.setRemindAt(QDateTime::fromString(itemQuery.value(13).toString(), Qt::ISODate));
-
-            tagQuery.prepare(QStringLiteral("SELECT t.name FROM tags t JOIN item_tags it ON t.id = it.tagId WHERE it.itemId = ?"));
-            tagQuery.addBindValue(item.getId());
-            if (tagQuery.exec()) {
-                QStringList tags;
-                while (tagQuery.next()) {
-                    tags.append(tagQuery.value(0).toString());
-                }
-                item.setTags(tags);
-            }
+    // 全局排序与原先"每个文件夹内"的排序一致，追加后各文件夹内顺序不变
+    QSqlQuery &itemQuery = statement(StmtLoadItems);
+    if (!itemQuery.exec()) {
+        m_lastError = itemQuery.lastError().text();
+        return folders;
+    }
 
-            folder.addItem(item);
+    while (itemQuery.next()) {
+        const auto it = folderIndex.constFind(itemQuery.value(7).toString());
+        if (it == folderIndex.constEnd()) {
+            continue;   // 所属文件夹已不存在的孤儿事项不加载（与旧逻辑一致）
         }
-
-        folders.append(folder);
+        TodoItem item = itemFromQuery(itemQuery);
+        item.setTags(tagsByItem.take(item.getId()));
+        item.setUpdatedTime(fromEpochMs(itemQuery.value(5)));
+        folders[it.value()].getItemsRef().append(item);
     }
-
+    itemQuery.finish();
     return folders;
 }
 
 bool DatabaseManager::upsertFolder(const TodoFolder &folder)
 {
-    QSqlQuery query(m_db);
-    query.prepare(QStringLiteral("INSERT OR REPLACE INTO folders (id, name, createdTime, isPinned, color) VALUES (?, ?, ?, ?, ?)"));
-    query.addBindValue(folder.getId());
-    query.addBindValue(folder.getName());
-    query.addBindValue(folder.getCreatedTime().toString(Qt::ISODate));
-    query.addBindValue(folder.isPinned() ? 1 : 0);
-    query.addBindValue(folder.getColor());
-    return execChecked(query, QStringLiteral("保存文件夹"));
+    return writeFolderRow(StmtUpsertFolder, folder, QStringLiteral("保存文件夹"));
 }
 
 bool DatabaseManager::deleteFolder(const QString &folderId)
 {
-    if (!m_db.transaction()) {
-        m_lastError = QStringLiteral("无法开启事务");
+    if (!beginWrite()) {
         return false;
     }
 
@@ -347,80 +800,133 @@ bool DatabaseManager::deleteFolder(const QString &folderId)
 
     // 文件夹下的事项软删除进回收站（保留 30 天），而不是直接抹掉
     query.prepare(QStringLiteral("UPDATE items SET deletedTime = ? WHERE folderId = ? AND deletedTime IS NULL"));
-    query.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
+    query.addBindValue(QDateTime::currentMSecsSinceEpoch());
     query.addBindValue(folderId);
-    if (!execChecked(query, QStringLiteral("文件夹事项移入回收站"))) { m_db.rollback(); return false; }
+    if (!execChecked(query, QStringLiteral("文件夹事项移入回收站"))) { rollbackWrite(); return false; }
 
     query.prepare(QStringLiteral("DELETE FROM folders WHERE id = ?"));
     query.addBindValue(folderId);
-    if (!execChecked(query, QStringLiteral("删除文件夹"))) { m_db.rollback(); return false; }
+    if (!execChecked(query, QStringLiteral("删除文件夹"))) { rollbackWrite(); return false; }
 
-    if (!m_db.commit()) {
-        m_lastError = QStringLiteral("提交失败");
-        m_db.rollback();
-        return false;
-    }
-    return true;
+    return commitWrite();
 }
 
 bool DatabaseManager::upsertItem(const TodoItem &item)
 {
-    if (!m_db.transaction()) {
-        m_lastError = QStringLiteral("无法开启事务");
+    if (!beginWrite()) {
         return false;
     }
 
-    QSqlQuery query(m_db);
-    query.prepare(QStringLiteral("INSERT OR REPLACE INTO items (id, title, details, createdTime, completedTime, updatedTime, isCompleted, folderId, plannedDate, dueDate, priority, tagColor, isPinned, remindAt) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
-    query.addBindValue(item.getId());
-    query.addBindValue(item.getTitle());
-    query.addBindValue(item.getDetails());
-    query.addBindValue(item.getCreatedTime().toString(Qt::ISODate));
-    query.addBindValue(item.getCompletedTime().toString(Qt::ISODate));
-    query.addBindValue(item.getUpdatedTime().toString(Qt::ISODate));
-    query.addBindValue(item.isCompleted() ? 1 : 0);
-    query.addBindValue(item.getFolderId());
-    query.addBindValue(item.getPlannedDate().toString(Qt::ISODate));
-    query.addBindValue(item.getDueDate().toString(Qt::ISODate));
-    query.addBindValue(item.getPriority());
-    query.addBindValue(item.getTagColor());
-    query.addBindValue(item.isPinned() ? 1 : 0);
-    query.addBindValue(item.getRemindAt().isValid() ? item.getRemindAt().toString(Qt::ISODate) : QVariant());
-    if (!execChecked(query, QStringLiteral("保存事项"))) { m_db.rollback(); return false; }
+    if (!writeItemRow(StmtUpsertItem, item, item.getFolderId(), QStringLiteral("保存事项"))) { rollbackWrite(); return false; }
 
-    // 同步标签关联
-    query.prepare(QStringLiteral("DELETE FROM item_tags WHERE itemId = ?"));
-    query.addBindValue(item.getId());
-    if (!execChecked(query, QStringLiteral("更新事项标签"))) { m_db.rollback(); return false; }
+    // 同步标签关联（只增删有变化的行）
+    if (!syncItemTags(item.getId(), item.getTags(), false)) { rollbackWrite(); return false; }
+
+    return commitWrite();
+}
 
-    for (const QString &tag : item.getTags()) {
-        query.prepare(QStringLiteral("INSERT OR IGNORE INTO tags (id, name) VALUES (?, ?)"));
-        query.addBindValue(QUuid::createUuid().toString(QUuid::WithoutBraces));
-        query.addBindValue(tag);
-        if (!execChecked(query, QStringLiteral("保存标签"))) { m_db.rollback(); return false; }
+bool DatabaseManager::deleteItem(const QString &itemId)
+{
+    // 软删除：标记 deletedTime，进入回收站（30 天内可恢复）
+    QSqlQuery &query = statement(StmtSoftDeleteItem);
+    query.addBindValue(QDateTime::currentMSecsSinceEpoch());
+    query.addBindValue(itemId);
+    return execChecked(query, QStringLiteral("移入回收站"));
+}
 
-        query.prepare(QStringLiteral("INSERT OR IGNORE INTO item_tags (itemId, tagId) SELECT ?, id FROM tags WHERE name = ?"));
-        query.addBindValue(item.getId());
-        query.addBindValue(tag);
-        if (!execChecked(query, QStringLiteral("关联标签"))) { m_db.rollback(); return false; }
+bool DatabaseManager::beginBatch()
+{
+    if (!m_db.transaction()) {
+        m_lastError = QStringLiteral("无法开启事务");
+        return false;
     }
+    m_inBatch = true;
+    return true;
+}
 
+bool DatabaseManager::commitBatch()
+{
+    m_inBatch = false;
     if (!m_db.commit()) {
         m_lastError = QStringLiteral("提交失败");
         m_db.rollback();
+        invalidateTagCache();
         return false;
     }
     return true;
 }
 
-bool DatabaseManager::deleteItem(const QString &itemId)
+void DatabaseManager::rollbackBatch()
 {
-    // 软删除：标记 deletedTime，进入回收站（30 天内可恢复）
-    QSqlQuery query(m_db);
-    query.prepare(QStringLiteral("UPDATE items SET deletedTime = ? WHERE id = ?"));
-    query.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
-    query.addBindValue(itemId);
-    return execChecked(query, QStringLiteral("移入回收站"));
+    m_inBatch = false;
+    m_db.rollback();
+    invalidateTagCache();
+}
+
+qint64 DatabaseManager::countActiveItems()
+{
+    QSqlQuery &query = statement(StmtCountActiveItems);
+    if (!execChecked(query, QStringLiteral("统计事项")) || !query.next()) {
+        return -1;
+    }
+    const qint64 count = query.value(0).toLongLong();
+    query.finish();
+    return count;
+}
+
+bool DatabaseManager::visitAll(const std::function<bool(const TodoFolder &)> &onFolder,
+                               const std::function<bool(const TodoItem &)> &onItem)
+{
+    // 整个遍历放在一个读事务里：WAL 下读到一致的快照，期间其他连接照常提交
+    const bool inTransaction = m_db.transaction();
+    const auto done = [&](bool ok) {
+        if (inTransaction) {
+            m_db.commit();
+        }
+        return ok;
+    };
+
+    // 文件夹数量少，先整体读出；事项按文件夹逐个游标读取（走 folderId 索引），任何时刻只驻留一行
+    QList<TodoFolder> folders;
+    QSqlQuery &folderQuery = statement(StmtLoadFolders);
+    if (!execChecked(folderQuery, QStringLiteral("读取文件夹"))) {
+        return done(false);
+    }
+    while (folderQuery.next()) {
+        TodoFolder folder;
+        folder.setId(folderQuery.value(0).toString());
+        folder.setName(folderQuery.value(1).toString());
+        folder.setCreatedTime(fromEpochMs(folderQuery.value(2)));
+        folder.setPinned(folderQuery.value(3).toInt() == 1);
+        folder.setColor(folderQuery.value(4).toString());
+        folders.append(folder);
+    }
+    folderQuery.finish();
+
+    QSqlQuery &itemQuery = statement(StmtFolderItemsWithTags);
+    for (const TodoFolder &folder : folders) {
+        if (!onFolder(folder)) {
+            return done(false);
+        }
+        itemQuery.addBindValue(folder.getId());
+        if (!execChecked(itemQuery, QStringLiteral("读取事项"))) {
+            return done(false);
+        }
+        while (itemQuery.next()) {
+            TodoItem item = itemFromQuery(itemQuery);
+            const QString tags = itemQuery.value(kItemColumnCount).toString();
+            if (!tags.isEmpty()) {
+                item.setTags(tags.split(QChar(0x1f)));
+                item.setUpdatedTime(fromEpochMs(itemQuery.value(5)));
+            }
+            if (!onItem(item)) {
+                itemQuery.finish();
+                return done(false);
+            }
+        }
+        itemQuery.finish();
+    }
+    return done(true);
 }
 
 QList<TodoItem> DatabaseManager::loadDeleted()
@@ -431,28 +937,13 @@ QList<TodoItem> DatabaseManager::loadDeleted()
     }
 
     QSqlQuery query(m_db);
-    if (!query.exec(QStringLiteral("SELECT id, title, details, createdTime, completedTime, updatedTime, isCompleted, folderId, plannedDate, dueDate, priority, tagColor, isPinned, remindAt FROM items WHERE deletedTime IS NOT NULL ORDER BY deletedTime DESC"))) {
+    if (!query.exec(QStringLiteral("SELECT %1 FROM items WHERE deletedTime IS NOT NULL ORDER BY deletedTime DESC").arg(kItemColumns))) {
         m_lastError = query.lastError().text();
         return items;
     }
 
     while (query.next()) {
-        TodoItem item;
-        item.setId(query.value(0).toString());
-        item.setTitle(query.value(1).toString());
-        item.setDetails(query.value(2).toString());
-        item.setCreatedTime(QDateTime::fromString(query.value(3).toString(), Qt::ISODate));
-        item.setCompletedTime(QDateTime::fromString(query.value(4).toString(), Qt::ISODate));
-        item.setUpdatedTime(QDateTime::fromString(query.value(5).toString(), Qt::ISODate));
-        item.setCompleted(query.value(6).toInt() == 1);
-        item.setFolderId(query.value(7).toString());
-        item.setPlannedDate(QDate::fromString(query.value(8).toString(), Qt::ISODate));
-        item.setDueDate(QDate::fromString(query.value(9).toString(), Qt::ISODate));
-        item.setPriority(query.value(10).toInt());
-        item.setTagColor(query.value(11).toString());
-        item.setPinned(query.value(12).toInt() == 1);
-        item.setRemindAt(QDateTime::fromString(query.value(13).toString(), Qt::ISODate));
-        items.append(item);
+        items.append(itemFromQuery(query));
     }
     return items;
 }
@@ -482,57 +973,57 @@ bool DatabaseManager::restoreItem(const QString &itemId)
 
 bool DatabaseManager::hardDeleteItem(const QString &itemId)
 {
-    if (!m_db.transaction()) {
-        m_lastError = QStringLiteral("无法开启事务");
+    if (!beginWrite()) {
         return false;
     }
 
     QSqlQuery query(m_db);
     query.prepare(QStringLiteral("DELETE FROM item_tags WHERE itemId = ?"));
     query.addBindValue(itemId);
-    if (!execChecked(query, QStringLiteral("删除事项标签"))) { m_db.rollback(); return false; }
+    if (!execChecked(query, QStringLiteral("删除事项标签"))) { rollbackWrite(); return false; }
 
     query.prepare(QStringLiteral("DELETE FROM items WHERE id = ?"));
     query.addBindValue(itemId);
-    if (!execChecked(query, QStringLiteral("彻底删除事项"))) { m_db.rollback(); return false; }
+    if (!execChecked(query, QStringLiteral("彻底删除事项"))) { rollbackWrite(); return false; }
 
-    if (!m_db.commit()) {
-        m_lastError = QStringLiteral("提交失败");
-        m_db.rollback();
-        return false;
-    }
-    return true;
+    return commitWrite();
 }
 
 int DatabaseManager::purgeExpiredDeleted()
 {
-    if (!isOpen()) {
+    // 启动时在 m_open 置位前调用，只要求连接已打开
+    if (!m_db.isOpen()) {
         return 0;
     }
 
-    // 找出超过 30 天的回收站项，逐个彻底删除（保证标签关联级联清理）
-    QSqlQuery query(m_db);
-    const QString cutoff = QDateTime::currentDateTime().addDays(-30).toString(Qt::ISODate);
-    query.prepare(QStringLiteral("SELECT id FROM items WHERE deletedTime IS NOT NULL AND deletedTime < ?"));
-    query.addBindValue(cutoff);
-    if (!query.exec()) {
+    // 集合式清理：一个事务两条 DELETE，先删标签关联再删事项（deletedTime 上有索引）
+    const qint64 cutoff = QDateTime::currentDateTime().addDays(-30).toMSecsSinceEpoch();
+
+    if (!beginWrite()) {
         return 0;
     }
 
-    QStringList expired;
-    while (query.next()) {
-        expired.append(query.value(0).toString());
-    }
-    for (const QString &id : expired) {
-        hardDeleteItem(id);
+    QSqlQuery query(m_db);
+    query.prepare(QStringLiteral(
+        "DELETE FROM item_tags WHERE itemId IN "
+        "(SELECT id FROM items WHERE deletedTime IS NOT NULL AND deletedTime < ?)"));
+    query.addBindValue(cutoff);
+    if (!execChecked(query, QStringLiteral("清理回收站标签"))) { rollbackWrite(); return 0; }
+
+    query.prepare(QStringLiteral("DELETE FROM items WHERE deletedTime IS NOT NULL AND deletedTime < ?"));
+    query.addBindValue(cutoff);
+    if (!execChecked(query, QStringLiteral("清理回收站"))) { rollbackWrite(); return 0; }
+    const int itemRows = query.numRowsAffected();
+
+    if (!commitWrite()) {
+        return 0;
     }
-    return expired.size();
+    return itemRows;
 }
 
 bool DatabaseManager::moveItem(const QString &itemId, const QString &targetFolderId)
 {
-    QSqlQuery query(m_db);
-    query.prepare(QStringLiteral("UPDATE items SET folderId = ? WHERE id = ?"));
+    QSqlQuery &query = statement(StmtMoveItem);
     query.addBindValue(targetFolderId);
     query.addBindValue(itemId);
     return execChecked(query, QStringLiteral("移动事项"));
@@ -540,34 +1031,13 @@ bool DatabaseManager::moveItem(const QString &itemId, const QString &targetFolde
 
 bool DatabaseManager::setItemTags(const QString &itemId, const QStringList &tags)
 {
-    if (!m_db.transaction()) {
-        m_lastError = QStringLiteral("无法开启事务");
+    if (!beginWrite()) {
         return false;
     }
 
-    QSqlQuery query(m_db);
-    query.prepare(QStringLiteral("DELETE FROM item_tags WHERE itemId = ?"));
-    query.addBindValue(itemId);
-    if (!execChecked(query, QStringLiteral("清除事项标签"))) { m_db.rollback(); return false; }
-
-    for (const QString &tag : tags) {
-        query.prepare(QStringLiteral("INSERT OR IGNORE INTO tags (id, name) VALUES (?, ?)"));
-        query.addBindValue(QUuid::createUuid().toString(QUuid::WithoutBraces));
-        query.addBindValue(tag);
-        if (!execChecked(query, QStringLiteral("保存标签"))) { m_db.rollback(); return false; }
+    if (!syncItemTags(itemId, tags, false)) { rollbackWrite(); return false; }
 
-        query.prepare(QStringLiteral("INSERT OR IGNORE INTO item_tags (itemId, tagId) SELECT ?, id FROM tags WHERE name = ?"));
-        query.addBindValue(itemId);
-        query.addBindValue(tag);
-        if (!execChecked(query, QStringLiteral("关联标签"))) { m_db.rollback(); return false; }
-    }
-
-    if (!m_db.commit()) {
-        m_lastError = QStringLiteral("提交失败");
-        m_db.rollback();
-        return false;
-    }
-    return true;
+    return commitWrite();
 }
 
 QStringList DatabaseManager::allTagNames()
@@ -587,144 +1057,422 @@ QStringList DatabaseManager::allTagNames()
 
 bool DatabaseManager::addTag(const QString &name)
 {
-    QSqlQuery query(m_db);
-    query.prepare(QStringLiteral("INSERT OR IGNORE INTO tags (id, name) VALUES (?, ?)"));
-    query.addBindValue(QUuid::createUuid().toString(QUuid::WithoutBraces));
-    query.addBindValue(name);
-    return execChecked(query, QStringLiteral("新建标签"));
+    return !tagId(name).isEmpty();
 }
 
 bool DatabaseManager::removeTag(const QString &name)
 {
-    if (!m_db.transaction()) {
-        m_lastError = QStringLiteral("无法开启事务");
+    if (!beginWrite()) {
         return false;
     }
 
     QSqlQuery query(m_db);
     query.prepare(QStringLiteral("DELETE FROM item_tags WHERE tagId IN (SELECT id FROM tags WHERE name = ?)"));
     query.addBindValue(name);
-    if (!execChecked(query, QStringLiteral("删除标签关联"))) { m_db.rollback(); return false; }
+    if (!execChecked(query, QStringLiteral("删除标签关联"))) { rollbackWrite(); return false; }
 
     query.prepare(QStringLiteral("DELETE FROM tags WHERE name = ?"));
     query.addBindValue(name);
-    if (!execChecked(query, QStringLiteral("删除标签"))) { m_db.rollback(); return false; }
+    if (!execChecked(query, QStringLiteral("删除标签"))) { rollbackWrite(); return false; }
 
-    if (!m_db.commit()) {
-        m_lastError = QStringLiteral("提交失败");
-        m_db.rollback();
+    if (!commitWrite()) {
         return false;
     }
+    // 本连接直接剔除；其他连接的缓存里还留着旧 id，通过代数变化让它们重载
+    m_tagIds.remove(name);
+    m_tagGeneration = ++g_tagGeneration;
     return true;
 }
 
-bool DatabaseManager::replaceAll(const QList<TodoFolder> &folders)
+bool DatabaseManager::beginBulkReplace()
 {
-    // 原子替换：事务内先清后插，任何失败整体回滚
     if (!m_db.transaction()) {
         m_lastError = QStringLiteral("无法开启事务");
         return false;
     }
 
+    // 先删二级索引再清表，插入期间不维护索引，提交前统一重建；
+    // DDL 同在事务内，回滚时索引随之恢复
     QSqlQuery query(m_db);
-    if (!query.exec(QStringLiteral("DELETE FROM item_tags")) ||
+    for (const IndexDef &index : kSecondaryIndexes) {
+        if (!query.exec(QStringLiteral("DROP INDEX IF EXISTS %1").arg(QLatin1String(index.name)))) {
+            m_lastError = QStringLiteral("删除索引失败: %1").arg(query.lastError().text());
+            abortBulkReplace();
+            return false;
+        }
+    }
+    // 变更触发器同样先删：整体替换只需把计数加一次，不必逐行触发
+    for (const char *table : kChangeTables) {
+        for (const char *event : kChangeEvents) {
+            if (!query.exec(QStringLiteral("DROP TRIGGER IF EXISTS %1").arg(changeTriggerName(table, event)))) {
+                m_lastError = QStringLiteral("删除触发器失败: %1").arg(query.lastError().text());
+                abortBulkReplace();
+                return false;
+            }
+        }
+    }
+    if (!query.exec(kBumpChangeCounter) ||
+        !query.exec(QStringLiteral("DELETE FROM item_tags")) ||
         !query.exec(QStringLiteral("DELETE FROM items")) ||
         !query.exec(QStringLiteral("DELETE FROM folders"))) {
         m_lastError = query.lastError().text();
-        m_db.rollback();
+        abortBulkReplace();
         return false;
     }
 
-    for (const TodoFolder &folder : folders) {
-        query.prepare(QStringLiteral("INSERT INTO folders (id, name, createdTime, isPinned, color) VALUES (?, ?, ?, ?, ?)"));
-        query.addBindValue(folder.getId());
-        query.addBindValue(folder.getName());
-        query.addBindValue(folder.getCreatedTime().toString(Qt::ISODate));
-        query.addBindValue(folder.isPinned() ? 1 : 0);
-        query.addBindValue(folder.getColor());
-        if (!execChecked(query, QStringLiteral("导入文件夹"))) { m_db.rollback(); return false; }
-
-        for (const TodoItem &item : folder.getItems()) {
-            query.prepare(QStringLiteral("INSERT INTO items (id, title, details, createdTime, completedTime, updatedTime, isCompleted, folderId, plannedDate, dueDate, priority, tagColor, isPinned, remindAt) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
-            query.addBindValue(item.getId());
-            query.addBindValue(item.getTitle());
-            query.addBindValue(item.getDetails());
-            query.addBindValue(item.getCreatedTime().toString(Qt::ISODate));
-            query.addBindValue(item.getCompletedTime().toString(Qt::ISODate));
-            query.addBindValue(item.getUpdatedTime().toString(Qt::ISODate));
-            query.addBindValue(item.isCompleted() ? 1 : 0);
-            query.addBindValue(folder.getId());
-            query.addBindValue(item.getPlannedDate().toString(Qt::ISODate));
-            query.addBindValue(item.getDueDate().toString(Qt::ISODate));
-            query.addBindValue(item.getPriority());
-            query.addBindValue(item.getTagColor());
-            query.addBindValue(item.isPinned() ? 1 : 0);
-            query.addBindValue(item.getRemindAt().isValid() ? item.getRemindAt().toString(Qt::ISODate) : QVariant());
-            if (!execChecked(query, QStringLiteral("导入事项"))) { m_db.rollback(); return false; }
-
-            for (const QString &tag : item.getTags()) {
-                query.prepare(QStringLiteral("INSERT OR IGNORE INTO tags (id, name) VALUES (?, ?)"));
-                query.addBindValue(QUuid::createUuid().toString(QUuid::WithoutBraces));
-                query.addBindValue(tag);
-                if (!execChecked(query, QStringLiteral("导入标签"))) { m_db.rollback(); return false; }
-
-                query.prepare(QStringLiteral("INSERT OR IGNORE INTO item_tags (itemId, tagId) SELECT ?, id FROM tags WHERE name = ?"));
-                query.addBindValue(item.getId());
-                query.addBindValue(tag);
-                if (!execChecked(query, QStringLiteral("导入标签关联"))) { m_db.rollback(); return false; }
+    // 预先载入标签字典，插入时标签 id 全部走缓存
+    if (!ensureTagCache()) {
+        abortBulkReplace();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::bulkInsertFolders(const QList<TodoFolder> &folders)
+{
+    return insertRows(StmtBulkInsertFolders, kFolderInsertHead, 5, folders.size(),
+                      [&folders](QSqlQuery &query, qsizetype i) { bindFolderRow(query, folders.at(i)); },
+                      QStringLiteral("导入文件夹"));
+}
+
+bool DatabaseManager::bulkInsertItems(const QList<TodoItem> &items)
+{
+    if (!insertRows(StmtBulkInsertItems, kItemInsertHead, kItemColumnCount, items.size(),
+                    [&items](QSqlQuery &query, qsizetype i) {
+                        const TodoItem &item = items.at(i);
+                        bindItemRow(query, item, item.getFolderId());
+                    },
+                    QStringLiteral("导入事项"))) {
+        return false;
+    }
+
+    QList<QPair<QString, QString>> links;
+    for (const TodoItem &item : items) {
+        for (const QString &tag : item.getTags()) {
+            const QString id = tagId(tag);
+            if (id.isEmpty()) {
+                return false;
             }
+            links.append({item.getId(), id});
         }
     }
+    return insertRows(StmtBulkLinkTags, kLinkInsertHead, 2, links.size(),
+                      [&links](QSqlQuery &query, qsizetype i) {
+                          query.addBindValue(links.at(i).first);
+                          query.addBindValue(links.at(i).second);
+                      },
+                      QStringLiteral("关联标签"));
+}
 
+bool DatabaseManager::finishBulkReplace()
+{
+    if (!createSecondaryIndexes() || !createChangeTriggers()) {
+        abortBulkReplace();
+        return false;
+    }
     if (!m_db.commit()) {
         m_lastError = QStringLiteral("提交失败");
-        m_db.rollback();
+        abortBulkReplace();
         return false;
     }
     return true;
 }
 
+void DatabaseManager::abortBulkReplace()
+{
+    m_db.rollback();
+    invalidateTagCache();
+}
+
 QString DatabaseManager::backupDir() const
 {
     QFileInfo dbInfo(m_dbPath);
     return dbInfo.absoluteDir().absolutePath() + QStringLiteral("/../backups");
 }
 
-bool DatabaseManager::backupNow(const QString &reason)
+QSqlQuery &DatabaseManager::statement(Statement id)
 {
-    if (m_dbPath.isEmpty() || !QFile::exists(m_dbPath)) {
-        return false;
+    auto it = m_statements.find(id);
+    if (it != m_statements.end()) {
+        return it->second;
     }
 
-    // 先 checkpoint，确保 WAL 内容落入主文件，备份才完整
-    if (m_db.isOpen()) {
-        QSqlQuery q(m_db);
-        q.exec(QStringLiteral("PRAGMA wal_checkpoint(TRUNCATE)"));
+    QString sql;
+    switch (id) {
+    case StmtLoadFolders:
+        sql = QStringLiteral("SELECT id, name, createdTime, isPinned, color FROM folders ORDER BY isPinned DESC, createdTime DESC");
+        break;
+    case StmtLoadItemTags:
+        sql = QStringLiteral("SELECT it.itemId, t.name FROM item_tags it JOIN tags t ON t.id = it.tagId");
+        break;
+    case StmtLoadItems:
+        sql = QStringLiteral("SELECT %1 FROM items WHERE deletedTime IS NULL ORDER BY isPinned DESC, createdTime DESC").arg(kItemColumns);
+        break;
+    case StmtUpsertFolder:
+        sql = QStringLiteral("INSERT OR REPLACE INTO folders (id, name, createdTime, isPinned, color) VALUES (?, ?, ?, ?, ?)");
+        break;
+    case StmtUpsertItem:
+        sql = QStringLiteral("INSERT INTO items (%1) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+                             "ON CONFLICT(id) DO UPDATE SET %2").arg(kItemColumns, itemUpsertAssignments());
+        break;
+    case StmtBulkInsertFolders:
+        sql = kFolderInsertHead + multiRowValues(5, kBulkRows);
+        break;
+    case StmtBulkInsertItems:
+        sql = kItemInsertHead + multiRowValues(kItemColumnCount, kBulkRows);
+        break;
+    case StmtBulkLinkTags:
+        sql = kLinkInsertHead + multiRowValues(2, kBulkRows);
+        break;
+    case StmtCountActiveItems:
+        sql = QStringLiteral("SELECT COUNT(*) FROM items WHERE deletedTime IS NULL");
+        break;
+    case StmtFolderItemsWithTags:
+        // 标签用 group_concat 一并取出（\x1f 分隔），逐行回调无需额外查询
+        sql = QStringLiteral("SELECT %1, (SELECT group_concat(t.name, char(31)) FROM item_tags it "
+                             "JOIN tags t ON t.id = it.tagId WHERE it.itemId = items.id) "
+                             "FROM items WHERE folderId = ? AND deletedTime IS NULL "
+                             "ORDER BY isPinned DESC, createdTime DESC").arg(kItemColumns);
+        break;
+    case StmtSoftDeleteItem:
+        sql = QStringLiteral("UPDATE items SET deletedTime = ? WHERE id = ?");
+        break;
+    case StmtMoveItem:
+        sql = QStringLiteral("UPDATE items SET folderId = ? WHERE id = ?");
+        break;
+    case StmtLoadTags:
+        sql = QStringLiteral("SELECT id, name FROM tags");
+        break;
+    case StmtTagIdByName:
+        sql = QStringLiteral("SELECT id FROM tags WHERE name = ?");
+        break;
+    case StmtInsertTag:
+        sql = QStringLiteral("INSERT OR IGNORE INTO tags (id, name) VALUES (?, ?)");
+        break;
+    case StmtItemTagIds:
+        sql = QStringLiteral("SELECT tagId FROM item_tags WHERE itemId = ?");
+        break;
+    case StmtLinkTag:
+        sql = QStringLiteral("INSERT OR IGNORE INTO item_tags (itemId, tagId) VALUES (?, ?)");
+        break;
+    case StmtUnlinkTag:
+        sql = QStringLiteral("DELETE FROM item_tags WHERE itemId = ? AND tagId = ?");
+        break;
     }
 
-    QString dirPath = backupDir();
-    QDir dir(dirPath);
-    if (!dir.exists() && !dir.mkpath(QStringLiteral("."))) {
-        m_lastError = QStringLiteral("无法创建备份目录");
+    it = m_statements.try_emplace(id, m_db).first;
+    QSqlQuery &query = it->second;
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        // 准备失败不缓存，下次调用重新准备；本次 exec 会经 execChecked 报错
+        qWarning() << "[DatabaseManager] prepare failed:" << query.lastError().text();
+        m_statements.erase(it);
+        m_failedStatement = QSqlQuery(m_db);
+        return m_failedStatement;
+    }
+    return query;
+}
+
+bool DatabaseManager::writeFolderRow(Statement id, const TodoFolder &folder, const QString &what)
+{
+    QSqlQuery &query = statement(id);
+    bindFolderRow(query, folder);
+    return execChecked(query, what);
+}
+
+bool DatabaseManager::writeItemRow(Statement id, const TodoItem &item, const QString &folderId, const QString &what)
+{
+    QSqlQuery &query = statement(id);
+    bindItemRow(query, item, folderId);
+    return execChecked(query, what);
+}
+
+bool DatabaseManager::insertRows(Statement fullBatch, const QString &head, int columns, qsizetype count,
+                                 const std::function<void(QSqlQuery &, qsizetype)> &bindRow, const QString &what)
+{
+    // 整批用缓存语句，尾部不足 kBulkRows 行的部分临时 prepare
+    for (qsizetype start = 0; start < count; start += kBulkRows) {
+        const int rows = int(std::min<qsizetype>(kBulkRows, count - start));
+        QSqlQuery tail(m_db);
+        QSqlQuery *query = &tail;
+        if (rows == kBulkRows) {
+            query = &statement(fullBatch);
+        } else if (!tail.prepare(head + multiRowValues(columns, rows))) {
+            m_lastError = QStringLiteral("%1失败: %2").arg(what, tail.lastError().text());
+            return false;
+        }
+        for (int i = 0; i < rows; ++i) {
+            bindRow(*query, start + i);
+        }
+        if (!execChecked(*query, what)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DatabaseManager::invalidateTagCache()
+{
+    m_tagIds.clear();
+    m_tagIdsLoaded = false;
+}
+
+bool DatabaseManager::ensureTagCache()
+{
+    const quint64 generation = g_tagGeneration.load();
+    if (m_tagIdsLoaded && m_tagGeneration == generation) {
+        return true;
+    }
+
+    m_tagIds.clear();
+    QSqlQuery &query = statement(StmtLoadTags);
+    if (!execChecked(query, QStringLiteral("读取标签"))) {
+        m_tagIdsLoaded = false;
         return false;
     }
+    while (query.next()) {
+        m_tagIds.insert(query.value(1).toString(), query.value(0).toString());
+    }
+    query.finish();
+    m_tagIdsLoaded = true;
+    m_tagGeneration = generation;
+    return true;
+}
+
+QString DatabaseManager::tagId(const QString &name)
+{
+    if (!ensureTagCache()) {
+        return QString();
+    }
+    const auto it = m_tagIds.constFind(name);
+    if (it != m_tagIds.constEnd()) {
+        return it.value();
+    }
+
+    // 未命中：新建；若已被其他连接建过（IGNORE 未插入），按名字取回已有 id
+    QString id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    QSqlQuery &insert = statement(StmtInsertTag);
+    insert.addBindValue(id);
+    insert.addBindValue(name);
+    if (!execChecked(insert, QStringLiteral("保存标签"))) {
+        return QString();
+    }
+    if (insert.numRowsAffected() == 0) {
+        QSqlQuery &lookup = statement(StmtTagIdByName);
+        lookup.addBindValue(name);
+        if (!execChecked(lookup, QStringLiteral("查询标签")) || !lookup.next()) {
+            return QString();
+        }
+        id = lookup.value(0).toString();
+        lookup.finish();
+    }
+    m_tagIds.insert(name, id);
+    return id;
+}
+
+bool DatabaseManager::syncItemTags(const QString &itemId, const QStringList &tags, bool isNewItem)
+{
+    QSet<QString> wanted;
+    for (const QString &tag : tags) {
+        const QString id = tagId(tag);
+        if (id.isEmpty()) {
+            return false;
+        }
+        wanted.insert(id);
+    }
+
+    // 新插入的事项没有旧关联，跳过读取
+    QSet<QString> current;
+    if (!isNewItem) {
+        QSqlQuery &query = statement(StmtItemTagIds);
+        query.addBindValue(itemId);
+        if (!execChecked(query, QStringLiteral("读取事项标签"))) {
+            return false;
+        }
+        while (query.next()) {
+            current.insert(query.value(0).toString());
+        }
+        query.finish();
+    }
+
+    QSqlQuery &unlink = statement(StmtUnlinkTag);
+    for (const QString &id : current) {
+        if (wanted.contains(id)) {
+            continue;
+        }
+        unlink.addBindValue(itemId);
+        unlink.addBindValue(id);
+        if (!execChecked(unlink, QStringLiteral("移除事项标签"))) return false;
+    }
+
+    QSqlQuery &link = statement(StmtLinkTag);
+    for (const QString &id : wanted) {
+        if (current.contains(id)) {
+            continue;
+        }
+        link.addBindValue(itemId);
+        link.addBindValue(id);
+        if (!execChecked(link, QStringLiteral("关联标签"))) return false;
+    }
+    return true;
+}
 
-    QString stamp = QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd_HHmmss"));
-    QString target = dir.absoluteFilePath(QStringLiteral("todolist_%1_%2.db").arg(stamp, reason));
-    if (!QFile::copy(m_dbPath, target)) {
-        m_lastError = QStringLiteral("备份失败");
+bool DatabaseManager::beginWrite()
+{
+    if (m_inBatch) {
+        return true;
+    }
+    if (!m_db.transaction()) {
+        m_lastError = QStringLiteral("无法开启事务");
         return false;
     }
+    return true;
+}
 
-    // 滚动清理：仅保留最近 kMaxBackups 份
-    QStringList files = dir.entryList({QStringLiteral("todolist_*.db")}, QDir::Files, QDir::Name);
-    while (files.size() > kMaxBackups) {
-        QFile::remove(dir.absoluteFilePath(files.first()));
-        files.removeFirst();
+bool DatabaseManager::commitWrite()
+{
+    if (m_inBatch) {
+        return true;
+    }
+    if (!m_db.commit()) {
+        m_lastError = QStringLiteral("提交失败");
+        m_db.rollback();
+        invalidateTagCache();
+        return false;
     }
     return true;
 }
 
+void DatabaseManager::rollbackWrite()
+{
+    // 批处理中由外层决定整批回滚，这里不打断外层事务
+    if (!m_inBatch) {
+        m_db.rollback();
+        invalidateTagCache();   // 事务内新建的标签随回滚消失，缓存不能再信
+    }
+}
+
+TodoItem DatabaseManager::itemFromQuery(const QSqlQuery &query)
+{
+    TodoItem item;
+    item.setId(query.value(0).toString());
+    item.setTitle(query.value(1).toString());
+    item.setDetails(query.value(2).toString());
+    item.setCreatedTime(fromEpochMs(query.value(3)));
+    item.setCompletedTime(fromEpochMs(query.value(4)));
+    item.setCompleted(query.value(6).toInt() == 1);
+    item.setFolderId(query.value(7).toString());
+    item.setPlannedDate(fromDayNumber(query.value(8)));
+    item.setDueDate(fromDayNumber(query.value(9)));
+    item.setPriority(query.value(10).toInt());
+    item.setTagColor(query.value(11).toString());
+    item.setPinned(query.value(12).toInt() == 1);
+    item.setRemindAt(fromEpochMs(query.value(13)));
+    // 各 setter 会刷新 updatedTime，必须放在最后恢复
+    item.setUpdatedTime(fromEpochMs(query.value(5)));
+    return item;
+}
+
 bool DatabaseManager::execChecked(QSqlQuery &query, const QString &what)
 {
     if (!query.exec()) {
@@ -4,7 +4,11 @@
 #include <QString>
 #include <QStringList>
 #include <QList>
+#include <QHash>
 #include <QSqlDatabase>
+#include <QSqlQuery>
+#include <unordered_map>
+#include <functional>
 #include "todoitem.h"
 #include "todofolder.h"
 
@@ -19,7 +23,7 @@ public:
     bool initialize();                       // 打开数据库、建表、迁移、启动备份
     bool isOpen() const;
 
-    QList<TodoFolder> loadAll();             // 加载全部文件夹及其事项（含标签）
+    QList<TodoFolder> loadAll();             // 加载全部文件夹及其事项（含标签），固定三条查询
 
     // 增量写操作（全部带事务校验）
     bool upsertFolder(const TodoFolder &folder);
@@ -29,6 +33,11 @@ public:
     bool moveItem(const QString &itemId, const QString &targetFolderId);
     bool setItemTags(const QString &itemId, const QStringList &tags);
 
+    // 组提交：beginBatch/commitBatch 之间的写操作并入同一事务，失败由调用方 rollbackBatch
+    bool beginBatch();
+    bool commitBatch();
+    void rollbackBatch();
+
     // 回收站（软删除，30 天保留）
     QList<TodoItem> loadDeleted();           // 回收站内的事项（含原文件夹名）
     QString deletedItemFolderName(const QString &folderId);
@@ -41,31 +50,117 @@ public:
     bool addTag(const QString &name);
     bool removeTag(const QString &name);
 
-    // 导入：原子替换全部数据，任何一步失败即回滚，绝不产生半写状态
-    bool replaceAll(const QList<TodoFolder> &folders);
-
-    // 备份：复制数据库文件到 backups/，滚动保留最近 maxBackups 份
-    bool backupNow(const QString &reason);
+    // 备份目录：BackupEngine 在此写入快照
     QString backupDir() const;
 
+    QString databasePath() const { return m_dbPath; }
+
+    // 数据版本戳：库实例 id + 变更计数（触发器维护），两者都相同即库内容未变
+    struct ChangeStamp {
+        qint64 databaseId = 0;
+        qint64 counter = -1;
+        bool isValid() const { return counter >= 0; }
+    };
+    ChangeStamp changeStamp();
+    QString snapshotPath() const;            // 内存模型快照文件，与库文件同目录
+
+    // 以临时连接读出另一份库文件的全部数据（可在任意线程调用，不影响主连接）
+    static bool loadFromFile(const QString &dbPath, QList<TodoFolder> *folders, QString *error);
     QString lastError() const { return m_lastError; }
 
 private:
+    friend class DatabaseWriter;
+    friend class ImportEngine;
+    friend class ExportEngine;
+    friend class tst_Database;               // 基准里清空语句缓存，对照缓存前的开销
+
     DatabaseManager() = default;
+    explicit DatabaseManager(const QString &connectionName) : m_connectionName(connectionName) {}
     DatabaseManager(const DatabaseManager&) = delete;
     DatabaseManager& operator=(const DatabaseManager&) = delete;
 
     bool openDatabase();
+    bool attach(const QString &dbPath);      // 以独立连接打开已初始化的库（供后台线程使用）
+    void detach();
     bool createSchema();
-    bool upgradeSchema();                    // 列级增量迁移（remindAt / deletedTime）
+    bool migrateSchema();                    // 按 PRAGMA user_version 依次执行未应用的迁移
+    bool migrateToV1();                      // 补列：remindAt / deletedTime
+    bool migrateToV2();                      // 热点查询索引
+    bool migrateToV3();                      // 时间列改为整数（epoch 毫秒 / 儒略日数）
+    bool migrateToV4();                      // 变更计数表 meta 与触发器
+    bool createChangeTriggers();
+    bool migrateToV5();                      // 全文索引 items_fts（trigram）与同步触发器
+    bool createSearchTriggers();
+    bool rebuildSearchIndex();
+    bool migrateToV6();                      // 撤掉 v5 的全文索引：搜索已改由内存索引承担
     void migrateLegacyDatabase();            // 从旧的 exe 同级 data/ 目录迁移
     void migrateFromJson();                  // 从旧的 JSON 存储迁移
-    bool execChecked(class QSqlQuery &query, const QString &what);
 
+    // 预编译语句缓存：每条连接按语句 id 只 prepare 一次，存续期间反复绑定执行
+    enum Statement {
+        StmtLoadFolders,
+        StmtLoadItemTags,
+        StmtLoadItems,
+        StmtUpsertFolder,
+        StmtUpsertItem,
+        StmtBulkInsertFolders,
+        StmtBulkInsertItems,
+        StmtBulkLinkTags,
+        StmtCountActiveItems,
+        StmtFolderItemsWithTags,
+        StmtSoftDeleteItem,
+        StmtMoveItem,
+        StmtLoadTags,
+        StmtTagIdByName,
+        StmtInsertTag,
+        StmtItemTagIds,
+        StmtLinkTag,
+        StmtUnlinkTag,
+    };
+    QSqlQuery &statement(Statement id);
+    bool writeFolderRow(Statement id, const TodoFolder &folder, const QString &what);
+    bool writeItemRow(Statement id, const TodoItem &item, const QString &folderId, const QString &what);
+    bool insertRows(Statement fullBatch, const QString &head, int columns, qsizetype count,
+                    const std::function<void(QSqlQuery &, qsizetype)> &bindRow, const QString &what);
+
+    // 批量整体替换：一个事务内删二级索引、清表、多行插入，最后重建索引并提交；
+    // 任一步失败整体回滚（导入与恢复都经 ImportEngine 走这条路径）
+    bool beginBulkReplace();
+    bool bulkInsertFolders(const QList<TodoFolder> &folders);
+    bool bulkInsertItems(const QList<TodoItem> &items);
+    bool finishBulkReplace();
+    void abortBulkReplace();
+    bool createSecondaryIndexes();
+
+    // 游标式遍历（导出用）：顺序与 loadAll 一致，先回调文件夹、再逐条回调其事项；回调返回 false 即中止
+    qint64 countActiveItems();
+    bool visitAll(const std::function<bool(const TodoFolder &)> &onFolder,
+                  const std::function<bool(const TodoItem &)> &onItem);
+
+    // 标签 name -> id 缓存：首次使用时整表载入，之后只在未命中时写库
+    bool ensureTagCache();
+    void invalidateTagCache();
+    QString tagId(const QString &name);      // 不存在则新建；失败返回空串
+    bool syncItemTags(const QString &itemId, const QStringList &tags, bool isNewItem);
+
+    bool beginWrite();                       // 单个写操作的事务；批处理中并入外层事务
+    bool commitWrite();
+    void rollbackWrite();
+    bool execChecked(QSqlQuery &query, const QString &what);
+    static TodoItem itemFromQuery(const QSqlQuery &query);   // 按 kItemColumns 列序构建事项
+
+    QString m_connectionName = QStringLiteral("qt_sql_default_connection");
     QSqlDatabase m_db;
+    std::unordered_map<int, QSqlQuery> m_statements;
+    QSqlQuery m_failedStatement;             // prepare 失败时返回的占位语句（exec 必然失败）
+    QHash<QString, QString> m_tagIds;        // 标签名 -> id
+    bool m_tagIdsLoaded = false;
+    quint64 m_tagGeneration = 0;             // 载入缓存时的全局标签删除代数
     QString m_dbPath;
     QString m_lastError;
     bool m_open = false;
+    bool m_snapshotBeforeMigration = true;   // 临时读取快照时不再为它做迁移前备份
+    bool m_inBatch = false;
 };
 
 #endif // DATABASEMANAGER_H
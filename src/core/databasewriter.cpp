@@ -0,0 +1,195 @@
+#include "databasewriter.h"
+#include "databasemanager.h"
+
+#include <QThread>
+#include <QTimer>
+#include <QMetaObject>
+
+namespace {
+const QString kWriterConnection = QStringLiteral("todolist_writer");
+constexpr int kCoalesceWindowMs = 150;   // 静默窗口：连续编辑停顿后提交
+constexpr int kMaxDelayMs = 1000;        // 最大延迟：持续编辑时最迟 1 秒落库
+}
+
+DatabaseWriter::DatabaseWriter(QObject *parent)
+    : QObject(parent)
+{
+}
+
+DatabaseWriter::~DatabaseWriter()
+{
+    stop();
+}
+
+void DatabaseWriter::start(const QString &dbPath)
+{
+    if (m_thread) {
+        return;
+    }
+
+    m_thread = new QThread(this);
+    m_thread->setObjectName(QStringLiteral("DatabaseWriter"));
+    m_context = new QObject();
+    m_context->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+    m_thread->start();
+
+    // 连接与定时器必须在使用它们的线程内创建
+    QMetaObject::invokeMethod(m_context, [this, dbPath]() {
+        m_quietTimer = new QTimer(m_context);
+        m_quietTimer->setSingleShot(true);
+        m_quietTimer->setInterval(kCoalesceWindowMs);
+        connect(m_quietTimer, &QTimer::timeout, m_context, [this]() { flushPending(); });
+
+        m_maxDelayTimer = new QTimer(m_context);
+        m_maxDelayTimer->setSingleShot(true);
+        m_maxDelayTimer->setInterval(kMaxDelayMs);
+        connect(m_maxDelayTimer, &QTimer::timeout, m_context, [this]() { flushPending(); });
+
+        m_db = new DatabaseManager(kWriterConnection);
+        if (!m_db->attach(dbPath)) {
+            emit writeFailed(m_db->lastError());
+        }
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWriter::stop()
+{
+    if (!m_thread) {
+        return;
+    }
+
+    // 收尾命令排在队列末尾：先把合并中的写入提交，再关闭连接、退出事件循环
+    QMetaObject::invokeMethod(m_context, [this]() {
+        flushPending();
+        if (m_db) {
+            m_db->detach();
+            delete m_db;
+            m_db = nullptr;
+        }
+        QThread::currentThread()->quit();
+    }, Qt::QueuedConnection);
+    m_thread->wait();
+
+    delete m_thread;
+    m_thread = nullptr;
+    m_context = nullptr;   // 已随 finished 信号 deleteLater（定时器是其子对象）
+    m_quietTimer = nullptr;
+    m_maxDelayTimer = nullptr;
+}
+
+void DatabaseWriter::flush(QObject *context, const std::function<void()> &done)
+{
+    if (!m_thread) {
+        QMetaObject::invokeMethod(context, done, Qt::QueuedConnection);
+        return;
+    }
+    // context 须存活到写线程停止；回调排进 context 的事件队列，context 销毁时未执行的回调随之丢弃
+    QMetaObject::invokeMethod(m_context, [this, context, done]() {
+        flushPending();
+        QMetaObject::invokeMethod(context, done, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWriter::post(const QString &key, Command command)
+{
+    if (!m_thread) {
+        return;
+    }
+    QMetaObject::invokeMethod(m_context, [this, key, command]() {
+        enqueue(key, command);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWriter::enqueue(const QString &key, const Command &command)
+{
+    if (!key.isEmpty()) {
+        const auto it = m_pendingIndex.constFind(key);
+        if (it != m_pendingIndex.constEnd()) {
+            // 同一对象的重复 upsert：只保留最新内容，位置不变
+            m_pending[it.value()].command = command;
+            m_quietTimer->start();
+            return;
+        }
+        m_pendingIndex.insert(key, m_pending.size());
+    } else {
+        m_pendingIndex.clear();
+    }
+
+    m_pending.append({key, command});
+    m_quietTimer->start();
+    if (!m_maxDelayTimer->isActive()) {
+        m_maxDelayTimer->start();
+    }
+}
+
+void DatabaseWriter::flushPending()
+{
+    if (m_quietTimer) m_quietTimer->stop();
+    if (m_maxDelayTimer) m_maxDelayTimer->stop();
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    const QList<PendingWrite> batch = m_pending;
+    m_pending.clear();
+    m_pendingIndex.clear();
+
+    if (!m_db || !m_db->isOpen()) {
+        emit writeFailed(QStringLiteral("后台数据库连接未打开"));
+        return;
+    }
+
+    // 组提交：整批一个事务
+    bool ok = m_db->beginBatch();
+    if (ok) {
+        for (const PendingWrite &write : batch) {
+            if (!write.command(*m_db)) {
+                ok = false;
+                break;
+            }
+        }
+        if (ok) {
+            ok = m_db->commitBatch();
+        } else {
+            m_db->rollbackBatch();
+        }
+    }
+    if (ok) {
+        return;
+    }
+
+    // 整批失败时逐条重放（各自独立事务），一条坏数据不拖累其余修改
+    for (const PendingWrite &write : batch) {
+        if (!write.command(*m_db)) {
+            emit writeFailed(m_db->lastError());
+        }
+    }
+}
+
+void DatabaseWriter::upsertFolder(const TodoFolder &folder)
+{
+    post(QStringLiteral("folder:") + folder.getId(),
+         [folder](DatabaseManager &db) { return db.upsertFolder(folder); });
+}
+
+void DatabaseWriter::deleteFolder(const QString &folderId)
+{
+    post(QString(), [folderId](DatabaseManager &db) { return db.deleteFolder(folderId); });
+}
+
+void DatabaseWriter::upsertItem(const TodoItem &item)
+{
+    post(QStringLiteral("item:") + item.getId(),
+         [item](DatabaseManager &db) { return db.upsertItem(item); });
+}
+
+void DatabaseWriter::deleteItem(const QString &itemId)
+{
+    post(QString(), [itemId](DatabaseManager &db) { return db.deleteItem(itemId); });
+}
+
+void DatabaseWriter::moveItem(const QString &itemId, const QString &targetFolderId)
+{
+    post(QString(), [itemId, targetFolderId](DatabaseManager &db) { return db.moveItem(itemId, targetFolderId); });
+}
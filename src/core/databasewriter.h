@@ -0,0 +1,69 @@
+#ifndef DATABASEWRITER_H
+#define DATABASEWRITER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <functional>
+#include "todoitem.h"
+#include "todofolder.h"
+
+class QThread;
+class QTimer;
+class DatabaseManager;
+
+// 异步写入器：专用写线程独占一条 SQLite 连接，GUI 线程只负责投递命令。
+// 写后合并：短窗口内同一事项/文件夹的重复 upsert 只保留最后一次，
+// 窗口静默或达到最大延迟后整批在一个事务中组提交；失败通过 writeFailed 信号回传。
+// 需要与主连接读写保持顺序的操作（回收站、导入、备份）经 flush() 排在写队列之后：
+// 写线程提交完此前的命令再回调，GUI 线程全程不等待。
+class DatabaseWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DatabaseWriter(QObject *parent = nullptr);
+    ~DatabaseWriter() override;
+
+    void start(const QString &dbPath);
+    void stop();                              // 执行完已投递命令后关闭连接并结束线程
+    bool isRunning() const { return m_thread != nullptr; }
+
+    void upsertFolder(const TodoFolder &folder);
+    void deleteFolder(const QString &folderId);
+    void upsertItem(const TodoItem &item);
+    void deleteItem(const QString &itemId);
+    void moveItem(const QString &itemId, const QString &targetFolderId);
+
+    // 立即组提交此前投递的命令，落库后在 context 所在线程回调 done（排队投递，不阻塞调用方）
+    void flush(QObject *context, const std::function<void()> &done);
+
+signals:
+    void writeFailed(const QString &error);
+
+private:
+    friend class tst_DatabaseWriter;         // 用计数命令观察合并与屏障
+
+    using Command = std::function<bool(DatabaseManager &)>;
+
+    struct PendingWrite {
+        QString key;                          // 合并键；空 = 不可合并（删除、移动）
+        Command command;
+    };
+
+    // 空 key 的命令是顺序屏障：其后的 upsert 不会合并到屏障之前
+    void post(const QString &key, Command command);
+    void enqueue(const QString &key, const Command &command);   // 以下均在写线程内执行
+    void flushPending();
+
+    QThread *m_thread = nullptr;
+    QObject *m_context = nullptr;             // 驻留写线程的投递目标
+    DatabaseManager *m_db = nullptr;          // 仅在写线程内创建、访问与销毁
+    QTimer *m_quietTimer = nullptr;           // 合并窗口：最后一次投递后静默多久提交
+    QTimer *m_maxDelayTimer = nullptr;        // 最大延迟：持续投递时也保证按时落库
+    QList<PendingWrite> m_pending;
+    QHash<QString, int> m_pendingIndex;       // 合并键 -> m_pending 下标
+};
+
+#endif // DATABASEWRITER_H
@@ -0,0 +1,174 @@
+#include "exportengine.h"
+#include "databasemanager.h"
+
+#include <QThread>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+const QString kExportConnection = QStringLiteral("todolist_export");
+constexpr int kFlushBytes = 1 << 20;     // 攒够 1 MiB 再写入文件
+
+QByteArray compact(const QJsonObject &object)
+{
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+}
+
+ExportEngine::ExportEngine(QObject *parent)
+    : QObject(parent)
+{
+    // finished 由工作线程发出；回到 GUI 线程后回收线程
+    connect(this, &ExportEngine::finished, this, [this]() { join(); }, Qt::QueuedConnection);
+}
+
+ExportEngine::~ExportEngine()
+{
+    cancel();
+    join();
+}
+
+bool ExportEngine::start(const QString &filePath, Format format, const QString &dbPath)
+{
+    if (m_thread) {
+        return false;
+    }
+    m_cancelled = false;
+    m_thread = QThread::create([this, filePath, format, dbPath]() { run(filePath, format, dbPath); });
+    m_thread->setObjectName(QStringLiteral("ExportEngine"));
+    m_thread->start();
+    return true;
+}
+
+void ExportEngine::cancel()
+{
+    m_cancelled = true;
+}
+
+void ExportEngine::join()
+{
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+}
+
+void ExportEngine::run(const QString &filePath, Format format, const QString &dbPath)
+{
+    // QSaveFile：取消或失败时目标文件保持原样，不会留下半截导出
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        emit finished(false, false, 0, QStringLiteral("无法创建文件进行写入。"));
+        return;
+    }
+
+    DatabaseManager db(kExportConnection);
+    if (!db.attach(dbPath)) {
+        const QString error = db.lastError();
+        db.detach();   // 打开失败时命名连接也已注册，同样要移除
+        file.cancelWriting();
+        emit finished(false, false, 0, error);
+        return;
+    }
+
+    const qint64 total = db.countActiveItems();
+    QByteArray buffer;
+    buffer.reserve(kFlushBytes + 64 * 1024);
+    bool writeOk = true;
+    auto flushBuffer = [&](bool force) {
+        if (writeOk && (force || buffer.size() >= kFlushBytes)) {
+            writeOk = file.write(buffer) == buffer.size();
+            buffer.clear();
+        }
+        return writeOk;
+    };
+
+    int itemCount = 0;
+    int lastPercent = -1;
+    bool firstFolder = true;
+    bool firstItem = true;
+
+    if (format == Json) {
+        buffer.append("{\"folders\":[");
+    }
+
+    auto onFolder = [&](const TodoFolder &folder) {
+        if (m_cancelled) {
+            return false;
+        }
+        QJsonObject object = folder.toJson();
+        object.remove(QStringLiteral("items"));
+        if (format == Json) {
+            // 去掉结尾的 }，接上 items 数组，文件夹在下一个文件夹开始或结尾时闭合
+            if (!firstFolder) {
+                buffer.append("]},");
+            }
+            QByteArray head = compact(object);
+            head.chop(1);
+            buffer.append(head);
+            buffer.append(",\"items\":[");
+        } else {
+            object.insert(QStringLiteral("type"), QStringLiteral("folder"));
+            buffer.append(compact(object));
+            buffer.append('\n');
+        }
+        firstFolder = false;
+        firstItem = true;
+        return flushBuffer(false);
+    };
+
+    auto onItem = [&](const TodoItem &item) {
+        if (m_cancelled) {
+            return false;
+        }
+        QJsonObject object = item.toJson();
+        if (format == Json) {
+            if (!firstItem) {
+                buffer.append(',');
+            }
+            buffer.append(compact(object));
+        } else {
+            object.insert(QStringLiteral("type"), QStringLiteral("item"));
+            buffer.append(compact(object));
+            buffer.append('\n');
+        }
+        firstItem = false;
+
+        ++itemCount;
+        const int percent = total > 0 ? int(qint64(itemCount) * 99 / total) : 0;
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            emit progress(percent);
+        }
+        return flushBuffer(false);
+    };
+
+    const bool visited = db.visitAll(onFolder, onItem);
+    const QString dbError = db.lastError();
+    db.detach();
+
+    if (m_cancelled) {
+        file.cancelWriting();
+        emit finished(false, true, itemCount, QString());
+        return;
+    }
+    if (!visited || !writeOk) {
+        file.cancelWriting();
+        emit finished(false, false, itemCount, writeOk ? dbError : QStringLiteral("写入文件失败。"));
+        return;
+    }
+
+    if (format == Json) {
+        buffer.append(firstFolder ? "]}" : "]}]}");
+        buffer.append('\n');
+    }
+    if (!flushBuffer(true) || !file.commit()) {
+        emit finished(false, false, itemCount, QStringLiteral("写入文件失败。"));
+        return;
+    }
+
+    emit progress(100);
+    emit finished(true, false, itemCount, QString());
+}
@@ -0,0 +1,42 @@
+#ifndef EXPORTENGINE_H
+#define EXPORTENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+
+class QThread;
+
+// 流式导出：工作线程用独立连接按游标逐行读库，边读边写文件，不在内存中构建整棵 JSON。
+// Json   —— 与原导出相同的 {"folders":[{..., "items":[...]}]} 结构（紧凑格式）
+// NdJson —— 每行一个对象：先是 {"type":"folder", ...}，随后是该文件夹的 {"type":"item", ...}
+class ExportEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        Json,
+        NdJson,
+    };
+
+    explicit ExportEngine(QObject *parent = nullptr);
+    ~ExportEngine() override;
+
+    bool start(const QString &filePath, Format format, const QString &dbPath);
+    void cancel();
+    bool isRunning() const { return m_thread != nullptr; }
+
+signals:
+    void progress(int percent);
+    void finished(bool ok, bool cancelled, int itemCount, const QString &error);
+
+private:
+    void run(const QString &filePath, Format format, const QString &dbPath);   // 工作线程
+    void join();
+
+    QThread *m_thread = nullptr;
+    std::atomic_bool m_cancelled{false};
+};
+
+#endif // EXPORTENGINE_H
@@ -0,0 +1,267 @@
+#include "fuzzymatcher.h"
+
+#include <QChar>
+#include <algorithm>
+
+namespace {
+constexpr int kScoreMatch = 16;
+constexpr int kBonusBoundary = 8;         // 词首：行首、分隔符之后
+constexpr int kBonusHan = 6;              // 汉字本身就是一个词
+constexpr int kBonusCamel = 4;            // 字母与数字交界
+constexpr int kBonusConsecutive = 4;
+constexpr int kPenaltyGapStart = 3;
+constexpr int kPenaltyGapExtension = 1;
+constexpr size_t kCompactMinUnits = 64 * 1024;
+
+bool isHan(char16_t ch)
+{
+    return (ch >= 0x4E00 && ch <= 0x9FFF) || (ch >= 0x3400 && ch <= 0x4DBF);
+}
+
+int boundaryBonus(const char16_t *text, qsizetype i)
+{
+    const char16_t ch = text[i];
+    if (i == 0) {
+        return kBonusBoundary + 2;
+    }
+    const char16_t prev = text[i - 1];
+    if (!QChar::isLetterOrNumber(prev)) {
+        return kBonusBoundary;
+    }
+    if (isHan(ch)) {
+        return kBonusHan;
+    }
+    if (QChar::isDigit(prev) != QChar::isDigit(ch)) {
+        return kBonusCamel;
+    }
+    return 0;
+}
+
+bool rankBefore(const FuzzyMatcher::Result &a, const FuzzyMatcher::Result &b)
+{
+    return a.score != b.score ? a.score > b.score : a.candidate < b.candidate;
+}
+}
+
+void FuzzyMatcher::clear()
+{
+    m_arena.clear();
+    m_entries.clear();
+    m_free.clear();
+    m_deadUnits = 0;
+    m_query.clear();
+    m_ranked = false;
+    m_matched.clear();
+}
+
+void FuzzyMatcher::reserve(int candidates, qsizetype units)
+{
+    m_arena.reserve(size_t(units));
+    m_entries.reserve(size_t(candidates));
+    // 排名用的缓冲区一次留足，之后每次按键都不再分配
+    m_matched.reserve(size_t(candidates));
+    m_next.reserve(size_t(candidates));
+    m_scored.reserve(size_t(candidates));
+}
+
+int FuzzyMatcher::add(const QString &text, const QString &alt)
+{
+    const Entry entry = append(text, alt);
+    int candidate = count();
+    if (m_free.empty()) {
+        m_entries.push_back(entry);
+    } else {
+        candidate = m_free.back();
+        m_free.pop_back();
+        m_entries[size_t(candidate)] = entry;
+    }
+    m_ranked = false;
+    return candidate;
+}
+
+void FuzzyMatcher::set(int candidate, const QString &text, const QString &alt)
+{
+    Entry &entry = m_entries[size_t(candidate)];
+    release(&entry);
+    entry = append(text, alt);
+    m_ranked = false;
+    compactIfSparse();
+}
+
+void FuzzyMatcher::remove(int candidate)
+{
+    Entry &entry = m_entries[size_t(candidate)];
+    if (!entry.live) {
+        return;
+    }
+    release(&entry);
+    m_free.push_back(candidate);
+    m_ranked = false;
+    compactIfSparse();
+}
+
+FuzzyMatcher::Entry FuzzyMatcher::append(const QString &text, const QString &alt)
+{
+    auto store = [this](const QString &value, quint32 *begin, quint32 *length) {
+        const QString folded = value.toCaseFolded();
+        *begin = quint32(m_arena.size());
+        *length = quint32(folded.size());
+        const auto *units = reinterpret_cast<const char16_t *>(folded.utf16());
+        m_arena.insert(m_arena.end(), units, units + folded.size());
+    };
+    Entry entry{};
+    entry.live = true;
+    store(text, &entry.begin, &entry.length);
+    if (!alt.isEmpty()) {
+        store(alt, &entry.altBegin, &entry.altLength);
+    }
+    return entry;
+}
+
+void FuzzyMatcher::release(Entry *entry)
+{
+    m_deadUnits += entry->length + entry->altLength;
+    *entry = Entry{};
+}
+
+void FuzzyMatcher::compactIfSparse()
+{
+    if (m_deadUnits < kCompactMinUnits || m_deadUnits * 2 < m_arena.size()) {
+        return;
+    }
+    std::vector<char16_t> arena;
+    arena.reserve(m_arena.size() - m_deadUnits);
+    auto move = [&](quint32 *begin, quint32 length) {
+        const quint32 offset = quint32(arena.size());
+        arena.insert(arena.end(), m_arena.begin() + *begin, m_arena.begin() + *begin + length);
+        *begin = offset;
+    };
+    for (Entry &entry : m_entries) {
+        if (entry.live) {
+            move(&entry.begin, entry.length);
+            move(&entry.altBegin, entry.altLength);
+        }
+    }
+    m_arena.swap(arena);
+    m_deadUnits = 0;
+}
+
+const std::vector<FuzzyMatcher::Result> &FuzzyMatcher::rank(const QString &query, int limit)
+{
+    const QString folded = query.toCaseFolded();
+    const bool extends = m_ranked && !m_query.isEmpty() && folded.startsWith(m_query);
+    m_query = folded;
+    m_ranked = true;
+
+    m_top.clear();
+    m_scored.clear();
+    if (folded.isEmpty()) {
+        m_matched.clear();
+        for (int c = 0; c < count(); ++c) {
+            if (m_entries[size_t(c)].live) {
+                m_matched.push_back(c);
+                if (int(m_top.size()) < limit) {
+                    m_top.push_back({c, 0});
+                }
+            }
+        }
+        return m_top;
+    }
+
+    const char16_t *arena = m_arena.data();
+    const auto *pattern = reinterpret_cast<const char16_t *>(folded.utf16());
+    const qsizetype m = folded.size();
+    auto consider = [&](int c) {
+        const Entry &entry = m_entries[size_t(c)];
+        if (!entry.live) {
+            return;
+        }
+        int best = score(arena + entry.begin, entry.length, pattern, m);
+        if (entry.altLength > 0) {
+            // 备用文本（拼音）命中略低于原文；得分 0 的命中仍是命中，减分不能把它变成未命中
+            const int alt = score(arena + entry.altBegin, entry.altLength, pattern, m);
+            best = qMax(best, alt > 0 ? alt - 1 : alt);
+        }
+        if (best >= 0) {
+            m_next.push_back(c);
+            m_scored.push_back({c, best});
+        }
+    };
+
+    m_next.clear();
+    if (extends) {
+        for (int c : m_matched) {
+            consider(c);
+        }
+    } else {
+        for (int c = 0; c < count(); ++c) {
+            consider(c);
+        }
+    }
+    m_matched.swap(m_next);
+
+    const size_t shown = qMin(size_t(qMax(limit, 0)), m_scored.size());
+    m_top.resize(shown);
+    std::partial_sort_copy(m_scored.begin(), m_scored.end(), m_top.begin(), m_top.end(), rankBefore);
+    return m_top;
+}
+
+int FuzzyMatcher::score(const char16_t *text, qsizetype n, const char16_t *pattern, qsizetype m)
+{
+    if (m == 0) {
+        return 0;
+    }
+    if (m > n) {
+        return -1;
+    }
+
+    // 1. 贪心正向：找到最早能凑齐整个查询的末位置
+    qsizetype end = -1;
+    for (qsizetype i = 0, j = 0; i < n; ++i) {
+        if (text[i] == pattern[j] && ++j == m) {
+            end = i;
+            break;
+        }
+    }
+    if (end < 0) {
+        return -1;
+    }
+    // 2. 从末位置反向匹配，收紧起点，得到最短窗口
+    qsizetype start = end;
+    for (qsizetype i = end, j = m - 1; i >= 0; --i) {
+        if (text[i] == pattern[j]) {
+            if (j == 0) {
+                start = i;
+                break;
+            }
+            --j;
+        }
+    }
+
+    // 3. 窗口内打分：连续命中沿用该段首字符的词首加分
+    int total = 0;
+    int chunkBonus = 0;
+    bool consecutive = false;
+    bool inGap = false;
+    for (qsizetype i = start, j = 0; i <= end && j < m; ++i) {
+        if (text[i] != pattern[j]) {
+            total -= inGap ? kPenaltyGapExtension : kPenaltyGapStart;
+            inGap = true;
+            consecutive = false;
+            continue;
+        }
+        int bonus = boundaryBonus(text, i);
+        if (consecutive) {
+            bonus = qMax(bonus, qMax(chunkBonus, kBonusConsecutive));
+        } else {
+            chunkBonus = bonus;
+        }
+        total += kScoreMatch + (j == 0 ? bonus * 2 : bonus);
+        consecutive = true;
+        inGap = false;
+        ++j;
+    }
+    // 同分时短文本优先
+    total -= int(qMin<qsizetype>(n, 256) / 32);
+    return qMax(total, 0);
+}
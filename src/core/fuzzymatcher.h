@@ -0,0 +1,62 @@
+#ifndef FUZZYMATCHER_H
+#define FUZZYMATCHER_H
+
+#include <QString>
+#include <vector>
+
+// 命令面板的模糊匹配：查询的字符按顺序出现在候选里即算命中（子序列），
+// 连续、词首、行首加分，间隔扣分；先贪心定位末字符，再反向收紧到最短窗口后打分。
+// 候选文本 casefold 后连续存放在一块 arena 里；排名时只读 arena、结果写进预留好的缓冲区，
+// 对候选不做任何堆分配。新查询是上一次的延长时，只在上一次的命中里重新打分
+// （子序列命中随查询变长单调收缩）。
+// 候选可以常驻并增量维护：set 改写的文本追加到 arena 末尾，remove 留下空位供 add 复用，
+// 作废的 arena 过半时整体压缩；候选下标在这期间保持不变。
+class FuzzyMatcher
+{
+public:
+    struct Result {
+        int candidate;
+        int score;
+    };
+
+    void clear();
+    void reserve(int candidates, qsizetype units);
+    // alt 为备用匹配文本（如汉字标题的拼音），两者取高分；返回候选下标（优先复用 remove 留下的空位）
+    int add(const QString &text, const QString &alt = QString());
+    void set(int candidate, const QString &text, const QString &alt = QString());
+    void remove(int candidate);
+    int count() const { return int(m_entries.size()); }     // 含空位
+
+    // 得分最高的至多 limit 项：得分降序，同分按加入顺序；空查询按加入顺序返回前 limit 项
+    const std::vector<Result> &rank(const QString &query, int limit);
+    int matchCount() const { return int(m_matched.size()); }
+
+    // 小于 0 表示不匹配；text 与 pattern 都应已 casefold
+    static int score(const char16_t *text, qsizetype n, const char16_t *pattern, qsizetype m);
+
+private:
+    struct Entry {
+        quint32 begin;
+        quint32 length;
+        quint32 altBegin;
+        quint32 altLength;
+        bool live;
+    };
+
+    Entry append(const QString &text, const QString &alt);
+    void release(Entry *entry);
+    void compactIfSparse();
+
+    std::vector<char16_t> m_arena;
+    std::vector<Entry> m_entries;
+    std::vector<int> m_free;              // remove 留下的空位
+    size_t m_deadUnits = 0;               // arena 中已作废的长度
+    QString m_query;                      // 上一次查询（casefold 后）
+    bool m_ranked = false;
+    std::vector<int> m_matched;           // 上一次查询的全部命中，升序
+    std::vector<int> m_next;
+    std::vector<Result> m_scored;
+    std::vector<Result> m_top;
+};
+
+#endif // FUZZYMATCHER_H
@@ -0,0 +1,518 @@
+#include "importengine.h"
+#include "databasemanager.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QHash>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <utility>
+
+namespace {
+const QString kImportConnection = QStringLiteral("todolist_import");
+constexpr int kBatchItems = 2048;        // 每批事项数
+constexpr int kQueueCapacity = 8;        // 队列满时解析线程等待，内存占用有上限
+
+// JSON 切分游标：只定位值的边界、不建 DOM，切出的片段再交给 QJsonDocument 解析
+class JsonCursor
+{
+public:
+    explicit JsonCursor(const QByteArray &data, qsizetype pos = 0)
+        : m_data(data.constData()), m_size(data.size()), m_pos(pos) {}
+
+    qsizetype pos() const { return m_pos; }
+
+    void skipBom()
+    {
+        if (m_size >= 3 && m_data[0] == '\xEF' && m_data[1] == '\xBB' && m_data[2] == '\xBF') {
+            m_pos = 3;
+        }
+    }
+
+    qsizetype skipSpace()
+    {
+        while (m_pos < m_size && (m_data[m_pos] == ' ' || m_data[m_pos] == '\n'
+                                  || m_data[m_pos] == '\r' || m_data[m_pos] == '\t')) {
+            ++m_pos;
+        }
+        return m_pos;
+    }
+
+    bool consume(char c)                     // 跳过空白后下一个字符为 c 则吃掉
+    {
+        skipSpace();
+        if (m_pos < m_size && m_data[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool readKey(QByteArray *key)            // "key" : —— 键按原始字节返回（不解转义，仅用于比较）
+    {
+        if (skipSpace() >= m_size || m_data[m_pos] != '"') {
+            return false;
+        }
+        const qsizetype begin = m_pos + 1;
+        if (!skipString()) {
+            return false;
+        }
+        *key = QByteArray(m_data + begin, m_pos - 1 - begin);
+        return consume(':');
+    }
+
+    bool skipValue()
+    {
+        if (skipSpace() >= m_size) {
+            return false;
+        }
+        const char first = m_data[m_pos];
+        if (first == '"') {
+            return skipString();
+        }
+        if (first != '{' && first != '[') {
+            const qsizetype begin = m_pos;
+            while (m_pos < m_size && !isDelimiter(m_data[m_pos])) {
+                ++m_pos;
+            }
+            return m_pos > begin;
+        }
+        int depth = 0;
+        while (m_pos < m_size) {
+            const char c = m_data[m_pos];
+            if (c == '"') {
+                if (!skipString()) {
+                    return false;
+                }
+                continue;
+            }
+            ++m_pos;
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static bool isDelimiter(char c)
+    {
+        return c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    bool skipString()                        // 当前位于起始引号
+    {
+        ++m_pos;
+        while (m_pos < m_size) {
+            const char c = m_data[m_pos++];
+            if (c == '\\') {
+                ++m_pos;
+            } else if (c == '"') {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char *m_data;
+    qsizetype m_size;
+    qsizetype m_pos;
+};
+}
+
+// 单生产者单消费者有界队列
+class ImportEngine::BatchQueue
+{
+public:
+    bool push(Batch batch)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_queue.size() >= kQueueCapacity && !m_aborted) {
+            m_notFull.wait(&m_mutex);
+        }
+        if (m_aborted) {
+            return false;
+        }
+        m_queue.enqueue(std::move(batch));
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    // 队列关闭且取空、或被中止时返回 false
+    bool pop(Batch *batch)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_queue.isEmpty() && !m_closed && !m_aborted) {
+            m_notEmpty.wait(&m_mutex);
+        }
+        if (m_aborted || m_queue.isEmpty()) {
+            return false;
+        }
+        *batch = m_queue.dequeue();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    void close()                             // 生产结束
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+    }
+
+    void abort()                             // 消费方放弃，唤醒并丢弃一切
+    {
+        QMutexLocker locker(&m_mutex);
+        m_aborted = true;
+        m_queue.clear();
+        m_notFull.wakeAll();
+        m_notEmpty.wakeAll();
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QQueue<Batch> m_queue;
+    bool m_closed = false;
+    bool m_aborted = false;
+};
+
+ImportEngine::ImportEngine(QObject *parent)
+    : QObject(parent)
+{
+    // finished 由写入线程发出；回到 GUI 线程后回收两个线程
+    connect(this, &ImportEngine::finished, this, [this]() {
+        joinThreads();
+        m_running = false;
+    }, Qt::QueuedConnection);
+}
+
+ImportEngine::~ImportEngine()
+{
+    cancel();
+    joinThreads();
+}
+
+bool ImportEngine::start(const QString &jsonPath, const QString &dbPath)
+{
+    return launch([this, jsonPath]() { runParser(jsonPath); }, dbPath);
+}
+
+bool ImportEngine::start(const QList<TodoFolder> &folders, const QString &dbPath)
+{
+    return launch([this, folders]() { runFeeder(folders); }, dbPath);
+}
+
+bool ImportEngine::launch(const std::function<void()> &produce, const QString &dbPath)
+{
+    if (m_running) {
+        return false;
+    }
+    m_running = true;
+    m_cancelled = false;
+    m_total = 0;
+    m_parseError.clear();
+    m_queue = std::make_unique<BatchQueue>();
+
+    m_parserThread = QThread::create(produce);
+    m_writerThread = QThread::create([this, dbPath]() { runWriter(dbPath); });
+    m_parserThread->setObjectName(QStringLiteral("ImportParser"));
+    m_writerThread->setObjectName(QStringLiteral("ImportWriter"));
+    m_writerThread->start();
+    m_parserThread->start();
+    return true;
+}
+
+void ImportEngine::cancel()
+{
+    m_cancelled = true;
+    if (m_queue) {
+        m_queue->abort();
+    }
+}
+
+void ImportEngine::joinThreads()
+{
+    for (QThread **thread : {&m_parserThread, &m_writerThread}) {
+        if (*thread) {
+            (*thread)->wait();
+            delete *thread;
+            *thread = nullptr;
+        }
+    }
+    m_queue.reset();
+}
+
+void ImportEngine::runParser(const QString &jsonPath)
+{
+    auto fail = [this](const QString &message) {
+        m_parseError = message;
+        m_queue->close();
+    };
+    const QString corrupted = QStringLiteral("文件内容损坏，导入已取消。");
+
+    QFile file(jsonPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        fail(QStringLiteral("无法打开文件进行读取。"));
+        return;
+    }
+    // 只读映射整个文件（映射失败时退回整体读入）；映射随 file 析构解除
+    QByteArray data;
+    if (uchar *mapped = file.size() > 0 ? file.map(0, file.size()) : nullptr) {
+        data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), qsizetype(file.size()));
+    } else {
+        data = file.readAll();
+    }
+    m_total = data.size();
+
+    // QJsonDocument 没有流式接口：这里只切出单个文件夹头与单条事项交给它解析，
+    // 首批在读到前 kBatchItems 条事项后即可写入，内存中不会出现整份文件的 DOM
+    JsonCursor cur(data);
+    cur.skipBom();
+    if (!cur.consume('{')) {
+        fail(QStringLiteral("文件格式不正确，缺少 folders 数据。"));
+        return;
+    }
+
+    bool sawFolders = false;
+    Batch batch;
+    QByteArray key;
+    if (!cur.consume('}')) {
+        do {
+            if (!cur.readKey(&key)) {
+                fail(corrupted);
+                return;
+            }
+            if (key != "folders") {
+                if (!cur.skipValue()) {
+                    fail(corrupted);
+                    return;
+                }
+                continue;
+            }
+            if (!cur.consume('[')) {
+                fail(QStringLiteral("文件格式不正确，缺少 folders 数据。"));
+                return;
+            }
+            sawFolders = true;
+            if (cur.consume(']')) {
+                continue;
+            }
+            do {
+                if (m_cancelled) {
+                    m_queue->close();
+                    return;
+                }
+                // 文件夹头：除 items 外的全部成员拼成一个小对象
+                if (!cur.consume('{')) {
+                    fail(corrupted);
+                    return;
+                }
+                QByteArray head(1, '{');
+                qsizetype itemsBegin = -1;
+                qsizetype itemsEnd = -1;
+                if (!cur.consume('}')) {
+                    do {
+                        const qsizetype memberBegin = cur.skipSpace();
+                        if (!cur.readKey(&key)) {
+                            fail(corrupted);
+                            return;
+                        }
+                        const qsizetype valueBegin = cur.skipSpace();
+                        if (!cur.skipValue()) {
+                            fail(corrupted);
+                            return;
+                        }
+                        if (key == "items" && data.at(valueBegin) == '[') {
+                            itemsBegin = valueBegin;
+                            itemsEnd = cur.pos();
+                            continue;
+                        }
+                        if (head.size() > 1) {
+                            head.append(',');
+                        }
+                        head.append(data.constData() + memberBegin, cur.pos() - memberBegin);
+                    } while (cur.consume(','));
+                    if (!cur.consume('}')) {
+                        fail(corrupted);
+                        return;
+                    }
+                }
+                head.append('}');
+
+                const QJsonDocument headDoc = QJsonDocument::fromJson(head);
+                if (!headDoc.isObject()) {
+                    fail(corrupted);
+                    return;
+                }
+                const TodoFolder folder(headDoc.object());
+                batch.folders.append(folder);
+
+                // 逐条事项：只回到刚才记下的 items 区间再切一遍
+                if (itemsBegin >= 0) {
+                    JsonCursor items(data, itemsBegin + 1);
+                    if (!items.consume(']')) {
+                        do {
+                            const qsizetype itemBegin = items.skipSpace();
+                            if (!items.skipValue() || items.pos() > itemsEnd) {
+                                fail(corrupted);
+                                return;
+                            }
+                            const QJsonDocument itemDoc = QJsonDocument::fromJson(
+                                QByteArray(data.constData() + itemBegin, items.pos() - itemBegin));
+                            if (!itemDoc.isObject()) {
+                                fail(corrupted);
+                                return;
+                            }
+                            TodoItem item(itemDoc.object());
+                            item.setFolderId(folder.getId());
+                            batch.items.append(std::move(item));
+                            if (batch.items.size() >= kBatchItems) {
+                                batch.done = items.pos();
+                                if (!m_queue->push(std::exchange(batch, Batch()))) {
+                                    return;   // 写入方已放弃
+                                }
+                                if (m_cancelled) {
+                                    m_queue->close();
+                                    return;
+                                }
+                            }
+                        } while (items.consume(','));
+                        if (!items.consume(']')) {
+                            fail(corrupted);
+                            return;
+                        }
+                    }
+                }
+            } while (cur.consume(','));
+            if (!cur.consume(']')) {
+                fail(corrupted);
+                return;
+            }
+        } while (cur.consume(','));
+        if (!cur.consume('}')) {
+            fail(corrupted);
+            return;
+        }
+    }
+    if (!sawFolders) {
+        fail(QStringLiteral("文件格式不正确，缺少 folders 数据。"));
+        return;
+    }
+
+    batch.done = data.size();
+    if ((!batch.folders.isEmpty() || !batch.items.isEmpty()) && !m_queue->push(std::move(batch))) {
+        return;
+    }
+    m_queue->close();
+}
+
+void ImportEngine::runFeeder(const QList<TodoFolder> &folders)
+{
+    qint64 total = 0;
+    for (const TodoFolder &folder : folders) {
+        total += folder.getItemCount();
+    }
+    m_total = total;
+
+    qint64 done = 0;
+    Batch batch;
+    for (const TodoFolder &folder : folders) {
+        if (m_cancelled) {
+            m_queue->close();
+            return;
+        }
+        TodoFolder head = folder;
+        head.setItems({});                    // 文件夹行与事项分开成批
+        batch.folders.append(head);
+        for (const TodoItem &item : folder.getItems()) {
+            batch.items.append(item);
+            if (++done % kBatchItems == 0) {
+                batch.done = done;
+                if (!m_queue->push(std::exchange(batch, Batch()))) {
+                    return;   // 写入方已放弃
+                }
+            }
+        }
+    }
+
+    batch.done = done;
+    if ((!batch.folders.isEmpty() || !batch.items.isEmpty()) && !m_queue->push(std::move(batch))) {
+        return;
+    }
+    m_queue->close();
+}
+
+void ImportEngine::runWriter(const QString &dbPath)
+{
+    QString error;
+    DatabaseManager db(kImportConnection);
+    bool ok = db.attach(dbPath) && db.beginBulkReplace();
+    if (!ok) {
+        error = db.lastError();
+    }
+
+    int lastPercent = -1;
+    QList<TodoFolder> folders;                // 写完的批次并入结果，批次本身随即释放
+    QHash<QString, qsizetype> folderIndex;
+    Batch batch;
+    while (ok && m_queue->pop(&batch)) {
+        if (m_cancelled) {
+            break;
+        }
+        if (!db.bulkInsertFolders(batch.folders) || !db.bulkInsertItems(batch.items)) {
+            ok = false;
+            error = db.lastError();
+            break;
+        }
+        for (TodoFolder &folder : batch.folders) {
+            folderIndex.insert(folder.getId(), folders.size());
+            folders.append(std::move(folder));
+        }
+        for (TodoItem &item : batch.items) {
+            const auto it = folderIndex.constFind(item.getFolderId());
+            if (it != folderIndex.constEnd()) {
+                folders[it.value()].getItemsRef().append(std::move(item));
+            }
+        }
+        // 写入占 95%，剩余留给索引重建与提交
+        const qint64 total = m_total.load();
+        const int percent = total > 0 ? int(batch.done * 95 / total) : 95;
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            emit progress(percent);
+        }
+    }
+
+    const bool cancelled = m_cancelled.load();
+    // 队列正常关闭时解析线程已写完 m_parseError（经队列互斥量同步）
+    if (ok && !cancelled && !m_parseError.isEmpty()) {
+        ok = false;
+        error = m_parseError;
+    }
+    if (ok && !cancelled) {
+        ok = db.finishBulkReplace();
+        if (!ok) {
+            error = db.lastError();
+        }
+    } else {
+        db.abortBulkReplace();
+    }
+    if (!ok || cancelled) {
+        m_queue->abort();   // 解析线程可能还阻塞在 push 上
+    }
+    db.detach();
+
+    const bool succeeded = ok && !cancelled;
+    if (succeeded) {
+        emit progress(100);
+    }
+    emit finished(succeeded, cancelled, succeeded ? folders : QList<TodoFolder>(), error);
+}
@@ -0,0 +1,60 @@
+#ifndef IMPORTENGINE_H
+#define IMPORTENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include "todoitem.h"
+#include "todofolder.h"
+
+class QThread;
+
+// 流水线导入：解析线程逐个切出 JSON 中的文件夹与事项、只为单条记录建 DOM，按批投入有界队列，
+// 写入线程用独立连接消费队列，在一个事务内整体替换（多行 INSERT、预载标签字典、索引最后重建），
+// 写完的批次随即并入结果模型，整个过程只有这一份模型副本。
+// 数据源也可以是内存中的文件夹列表（从备份恢复），同样分批、可取消、整体回滚。
+// 任一环节失败或被取消都整体回滚，现有数据不受影响；结果经 finished 信号交回。
+class ImportEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ImportEngine(QObject *parent = nullptr);
+    ~ImportEngine() override;
+
+    bool start(const QString &jsonPath, const QString &dbPath);
+    bool start(const QList<TodoFolder> &folders, const QString &dbPath);
+    void cancel();                            // 异步取消；随后仍会收到 finished(cancelled = true)
+    bool isRunning() const { return m_running; }
+
+signals:
+    void progress(int percent);
+    void finished(bool ok, bool cancelled, const QList<TodoFolder> &folders, const QString &error);
+
+private:
+    struct Batch {
+        QList<TodoFolder> folders;            // 文件夹行（所含事项由 items 单独写入）
+        QList<TodoItem> items;
+        qint64 done = 0;                      // 截至本批已产出的进度单位（字节或事项数）
+    };
+    class BatchQueue;
+
+    bool launch(const std::function<void()> &produce, const QString &dbPath);
+    void runParser(const QString &jsonPath);  // 解析线程
+    void runFeeder(const QList<TodoFolder> &folders);   // 同上，数据源为内存列表
+    void runWriter(const QString &dbPath);    // 写入线程
+    void joinThreads();
+
+    QThread *m_parserThread = nullptr;
+    QThread *m_writerThread = nullptr;
+    std::unique_ptr<BatchQueue> m_queue;
+    std::atomic_bool m_cancelled{false};
+    std::atomic<qint64> m_total{0};           // 进度总量，与 Batch::done 同单位
+    QString m_parseError;                     // 解析线程填充，队列关闭后由写入线程读取
+    bool m_running = false;                   // 仅在 GUI 线程读写
+};
+
+#endif // IMPORTENGINE_H
@@ -0,0 +1,129 @@
+#ifndef KEYEDDIFF_H
+#define KEYEDDIFF_H
+
+#include <QList>
+#include <QHash>
+#include <vector>
+#include <algorithm>
+
+// 有序列表的键控差异：算出把旧列表变成新列表所需的最少删除、插入、移动，以及内容有变的原地更新。
+// 移动最少：保留下来的行按新下标构成的最长递增子序列原地不动，只移动其余的行，每行至多一次。
+// 步骤须按顺序应用，每一步的下标都对应应用到该步时的列表：
+//   Remove  删掉 row 行（先全部删完，按旧下标降序）
+//   Insert  在 row 处插入新列表第 item 项
+//   Move    把 from 行取出，插到 row（row 为取出之后的下标）
+//   Update  用新列表第 item 项刷新 row 行（此时 row == item；from 为它在旧列表中的下标）
+// 键须唯一。计算 O(n log n)，移动与插入各另需一次 O(n) 定位，只有变化的行才付这笔开销。
+namespace KeyedDiff {
+
+enum Kind { Remove, Insert, Move, Update };
+
+struct Step {
+    Kind kind;
+    int row;
+    int from = -1;
+    int item = -1;
+};
+
+// changed(from, item)：旧列表第 from 项与新列表第 item 项键相同，返回内容是否需要刷新
+template <typename Key, typename Changed>
+std::vector<Step> compute(const QList<Key> &before, const QList<Key> &after, Changed changed)
+{
+    const int count = int(after.size());
+    QHash<Key, int> indexOf;
+    indexOf.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        indexOf.insert(after.at(i), i);
+    }
+
+    // 删除：按旧下标降序，前面的行下标不受影响；剩下的行记其新下标
+    std::vector<Step> steps;
+    std::vector<int> current;               // 当前各行对应的新下标
+    std::vector<int> source(count, -1);     // 新下标 → 旧下标；-1 = 需要插入
+    current.reserve(before.size());
+    for (int i = int(before.size()) - 1; i >= 0; --i) {
+        const int target = indexOf.value(before.at(i), -1);
+        if (target < 0) {
+            steps.push_back({Remove, i});
+        } else {
+            current.push_back(target);
+            source[target] = i;
+        }
+    }
+    std::reverse(current.begin(), current.end());
+
+    // 最长递增子序列（patience sorting）：这些行彼此的先后已经正确，不动
+    std::vector<char> stable(count, 0);
+    {
+        std::vector<int> tails;             // tails[k]：长度 k+1 的递增子序列末尾所在的行
+        std::vector<int> prev(current.size(), -1);
+        for (int i = 0; i < int(current.size()); ++i) {
+            const auto pos = std::lower_bound(tails.begin(), tails.end(), current[i],
+                                              [&current](int row, int value) { return current[row] < value; });
+            if (pos != tails.begin()) {
+                prev[i] = *(pos - 1);
+            }
+            if (pos == tails.end()) {
+                tails.push_back(i);
+            } else {
+                *pos = i;
+            }
+        }
+        for (int i = tails.empty() ? -1 : tails.back(); i >= 0; i = prev[i]) {
+            stable[current[i]] = 1;
+        }
+    }
+
+    // 自后向前落位：其余各项放到新列表中后一项之前，后缀始终已就位
+    for (int i = count - 1; i >= 0; --i) {
+        if (stable[i]) {
+            continue;
+        }
+        const int anchor = i + 1 < count
+            ? int(std::find(current.begin(), current.end(), i + 1) - current.begin())
+            : int(current.size());
+        if (source[i] < 0) {
+            current.insert(current.begin() + anchor, i);
+            steps.push_back({Insert, anchor, -1, i});
+            continue;
+        }
+        const int from = int(std::find(current.begin(), current.end(), i) - current.begin());
+        const int row = anchor > from ? anchor - 1 : anchor;
+        if (row != from) {
+            current.erase(current.begin() + from);
+            current.insert(current.begin() + row, i);
+            steps.push_back({Move, row, from, i});
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (source[i] >= 0 && changed(source[i], i)) {
+            steps.push_back({Update, i, source[i], i});
+        }
+    }
+    return steps;
+}
+
+template <typename Key>
+std::vector<Step> compute(const QList<Key> &before, const QList<Key> &after)
+{
+    return compute(before, after, [](int, int) { return false; });
+}
+
+// 依次把步骤交给视图：remove(row)、insert(row, item)、move(from, row)、update(row, item)
+template <typename RemoveFn, typename InsertFn, typename MoveFn, typename UpdateFn>
+void apply(const std::vector<Step> &steps, RemoveFn remove, InsertFn insert, MoveFn move, UpdateFn update)
+{
+    for (const Step &step : steps) {
+        switch (step.kind) {
+        case Remove: remove(step.row); break;
+        case Insert: insert(step.row, step.item); break;
+        case Move:   move(step.from, step.row); break;
+        case Update: update(step.row, step.item); break;
+        }
+    }
+}
+
+} // namespace KeyedDiff
+
+#endif // KEYEDDIFF_H
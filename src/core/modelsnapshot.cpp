@@ -0,0 +1,311 @@
+#include "modelsnapshot.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QHash>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace {
+constexpr char kMagic[8] = {'T', 'D', 'L', 'S', 'N', 'A', 'P', '\0'};
+constexpr quint32 kFormatVersion = 1;
+constexpr quint32 kByteOrderMark = 0x01020304;
+constexpr qint64 kNull = std::numeric_limits<qint64>::min();   // 无效时间 / 日期
+
+struct StrRef {
+    quint32 offset;                          // 字符串表内的 char16_t 下标
+    quint32 length;
+};
+
+struct Header {
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    qint64 databaseId;
+    qint64 changeCounter;
+    quint32 folderCount;
+    quint32 itemCount;
+    quint32 tagRefCount;
+    quint32 stringUnits;
+    quint64 folderOffset;
+    quint64 itemOffset;
+    quint64 tagRefOffset;
+    quint64 stringOffset;
+    quint64 fileSize;
+};
+
+struct FolderRecord {
+    StrRef id;
+    StrRef name;
+    StrRef color;
+    qint64 createdTime;
+    quint32 firstItem;
+    quint32 itemCount;
+    quint8 isPinned;
+    quint8 reserved[7];
+};
+
+struct ItemRecord {
+    StrRef id;
+    StrRef title;
+    StrRef details;
+    StrRef tagColor;
+    qint64 createdTime;
+    qint64 completedTime;
+    qint64 updatedTime;
+    qint64 remindAt;
+    qint64 plannedDate;
+    qint64 dueDate;
+    quint32 firstTag;
+    quint32 tagCount;
+    qint32 priority;
+    quint8 isCompleted;
+    quint8 isPinned;
+    quint8 reserved[2];
+};
+
+static_assert(sizeof(StrRef) == 8, "unexpected padding");
+static_assert(sizeof(Header) == 88, "unexpected padding");
+static_assert(sizeof(FolderRecord) == 48, "unexpected padding");
+static_assert(sizeof(ItemRecord) == 104, "unexpected padding");
+static_assert(std::is_trivially_copyable_v<ItemRecord>, "records must be raw-copyable");
+
+qint64 toMs(const QDateTime &time) { return time.isValid() ? time.toMSecsSinceEpoch() : kNull; }
+qint64 toDay(const QDate &date) { return date.isValid() ? date.toJulianDay() : kNull; }
+QDateTime fromMs(qint64 ms) { return ms == kNull ? QDateTime() : QDateTime::fromMSecsSinceEpoch(ms); }
+QDate fromDay(qint64 day) { return day == kNull ? QDate() : QDate::fromJulianDay(day); }
+
+// 写入端的字符串表；interned 的字符串（标签、颜色）重复出现时只存一份
+class StringTable
+{
+public:
+    StrRef add(const QString &text)
+    {
+        const StrRef ref{quint32(m_units.size()), quint32(text.size())};
+        m_units.append(text);
+        return ref;
+    }
+
+    StrRef intern(const QString &text)
+    {
+        const auto it = m_interned.constFind(text);
+        if (it != m_interned.constEnd()) {
+            return it.value();
+        }
+        const StrRef ref = add(text);
+        m_interned.insert(text, ref);
+        return ref;
+    }
+
+    const QString &units() const { return m_units; }   // 整张表，UTF-16
+
+private:
+    QString m_units;
+    QHash<QString, StrRef> m_interned;
+};
+
+template <typename T>
+void appendRaw(QByteArray *out, const QList<T> &records)
+{
+    out->append(reinterpret_cast<const char *>(records.constData()), records.size() * qsizetype(sizeof(T)));
+}
+}
+
+bool ModelSnapshot::save(const QString &path, const QList<TodoFolder> &folders,
+                         const DatabaseManager::ChangeStamp &stamp, QString *error)
+{
+    StringTable strings;
+    strings.add(QString());                  // 下标 0 留给空串
+    QList<FolderRecord> folderRecords;
+    QList<ItemRecord> itemRecords;
+    QList<StrRef> tagRefs;
+    folderRecords.reserve(folders.size());
+
+    for (const TodoFolder &folder : folders) {
+        FolderRecord record{};
+        record.id = strings.intern(folder.getId());    // 事项记录不重复存文件夹 id
+        record.name = strings.add(folder.getName());
+        record.color = strings.intern(folder.getColor());
+        record.createdTime = toMs(folder.getCreatedTime());
+        record.firstItem = quint32(itemRecords.size());
+        record.isPinned = folder.isPinned();
+
+        const QList<TodoItem> items = folder.getItems();
+        record.itemCount = quint32(items.size());
+        for (const TodoItem &item : items) {
+            ItemRecord row{};
+            row.id = strings.add(item.getId());
+            row.title = strings.add(item.getTitle());
+            row.details = strings.add(item.getDetails());
+            row.tagColor = strings.intern(item.getTagColor());
+            row.createdTime = toMs(item.getCreatedTime());
+            row.completedTime = toMs(item.getCompletedTime());
+            row.updatedTime = toMs(item.getUpdatedTime());
+            row.remindAt = toMs(item.getRemindAt());
+            row.plannedDate = toDay(item.getPlannedDate());
+            row.dueDate = toDay(item.getDueDate());
+            row.priority = item.getPriority();
+            row.isCompleted = item.isCompleted();
+            row.isPinned = item.isPinned();
+
+            const QStringList tags = item.getTags();
+            row.firstTag = quint32(tagRefs.size());
+            row.tagCount = quint32(tags.size());
+            for (const QString &tag : tags) {
+                tagRefs.append(strings.intern(tag));
+            }
+            itemRecords.append(row);
+        }
+        folderRecords.append(record);
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.byteOrder = kByteOrderMark;
+    header.databaseId = stamp.databaseId;
+    header.changeCounter = stamp.counter;
+    header.folderCount = quint32(folderRecords.size());
+    header.itemCount = quint32(itemRecords.size());
+    header.tagRefCount = quint32(tagRefs.size());
+    header.stringUnits = quint32(strings.units().size());
+    header.folderOffset = sizeof(Header);
+    header.itemOffset = header.folderOffset + quint64(folderRecords.size()) * sizeof(FolderRecord);
+    header.tagRefOffset = header.itemOffset + quint64(itemRecords.size()) * sizeof(ItemRecord);
+    header.stringOffset = header.tagRefOffset + quint64(tagRefs.size()) * sizeof(StrRef);
+    header.fileSize = header.stringOffset + quint64(strings.units().size()) * sizeof(char16_t);
+
+    QByteArray data;
+    data.reserve(qsizetype(header.fileSize));
+    data.append(reinterpret_cast<const char *>(&header), sizeof(Header));
+    appendRaw(&data, folderRecords);
+    appendRaw(&data, itemRecords);
+    appendRaw(&data, tagRefs);
+    data.append(reinterpret_cast<const char *>(strings.units().utf16()),
+                strings.units().size() * qsizetype(sizeof(char16_t)));
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+bool ModelSnapshot::load(const QString &path, const DatabaseManager::ChangeStamp &stamp,
+                         QList<TodoFolder> *folders)
+{
+    if (!stamp.isValid()) {
+        return false;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(Header))) {
+        return false;
+    }
+
+    // 映射只在本函数内使用：字符串都会复制成 QString，返回后即可解除映射、文件可被覆盖
+    const uchar *base = file.map(0, file.size());
+    if (!base) {
+        return false;
+    }
+    const auto *header = reinterpret_cast<const Header *>(base);
+    const quint64 size = quint64(file.size());
+
+    // 头部与各段边界：任何不一致都当作没有快照
+    const bool headerOk = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0
+        && header->version == kFormatVersion
+        && header->byteOrder == kByteOrderMark
+        && header->databaseId == stamp.databaseId
+        && header->changeCounter == stamp.counter
+        && header->fileSize == size
+        && header->folderOffset == sizeof(Header)
+        && header->itemOffset == header->folderOffset + quint64(header->folderCount) * sizeof(FolderRecord)
+        && header->tagRefOffset == header->itemOffset + quint64(header->itemCount) * sizeof(ItemRecord)
+        && header->stringOffset == header->tagRefOffset + quint64(header->tagRefCount) * sizeof(StrRef)
+        && header->fileSize == header->stringOffset + quint64(header->stringUnits) * sizeof(char16_t);
+    if (!headerOk) {
+        return false;
+    }
+
+    const auto *folderRecords = reinterpret_cast<const FolderRecord *>(base + header->folderOffset);
+    const auto *itemRecords = reinterpret_cast<const ItemRecord *>(base + header->itemOffset);
+    const auto *tagRefs = reinterpret_cast<const StrRef *>(base + header->tagRefOffset);
+    const auto *units = reinterpret_cast<const QChar *>(base + header->stringOffset);
+
+    bool ok = true;
+    auto text = [&](const StrRef &ref) {
+        if (quint64(ref.offset) + ref.length > header->stringUnits) {
+            ok = false;
+            return QString();
+        }
+        return QString(units + ref.offset, ref.length);
+    };
+    // 重复出现的字符串（标签、颜色）复用同一个 QString，隐式共享省去重复分配
+    QHash<quint32, QString> shared;
+    auto sharedText = [&](const StrRef &ref) {
+        auto it = shared.find(ref.offset);
+        if (it == shared.end()) {
+            it = shared.insert(ref.offset, text(ref));
+        }
+        return it.value();
+    };
+
+    QList<TodoFolder> result;
+    result.reserve(header->folderCount);
+    for (quint32 f = 0; f < header->folderCount && ok; ++f) {
+        const FolderRecord &record = folderRecords[f];
+        if (quint64(record.firstItem) + record.itemCount > header->itemCount) {
+            return false;
+        }
+        TodoFolder folder;
+        folder.setId(text(record.id));
+        folder.setName(text(record.name));
+        folder.setColor(sharedText(record.color));
+        folder.setCreatedTime(fromMs(record.createdTime));
+        folder.setPinned(record.isPinned != 0);
+
+        QList<TodoItem> &items = folder.getItemsRef();
+        items.reserve(record.itemCount);
+        for (quint32 i = record.firstItem; i < record.firstItem + record.itemCount; ++i) {
+            const ItemRecord &row = itemRecords[i];
+            if (quint64(row.firstTag) + row.tagCount > header->tagRefCount) {
+                return false;
+            }
+            QStringList tags;
+            tags.reserve(row.tagCount);
+            for (quint32 t = row.firstTag; t < row.firstTag + row.tagCount; ++t) {
+                tags.append(sharedText(tagRefs[t]));
+            }
+
+            TodoItem item;
+            item.setId(text(row.id));
+            item.setTitle(text(row.title));
+            item.setDetails(text(row.details));
+            item.setCreatedTime(fromMs(row.createdTime));
+            item.setCompleted(row.isCompleted != 0);
+            item.setCompletedTime(fromMs(row.completedTime));
+            item.setFolderId(folder.getId());
+            item.setPlannedDate(fromDay(row.plannedDate));
+            item.setDueDate(fromDay(row.dueDate));
+            item.setPriority(row.priority);
+            item.setTagColor(sharedText(row.tagColor));
+            item.setPinned(row.isPinned != 0);
+            item.setRemindAt(fromMs(row.remindAt));
+            item.setTags(tags);
+            // 各 setter 会刷新 updatedTime，必须放在最后恢复
+            item.setUpdatedTime(fromMs(row.updatedTime));
+            items.append(item);
+        }
+        result.append(folder);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    *folders = std::move(result);
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef MODELSNAPSHOT_H
+#define MODELSNAPSHOT_H
+
+#include <QString>
+#include <QList>
+#include "todofolder.h"
+#include "databasemanager.h"
+
+// 内存模型的二进制快照：正常退出时写在 todolist.db 旁，下次启动若库未变化则映射读取，
+// 省去 SQL 查询、逐行取值与日期文本解析。
+//
+// 不做按需水合，启动仍随事项数线性增长：load 把每条记录拷成 TodoFolder / TodoItem（标题、详情各
+// 分配一次 QString）。日历、统计页虽已推迟构建，但桌面小部件在首帧前就取 TodoStore::snapshot()
+// 遍历全部事项，随后的提醒扫描与命令面板候选同样如此，懒加载的文件夹会立即被全部水合，
+// 还要让映射在整个运行期间保持打开（退出时无法覆盖快照文件）。省下的只是每条记录的常数开销。
+//
+// 文件为定长布局，可直接 mmap：
+//   Header | FolderRecord[folderCount] | ItemRecord[itemCount] | StrRef[tagRefCount] | char16_t[stringUnits]
+// 记录中的字符串都是指向末尾字符串表的 (偏移, 长度)，标签名与颜色在表中只存一份。
+// 本机字节序写入，头部带字节序标记；任何校验不过都视为无快照，回退到 loadAll。
+class ModelSnapshot
+{
+public:
+    static bool save(const QString &path, const QList<TodoFolder> &folders,
+                     const DatabaseManager::ChangeStamp &stamp, QString *error);
+
+    // 快照存在、格式完整且版本戳与库一致时返回 true
+    static bool load(const QString &path, const DatabaseManager::ChangeStamp &stamp,
+                     QList<TodoFolder> *folders);
+};
+
+#endif // MODELSNAPSHOT_H
@@ -0,0 +1,145 @@
+#include "palettecorpus.h"
+#include "pinyinindex.h"
+
+#include <QSet>
+
+PaletteCorpus::PaletteCorpus(const TodoStore *store, QObject *parent)
+    : QObject(parent)
+    , m_store(store)
+{
+    const TodoChangeFeed *feed = store->feed();
+    connect(feed, &TodoChangeFeed::itemAdded, this, &PaletteCorpus::onItemAdded);
+    connect(feed, &TodoChangeFeed::itemChanged, this, &PaletteCorpus::onItemChanged);
+    connect(feed, &TodoChangeFeed::itemMoved, this, &PaletteCorpus::onItemMoved);
+    connect(feed, &TodoChangeFeed::itemRemoved, this, &PaletteCorpus::onItemRemoved);
+    connect(feed, &TodoChangeFeed::folderChanged, this, &PaletteCorpus::onFolderChanged);
+    connect(feed, &TodoChangeFeed::modelReset, this, [this]() { m_stale = true; });
+}
+
+void PaletteCorpus::prepare(const QList<std::pair<QString, QString>> &actions, const QStringList &tags)
+{
+    if (m_stale) {
+        rebuild(actions, tags);
+        return;
+    }
+    for (const auto &action : actions) {
+        put(Action, action.first, action.second, QStringLiteral("操作"));   // 主题切换的显示名会变
+    }
+    const QSet<QString> wanted(tags.cbegin(), tags.cend());
+    const QStringList known = m_candidateOf[Tag].keys();
+    for (const QString &tag : known) {
+        if (!wanted.contains(tag)) {
+            drop(Tag, tag);
+        }
+    }
+    for (const QString &tag : tags) {
+        put(Tag, tag, QLatin1Char('#') + tag, QStringLiteral("标签"));
+    }
+}
+
+QString PaletteCorpus::subtitle(int candidate) const
+{
+    const Entry &entry = m_entries[size_t(candidate)];
+    return entry.kind == Item ? m_store->folderName(entry.subtitle) : entry.subtitle;
+}
+
+void PaletteCorpus::rebuild(const QList<std::pair<QString, QString>> &actions, const QStringList &tags)
+{
+    m_matcher.clear();
+    m_entries.clear();
+    for (QHash<QString, int> &candidates : m_candidateOf) {
+        candidates.clear();
+    }
+
+    // 加入顺序即空查询时的列表顺序：操作、文件夹、标签、事项
+    const QList<TodoFolder> &folders = m_store->folders();
+    const int count = int(actions.size() + folders.size() + tags.size()) + m_store->itemCount();
+    m_matcher.reserve(count, qsizetype(m_store->itemCount()) * 24);
+    m_entries.reserve(size_t(count));
+    for (const auto &action : actions) {
+        put(Action, action.first, action.second, QStringLiteral("操作"));
+    }
+    for (const TodoFolder &folder : folders) {
+        put(Folder, folder.getId(), folder.getName(), QStringLiteral("文件夹"));
+    }
+    for (const QString &tag : tags) {
+        put(Tag, tag, QLatin1Char('#') + tag, QStringLiteral("标签"));
+    }
+    for (const TodoFolder &folder : folders) {
+        for (const TodoItem &item : folder.getItems()) {
+            put(Item, item.getId(), item.getTitle(), folder.getId());
+        }
+    }
+    m_stale = false;
+}
+
+void PaletteCorpus::put(Kind kind, const QString &key, const QString &title, const QString &subtitle)
+{
+    const auto it = m_candidateOf[kind].constFind(key);
+    if (it != m_candidateOf[kind].constEnd()) {
+        Entry &entry = m_entries[size_t(it.value())];
+        entry.subtitle = subtitle;
+        if (entry.title != title) {
+            entry.title = title;
+            m_matcher.set(it.value(), title, PinyinIndex::spell(title));
+        }
+        return;
+    }
+    const int candidate = m_matcher.add(title, PinyinIndex::spell(title));
+    if (candidate == int(m_entries.size())) {
+        m_entries.push_back({kind, key, title, subtitle});
+    } else {
+        m_entries[size_t(candidate)] = {kind, key, title, subtitle};
+    }
+    m_candidateOf[kind].insert(key, candidate);
+}
+
+void PaletteCorpus::drop(Kind kind, const QString &key)
+{
+    const int candidate = m_candidateOf[kind].take(key);
+    m_matcher.remove(candidate);
+    m_entries[size_t(candidate)] = Entry();
+}
+
+void PaletteCorpus::onItemAdded(const TodoItem &item)
+{
+    if (!m_stale) {
+        put(Item, item.getId(), item.getTitle(), item.getFolderId());
+    }
+}
+
+void PaletteCorpus::onItemChanged(const TodoItem &item, TodoChangeFeed::Fields fields)
+{
+    if (!m_stale && (fields & TodoChangeFeed::Title)) {
+        put(Item, item.getId(), item.getTitle(), item.getFolderId());
+    }
+}
+
+void PaletteCorpus::onItemMoved(const TodoItem &item)
+{
+    if (!m_stale) {
+        put(Item, item.getId(), item.getTitle(), item.getFolderId());
+    }
+}
+
+void PaletteCorpus::onItemRemoved(const TodoItem &item)
+{
+    if (!m_stale && m_candidateOf[Item].contains(item.getId())) {
+        drop(Item, item.getId());
+    }
+}
+
+void PaletteCorpus::onFolderChanged(const TodoFolder &folder)
+{
+    if (m_stale) {
+        return;
+    }
+    // 新建的文件夹连同其中的事项一起加入（addFolder 只发 folderChanged）
+    const bool added = !m_candidateOf[Folder].contains(folder.getId());
+    put(Folder, folder.getId(), folder.getName(), QStringLiteral("文件夹"));
+    if (added) {
+        for (const TodoItem &item : folder.getItems()) {
+            put(Item, item.getId(), item.getTitle(), folder.getId());
+        }
+    }
+}
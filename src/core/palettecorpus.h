@@ -0,0 +1,60 @@
+#ifndef PALETTECORPUS_H
+#define PALETTECORPUS_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <utility>
+#include <vector>
+#include "fuzzymatcher.h"
+#include "todostore.h"
+
+// 命令面板的候选集：操作、文件夹、标签与全部事项标题（附拼音）常驻在一个 FuzzyMatcher 里，
+// 随 TodoChangeFeed 逐项增删改，每次打开面板不再整表重建。
+// 模型整体替换（modelReset）后只标记失效，下一次 prepare 时整表重建一次；
+// 操作与标签数量很少，每次 prepare 按差异同步。事项的副标题是所在文件夹名，显示时按 id 读取，
+// 文件夹改名不必改动事项候选。
+class PaletteCorpus : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind { Action, Folder, Item, Tag };
+
+    struct Entry {
+        Kind kind = Action;
+        QString key;                         // 操作名、文件夹 id、事项 id 或标签名
+        QString title;
+        QString subtitle;                    // 事项为所在文件夹 id，其余为固定说明
+    };
+
+    explicit PaletteCorpus(const TodoStore *store, QObject *parent = nullptr);
+
+    // 打开面板前调用。actions 为 (key, 显示名)，tags 为标签库全部标签
+    void prepare(const QList<std::pair<QString, QString>> &actions, const QStringList &tags);
+
+    FuzzyMatcher &matcher() { return m_matcher; }
+    const Entry &entry(int candidate) const { return m_entries[size_t(candidate)]; }
+    QString subtitle(int candidate) const;
+
+private:
+    void rebuild(const QList<std::pair<QString, QString>> &actions, const QStringList &tags);
+    void put(Kind kind, const QString &key, const QString &title, const QString &subtitle);
+    void drop(Kind kind, const QString &key);
+
+    void onItemAdded(const TodoItem &item);
+    void onItemChanged(const TodoItem &item, TodoChangeFeed::Fields fields);
+    void onItemMoved(const TodoItem &item);
+    void onItemRemoved(const TodoItem &item);
+    void onFolderChanged(const TodoFolder &folder);
+
+    const TodoStore *m_store;
+    FuzzyMatcher m_matcher;
+    std::vector<Entry> m_entries;            // 与候选下标一一对应，空位的 key 为空
+    QHash<QString, int> m_candidateOf[Tag + 1];
+    bool m_stale = true;                     // 尚未构建或模型已整体替换
+};
+
+#endif // PALETTECORPUS_H
@@ -0,0 +1,295 @@
+#include "pinyinindex.h"
+#include "pinyintable.h"
+#include "simdfind.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr char kSegmentEnd = 0x01;            // 全拼段、首字母段之后各一个，命中不会跨段
+constexpr quint32 kSlack = 8;                 // 槽位预留字节，标题小改动可以原地改写
+constexpr qsizetype kCompactMinBytes = 64 * 1024;
+
+bool isAsciiAlnum(char16_t ch)
+{
+    return (ch >= u'a' && ch <= u'z') || (ch >= u'A' && ch <= u'Z') || (ch >= u'0' && ch <= u'9');
+}
+
+struct Key {
+    QByteArray bytes;
+    QByteArray starts;                        // 1 = 音节起点
+    QList<qsizetype> source;                  // 每个字节来自原文哪个字符（仅 findSpan 需要）
+};
+
+// 追加 text 的全拼段与首字母段：汉字按音节展开，字母数字串整体小写后算一个音节，
+// 其余字符只起分隔作用。text 不含汉字时什么也不追加并返回 false（纯文本搜索已能覆盖）
+bool appendKey(QStringView text, Key *key, bool trackSource)
+{
+    const bool hasHan = std::any_of(text.cbegin(), text.cend(),
+                                    [](QChar ch) { return PinyinTable::syllable(ch.unicode()) != nullptr; });
+    if (!hasHan) {
+        return false;
+    }
+    auto push = [&](char byte, bool start, qsizetype from) {
+        key->bytes.append(byte);
+        key->starts.append(start ? '\1' : '\0');
+        if (trackSource) {
+            key->source.append(from);
+        }
+    };
+    for (const bool initials : {false, true}) {
+        for (qsizetype i = 0; i < text.size();) {
+            const char16_t ch = text.at(i).unicode();
+            if (const char *syllable = PinyinTable::syllable(ch)) {
+                push(syllable[0], true, i);
+                for (const char *p = syllable + 1; !initials && *p; ++p) {
+                    push(*p, false, i);
+                }
+                ++i;
+            } else if (isAsciiAlnum(ch)) {
+                const qsizetype run = i;
+                for (; i < text.size() && isAsciiAlnum(text.at(i).unicode()); ++i) {
+                    push(char(QChar::toLower(text.at(i).unicode())), i == run, i);
+                }
+            } else {
+                ++i;
+            }
+        }
+        push(kSegmentEnd, false, text.size());
+    }
+    return true;
+}
+
+QString sourceOf(const TodoItem &item)
+{
+    return item.getTitle() + QChar(kSegmentEnd) + item.getTags().join(QChar(kSegmentEnd));
+}
+
+// 标题段在前，之后是各标签；全部不含汉字时返回 false
+bool buildKey(const TodoItem &item, Key *key, quint32 *titleBytes)
+{
+    appendKey(item.getTitle(), key, false);
+    *titleBytes = quint32(key->bytes.size());
+    for (const QString &tag : item.getTags()) {
+        appendKey(tag, key, false);
+    }
+    return !key->bytes.isEmpty();
+}
+}
+
+void PinyinIndex::reset(const QList<TodoFolder> &folders)
+{
+    // 在锁外建好新索引再整体换入，查询最多等一次交换
+    PinyinIndex fresh;
+    for (const TodoFolder &folder : folders) {
+        for (const TodoItem &item : folder.getItems()) {
+            Key key;
+            quint32 titleBytes = 0;
+            if (buildKey(item, &key, &titleBytes)) {
+                fresh.append(item.getId(), sourceOf(item), key.bytes, key.starts, titleBytes);
+            }
+        }
+    }
+
+    {
+        QWriteLocker locker(&m_lock);
+        m_arena.swap(fresh.m_arena);
+        m_starts.swap(fresh.m_starts);
+        m_slots.swap(fresh.m_slots);
+        m_slotOf.swap(fresh.m_slotOf);
+        m_deadBytes = 0;
+    }
+}
+
+void PinyinIndex::upsert(const TodoItem &item)
+{
+    const QString source = sourceOf(item);
+    int existing = -1;
+    {
+        QReadLocker locker(&m_lock);
+        existing = m_slotOf.value(item.getId(), -1);
+        if (existing >= 0 && m_slots.at(existing).source == source) {
+            return;   // 标题与标签都没变（完成状态、详情等改动）
+        }
+    }
+
+    Key key;
+    quint32 titleBytes = 0;
+    const bool indexed = buildKey(item, &key, &titleBytes);
+
+    QWriteLocker locker(&m_lock);
+    if (indexed && existing >= 0 && quint32(key.bytes.size()) <= m_slots.at(existing).capacity) {
+        // 原地改写，余下部分补 \0
+        Slot &slot = m_slots[existing];
+        const qsizetype used = key.bytes.size();
+        std::memcpy(m_arena.data() + slot.offset, key.bytes.constData(), size_t(used));
+        std::memcpy(m_starts.data() + slot.offset, key.starts.constData(), size_t(used));
+        std::memset(m_arena.data() + slot.offset + used, 0, size_t(slot.capacity - used));
+        std::memset(m_starts.data() + slot.offset + used, 0, size_t(slot.capacity - used));
+        slot.titleBytes = titleBytes;
+        slot.source = source;
+        return;
+    }
+    if (existing >= 0) {
+        release(existing);
+    }
+    if (indexed) {
+        append(item.getId(), source, key.bytes, key.starts, titleBytes);
+    }
+    compactIfSparse();
+}
+
+void PinyinIndex::remove(const QString &itemId)
+{
+    QWriteLocker locker(&m_lock);
+    const int slot = m_slotOf.value(itemId, -1);
+    if (slot >= 0) {
+        release(slot);
+        compactIfSparse();
+    }
+}
+
+int PinyinIndex::size() const
+{
+    QReadLocker locker(&m_lock);
+    return int(m_slotOf.size());
+}
+
+QList<PinyinIndex::Match> PinyinIndex::match(const QString &query) const
+{
+    QList<Match> result;
+    const QByteArray needle = query.toLatin1();
+    if (needle.isEmpty()) {
+        return result;
+    }
+
+    QReadLocker locker(&m_lock);
+    const char *hay = m_arena.constData();
+    const qsizetype n = m_arena.size();
+    qsizetype pos = 0;
+    while (pos < n) {
+        const qsizetype at = SimdFind::findBytes(hay + pos, n - pos, needle.constData(), needle.size());
+        if (at < 0) {
+            break;
+        }
+        const qsizetype hit = pos + at;
+        if (!m_starts.at(hit)) {
+            pos = hit + 1;                    // 落在音节中间，不算前缀命中
+            continue;
+        }
+        // 作废的槽位已全部清零，命中的一定是有效槽位；记一次后跳到槽位末尾
+        const auto slot = std::upper_bound(m_slots.cbegin(), m_slots.cend(), quint32(hit),
+                                           [](quint32 value, const Slot &s) { return value < s.offset; }) - 1;
+        result.append({slot->itemId, hit < qsizetype(slot->offset + slot->titleBytes)});
+        pos = qsizetype(slot->offset) + slot->capacity;
+    }
+    return result;
+}
+
+bool PinyinIndex::isQuery(const QString &text)
+{
+    return !text.isEmpty() && std::all_of(text.cbegin(), text.cend(), [](QChar ch) {
+        return ch.unicode() >= u'a' && ch.unicode() <= u'z';
+    });
+}
+
+QString PinyinIndex::spell(const QString &text)
+{
+    Key key;
+    if (!appendKey(text, &key, false)) {
+        return QString();
+    }
+    // 只取全拼段，音节起点前补空格
+    QString spelled;
+    spelled.reserve(key.bytes.size() * 2);
+    for (qsizetype i = 0; i < key.bytes.size() && key.bytes.at(i) != kSegmentEnd; ++i) {
+        if (key.starts.at(i) && !spelled.isEmpty()) {
+            spelled += QLatin1Char(' ');
+        }
+        spelled += QLatin1Char(key.bytes.at(i));
+    }
+    return spelled;
+}
+
+bool PinyinIndex::findSpan(const QString &text, const QString &query, qsizetype *begin, qsizetype *length)
+{
+    Key key;
+    const QByteArray needle = query.toLatin1();
+    if (needle.isEmpty() || !appendKey(text, &key, true)) {
+        return false;
+    }
+    qsizetype pos = 0;
+    qsizetype at = 0;
+    while ((at = SimdFind::findBytes(key.bytes.constData() + pos, key.bytes.size() - pos,
+                                     needle.constData(), needle.size())) >= 0) {
+        const qsizetype hit = pos + at;
+        if (key.starts.at(hit)) {
+            *begin = key.source.at(hit);
+            *length = key.source.at(hit + needle.size() - 1) - *begin + 1;
+            return true;
+        }
+        pos = hit + 1;
+    }
+    return false;
+}
+
+void PinyinIndex::append(const QString &itemId, const QString &source, const QByteArray &key,
+                         const QByteArray &starts, quint32 titleBytes)
+{
+    Slot slot;
+    slot.offset = quint32(m_arena.size());
+    slot.capacity = quint32(key.size()) + kSlack;
+    slot.titleBytes = titleBytes;
+    slot.live = true;
+    slot.itemId = itemId;
+    slot.source = source;
+
+    m_arena.append(key);
+    m_arena.append(qsizetype(kSlack), '\0');
+    m_starts.append(starts);
+    m_starts.append(qsizetype(kSlack), '\0');
+    m_slots.append(slot);
+    m_slotOf.insert(itemId, int(m_slots.size() - 1));
+}
+
+void PinyinIndex::release(int slot)
+{
+    Slot &dead = m_slots[slot];
+    std::memset(m_arena.data() + dead.offset, 0, dead.capacity);
+    std::memset(m_starts.data() + dead.offset, 0, dead.capacity);
+    m_slotOf.remove(dead.itemId);
+    dead.live = false;
+    dead.itemId.clear();
+    dead.source.clear();
+    m_deadBytes += dead.capacity;
+}
+
+void PinyinIndex::compactIfSparse()
+{
+    if (m_deadBytes < kCompactMinBytes || m_deadBytes * 2 < m_arena.size()) {
+        return;
+    }
+    QByteArray arena;
+    QByteArray starts;
+    QList<Slot> slots;
+    arena.reserve(m_arena.size() - m_deadBytes);
+    starts.reserve(m_arena.size() - m_deadBytes);
+    m_slotOf.clear();
+    for (Slot &slot : m_slots) {
+        if (!slot.live) {
+            continue;
+        }
+        const quint32 offset = quint32(arena.size());
+        arena.append(m_arena.constData() + slot.offset, slot.capacity);
+        starts.append(m_starts.constData() + slot.offset, slot.capacity);
+        slot.offset = offset;
+        m_slotOf.insert(slot.itemId, int(slots.size()));
+        slots.append(std::move(slot));
+    }
+    m_arena.swap(arena);
+    m_starts.swap(starts);
+    m_slots.swap(slots);
+    m_deadBytes = 0;
+}
@@ -0,0 +1,64 @@
+#ifndef PINYININDEX_H
+#define PINYININDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include <QHash>
+#include <QReadWriteLock>
+#include "todofolder.h"
+
+// 拼音索引：为含汉字的标题与标签保存全拼和首字母，纯字母查询按音节前缀匹配。
+// 「开会」→ 全拼 kaihui（音节起点 k、h）与首字母 kh；输入 kh、kai、kaihui、hui 都能命中。
+//
+// 全部键按事项存放在一块 Latin-1 arena 的槽位里，另有一张同长的音节起点标记；
+// 查询用 SSE2 子串内核整段扫描，只接受落在音节起点上的命中。
+// 按事项增量维护：upsert 能放进原槽位就原地改写，放不下才追加新槽位并把旧槽位作废，
+// 作废空间过半时整体压缩。查询可在线程池上并发进行，写入时短暂持写锁。
+class PinyinIndex
+{
+public:
+    struct Match {
+        QString itemId;
+        bool inTitle = false;                // 命中标题（否则命中标签）
+    };
+
+    void reset(const QList<TodoFolder> &folders);
+    void upsert(const TodoItem &item);
+    void remove(const QString &itemId);
+
+    // query 须为小写 ASCII 字母（见 isQuery）
+    QList<Match> match(const QString &query) const;
+    int size() const;
+
+    static bool isQuery(const QString &text);
+    // 「开会 PPT」→ "kai hui ppt"：音节以空格分开，供模糊匹配用；不含汉字时返回空串
+    static QString spell(const QString &text);
+    // text 中被 query 的拼音命中的首个字符区间，高亮用
+    static bool findSpan(const QString &text, const QString &query, qsizetype *begin, qsizetype *length);
+
+private:
+    struct Slot {
+        quint32 offset = 0;
+        quint32 capacity = 0;
+        quint32 titleBytes = 0;
+        bool live = false;
+        QString itemId;
+        QString source;                      // 建键时的标题与标签，未变化的 upsert 直接跳过
+    };
+
+    void append(const QString &itemId, const QString &source, const QByteArray &key,
+                const QByteArray &starts, quint32 titleBytes);
+    void release(int slot);
+    void compactIfSparse();
+
+    mutable QReadWriteLock m_lock;
+    QByteArray m_arena;                      // 各槽位的键，槽位尾部以 \0 填充
+    QByteArray m_starts;                     // 与 arena 等长：1 表示该字节是音节起点
+    QList<Slot> m_slots;                     // 按 offset 升序
+    QHash<QString, int> m_slotOf;            // 事项 id → 有效槽位
+    qsizetype m_deadBytes = 0;
+};
+
+#endif // PINYININDEX_H
@@ -0,0 +1,923 @@
+#include "pinyintable.h"
+
+// 由 ICU 的 Han-Latin 转写逐字生成，去掉声调，ü 记作 v；多音字只保留默认读音。
+// kReadings[ch - kFirst] 是 kSyllables 的下标，0 表示该字没有读音。
+
+namespace {
+constexpr char16_t kFirst = 0x4E00;
+constexpr char16_t kLast = 0x9FA5;
+
+const char *const kSyllables[] = {
+    nullptr, "a", "ai", "an", "ang", "ao", "ba", "bai", "ban", "bang", "bao", "bei", "ben", "beng",
+    "bi", "bian", "biao", "bie", "bin", "bing", "bo", "bu", "ca", "cai", "can", "cang", "cao", "ce",
+    "cen", "ceng", "cha", "chai", "chan", "chang", "chao", "che", "chen", "cheng", "chi", "chong",
+    "chou", "chu", "chua", "chuai", "chuan", "chuang", "chui", "chun", "chuo", "ci", "cong", "cou",
+    "cu", "cuan", "cui", "cun", "cuo", "da", "dai", "dan", "dang", "dao", "de", "den", "deng", "di",
+    "dian", "diao", "die", "ding", "diu", "dong", "dou", "du", "duan", "dui", "dun", "duo", "e",
+    "ei", "en", "eng", "er", "fa", "fan", "fang", "fei", "fen", "feng", "fiao", "fo", "fou", "fu",
+    "ga", "gai", "gan", "gang", "gao", "ge", "gei", "gen", "geng", "gong", "gou", "gu", "gua",
+    "guai", "guan", "guang", "gui", "gun", "guo", "ha", "hai", "han", "hang", "hao", "he", "hei",
+    "hen", "heng", "hm", "hong", "hou", "hu", "hua", "huai", "huan", "huang", "hui", "hun", "huo",
+    "ji", "jia", "jian", "jiang", "jiao", "jie", "jin", "jing", "jiong", "jiu", "ju", "juan", "jue",
+    "jun", "ka", "kai", "kan", "kang", "kao", "ke", "kei", "ken", "keng", "kong", "kou", "ku",
+    "kua", "kuai", "kuan", "kuang", "kui", "kun", "kuo", "la", "lai", "lan", "lang", "lao", "le",
+    "lei", "leng", "li", "lia", "lian", "liang", "liao", "lie", "lin", "ling", "liu", "lo", "long",
+    "lou", "lu", "luan", "lun", "luo", "lve", "m", "ma", "mai", "man", "mang", "mao", "me", "mei",
+    "men", "meng", "mi", "mian", "miao", "mie", "min", "ming", "miu", "mo", "mou", "mu", "n", "na",
+    "nai", "nan", "nang", "nao", "ne", "nei", "nen", "neng", "ni", "nian", "niang", "niao", "nie",
+    "nin", "ning", "niu", "nong", "nou", "nu", "nuan", "nun", "nuo", "nve", "o", "ou", "pa", "pai",
+    "pan", "pang", "pao", "pei", "pen", "peng", "pi", "pian", "piao", "pie", "pin", "ping", "po",
+    "pou", "pu", "qi", "qia", "qian", "qiang", "qiao", "qie", "qin", "qing", "qiong", "qiu", "qu",
+    "quan", "que", "qun", "ran", "rang", "rao", "re", "ren", "reng", "ri", "rong", "rou", "ru",
+    "rua", "ruan", "rui", "run", "ruo", "sa", "sai", "san", "sang", "sao", "se", "sen", "seng",
+    "sha", "shai", "shan", "shang", "shao", "she", "shei", "shen", "sheng", "shi", "shou", "shu",
+    "shua", "shuai", "shuan", "shuang", "shui", "shun", "shuo", "si", "song", "sou", "su", "suan",
+    "sui", "sun", "suo", "ta", "tai", "tan", "tang", "tao", "te", "teng", "ti", "tian", "tiao",
+    "tie", "ting", "tong", "tou", "tu", "tuan", "tui", "tun", "tuo", "wa", "wai", "wan", "wang",
+    "wei", "wen", "weng", "wo", "wu", "xi", "xia", "xian", "xiang", "xiao", "xie", "xin", "xing",
+    "xiong", "xiu", "xu", "xuan", "xue", "xun", "ya", "yan", "yang", "yao", "ye", "yi", "yin",
+    "ying", "yo", "yong", "you", "yu", "yuan", "yue", "yun", "za", "zai", "zan", "zang", "zao",
+    "ze", "zei", "zen", "zeng", "zha", "zhai", "zhan", "zhang", "zhao", "zhe", "zhen", "zheng",
+    "zhi", "zhong", "zhou", "zhu", "zhua", "zhuai", "zhuan", "zhuang", "zhui", "zhun", "zhuo", "zi",
+    "zong", "zou", "zu", "zuan", "zui", "zun", "zuo",
+};
+
+const quint16 kReadings[kLast - kFirst + 1] = {
+    365, 69, 150, 254, 294, 347, 114, 339, 387, 285, 294, 347, 132, 21, 371, 201, 94, 40, 40, 398, 259, 245, 300, 300,
+    263, 19, 364, 50, 71, 310, 37, 70, 263, 176, 70, 370, 176, 361, 19, 286, 110, 141, 98, 360, 257, 393, 132, 137,
+    88, 107, 44, 32, 179, 402, 395, 6, 339, 59, 341, 395, 139, 173, 142, 248, 92, 365, 365, 212, 345, 141, 141, 336,
+    196, 365, 365, 392, 345, 384, 124, 83, 170, 366, 250, 240, 258, 124, 106, 37, 37, 365, 366, 360, 203, 141, 254, 364,
+    346, 349, 94, 141, 347, 124, 302, 72, 300, 132, 214, 133, 142, 300, 195, 124, 192, 186, 403, 277, 358, 361, 92, 291,
+    211, 95, 317, 371, 54, 389, 256, 392, 109, 95, 186, 179, 365, 144, 170, 191, 371, 391, 300, 300, 82, 41, 371, 162,
+    371, 374, 124, 254, 345, 139, 310, 315, 100, 100, 360, 351, 360, 254, 360, 132, 331, 340, 149, 57, 136, 113, 365, 32,
+    120, 209, 364, 349, 139, 329, 176, 349, 139, 364, 260, 20, 370, 351, 59, 175, 77, 198, 272, 272, 132, 132, 340, 365,
+    298, 272, 170, 69, 380, 138, 253, 40, 6, 387, 138, 137, 19, 273, 50, 90, 285, 187, 19, 25, 403, 300, 318, 387,
+    92, 348, 348, 336, 122, 330, 272, 256, 95, 98, 20, 58, 180, 365, 34, 33, 283, 33, 365, 209, 198, 272, 84, 34,
+    362, 256, 393, 245, 344, 345, 134, 133, 363, 88, 25, 272, 340, 87, 65, 85, 393, 254, 242, 371, 67, 76, 345, 365,
+    352, 149, 365, 132, 2, 345, 132, 92, 83, 355, 138, 245, 59, 92, 321, 393, 370, 131, 129, 371, 54, 374, 285, 341,
+    44, 35, 360, 348, 294, 33, 187, 25, 359, 352, 341, 395, 380, 348, 230, 20, 104, 220, 220, 351, 8, 356, 180, 394,
+    298, 264, 49, 13, 300, 133, 245, 365, 310, 365, 391, 66, 114, 192, 59, 395, 21, 264, 14, 388, 49, 341, 65, 395,
+    410, 370, 362, 325, 386, 117, 14, 336, 296, 371, 365, 92, 410, 103, 226, 330, 220, 348, 264, 369, 337, 256, 300, 146,
+    10, 242, 129, 117, 169, 349, 98, 362, 7, 83, 205, 133, 82, 19, 132, 119, 131, 109, 265, 327, 136, 49, 365, 300,
+    353, 298, 336, 148, 392, 94, 166, 365, 38, 158, 108, 173, 366, 300, 200, 395, 356, 370, 3, 185, 208, 82, 187, 71,
+    30, 38, 359, 102, 394, 365, 277, 55, 347, 310, 58, 185, 318, 136, 390, 27, 258, 159, 31, 226, 228, 138, 345, 123,
+    140, 37, 390, 410, 40, 260, 185, 142, 302, 329, 298, 334, 20, 213, 350, 15, 334, 371, 346, 52, 78, 263, 356, 108,
+    157, 345, 145, 365, 92, 176, 406, 258, 173, 369, 130, 139, 256, 285, 242, 313, 92, 346, 173, 92, 250, 10, 371, 254,
+    347, 352, 355, 371, 65, 35, 40, 392, 361, 174, 173, 166, 310, 134, 355, 92, 131, 142, 350, 238, 134, 16, 41, 86,
+    88, 360, 3, 11, 371, 352, 14, 124, 33, 392, 19, 141, 363, 54, 174, 339, 166, 25, 404, 98, 107, 11, 326, 302,
+    302, 198, 61, 320, 144, 46, 353, 244, 321, 123, 365, 254, 325, 95, 139, 137, 315, 33, 137, 85, 392, 155, 143, 404,
+    142, 256, 220, 187, 402, 344, 188, 311, 172, 130, 71, 403, 12, 345, 142, 212, 23, 134, 385, 364, 392, 291, 261, 226,
+    367, 37, 256, 361, 279, 393, 47, 133, 132, 341, 371, 19, 282, 325, 341, 246, 361, 88, 321, 344, 78, 351, 35, 299,
+    148, 65, 410, 30, 329, 11, 351, 128, 363, 386, 40, 361, 370, 134, 356, 384, 49, 92, 14, 392, 404, 201, 132, 365,
+    351, 359, 23, 74, 27, 390, 236, 331, 331, 11, 375, 184, 137, 341, 87, 33, 109, 312, 392, 313, 347, 92, 372, 275,
+    173, 230, 374, 135, 191, 9, 66, 321, 116, 137, 346, 293, 256, 144, 25, 41, 285, 11, 350, 369, 363, 320, 317, 362,
+    83, 19, 133, 58, 376, 321, 104, 18, 41, 233, 24, 171, 54, 369, 379, 404, 13, 311, 5, 44, 371, 385, 406, 294,
+    45, 139, 38, 291, 114, 387, 261, 361, 65, 351, 184, 11, 247, 138, 175, 185, 193, 256, 348, 320, 367, 71, 398, 349,
+    293, 258, 140, 334, 409, 253, 346, 169, 33, 108, 177, 254, 37, 32, 341, 132, 20, 129, 44, 328, 59, 136, 141, 290,
+    87, 348, 142, 78, 136, 134, 330, 179, 20, 104, 348, 313, 348, 135, 204, 364, 138, 133, 258, 245, 88, 394, 2, 284,
+    365, 145, 228, 32, 365, 60, 139, 357, 159, 134, 41, 59, 136, 291, 376, 24, 18, 3, 277, 319, 40, 31, 167, 220,
+    138, 256, 199, 345, 226, 262, 220, 33, 178, 171, 185, 161, 10, 371, 16, 377, 392, 310, 370, 116, 261, 36, 173, 324,
+    341, 183, 41, 32, 269, 302, 129, 173, 188, 377, 233, 321, 361, 171, 214, 82, 345, 374, 377, 372, 354, 39, 388, 354,
+    348, 108, 75, 151, 75, 201, 332, 33, 82, 75, 82, 138, 332, 310, 361, 361, 300, 0, 60, 256, 72, 87, 195, 298,
+    72, 0, 139, 173, 128, 277, 340, 217, 265, 176, 371, 6, 102, 181, 346, 114, 167, 102, 326, 107, 353, 19, 254, 142,
+    66, 403, 87, 362, 134, 301, 132, 365, 132, 32, 140, 195, 268, 217, 372, 195, 96, 268, 27, 140, 27, 376, 105, 140,
+    195, 394, 195, 103, 356, 201, 200, 275, 366, 351, 148, 145, 228, 365, 200, 300, 107, 199, 393, 142, 372, 205, 156, 179,
+    92, 351, 200, 19, 71, 319, 96, 88, 19, 124, 39, 144, 124, 161, 364, 172, 239, 92, 204, 71, 348, 178, 255, 134,
+    139, 312, 197, 332, 254, 104, 401, 311, 139, 176, 261, 67, 180, 71, 95, 134, 366, 51, 2, 173, 45, 205, 401, 54,
+    310, 77, 138, 179, 179, 226, 346, 73, 132, 84, 84, 84, 88, 142, 41, 391, 88, 209, 392, 92, 88, 250, 88, 147,
+    128, 147, 95, 64, 250, 256, 354, 159, 332, 5, 41, 132, 60, 114, 114, 379, 61, 67, 61, 272, 272, 45, 87, 259,
+    365, 132, 148, 256, 55, 41, 342, 132, 59, 353, 125, 339, 144, 173, 373, 178, 181, 380, 96, 45, 92, 41, 264, 67,
+    293, 204, 180, 393, 239, 17, 137, 137, 241, 173, 293, 17, 32, 139, 105, 101, 61, 45, 162, 157, 77, 82, 392, 303,
+    265, 291, 49, 151, 137, 109, 49, 109, 147, 77, 132, 325, 139, 184, 188, 380, 372, 56, 358, 152, 165, 256, 291, 45,
+    105, 134, 56, 173, 325, 86, 252, 32, 254, 45, 403, 96, 339, 20, 132, 77, 261, 293, 73, 134, 132, 20, 361, 142,
+    131, 299, 134, 77, 74, 345, 105, 92, 299, 134, 98, 57, 147, 45, 44, 32, 333, 185, 173, 244, 293, 247, 156, 136,
+    105, 258, 144, 125, 384, 402, 175, 142, 245, 181, 109, 136, 109, 134, 134, 321, 131, 132, 134, 365, 134, 392, 32, 134,
+    207, 173, 395, 173, 360, 265, 8, 102, 133, 345, 192, 178, 138, 154, 351, 392, 71, 395, 230, 137, 264, 295, 365, 395,
+    207, 173, 138, 169, 169, 143, 156, 362, 337, 350, 208, 161, 137, 178, 117, 300, 151, 138, 97, 20, 204, 38, 168, 369,
+    369, 201, 151, 359, 143, 261, 185, 21, 199, 38, 171, 147, 201, 71, 356, 356, 148, 345, 365, 359, 343, 299, 169, 209,
+    185, 247, 300, 132, 260, 135, 34, 265, 349, 365, 144, 84, 143, 330, 142, 59, 351, 192, 359, 359, 185, 173, 35, 269,
+    265, 10, 295, 374, 141, 10, 103, 345, 374, 342, 354, 94, 94, 10, 50, 365, 354, 244, 142, 322, 98, 253, 78, 241,
+    92, 102, 57, 141, 102, 14, 125, 11, 215, 300, 85, 141, 365, 375, 135, 149, 135, 161, 124, 347, 264, 84, 109, 259,
+    378, 161, 86, 124, 371, 109, 162, 129, 59, 109, 175, 175, 314, 73, 141, 144, 346, 245, 264, 365, 151, 361, 15, 220,
+    264, 300, 359, 256, 221, 283, 406, 299, 345, 129, 8, 300, 346, 339, 125, 351, 339, 11, 406, 402, 351, 59, 192, 213,
+    59, 132, 20, 304, 20, 161, 15, 21, 386, 146, 185, 370, 185, 346, 105, 344, 351, 137, 137, 341, 4, 262, 392, 195,
+    366, 341, 295, 132, 266, 186, 38, 143, 351, 356, 138, 266, 345, 132, 78, 261, 346, 285, 33, 341, 78, 329, 173, 389,
+    114, 173, 360, 360, 361, 296, 65, 384, 240, 360, 259, 360, 392, 27, 240, 325, 173, 296, 123, 329, 408, 56, 86, 372,
+    27, 372, 349, 361, 173, 144, 291, 66, 41, 141, 138, 5, 109, 361, 310, 173, 33, 167, 173, 361, 361, 372, 310, 102,
+    179, 276, 264, 264, 82, 171, 73, 348, 398, 285, 24, 24, 24, 24, 2, 58, 370, 30, 132, 370, 306, 84, 301, 106,
+    6, 83, 282, 300, 302, 402, 264, 301, 15, 356, 347, 239, 312, 132, 341, 312, 68, 280, 50, 156, 104, 142, 180, 105,
+    61, 156, 392, 136, 388, 6, 69, 151, 319, 38, 300, 370, 263, 251, 364, 116, 310, 320, 38, 170, 67, 132, 177, 122,
+    203, 356, 194, 38, 98, 357, 363, 403, 117, 132, 67, 55, 330, 205, 123, 173, 332, 349, 384, 347, 364, 185, 360, 191,
+    236, 131, 365, 145, 40, 179, 335, 366, 86, 14, 260, 260, 137, 21, 91, 6, 76, 87, 78, 114, 329, 154, 308, 254,
+    122, 392, 366, 345, 345, 34, 211, 358, 346, 46, 72, 342, 123, 122, 345, 97, 360, 145, 185, 78, 98, 197, 58, 254,
+    37, 345, 97, 92, 136, 122, 38, 299, 211, 335, 92, 365, 58, 236, 173, 11, 372, 111, 342, 257, 345, 78, 300, 143,
+    243, 342, 216, 190, 180, 268, 370, 65, 394, 300, 394, 328, 346, 365, 254, 250, 403, 104, 49, 341, 356, 117, 215, 93,
+    242, 365, 350, 298, 124, 205, 57, 264, 142, 114, 375, 336, 77, 252, 241, 17, 92, 362, 117, 375, 117, 113, 141, 369,
+    92, 57, 394, 337, 146, 104, 146, 410, 21, 183, 71, 226, 318, 310, 348, 131, 254, 82, 78, 108, 384, 346, 365, 178,
+    403, 203, 200, 392, 363, 132, 394, 98, 302, 377, 350, 113, 129, 158, 126, 322, 348, 78, 357, 355, 111, 361, 169, 365,
+    2, 249, 298, 330, 122, 354, 77, 337, 112, 376, 370, 68, 238, 349, 2, 100, 161, 360, 57, 350, 14, 129, 221, 125,
+    353, 159, 77, 87, 132, 228, 208, 368, 116, 372, 183, 252, 194, 98, 235, 38, 295, 173, 211, 406, 117, 157, 350, 348,
+    169, 20, 389, 384, 176, 6, 203, 178, 315, 92, 21, 114, 120, 101, 309, 98, 370, 361, 104, 104, 11, 114, 317, 47,
+    365, 2, 133, 332, 348, 339, 173, 346, 321, 410, 263, 35, 345, 379, 360, 72, 254, 65, 260, 191, 207, 102, 72, 264,
+    169, 176, 317, 379, 127, 168, 291, 132, 406, 344, 88, 138, 124, 254, 301, 341, 303, 33, 82, 173, 257, 3, 380, 368,
+    221, 371, 326, 166, 291, 346, 336, 124, 2, 388, 229, 153, 402, 402, 294, 65, 120, 179, 1, 23, 349, 335, 345, 342,
+    54, 291, 104, 254, 254, 322, 59, 59, 364, 403, 14, 54, 43, 117, 360, 254, 389, 86, 176, 348, 245, 291, 165, 380,
+    367, 105, 237, 389, 288, 398, 224, 111, 188, 361, 65, 265, 32, 20, 69, 168, 350, 142, 321, 38, 325, 3, 141, 59,
+    146, 369, 341, 213, 293, 371, 389, 165, 137, 123, 114, 68, 394, 31, 338, 233, 371, 366, 375, 363, 235, 201, 124, 374,
+    44, 129, 127, 127, 346, 117, 132, 162, 393, 341, 291, 356, 128, 77, 224, 357, 176, 371, 286, 38, 258, 361, 59, 243,
+    24, 173, 368, 384, 341, 202, 367, 243, 21, 162, 346, 371, 137, 184, 157, 379, 124, 325, 363, 117, 1, 355, 257, 288,
+    369, 313, 122, 351, 2, 317, 191, 30, 113, 151, 57, 286, 36, 277, 312, 337, 132, 240, 345, 256, 300, 98, 403, 137,
+    169, 343, 337, 310, 38, 116, 317, 0, 113, 317, 260, 224, 117, 392, 284, 210, 98, 211, 68, 2, 257, 330, 14, 5,
+    5, 175, 408, 389, 207, 312, 312, 320, 65, 254, 136, 39, 136, 147, 320, 293, 26, 133, 2, 350, 247, 184, 93, 104,
+    350, 124, 129, 111, 236, 348, 380, 33, 356, 251, 62, 191, 191, 124, 171, 73, 93, 321, 364, 13, 367, 284, 136, 200,
+    350, 125, 192, 268, 43, 244, 169, 350, 132, 395, 34, 162, 408, 350, 310, 116, 92, 177, 258, 346, 41, 32, 59, 118,
+    359, 78, 409, 84, 38, 129, 377, 45, 52, 59, 371, 335, 29, 136, 364, 346, 254, 116, 175, 356, 64, 129, 366, 253,
+    144, 260, 359, 224, 185, 310, 361, 367, 57, 386, 235, 394, 138, 228, 129, 351, 254, 78, 379, 365, 300, 136, 372, 2,
+    369, 144, 159, 371, 243, 61, 93, 121, 76, 60, 352, 284, 245, 245, 366, 408, 226, 65, 167, 318, 131, 277, 116, 347,
+    364, 77, 245, 40, 132, 138, 116, 325, 33, 359, 196, 22, 325, 185, 129, 20, 370, 224, 366, 124, 196, 122, 389, 173,
+    181, 113, 214, 350, 207, 361, 173, 185, 183, 207, 59, 36, 249, 245, 349, 131, 207, 346, 77, 157, 361, 32, 367, 269,
+    66, 165, 318, 350, 144, 48, 127, 131, 398, 224, 350, 22, 173, 32, 31, 173, 365, 188, 214, 375, 313, 346, 382, 134,
+    375, 395, 167, 224, 214, 167, 182, 341, 129, 366, 263, 310, 225, 134, 129, 352, 366, 213, 333, 333, 76, 149, 372, 140,
+    246, 374, 50, 124, 129, 372, 78, 111, 163, 50, 330, 332, 341, 187, 111, 267, 274, 180, 104, 111, 319, 111, 332, 370,
+    111, 366, 130, 253, 371, 114, 372, 187, 265, 371, 261, 111, 44, 341, 372, 265, 157, 253, 372, 372, 360, 332, 332, 332,
+    333, 189, 129, 365, 127, 186, 186, 332, 360, 332, 329, 299, 253, 185, 159, 360, 376, 341, 98, 371, 345, 109, 245, 365,
+    62, 256, 256, 390, 402, 60, 255, 347, 293, 161, 33, 254, 224, 207, 132, 133, 392, 392, 8, 359, 365, 260, 197, 145,
+    275, 335, 85, 12, 12, 320, 148, 126, 410, 154, 14, 139, 65, 139, 132, 159, 65, 139, 134, 320, 173, 6, 345, 87,
+    400, 251, 8, 321, 163, 264, 320, 392, 336, 95, 250, 66, 105, 220, 319, 245, 140, 362, 90, 5, 185, 263, 209, 151,
+    103, 358, 6, 38, 35, 180, 395, 92, 124, 392, 46, 165, 183, 183, 185, 5, 58, 241, 204, 353, 71, 132, 117, 185,
+    49, 38, 171, 94, 366, 123, 75, 388, 92, 108, 363, 77, 77, 109, 30, 362, 366, 83, 103, 372, 68, 351, 153, 294,
+    301, 78, 19, 66, 122, 360, 158, 57, 146, 60, 147, 115, 215, 3, 353, 348, 372, 9, 92, 6, 365, 366, 114, 356,
+    46, 260, 101, 2, 13, 85, 266, 369, 145, 133, 65, 192, 168, 143, 37, 293, 138, 389, 178, 178, 21, 37, 125, 21,
+    300, 359, 111, 140, 364, 221, 65, 371, 21, 360, 265, 315, 245, 261, 339, 142, 187, 391, 155, 39, 71, 58, 320, 3,
+    23, 41, 13, 148, 392, 77, 365, 392, 365, 242, 132, 401, 254, 287, 142, 220, 157, 151, 321, 163, 220, 134, 75, 138,
+    96, 371, 78, 244, 104, 332, 172, 85, 360, 256, 163, 3, 298, 77, 215, 332, 37, 366, 130, 14, 175, 111, 68, 398,
+    123, 10, 10, 371, 65, 195, 137, 279, 364, 101, 148, 404, 371, 128, 78, 363, 361, 10, 49, 197, 33, 73, 336, 366,
+    88, 393, 137, 138, 120, 96, 47, 134, 250, 171, 349, 128, 172, 74, 339, 357, 132, 132, 159, 367, 318, 37, 369, 147,
+    313, 313, 300, 200, 318, 343, 37, 332, 321, 266, 393, 173, 393, 9, 284, 378, 75, 326, 345, 391, 359, 98, 390, 2,
+    102, 361, 148, 326, 372, 342, 351, 181, 113, 168, 33, 244, 13, 36, 185, 185, 236, 256, 197, 207, 398, 306, 302, 184,
+    38, 193, 16, 139, 27, 302, 392, 387, 148, 369, 66, 36, 392, 346, 111, 257, 138, 65, 294, 209, 54, 361, 318, 383,
+    256, 257, 176, 341, 400, 258, 383, 356, 293, 293, 6, 253, 159, 71, 84, 266, 207, 76, 76, 409, 65, 299, 77, 77,
+    320, 64, 209, 87, 128, 320, 57, 364, 395, 134, 5, 257, 132, 258, 153, 365, 245, 14, 66, 135, 364, 369, 358, 320,
+    167, 142, 126, 60, 269, 256, 359, 348, 346, 117, 2, 360, 61, 116, 279, 138, 171, 161, 185, 361, 320, 341, 126, 183,
+    183, 280, 173, 179, 269, 32, 359, 361, 171, 6, 339, 300, 272, 285, 399, 399, 299, 365, 192, 151, 395, 399, 124, 124,
+    163, 365, 124, 356, 163, 301, 194, 409, 301, 365, 392, 104, 41, 135, 88, 11, 385, 15, 315, 267, 180, 92, 56, 347,
+    354, 351, 215, 347, 162, 346, 338, 372, 195, 313, 77, 77, 364, 261, 338, 103, 103, 254, 199, 199, 366, 131, 36, 57,
+    380, 326, 319, 92, 106, 363, 362, 115, 97, 300, 322, 319, 331, 361, 14, 365, 158, 133, 77, 125, 161, 374, 133, 6,
+    80, 175, 127, 65, 361, 241, 143, 254, 212, 88, 351, 87, 66, 265, 162, 405, 127, 254, 147, 384, 12, 365, 135, 322,
+    378, 12, 346, 128, 86, 67, 359, 13, 66, 5, 296, 343, 112, 5, 345, 5, 135, 175, 77, 374, 135, 300, 87, 131,
+    14, 186, 77, 230, 230, 69, 212, 256, 134, 318, 141, 231, 30, 116, 348, 84, 132, 309, 277, 86, 340, 122, 399, 92,
+    191, 59, 272, 92, 139, 361, 113, 342, 393, 237, 73, 132, 154, 393, 363, 138, 374, 202, 91, 38, 373, 399, 227, 361,
+    211, 352, 87, 14, 371, 336, 88, 339, 85, 345, 371, 109, 73, 6, 220, 394, 402, 388, 57, 212, 372, 331, 348, 392,
+    78, 197, 207, 254, 14, 298, 259, 78, 117, 356, 83, 391, 204, 8, 209, 92, 180, 403, 403, 300, 268, 293, 362, 193,
+    137, 104, 310, 353, 341, 403, 142, 293, 249, 272, 363, 71, 135, 302, 132, 94, 349, 125, 143, 136, 103, 169, 134, 134,
+    365, 221, 392, 132, 132, 348, 120, 108, 145, 158, 361, 205, 178, 242, 78, 370, 361, 30, 298, 366, 300, 109, 265, 403,
+    311, 341, 122, 337, 184, 360, 270, 136, 186, 250, 348, 295, 173, 37, 351, 194, 92, 317, 197, 341, 151, 48, 48, 329,
+    222, 353, 213, 371, 211, 252, 217, 143, 298, 392, 114, 65, 399, 78, 249, 334, 348, 201, 345, 361, 345, 2, 361, 371,
+    310, 371, 337, 173, 348, 142, 264, 400, 254, 348, 402, 71, 33, 185, 2, 78, 78, 184, 201, 50, 252, 142, 251, 23,
+    180, 339, 16, 350, 302, 254, 129, 84, 344, 280, 320, 86, 86, 137, 326, 220, 265, 139, 130, 139, 256, 66, 353, 124,
+    339, 166, 14, 366, 40, 215, 92, 139, 187, 3, 167, 163, 366, 360, 142, 173, 66, 348, 125, 125, 367, 32, 298, 329,
+    60, 363, 345, 213, 48, 133, 331, 356, 371, 341, 65, 276, 197, 59, 279, 260, 129, 344, 256, 47, 202, 92, 137, 74,
+    365, 393, 197, 128, 201, 3, 367, 357, 137, 341, 197, 372, 391, 263, 300, 351, 336, 175, 195, 268, 310, 246, 341, 337,
+    52, 124, 5, 137, 10, 356, 331, 109, 41, 363, 245, 346, 372, 367, 275, 277, 38, 181, 197, 239, 5, 191, 103, 162,
+    260, 133, 287, 390, 372, 137, 275, 205, 367, 132, 313, 223, 348, 322, 240, 168, 215, 10, 2, 245, 249, 365, 247, 371,
+    171, 357, 193, 365, 387, 149, 369, 220, 173, 65, 109, 361, 138, 398, 33, 380, 114, 218, 169, 207, 389, 124, 124, 5,
+    218, 257, 191, 248, 104, 345, 258, 336, 386, 202, 348, 348, 207, 177, 175, 125, 109, 64, 392, 356, 365, 125, 346, 162,
+    270, 346, 361, 32, 136, 197, 84, 84, 348, 365, 129, 136, 92, 300, 14, 293, 315, 257, 175, 127, 352, 223, 71, 365,
+    24, 2, 222, 226, 191, 327, 40, 138, 49, 371, 249, 275, 277, 212, 361, 319, 367, 256, 223, 373, 367, 201, 14, 191,
+    298, 353, 220, 73, 181, 372, 167, 361, 306, 180, 136, 222, 167, 256, 367, 306, 129, 265, 200, 173, 186, 361, 395, 167,
+    403, 137, 144, 144, 155, 374, 191, 403, 55, 316, 92, 11, 403, 350, 352, 199, 310, 319, 10, 132, 104, 230, 358, 370,
+    398, 113, 186, 316, 215, 203, 50, 256, 302, 24, 360, 403, 220, 92, 403, 173, 358, 20, 277, 212, 224, 224, 367, 186,
+    201, 226, 275, 318, 109, 385, 262, 371, 301, 3, 332, 311, 339, 276, 363, 122, 365, 139, 401, 200, 395, 60, 122, 404,
+    107, 394, 69, 339, 365, 10, 300, 300, 39, 298, 151, 357, 300, 370, 127, 365, 327, 300, 348, 102, 37, 267, 102, 350,
+    376, 384, 10, 113, 361, 350, 133, 298, 36, 275, 128, 200, 156, 160, 18, 313, 23, 377, 132, 372, 132, 366, 200, 156,
+    261, 117, 390, 134, 92, 226, 19, 127, 197, 260, 114, 371, 300, 226, 138, 226, 392, 371, 10, 160, 226, 260, 207, 30,
+    142, 105, 260, 124, 345, 177, 300, 226, 385, 298, 341, 351, 160, 129, 177, 145, 127, 365, 365, 10, 260, 39, 10, 88,
+    55, 75, 310, 359, 61, 185, 75, 301, 251, 88, 398, 92, 296, 151, 135, 135, 398, 341, 409, 359, 302, 75, 61, 350,
+    137, 295, 82, 82, 82, 93, 134, 302, 36, 294, 294, 207, 93, 33, 177, 348, 348, 163, 370, 340, 370, 177, 177, 363,
+    194, 340, 340, 340, 93, 363, 77, 162, 393, 141, 95, 104, 95, 334, 95, 95, 300, 366, 38, 150, 220, 138, 341, 223,
+    142, 245, 29, 346, 14, 142, 137, 326, 264, 325, 137, 345, 67, 300, 300, 250, 132, 351, 390, 351, 220, 386, 346, 341,
+    193, 78, 184, 250, 325, 86, 302, 351, 332, 185, 185, 346, 29, 185, 142, 351, 142, 144, 177, 144, 302, 346, 35, 335,
+    220, 293, 337, 348, 173, 78, 129, 129, 183, 365, 254, 272, 345, 114, 298, 371, 41, 315, 254, 272, 373, 8, 363, 4,
+    360, 345, 137, 78, 132, 256, 87, 339, 254, 28, 256, 254, 30, 137, 264, 96, 348, 5, 167, 61, 6, 410, 410, 362,
+    142, 96, 151, 103, 358, 251, 173, 327, 264, 361, 92, 355, 133, 180, 336, 245, 5, 58, 161, 373, 264, 124, 251, 204,
+    3, 327, 180, 38, 250, 71, 114, 162, 355, 195, 330, 358, 365, 15, 117, 6, 188, 78, 92, 359, 68, 185, 80, 82,
+    94, 265, 71, 365, 209, 300, 3, 341, 127, 392, 200, 173, 132, 330, 341, 370, 255, 347, 173, 363, 136, 391, 186, 136,
+    78, 78, 371, 351, 21, 258, 267, 88, 88, 215, 173, 370, 348, 275, 61, 298, 37, 332, 101, 145, 97, 347, 366, 371,
+    168, 148, 169, 166, 348, 266, 155, 39, 39, 318, 179, 125, 142, 166, 254, 204, 163, 163, 406, 104, 54, 360, 360, 96,
+    187, 187, 172, 144, 77, 391, 111, 366, 71, 114, 391, 341, 350, 245, 361, 311, 137, 13, 406, 157, 71, 386, 104, 366,
+    403, 380, 128, 371, 338, 362, 88, 263, 362, 325, 365, 392, 300, 376, 363, 78, 395, 148, 185, 361, 197, 114, 132, 132,
+    127, 329, 299, 197, 256, 345, 371, 404, 167, 151, 361, 361, 341, 404, 30, 315, 275, 151, 260, 371, 254, 184, 332, 75,
+    346, 343, 25, 60, 275, 137, 147, 181, 345, 311, 258, 403, 341, 13, 66, 56, 256, 369, 224, 56, 132, 300, 282, 311,
+    404, 135, 177, 149, 32, 68, 28, 69, 332, 184, 387, 386, 386, 5, 26, 264, 257, 54, 408, 61, 61, 346, 371, 242,
+    183, 349, 29, 20, 260, 136, 361, 169, 386, 179, 177, 177, 138, 64, 77, 409, 136, 109, 363, 136, 363, 144, 386, 365,
+    358, 215, 364, 364, 365, 224, 348, 132, 351, 151, 346, 65, 5, 408, 341, 365, 275, 61, 180, 137, 371, 373, 366, 277,
+    137, 173, 109, 183, 183, 66, 275, 346, 142, 32, 367, 162, 361, 341, 215, 265, 34, 53, 186, 66, 66, 224, 361, 361,
+    361, 162, 361, 44, 159, 44, 394, 128, 139, 359, 34, 34, 178, 102, 410, 258, 142, 102, 142, 345, 253, 253, 30, 263,
+    263, 132, 365, 310, 6, 392, 388, 349, 365, 138, 359, 143, 6, 359, 138, 92, 375, 14, 300, 21, 69, 304, 84, 224,
+    300, 87, 237, 392, 346, 124, 59, 341, 387, 321, 58, 207, 242, 237, 328, 20, 175, 392, 394, 20, 392, 65, 207, 365,
+    365, 250, 255, 143, 277, 304, 58, 391, 307, 258, 390, 300, 267, 346, 9, 58, 109, 40, 250, 387, 285, 339, 58, 341,
+    33, 291, 254, 380, 111, 195, 73, 123, 391, 356, 200, 341, 344, 92, 365, 9, 250, 68, 102, 239, 128, 322, 200, 133,
+    324, 129, 393, 293, 193, 209, 16, 111, 380, 209, 9, 387, 139, 32, 92, 392, 124, 84, 45, 14, 14, 387, 200, 258,
+    32, 87, 199, 9, 40, 203, 41, 137, 348, 167, 95, 250, 221, 134, 19, 19, 353, 95, 363, 127, 370, 370, 132, 108,
+    245, 329, 380, 108, 399, 207, 261, 14, 260, 76, 45, 109, 360, 7, 137, 356, 185, 345, 399, 157, 367, 65, 241, 66,
+    360, 202, 101, 49, 92, 330, 240, 86, 349, 365, 392, 327, 392, 355, 73, 410, 350, 332, 109, 157, 194, 329, 370, 21,
+    19, 37, 166, 14, 132, 3, 302, 149, 369, 336, 311, 302, 261, 371, 371, 202, 312, 27, 349, 86, 141, 78, 109, 181,
+    291, 175, 168, 312, 392, 21, 261, 141, 141, 138, 5, 164, 184, 366, 177, 58, 185, 365, 41, 32, 332, 310, 352, 202,
+    33, 345, 86, 108, 157, 159, 14, 257, 351, 179, 179, 177, 185, 132, 367, 348, 329, 369, 173, 329, 366, 359, 361, 329,
+    65, 238, 134, 129, 212, 129, 102, 221, 147, 15, 365, 254, 228, 87, 142, 361, 365, 378, 14, 365, 365, 82, 285, 300,
+    82, 300, 300, 102, 67, 366, 124, 92, 122, 345, 334, 38, 135, 6, 298, 65, 387, 144, 322, 92, 65, 200, 348, 124,
+    34, 230, 139, 390, 365, 200, 265, 339, 295, 282, 357, 139, 67, 387, 135, 257, 244, 59, 257, 14, 14, 296, 59, 134,
+    103, 98, 83, 14, 156, 134, 17, 350, 59, 111, 135, 122, 200, 111, 339, 144, 132, 132, 109, 60, 185, 185, 333, 129,
+    392, 129, 129, 365, 365, 365, 365, 373, 373, 293, 353, 342, 330, 361, 361, 371, 38, 23, 16, 67, 18, 244, 369, 247,
+    387, 367, 38, 38, 402, 336, 132, 85, 393, 365, 340, 35, 14, 65, 180, 92, 340, 391, 52, 340, 139, 58, 346, 359,
+    119, 362, 126, 185, 123, 340, 37, 392, 356, 139, 332, 50, 392, 166, 50, 62, 238, 346, 71, 132, 33, 392, 50, 394,
+    166, 371, 351, 137, 134, 300, 133, 15, 128, 92, 359, 341, 240, 363, 341, 346, 391, 247, 325, 62, 391, 392, 17, 62,
+    39, 35, 136, 129, 136, 129, 197, 183, 349, 10, 264, 352, 352, 14, 365, 170, 272, 61, 69, 94, 132, 272, 272, 32,
+    320, 323, 323, 95, 254, 300, 55, 392, 340, 194, 346, 84, 367, 326, 204, 342, 393, 39, 345, 132, 345, 346, 133, 370,
+    339, 50, 311, 159, 371, 15, 392, 254, 54, 36, 319, 335, 256, 221, 130, 354, 227, 161, 348, 352, 149, 124, 147, 87,
+    126, 319, 311, 345, 236, 33, 45, 142, 365, 10, 34, 204, 242, 410, 382, 362, 142, 8, 230, 215, 391, 237, 21, 328,
+    124, 124, 142, 57, 175, 310, 40, 65, 58, 365, 332, 370, 92, 132, 244, 353, 372, 220, 106, 92, 346, 14, 370, 259,
+    357, 50, 19, 128, 356, 41, 14, 302, 346, 320, 369, 404, 75, 207, 392, 365, 300, 218, 359, 300, 346, 169, 120, 161,
+    208, 392, 351, 175, 327, 128, 68, 116, 155, 109, 120, 346, 136, 302, 310, 124, 263, 362, 129, 129, 38, 133, 365, 354,
+    106, 179, 129, 403, 356, 38, 294, 230, 119, 80, 151, 71, 326, 102, 265, 346, 255, 373, 244, 153, 62, 129, 78, 350,
+    330, 361, 147, 27, 215, 374, 194, 369, 369, 372, 245, 163, 258, 373, 371, 332, 137, 346, 389, 179, 325, 114, 116, 259,
+    325, 21, 365, 256, 129, 346, 11, 193, 365, 120, 311, 265, 37, 162, 345, 345, 370, 173, 176, 127, 50, 365, 373, 173,
+    225, 215, 78, 266, 357, 256, 345, 204, 50, 86, 11, 62, 54, 33, 198, 173, 132, 107, 107, 353, 61, 254, 155, 326,
+    187, 346, 148, 110, 220, 261, 40, 76, 111, 386, 139, 339, 372, 138, 132, 167, 371, 131, 117, 265, 320, 325, 325, 224,
+    340, 48, 124, 130, 346, 33, 352, 341, 129, 78, 317, 404, 134, 369, 66, 142, 24, 37, 62, 11, 259, 24, 59, 107,
+    77, 215, 374, 349, 400, 68, 128, 47, 262, 271, 353, 27, 15, 204, 404, 325, 258, 40, 11, 357, 341, 98, 256, 341,
+    371, 371, 14, 357, 127, 204, 14, 365, 201, 369, 147, 60, 366, 78, 36, 195, 255, 151, 371, 2, 259, 361, 233, 95,
+    374, 404, 284, 172, 87, 367, 162, 162, 266, 102, 374, 313, 313, 254, 363, 311, 128, 132, 104, 142, 45, 220, 351, 147,
+    391, 369, 26, 359, 298, 20, 147, 372, 346, 130, 369, 362, 173, 287, 322, 366, 49, 356, 256, 319, 128, 374, 298, 205,
+    102, 296, 50, 247, 209, 209, 111, 38, 24, 24, 24, 54, 204, 323, 387, 330, 5, 306, 193, 107, 266, 379, 141, 129,
+    147, 175, 236, 311, 260, 366, 185, 294, 341, 333, 193, 256, 296, 369, 261, 149, 65, 392, 184, 143, 254, 254, 371, 250,
+    177, 50, 370, 39, 392, 330, 37, 254, 264, 244, 11, 17, 262, 136, 383, 38, 175, 250, 162, 129, 258, 37, 366, 366,
+    346, 346, 59, 320, 77, 75, 75, 313, 144, 27, 350, 84, 87, 169, 169, 39, 114, 254, 348, 204, 139, 177, 345, 24,
+    144, 52, 348, 320, 299, 245, 365, 41, 348, 215, 59, 320, 139, 311, 114, 136, 341, 357, 71, 260, 260, 142, 26, 153,
+    351, 367, 5, 195, 365, 179, 288, 145, 126, 198, 167, 2, 179, 361, 164, 347, 38, 371, 366, 58, 199, 2, 199, 75,
+    254, 207, 167, 198, 40, 392, 233, 233, 361, 362, 20, 392, 161, 161, 370, 92, 181, 203, 37, 129, 32, 199, 167, 126,
+    357, 269, 32, 132, 142, 127, 296, 365, 175, 213, 200, 321, 144, 96, 96, 399, 98, 373, 345, 134, 356, 302, 275, 346,
+    37, 344, 137, 98, 134, 257, 131, 257, 386, 71, 254, 133, 68, 381, 133, 132, 392, 148, 132, 162, 94, 64, 386, 257,
+    98, 134, 137, 371, 134, 361, 185, 124, 386, 346, 346, 48, 58, 264, 124, 124, 124, 78, 300, 325, 195, 124, 173, 85,
+    317, 15, 66, 140, 294, 365, 365, 293, 124, 86, 361, 301, 301, 23, 384, 263, 170, 253, 6, 57, 273, 84, 277, 376,
+    336, 387, 67, 149, 371, 157, 95, 298, 30, 336, 104, 156, 345, 63, 256, 392, 272, 164, 198, 287, 362, 227, 8, 35,
+    270, 346, 256, 8, 133, 371, 92, 5, 346, 245, 392, 392, 78, 63, 388, 37, 132, 361, 161, 15, 34, 142, 342, 124,
+    373, 144, 6, 260, 59, 391, 374, 339, 216, 365, 302, 396, 252, 331, 72, 149, 389, 252, 92, 241, 6, 5, 380, 333,
+    156, 187, 257, 374, 124, 10, 19, 392, 244, 213, 21, 245, 319, 363, 390, 384, 362, 10, 117, 220, 364, 65, 38, 245,
+    133, 207, 197, 36, 360, 40, 264, 204, 41, 133, 92, 384, 395, 59, 31, 209, 221, 165, 92, 241, 8, 238, 179, 211,
+    106, 256, 142, 318, 6, 336, 336, 5, 142, 402, 239, 388, 7, 7, 65, 220, 142, 164, 183, 134, 255, 369, 167, 226,
+    20, 380, 256, 119, 164, 300, 137, 391, 225, 102, 102, 265, 305, 55, 375, 150, 365, 351, 27, 129, 249, 397, 300, 211,
+    7, 38, 105, 392, 164, 77, 77, 392, 259, 3, 228, 390, 98, 136, 158, 71, 211, 327, 178, 384, 185, 68, 337, 144,
+    178, 142, 392, 186, 360, 344, 318, 351, 215, 60, 136, 391, 132, 129, 348, 371, 2, 336, 233, 56, 20, 101, 325, 390,
+    37, 283, 283, 154, 197, 228, 142, 244, 134, 365, 329, 293, 278, 339, 351, 30, 88, 136, 345, 145, 141, 330, 163, 131,
+    332, 402, 252, 185, 6, 114, 295, 224, 143, 380, 302, 364, 144, 21, 339, 21, 409, 364, 385, 185, 312, 336, 169, 316,
+    9, 134, 127, 61, 341, 339, 260, 244, 296, 178, 204, 198, 92, 7, 142, 61, 344, 2, 143, 373, 404, 36, 46, 137,
+    332, 12, 211, 221, 282, 410, 344, 254, 348, 37, 66, 287, 187, 261, 96, 77, 301, 67, 252, 65, 387, 130, 132, 322,
+    255, 254, 238, 302, 256, 180, 364, 360, 144, 391, 176, 105, 365, 131, 293, 391, 189, 23, 320, 35, 19, 137, 325, 155,
+    334, 361, 56, 394, 142, 326, 256, 153, 7, 237, 137, 185, 106, 205, 137, 392, 59, 199, 24, 287, 107, 244, 372, 233,
+    134, 391, 141, 134, 371, 361, 162, 213, 122, 276, 245, 341, 284, 405, 357, 202, 325, 224, 30, 300, 404, 390, 365, 359,
+    369, 15, 362, 127, 361, 377, 3, 356, 360, 344, 151, 43, 132, 325, 165, 165, 36, 147, 141, 141, 332, 137, 129, 100,
+    39, 350, 68, 351, 372, 256, 364, 30, 384, 11, 363, 341, 13, 167, 342, 260, 32, 98, 184, 404, 100, 136, 103, 260,
+    275, 266, 40, 43, 386, 316, 316, 20, 41, 275, 9, 56, 287, 151, 363, 61, 392, 230, 165, 134, 312, 263, 97, 348,
+    309, 286, 138, 203, 78, 46, 233, 293, 318, 384, 321, 239, 8, 57, 173, 322, 124, 392, 337, 125, 256, 342, 257, 326,
+    390, 78, 351, 233, 265, 30, 384, 98, 345, 80, 296, 149, 296, 302, 7, 363, 18, 312, 320, 283, 32, 317, 141, 39,
+    45, 106, 19, 88, 304, 65, 254, 312, 385, 175, 37, 38, 107, 185, 188, 184, 404, 94, 124, 384, 45, 321, 125, 54,
+    212, 207, 135, 109, 367, 392, 5, 392, 224, 193, 32, 156, 41, 296, 333, 136, 207, 207, 389, 24, 154, 16, 135, 363,
+    103, 256, 177, 132, 367, 144, 248, 248, 169, 76, 348, 279, 109, 377, 365, 348, 37, 37, 283, 215, 122, 310, 114, 108,
+    57, 409, 221, 179, 391, 129, 399, 136, 132, 26, 59, 59, 35, 20, 35, 144, 92, 177, 12, 92, 258, 20, 56, 402,
+    398, 341, 253, 260, 76, 221, 125, 351, 185, 136, 53, 318, 114, 258, 344, 134, 95, 369, 171, 214, 185, 293, 402, 380,
+    253, 48, 132, 60, 288, 26, 261, 261, 127, 137, 260, 159, 59, 351, 146, 245, 7, 5, 142, 364, 78, 199, 312, 200,
+    132, 319, 402, 61, 353, 167, 22, 142, 364, 277, 364, 364, 220, 344, 137, 18, 226, 98, 392, 392, 164, 207, 134, 351,
+    178, 320, 7, 312, 185, 189, 270, 325, 239, 362, 171, 22, 302, 377, 221, 348, 145, 131, 173, 165, 127, 367, 185, 183,
+    256, 256, 377, 256, 167, 348, 367, 197, 269, 32, 343, 53, 351, 296, 188, 145, 200, 38, 377, 186, 320, 407, 173, 66,
+    337, 60, 136, 144, 167, 173, 214, 392, 109, 109, 254, 359, 253, 253, 301, 150, 370, 94, 365, 102, 95, 8, 85, 391,
+    251, 66, 156, 204, 345, 104, 117, 27, 350, 200, 41, 98, 65, 356, 136, 204, 36, 141, 298, 77, 371, 38, 5, 7,
+    356, 136, 77, 175, 224, 14, 33, 66, 77, 365, 95, 285, 151, 361, 76, 132, 331, 350, 77, 136, 139, 362, 347, 204,
+    302, 2, 258, 2, 391, 65, 390, 92, 302, 177, 264, 354, 365, 136, 293, 136, 402, 365, 175, 14, 173, 350, 350, 342,
+    358, 254, 254, 385, 18, 144, 385, 168, 86, 8, 8, 167, 371, 167, 341, 72, 299, 177, 133, 124, 351, 133, 371, 390,
+    136, 344, 327, 72, 138, 38, 366, 92, 257, 386, 264, 402, 386, 74, 56, 310, 352, 402, 402, 260, 179, 402, 41, 74,
+    395, 85, 32, 115, 371, 300, 242, 370, 197, 240, 254, 386, 195, 185, 242, 245, 181, 92, 85, 357, 139, 139, 220, 406,
+    388, 365, 181, 295, 134, 371, 365, 254, 392, 84, 247, 84, 386, 159, 315, 371, 345, 132, 132, 132, 131, 274, 59, 141,
+    392, 379, 351, 327, 359, 356, 93, 165, 95, 114, 319, 65, 356, 32, 300, 161, 362, 300, 340, 204, 204, 335, 47, 345,
+    374, 11, 4, 380, 8, 137, 163, 299, 124, 85, 116, 109, 33, 357, 205, 130, 87, 260, 124, 365, 346, 352, 361, 380,
+    85, 320, 298, 142, 362, 377, 19, 353, 367, 357, 251, 390, 180, 47, 116, 197, 410, 207, 15, 356, 130, 388, 404, 300,
+    300, 371, 86, 68, 195, 220, 33, 342, 71, 2, 19, 4, 394, 183, 348, 161, 327, 34, 300, 128, 128, 357, 162, 356,
+    136, 138, 392, 138, 294, 330, 122, 361, 94, 349, 292, 350, 364, 374, 129, 114, 114, 145, 339, 348, 163, 394, 346, 37,
+    299, 21, 389, 389, 345, 339, 129, 116, 36, 339, 326, 402, 408, 394, 253, 139, 346, 293, 220, 346, 261, 254, 139, 109,
+    391, 365, 392, 3, 339, 179, 176, 33, 340, 350, 377, 86, 357, 101, 365, 347, 374, 129, 356, 204, 162, 364, 367, 302,
+    341, 302, 261, 195, 213, 134, 231, 3, 362, 47, 363, 317, 253, 205, 136, 147, 97, 343, 33, 254, 116, 361, 173, 2,
+    132, 132, 198, 377, 351, 116, 209, 207, 50, 220, 387, 129, 10, 114, 357, 44, 177, 348, 320, 139, 248, 179, 335, 346,
+    365, 132, 128, 58, 364, 364, 173, 320, 330, 350, 86, 298, 388, 116, 365, 349, 353, 298, 136, 10, 139, 361, 2, 364,
+    277, 302, 199, 359, 363, 253, 173, 36, 161, 68, 177, 361, 131, 185, 346, 275, 183, 214, 188, 186, 292, 321, 361, 395,
+    373, 373, 264, 364, 101, 364, 124, 117, 302, 26, 26, 299, 193, 29, 29, 325, 408, 24, 356, 129, 366, 259, 87, 245,
+    373, 370, 279, 244, 87, 92, 180, 86, 264, 325, 230, 327, 309, 390, 168, 168, 408, 205, 128, 340, 335, 34, 132, 254,
+    367, 404, 340, 330, 168, 169, 199, 183, 209, 64, 341, 207, 12, 384, 302, 302, 209, 395, 272, 6, 253, 77, 77, 61,
+    173, 109, 132, 141, 14, 355, 37, 49, 291, 277, 375, 265, 256, 371, 95, 345, 30, 293, 359, 84, 345, 403, 173, 353,
+    23, 55, 272, 16, 336, 65, 387, 194, 38, 365, 94, 102, 73, 173, 254, 302, 96, 327, 135, 201, 339, 166, 141, 194,
+    362, 191, 202, 310, 372, 115, 86, 11, 137, 71, 97, 363, 348, 41, 47, 237, 302, 125, 352, 40, 395, 40, 311, 8,
+    311, 132, 344, 138, 103, 132, 195, 245, 14, 340, 4, 85, 87, 365, 92, 213, 346, 124, 360, 72, 352, 390, 363, 179,
+    280, 78, 197, 388, 111, 392, 50, 374, 408, 299, 302, 379, 65, 173, 185, 134, 37, 311, 257, 88, 386, 350, 348, 157,
+    250, 319, 346, 392, 106, 350, 133, 133, 103, 10, 207, 365, 364, 364, 300, 224, 14, 77, 365, 180, 19, 220, 165, 117,
+    8, 84, 393, 58, 49, 362, 92, 7, 208, 95, 254, 268, 276, 195, 295, 311, 389, 347, 370, 298, 109, 336, 384, 213,
+    226, 369, 65, 392, 384, 30, 59, 104, 21, 141, 5, 92, 134, 6, 77, 151, 212, 395, 14, 181, 31, 293, 310, 41,
+    242, 300, 106, 384, 363, 37, 141, 300, 392, 181, 197, 173, 275, 384, 379, 16, 386, 392, 183, 71, 185, 299, 173, 167,
+    369, 302, 359, 305, 254, 390, 254, 173, 365, 349, 390, 173, 288, 105, 148, 12, 272, 350, 7, 272, 19, 403, 40, 365,
+    49, 356, 395, 134, 408, 82, 82, 370, 83, 102, 150, 169, 386, 178, 366, 362, 117, 100, 365, 300, 98, 376, 186, 92,
+    137, 120, 109, 322, 108, 341, 161, 277, 3, 3, 143, 365, 402, 157, 392, 262, 330, 286, 286, 127, 142, 141, 358, 77,
+    400, 371, 377, 0, 367, 137, 181, 386, 360, 270, 390, 60, 254, 258, 125, 109, 135, 399, 359, 317, 291, 390, 11, 329,
+    164, 139, 251, 12, 92, 280, 330, 144, 346, 168, 181, 88, 254, 342, 145, 95, 313, 176, 263, 329, 370, 197, 9, 183,
+    244, 399, 65, 357, 332, 379, 5, 104, 14, 65, 114, 403, 392, 272, 11, 101, 134, 127, 339, 233, 133, 327, 132, 350,
+    185, 130, 295, 28, 87, 311, 199, 345, 173, 173, 72, 260, 367, 317, 142, 325, 351, 163, 402, 302, 32, 84, 341, 139,
+    173, 18, 347, 90, 322, 392, 166, 175, 134, 402, 180, 173, 254, 19, 187, 50, 256, 201, 254, 254, 23, 110, 32, 62,
+    86, 238, 9, 9, 130, 404, 37, 379, 132, 173, 244, 371, 371, 104, 145, 71, 321, 96, 340, 65, 56, 84, 37, 386,
+    254, 372, 361, 371, 265, 365, 289, 272, 46, 172, 254, 402, 92, 151, 166, 405, 405, 388, 107, 87, 87, 298, 261, 220,
+    339, 111, 185, 116, 137, 365, 40, 142, 142, 37, 410, 176, 257, 392, 46, 360, 142, 11, 136, 402, 403, 18, 244, 69,
+    41, 33, 198, 125, 134, 109, 346, 73, 256, 61, 109, 66, 188, 392, 265, 205, 92, 101, 244, 293, 365, 336, 289, 77,
+    364, 92, 341, 341, 74, 133, 404, 134, 365, 298, 346, 361, 361, 44, 134, 47, 371, 117, 384, 344, 246, 14, 363, 131,
+    356, 282, 362, 165, 361, 12, 129, 162, 137, 162, 310, 88, 351, 336, 392, 134, 209, 195, 41, 124, 124, 175, 172, 329,
+    213, 371, 370, 197, 311, 357, 357, 362, 390, 246, 364, 132, 137, 364, 41, 76, 371, 405, 341, 197, 325, 132, 137, 147,
+    263, 367, 276, 128, 184, 170, 265, 349, 249, 300, 94, 320, 167, 342, 371, 36, 185, 142, 298, 41, 14, 351, 133, 365,
+    386, 92, 233, 200, 168, 275, 104, 134, 142, 318, 363, 390, 9, 291, 372, 403, 205, 313, 133, 363, 137, 128, 95, 86,
+    384, 256, 191, 316, 372, 351, 275, 300, 392, 54, 342, 329, 181, 275, 321, 266, 385, 310, 299, 318, 151, 346, 104, 254,
+    97, 97, 316, 239, 322, 98, 47, 66, 229, 132, 309, 103, 46, 257, 30, 256, 126, 197, 356, 96, 97, 402, 336, 258,
+    362, 66, 133, 148, 408, 61, 183, 18, 395, 286, 346, 132, 175, 129, 369, 256, 111, 94, 94, 333, 125, 254, 289, 54,
+    244, 370, 124, 135, 124, 127, 109, 224, 365, 97, 149, 109, 109, 26, 193, 138, 65, 399, 170, 168, 36, 50, 173, 355,
+    261, 306, 84, 330, 107, 380, 313, 171, 185, 176, 200, 184, 34, 313, 151, 41, 321, 16, 185, 141, 389, 384, 302, 387,
+    193, 207, 223, 362, 327, 244, 395, 291, 346, 265, 120, 134, 50, 132, 361, 257, 358, 367, 82, 359, 392, 258, 408, 50,
+    253, 302, 125, 162, 390, 409, 373, 293, 346, 47, 66, 83, 95, 207, 345, 258, 270, 179, 181, 258, 348, 281, 84, 386,
+    336, 169, 374, 308, 76, 37, 321, 199, 142, 37, 313, 144, 144, 66, 129, 132, 233, 349, 336, 226, 280, 395, 330, 383,
+    87, 262, 268, 120, 256, 104, 181, 169, 97, 41, 346, 299, 403, 285, 132, 72, 139, 185, 134, 41, 372, 318, 302, 135,
+    320, 179, 228, 366, 346, 129, 293, 408, 357, 37, 95, 142, 408, 365, 260, 253, 361, 171, 88, 129, 60, 132, 315, 20,
+    250, 37, 41, 396, 109, 132, 137, 133, 261, 385, 134, 257, 61, 365, 16, 311, 296, 179, 173, 30, 199, 366, 322, 319,
+    201, 254, 333, 18, 131, 132, 256, 220, 226, 365, 97, 148, 366, 229, 261, 361, 254, 200, 388, 109, 47, 132, 162, 251,
+    64, 41, 98, 201, 370, 392, 128, 256, 171, 171, 283, 185, 173, 53, 185, 203, 129, 236, 185, 392, 97, 73, 372, 173,
+    86, 402, 312, 175, 135, 41, 261, 395, 185, 361, 173, 395, 36, 137, 78, 313, 126, 224, 371, 183, 166, 136, 348, 109,
+    142, 350, 180, 367, 134, 366, 370, 367, 349, 228, 20, 32, 167, 142, 306, 296, 341, 50, 265, 264, 25, 141, 371, 188,
+    173, 53, 186, 60, 144, 361, 167, 167, 395, 171, 173, 6, 214, 371, 180, 108, 256, 49, 127, 352, 371, 365, 256, 236,
+    356, 34, 41, 254, 147, 365, 144, 346, 356, 117, 371, 162, 168, 160, 309, 346, 2, 365, 254, 42, 38, 260, 160, 148,
+    160, 148, 44, 291, 105, 366, 352, 351, 371, 256, 350, 364, 98, 345, 320, 138, 236, 124, 325, 127, 356, 243, 346, 350,
+    42, 296, 293, 114, 41, 365, 78, 371, 48, 127, 392, 391, 49, 21, 345, 254, 21, 21, 338, 142, 256, 38, 288, 38,
+    288, 393, 315, 315, 173, 380, 371, 173, 109, 58, 78, 310, 134, 389, 207, 207, 363, 207, 52, 362, 326, 299, 58, 294,
+    356, 359, 302, 24, 144, 247, 255, 263, 313, 261, 374, 175, 365, 91, 392, 364, 24, 130, 59, 132, 68, 390, 374, 342,
+    40, 18, 325, 138, 294, 366, 67, 141, 129, 53, 365, 59, 73, 135, 175, 18, 73, 134, 134, 302, 236, 74, 395, 366,
+    261, 365, 291, 258, 151, 350, 359, 66, 129, 129, 104, 258, 132, 365, 236, 129, 74, 365, 350, 345, 107, 209, 197, 197,
+    2, 137, 73, 371, 14, 14, 14, 245, 245, 14, 32, 195, 116, 23, 245, 178, 133, 386, 284, 209, 336, 359, 82, 275,
+    348, 142, 209, 116, 263, 72, 291, 320, 242, 142, 77, 54, 14, 285, 285, 195, 284, 302, 302, 336, 117, 134, 318, 285,
+    185, 209, 195, 330, 275, 33, 253, 185, 386, 287, 386, 199, 185, 264, 68, 300, 65, 204, 144, 194, 254, 248, 212, 254,
+    61, 348, 44, 87, 362, 217, 18, 92, 298, 71, 261, 254, 366, 346, 113, 362, 3, 360, 151, 261, 360, 71, 59, 185,
+    261, 362, 374, 374, 307, 307, 391, 19, 369, 60, 307, 170, 220, 335, 84, 109, 329, 392, 263, 18, 380, 201, 53, 129,
+    67, 114, 30, 402, 44, 339, 84, 57, 346, 336, 194, 263, 254, 293, 249, 114, 256, 345, 345, 359, 310, 277, 102, 135,
+    38, 345, 332, 141, 321, 392, 392, 256, 200, 104, 340, 139, 139, 280, 145, 122, 319, 265, 132, 15, 15, 95, 342, 393,
+    85, 354, 144, 124, 227, 254, 87, 356, 356, 260, 365, 344, 374, 372, 115, 361, 298, 36, 59, 370, 76, 124, 131, 254,
+    209, 230, 197, 57, 201, 200, 39, 240, 14, 291, 392, 242, 239, 400, 375, 103, 181, 197, 380, 88, 236, 173, 187, 25,
+    88, 341, 124, 207, 197, 302, 142, 375, 336, 336, 336, 117, 173, 200, 365, 83, 86, 370, 326, 392, 388, 104, 386, 361,
+    310, 161, 140, 142, 351, 263, 365, 133, 393, 265, 251, 129, 200, 12, 380, 395, 170, 370, 104, 122, 95, 83, 195, 310,
+    124, 250, 49, 84, 392, 313, 226, 37, 180, 241, 20, 254, 310, 220, 142, 283, 395, 299, 171, 357, 144, 92, 239, 204,
+    319, 362, 132, 369, 107, 13, 358, 183, 185, 59, 188, 351, 251, 380, 139, 366, 239, 137, 364, 129, 129, 376, 37, 366,
+    341, 123, 134, 362, 178, 310, 132, 82, 353, 92, 283, 288, 392, 366, 345, 346, 150, 395, 135, 188, 188, 3, 71, 325,
+    208, 171, 365, 200, 265, 138, 251, 341, 350, 351, 122, 356, 313, 161, 322, 259, 142, 82, 394, 277, 250, 359, 354, 392,
+    108, 127, 205, 131, 337, 255, 238, 345, 264, 181, 365, 133, 139, 256, 135, 136, 390, 300, 402, 27, 83, 129, 132, 181,
+    32, 130, 124, 228, 359, 138, 178, 263, 341, 389, 145, 114, 9, 194, 402, 370, 346, 20, 72, 127, 122, 365, 253, 367,
+    167, 116, 168, 114, 173, 101, 92, 345, 175, 47, 88, 365, 371, 330, 169, 113, 138, 133, 39, 140, 197, 315, 37, 242,
+    348, 298, 332, 163, 250, 224, 114, 139, 350, 296, 221, 332, 369, 350, 348, 329, 78, 313, 335, 143, 28, 325, 173, 307,
+    310, 171, 307, 322, 73, 169, 166, 175, 341, 344, 374, 127, 65, 120, 281, 134, 387, 288, 92, 107, 353, 301, 305, 360,
+    48, 387, 364, 155, 344, 114, 336, 71, 117, 344, 142, 296, 176, 130, 318, 402, 66, 259, 62, 143, 403, 346, 350, 254,
+    104, 111, 361, 179, 321, 394, 244, 116, 33, 302, 254, 85, 392, 185, 215, 142, 322, 50, 171, 389, 250, 86, 311, 326,
+    245, 59, 371, 220, 371, 185, 95, 200, 139, 180, 187, 366, 54, 264, 126, 371, 221, 298, 16, 47, 124, 372, 166, 130,
+    261, 361, 256, 326, 202, 392, 366, 20, 12, 372, 342, 282, 86, 261, 372, 151, 132, 296, 372, 288, 185, 403, 73, 365,
+    134, 201, 238, 346, 371, 372, 298, 298, 276, 127, 395, 134, 231, 371, 263, 329, 264, 73, 84, 384, 20, 344, 344, 65,
+    341, 342, 277, 351, 27, 341, 117, 96, 361, 122, 357, 200, 151, 195, 367, 361, 370, 122, 202, 299, 197, 376, 130, 212,
+    109, 38, 78, 238, 197, 175, 254, 254, 197, 326, 51, 341, 24, 333, 201, 129, 207, 356, 132, 243, 134, 134, 124, 88,
+    349, 365, 366, 386, 300, 137, 37, 128, 320, 371, 14, 204, 300, 332, 299, 369, 142, 71, 333, 136, 136, 263, 361, 321,
+    183, 131, 372, 213, 8, 370, 265, 399, 176, 32, 348, 47, 224, 403, 339, 300, 193, 367, 165, 162, 88, 134, 356, 184,
+    341, 94, 20, 367, 251, 138, 361, 321, 372, 317, 372, 175, 363, 199, 401, 37, 151, 319, 318, 337, 181, 103, 287, 205,
+    384, 300, 365, 187, 191, 253, 341, 173, 376, 345, 346, 342, 257, 380, 300, 313, 2, 260, 312, 374, 355, 366, 275, 130,
+    313, 317, 220, 318, 300, 277, 2, 239, 41, 41, 240, 343, 25, 203, 98, 66, 116, 128, 346, 403, 65, 392, 353, 92,
+    137, 125, 98, 403, 322, 324, 315, 14, 136, 129, 110, 366, 97, 183, 392, 361, 296, 193, 367, 47, 185, 167, 186, 363,
+    18, 320, 371, 355, 124, 14, 16, 392, 135, 156, 298, 294, 65, 200, 5, 185, 124, 124, 370, 32, 84, 369, 110, 193,
+    261, 371, 247, 132, 360, 34, 254, 346, 132, 185, 184, 183, 138, 111, 50, 184, 392, 94, 257, 173, 361, 26, 136, 50,
+    47, 333, 236, 324, 364, 346, 200, 321, 207, 294, 114, 175, 167, 337, 38, 95, 88, 357, 365, 193, 403, 194, 149, 188,
+    244, 302, 387, 387, 399, 356, 127, 131, 134, 361, 306, 177, 54, 325, 362, 135, 50, 367, 122, 355, 302, 107, 367, 350,
+    404, 163, 356, 175, 392, 341, 245, 371, 136, 251, 60, 129, 137, 345, 237, 132, 239, 341, 313, 256, 256, 346, 185, 346,
+    359, 76, 128, 204, 281, 313, 169, 390, 50, 365, 389, 339, 293, 320, 34, 359, 162, 364, 295, 332, 395, 283, 118, 14,
+    293, 32, 32, 302, 330, 253, 179, 341, 288, 288, 37, 140, 37, 125, 136, 169, 35, 95, 55, 122, 310, 302, 244, 114,
+    374, 181, 122, 92, 116, 117, 348, 134, 293, 346, 371, 185, 167, 226, 371, 179, 201, 379, 60, 127, 380, 351, 371, 173,
+    300, 358, 180, 339, 403, 369, 129, 24, 175, 66, 364, 5, 127, 390, 32, 193, 59, 59, 365, 315, 245, 142, 318, 260,
+    132, 402, 175, 228, 111, 138, 87, 288, 132, 315, 129, 41, 318, 311, 69, 288, 395, 166, 18, 175, 200, 300, 302, 200,
+    226, 367, 367, 199, 138, 254, 14, 132, 116, 277, 54, 344, 322, 366, 366, 75, 49, 131, 261, 167, 145, 2, 253, 402,
+    341, 18, 104, 256, 367, 18, 164, 86, 25, 196, 134, 341, 188, 377, 185, 173, 370, 362, 185, 310, 392, 367, 73, 340,
+    129, 351, 239, 298, 16, 32, 207, 181, 134, 253, 288, 37, 104, 18, 131, 348, 185, 260, 114, 367, 275, 173, 139, 350,
+    367, 315, 341, 351, 126, 358, 395, 183, 166, 75, 84, 124, 166, 302, 180, 367, 200, 132, 175, 134, 367, 87, 179, 365,
+    134, 373, 32, 58, 269, 134, 167, 84, 306, 372, 402, 88, 296, 171, 167, 50, 264, 369, 256, 83, 107, 144, 361, 116,
+    367, 283, 377, 186, 361, 173, 200, 293, 320, 60, 136, 32, 367, 116, 6, 395, 167, 167, 214, 339, 186, 359, 348, 361,
+    95, 361, 371, 131, 16, 203, 108, 64, 129, 350, 350, 129, 122, 180, 379, 398, 141, 384, 351, 38, 402, 376, 376, 24,
+    362, 254, 393, 87, 227, 140, 342, 253, 365, 185, 46, 245, 147, 239, 361, 147, 240, 209, 34, 177, 109, 149, 76, 108,
+    352, 392, 108, 108, 341, 257, 15, 57, 347, 391, 395, 151, 388, 92, 6, 351, 351, 180, 402, 357, 142, 320, 241, 140,
+    241, 319, 319, 19, 362, 330, 293, 395, 384, 66, 341, 300, 175, 38, 128, 394, 124, 309, 167, 329, 136, 356, 120, 265,
+    178, 127, 362, 355, 355, 348, 366, 345, 394, 363, 300, 341, 330, 203, 376, 147, 122, 169, 347, 395, 357, 391, 251, 361,
+    129, 108, 35, 129, 150, 142, 84, 295, 364, 129, 0, 321, 138, 271, 178, 346, 92, 140, 351, 253, 329, 402, 329, 339,
+    113, 244, 168, 361, 356, 88, 38, 275, 124, 346, 302, 117, 359, 157, 143, 350, 346, 361, 114, 399, 145, 65, 351, 132,
+    345, 361, 185, 114, 361, 127, 198, 142, 61, 11, 87, 179, 163, 130, 335, 346, 54, 345, 122, 34, 92, 344, 136, 50,
+    88, 250, 262, 282, 346, 262, 352, 34, 361, 361, 365, 144, 371, 96, 268, 245, 354, 96, 299, 33, 295, 354, 221, 101,
+    341, 36, 117, 162, 393, 74, 347, 129, 88, 175, 357, 353, 128, 136, 134, 14, 367, 395, 341, 333, 293, 346, 231, 231,
+    32, 361, 140, 140, 371, 197, 291, 341, 384, 138, 262, 276, 197, 127, 356, 388, 341, 84, 263, 315, 362, 178, 395, 137,
+    379, 105, 10, 124, 374, 213, 300, 176, 15, 103, 334, 321, 34, 293, 80, 20, 128, 351, 346, 345, 346, 374, 117, 117,
+    346, 374, 354, 212, 293, 262, 363, 359, 200, 175, 367, 345, 275, 102, 361, 257, 181, 346, 14, 16, 50, 185, 134, 302,
+    365, 184, 244, 315, 365, 324, 144, 404, 374, 124, 365, 392, 5, 341, 181, 114, 236, 271, 140, 193, 163, 294, 53, 383,
+    134, 346, 346, 346, 365, 350, 38, 128, 32, 364, 320, 268, 361, 359, 258, 145, 64, 76, 298, 136, 87, 310, 177, 371,
+    179, 330, 295, 87, 84, 361, 359, 167, 197, 321, 365, 140, 198, 139, 136, 367, 371, 365, 358, 167, 319, 379, 24, 315,
+    346, 266, 404, 175, 129, 395, 351, 180, 341, 365, 351, 388, 129, 57, 228, 167, 277, 348, 117, 359, 138, 40, 61, 363,
+    117, 167, 16, 275, 173, 207, 10, 282, 185, 165, 5, 359, 161, 309, 177, 173, 185, 144, 177, 361, 346, 351, 183, 364,
+    24, 269, 373, 167, 50, 144, 39, 107, 142, 35, 200, 321, 167, 395, 167, 180, 53, 371, 388, 388, 237, 391, 241, 37,
+    372, 2, 341, 114, 144, 144, 92, 364, 6, 68, 364, 363, 406, 306, 82, 239, 45, 151, 378, 68, 257, 369, 257, 246,
+    8, 239, 34, 134, 238, 73, 45, 371, 384, 15, 68, 9, 20, 45, 370, 370, 73, 360, 37, 227, 227, 249, 141, 208,
+    318, 209, 169, 272, 194, 85, 195, 209, 96, 345, 361, 98, 11, 310, 134, 104, 370, 98, 299, 209, 65, 256, 265, 265,
+    403, 323, 346, 194, 154, 256, 345, 104, 346, 173, 173, 252, 132, 96, 392, 12, 265, 47, 73, 142, 133, 134, 88, 246,
+    151, 142, 150, 41, 346, 11, 188, 137, 191, 285, 341, 195, 76, 330, 258, 135, 346, 173, 73, 178, 238, 247, 20, 346,
+    40, 341, 162, 40, 265, 265, 6, 84, 263, 132, 31, 402, 3, 98, 399, 108, 191, 370, 149, 20, 123, 360, 366, 127,
+    399, 374, 161, 227, 65, 161, 393, 209, 11, 245, 142, 365, 299, 241, 347, 336, 124, 180, 86, 245, 220, 363, 370, 103,
+    358, 142, 59, 20, 157, 348, 226, 127, 119, 136, 117, 388, 132, 359, 293, 318, 275, 301, 330, 169, 73, 347, 300, 159,
+    391, 371, 316, 371, 14, 194, 346, 143, 173, 347, 366, 314, 168, 11, 392, 361, 291, 173, 114, 348, 139, 238, 86, 350,
+    7, 254, 220, 16, 366, 166, 178, 134, 257, 163, 361, 111, 404, 200, 33, 365, 392, 391, 360, 199, 23, 52, 296, 178,
+    66, 188, 124, 404, 109, 341, 88, 344, 372, 353, 395, 195, 341, 44, 348, 333, 360, 215, 351, 133, 123, 15, 370, 370,
+    197, 30, 363, 316, 20, 205, 125, 372, 312, 191, 372, 58, 371, 300, 116, 257, 365, 390, 25, 116, 193, 139, 135, 207,
+    387, 32, 5, 5, 116, 54, 12, 144, 14, 14, 128, 253, 179, 356, 330, 363, 177, 309, 350, 301, 76, 136, 98, 143,
+    73, 129, 159, 348, 351, 318, 348, 359, 226, 15, 131, 229, 199, 178, 215, 108, 301, 185, 318, 348, 200, 269, 127, 215,
+    188, 348, 254, 144, 357, 202, 403, 185, 185, 371, 313, 340, 263, 93, 69, 170, 6, 132, 122, 65, 44, 95, 141, 371,
+    254, 371, 33, 191, 122, 345, 92, 342, 137, 360, 18, 15, 9, 373, 144, 198, 144, 339, 134, 197, 59, 249, 341, 127,
+    348, 257, 180, 58, 365, 3, 250, 66, 92, 357, 346, 20, 49, 103, 133, 295, 251, 49, 151, 268, 299, 298, 365, 406,
+    133, 204, 293, 181, 14, 390, 390, 144, 83, 183, 138, 136, 134, 173, 108, 348, 394, 102, 361, 355, 362, 356, 188, 313,
+    395, 260, 366, 359, 10, 82, 349, 363, 347, 115, 109, 39, 356, 8, 242, 169, 60, 367, 129, 342, 78, 37, 65, 345,
+    345, 37, 145, 197, 11, 329, 348, 41, 114, 357, 361, 263, 357, 168, 173, 355, 92, 181, 360, 346, 180, 173, 138, 175,
+    317, 317, 88, 339, 66, 249, 386, 288, 204, 371, 142, 36, 166, 204, 299, 341, 326, 41, 410, 13, 37, 124, 254, 78,
+    163, 33, 254, 13, 339, 185, 50, 107, 361, 67, 11, 179, 260, 245, 237, 266, 402, 260, 83, 138, 262, 73, 137, 130,
+    371, 195, 197, 47, 357, 325, 353, 58, 276, 204, 134, 341, 279, 127, 351, 44, 134, 398, 33, 175, 265, 347, 74, 372,
+    360, 215, 124, 367, 371, 128, 280, 288, 181, 300, 275, 317, 363, 342, 345, 390, 138, 367, 191, 322, 181, 321, 173, 168,
+    109, 390, 257, 56, 144, 388, 363, 2, 18, 302, 33, 163, 398, 50, 138, 365, 54, 50, 254, 173, 139, 317, 263, 357,
+    5, 175, 198, 387, 366, 364, 367, 341, 185, 345, 64, 355, 383, 359, 264, 60, 179, 177, 262, 313, 128, 109, 253, 139,
+    84, 138, 181, 132, 129, 139, 2, 14, 24, 264, 379, 60, 136, 110, 320, 129, 127, 288, 315, 326, 41, 371, 138, 185,
+    18, 302, 342, 408, 167, 346, 403, 357, 279, 344, 94, 171, 73, 173, 392, 276, 173, 377, 262, 325, 109, 315, 165, 183,
+    185, 173, 377, 167, 367, 200, 349, 262, 107, 61, 377, 127, 105, 20, 68, 20, 124, 392, 247, 8, 269, 173, 337, 0,
+    349, 256, 8, 243, 85, 59, 343, 236, 0, 0, 337, 124, 180, 365, 250, 49, 7, 143, 33, 38, 0, 60, 199, 21,
+    400, 250, 15, 394, 390, 0, 49, 367, 254, 348, 184, 65, 236, 199, 398, 13, 179, 383, 345, 245, 59, 343, 367, 361,
+    95, 58, 298, 326, 326, 114, 33, 299, 261, 298, 32, 32, 280, 299, 313, 298, 369, 304, 185, 92, 369, 13, 88, 226,
+    326, 370, 133, 298, 384, 66, 92, 213, 66, 250, 329, 125, 329, 390, 376, 199, 14, 14, 181, 359, 181, 33, 209, 374,
+    84, 92, 101, 326, 137, 137, 265, 341, 92, 326, 209, 77, 239, 135, 337, 57, 213, 181, 12, 390, 41, 209, 209, 27,
+    326, 94, 14, 57, 392, 189, 254, 189, 239, 365, 84, 125, 296, 371, 209, 145, 365, 181, 296, 68, 40, 125, 60, 400,
+    132, 339, 135, 37, 33, 335, 171, 132, 30, 181, 68, 333, 179, 135, 135, 40, 245, 68, 68, 245, 137, 59, 302, 302,
+    392, 365, 216, 212, 69, 14, 137, 177, 96, 98, 141, 394, 347, 293, 356, 234, 173, 362, 36, 370, 6, 137, 144, 254,
+    347, 54, 14, 365, 173, 404, 45, 88, 395, 241, 245, 95, 151, 49, 358, 392, 59, 390, 83, 392, 324, 142, 132, 86,
+    142, 293, 133, 357, 384, 19, 224, 391, 369, 139, 265, 324, 330, 365, 137, 341, 129, 320, 362, 38, 392, 119, 360, 197,
+    72, 139, 350, 330, 332, 194, 245, 350, 314, 92, 173, 392, 56, 77, 345, 291, 169, 301, 127, 348, 365, 13, 387, 107,
+    320, 86, 191, 179, 38, 132, 326, 3, 38, 14, 14, 204, 104, 75, 78, 341, 371, 54, 360, 395, 52, 59, 298, 393,
+    38, 371, 123, 88, 165, 362, 36, 332, 371, 111, 342, 127, 157, 133, 366, 365, 184, 287, 144, 38, 346, 107, 365, 342,
+    132, 45, 8, 129, 181, 31, 301, 234, 66, 57, 17, 320, 387, 16, 298, 52, 188, 365, 404, 40, 387, 385, 312, 288,
+    266, 67, 184, 184, 207, 260, 366, 367, 128, 92, 177, 183, 258, 181, 169, 348, 86, 59, 366, 117, 2, 8, 348, 107,
+    109, 228, 371, 341, 365, 369, 245, 171, 173, 302, 59, 179, 66, 179, 166, 17, 132, 38, 362, 357, 137, 391, 196, 173,
+    131, 166, 132, 66, 357, 367, 366, 264, 369, 320, 66, 188, 186, 186, 20, 20, 109, 6, 83, 64, 83, 7, 7, 259,
+    132, 379, 379, 195, 62, 237, 137, 128, 109, 49, 180, 97, 207, 132, 136, 244, 97, 2, 78, 116, 114, 14, 339, 40,
+    256, 346, 2, 350, 116, 128, 116, 380, 54, 116, 350, 364, 251, 116, 136, 2, 353, 128, 173, 247, 117, 136, 245, 95,
+    241, 394, 145, 263, 55, 266, 384, 104, 145, 145, 394, 384, 104, 388, 73, 204, 254, 367, 371, 11, 388, 393, 243, 117,
+    367, 117, 365, 20, 339, 117, 4, 386, 361, 134, 117, 371, 162, 84, 94, 61, 239, 92, 263, 299, 61, 185, 386, 199,
+    173, 138, 356, 134, 239, 107, 3, 185, 356, 394, 60, 3, 104, 173, 209, 69, 95, 356, 194, 340, 392, 254, 372, 326,
+    349, 76, 352, 346, 239, 88, 76, 204, 205, 299, 300, 374, 201, 239, 85, 202, 59, 197, 195, 148, 348, 156, 300, 362,
+    391, 363, 298, 131, 57, 390, 161, 142, 298, 365, 299, 197, 207, 395, 390, 390, 201, 300, 372, 68, 220, 403, 403, 34,
+    384, 357, 19, 200, 183, 315, 330, 200, 68, 65, 216, 205, 357, 38, 161, 143, 208, 390, 327, 362, 361, 207, 393, 207,
+    389, 391, 197, 317, 295, 114, 127, 65, 37, 56, 143, 78, 193, 348, 346, 163, 166, 134, 293, 326, 110, 339, 172, 300,
+    262, 178, 360, 139, 391, 173, 166, 315, 143, 307, 315, 73, 14, 245, 209, 130, 220, 185, 365, 137, 23, 394, 371, 130,
+    191, 347, 353, 129, 110, 376, 47, 134, 197, 73, 123, 357, 326, 162, 97, 280, 195, 356, 83, 344, 202, 40, 162, 200,
+    343, 156, 60, 36, 151, 312, 347, 262, 207, 205, 193, 307, 380, 387, 365, 67, 156, 207, 308, 50, 184, 38, 193, 247,
+    37, 109, 199, 339, 281, 248, 346, 258, 253, 395, 64, 298, 308, 177, 35, 348, 148, 364, 356, 330, 208, 179, 109, 134,
+    364, 2, 129, 386, 134, 104, 388, 264, 197, 40, 287, 226, 359, 363, 131, 199, 201, 249, 201, 171, 161, 144, 357, 201,
+    131, 185, 199, 183, 107, 193, 346, 41, 321, 148, 395, 195, 138, 138, 371, 309, 380, 144, 300, 365, 298, 392, 123, 298,
+    367, 142, 394, 136, 56, 74, 2, 136, 383, 373, 6, 300, 69, 254, 132, 403, 95, 345, 389, 157, 96, 346, 84, 161,
+    60, 191, 291, 59, 144, 173, 92, 204, 78, 131, 149, 392, 254, 148, 137, 18, 78, 360, 245, 389, 361, 315, 398, 35,
+    76, 337, 361, 138, 88, 83, 207, 384, 142, 371, 151, 336, 336, 65, 385, 390, 78, 92, 209, 395, 165, 15, 230, 250,
+    244, 180, 241, 170, 251, 20, 251, 298, 375, 2, 173, 183, 330, 369, 173, 161, 41, 154, 265, 395, 161, 109, 78, 215,
+    255, 185, 341, 2, 98, 348, 353, 361, 71, 244, 346, 169, 122, 309, 347, 258, 261, 341, 258, 365, 154, 350, 266, 32,
+    168, 122, 371, 350, 347, 194, 188, 369, 35, 35, 344, 181, 367, 194, 266, 361, 291, 163, 371, 38, 125, 185, 36, 134,
+    234, 311, 402, 154, 244, 361, 400, 155, 37, 254, 404, 261, 179, 145, 20, 69, 204, 67, 134, 117, 185, 2, 315, 266,
+    172, 11, 366, 75, 345, 254, 187, 339, 66, 215, 11, 254, 36, 279, 361, 68, 69, 73, 336, 137, 367, 15, 151, 14,
+    341, 309, 390, 74, 347, 60, 325, 215, 244, 134, 65, 320, 30, 326, 254, 76, 88, 357, 266, 266, 191, 102, 221, 313,
+    78, 49, 181, 310, 321, 9, 125, 245, 341, 286, 171, 56, 326, 347, 346, 175, 239, 341, 374, 75, 389, 151, 165, 398,
+    363, 110, 398, 32, 254, 5, 244, 181, 185, 148, 45, 36, 366, 171, 16, 254, 207, 254, 54, 404, 261, 48, 187, 132,
+    293, 169, 264, 383, 64, 134, 346, 179, 69, 320, 128, 239, 375, 258, 65, 173, 134, 136, 346, 387, 258, 76, 134, 371,
+    400, 117, 151, 380, 171, 137, 41, 364, 266, 60, 365, 135, 245, 245, 371, 249, 78, 2, 151, 134, 371, 279, 199, 241,
+    49, 20, 362, 191, 22, 348, 161, 171, 171, 392, 173, 173, 84, 266, 241, 367, 173, 183, 183, 207, 20, 306, 107, 167,
+    22, 361, 300, 300, 173, 273, 296, 373, 310, 254, 318, 191, 351, 363, 348, 254, 254, 392, 13, 75, 393, 272, 365, 300,
+    370, 392, 327, 92, 92, 200, 406, 392, 314, 197, 410, 264, 124, 395, 298, 315, 49, 31, 200, 185, 371, 349, 345, 327,
+    247, 395, 109, 347, 392, 132, 97, 390, 97, 307, 138, 298, 94, 163, 65, 61, 131, 322, 254, 104, 107, 408, 180, 185,
+    19, 138, 61, 392, 185, 32, 14, 389, 129, 370, 346, 366, 403, 131, 390, 92, 372, 345, 348, 362, 392, 365, 197, 310,
+    65, 11, 402, 390, 369, 132, 97, 321, 310, 191, 318, 92, 357, 254, 371, 346, 132, 310, 32, 59, 109, 315, 173, 228,
+    200, 61, 173, 269, 373, 325, 377, 171, 276, 371, 371, 173, 351, 260, 117, 332, 355, 310, 272, 332, 403, 30, 95, 365,
+    348, 19, 221, 263, 263, 393, 87, 116, 374, 151, 202, 392, 139, 14, 392, 371, 200, 157, 8, 245, 220, 173, 370, 406,
+    245, 20, 180, 207, 37, 221, 260, 362, 410, 392, 392, 302, 142, 403, 131, 132, 37, 330, 392, 131, 117, 366, 403, 392,
+    137, 272, 73, 365, 395, 129, 228, 92, 346, 97, 168, 92, 359, 307, 185, 163, 95, 139, 325, 37, 332, 295, 307, 360,
+    187, 185, 104, 410, 272, 401, 9, 7, 132, 392, 392, 163, 172, 244, 151, 19, 40, 408, 371, 313, 189, 349, 365, 346,
+    15, 132, 92, 245, 233, 137, 393, 404, 356, 37, 61, 342, 348, 403, 371, 132, 356, 390, 392, 61, 133, 132, 97, 97,
+    104, 275, 315, 275, 132, 149, 209, 24, 197, 392, 132, 185, 313, 132, 367, 342, 263, 288, 117, 365, 128, 259, 132, 315,
+    350, 253, 136, 402, 393, 408, 185, 315, 228, 288, 129, 269, 233, 371, 249, 132, 334, 342, 37, 131, 161, 185, 16, 288,
+    269, 402, 173, 53, 358, 337, 141, 262, 346, 262, 155, 371, 298, 139, 363, 44, 401, 332, 169, 259, 385, 363, 15, 10,
+    363, 19, 337, 395, 136, 258, 67, 345, 109, 363, 392, 45, 363, 327, 136, 45, 140, 350, 37, 156, 53, 344, 59, 157,
+    151, 402, 356, 313, 107, 162, 72, 402, 359, 344, 337, 360, 371, 142, 262, 363, 363, 327, 34, 371, 326, 67, 142, 177,
+    346, 345, 162, 45, 388, 160, 160, 183, 37, 54, 177, 379, 53, 258, 262, 72, 379, 183, 259, 173, 41, 300, 92, 256,
+    41, 122, 254, 116, 299, 87, 302, 202, 264, 386, 395, 180, 183, 19, 139, 139, 387, 7, 310, 145, 122, 330, 311, 139,
+    67, 365, 302, 139, 264, 137, 250, 74, 173, 398, 29, 64, 55, 338, 139, 148, 139, 395, 395, 170, 244, 371, 38, 95,
+    194, 395, 339, 73, 132, 136, 6, 314, 132, 260, 388, 316, 360, 400, 372, 124, 115, 350, 28, 14, 14, 134, 365, 71,
+    293, 299, 57, 65, 395, 211, 38, 104, 173, 259, 204, 10, 327, 310, 92, 27, 12, 83, 57, 403, 65, 180, 380, 230,
+    92, 103, 84, 133, 95, 84, 300, 195, 251, 325, 134, 262, 183, 204, 15, 188, 109, 264, 38, 366, 363, 348, 14, 262,
+    164, 64, 350, 138, 265, 316, 277, 83, 161, 395, 330, 132, 57, 115, 27, 393, 156, 166, 14, 292, 60, 391, 27, 92,
+    374, 332, 237, 173, 168, 142, 107, 134, 114, 330, 347, 392, 37, 314, 300, 395, 410, 350, 295, 329, 27, 361, 97, 159,
+    95, 40, 161, 96, 374, 236, 256, 350, 134, 252, 166, 405, 14, 14, 14, 98, 319, 106, 371, 134, 61, 104, 38, 391,
+    261, 291, 394, 185, 20, 132, 179, 314, 145, 92, 384, 104, 155, 256, 256, 145, 46, 107, 372, 27, 406, 20, 380, 259,
+    336, 188, 59, 350, 282, 134, 357, 15, 316, 349, 348, 250, 390, 353, 124, 365, 395, 373, 47, 185, 345, 71, 309, 132,
+    137, 128, 353, 197, 84, 44, 398, 246, 88, 395, 128, 259, 123, 263, 202, 256, 104, 162, 300, 184, 374, 117, 321, 373,
+    40, 97, 86, 282, 391, 103, 224, 256, 350, 53, 183, 244, 73, 173, 14, 402, 41, 292, 38, 395, 257, 183, 167, 134,
+    21, 173, 129, 14, 65, 50, 361, 244, 24, 398, 245, 247, 72, 371, 203, 333, 380, 292, 109, 365, 124, 32, 156, 52,
+    250, 379, 132, 109, 313, 184, 27, 185, 221, 317, 53, 67, 317, 170, 74, 176, 350, 20, 200, 292, 60, 177, 59, 66,
+    92, 134, 204, 162, 58, 136, 64, 128, 316, 169, 377, 350, 185, 300, 377, 254, 238, 254, 238, 95, 142, 185, 185, 361,
+    20, 60, 284, 396, 103, 256, 175, 21, 394, 166, 300, 167, 162, 371, 373, 116, 390, 319, 325, 224, 40, 132, 365, 254,
+    324, 398, 394, 84, 312, 394, 256, 402, 324, 185, 185, 134, 336, 367, 371, 166, 183, 259, 175, 167, 256, 373, 393, 264,
+    175, 15, 74, 407, 173, 310, 188, 367, 373, 402, 371, 200, 65, 84, 298, 389, 298, 230, 117, 171, 348, 403, 220, 55,
+    387, 256, 385, 14, 8, 345, 291, 149, 276, 87, 14, 54, 366, 389, 200, 319, 124, 6, 173, 95, 142, 251, 207, 52,
+    386, 394, 38, 313, 327, 173, 346, 313, 122, 330, 403, 27, 373, 394, 179, 399, 7, 169, 87, 82, 264, 117, 176, 348,
+    92, 176, 24, 139, 173, 373, 185, 142, 254, 54, 7, 387, 179, 404, 139, 111, 125, 285, 285, 321, 15, 276, 201, 123,
+    356, 404, 124, 134, 377, 49, 173, 351, 92, 233, 11, 104, 355, 97, 321, 263, 133, 26, 399, 321, 200, 285, 87, 379,
+    149, 135, 207, 285, 285, 233, 346, 176, 135, 159, 20, 127, 302, 404, 348, 233, 333, 224, 173, 410, 65, 224, 327, 167,
+    200, 310, 141, 346, 102, 391, 141, 370, 132, 30, 394, 359, 373, 122, 371, 117, 339, 272, 342, 342, 263, 211, 403, 331,
+    227, 91, 132, 302, 47, 245, 390, 291, 122, 392, 132, 87, 374, 272, 59, 138, 313, 85, 317, 54, 141, 375, 6, 138,
+    92, 392, 254, 403, 40, 122, 375, 171, 346, 92, 351, 298, 20, 395, 264, 180, 395, 295, 95, 362, 92, 336, 390, 58,
+    41, 300, 393, 348, 406, 140, 8, 264, 207, 302, 408, 161, 139, 272, 115, 351, 137, 395, 40, 105, 7, 144, 161, 124,
+    49, 127, 101, 322, 137, 157, 136, 265, 94, 188, 357, 13, 348, 92, 99, 71, 275, 327, 366, 171, 351, 143, 356, 94,
+    68, 330, 310, 135, 349, 129, 144, 392, 134, 143, 38, 201, 390, 185, 37, 263, 302, 9, 330, 350, 127, 260, 101, 355,
+    325, 331, 351, 122, 346, 92, 329, 315, 75, 163, 92, 139, 124, 392, 361, 140, 88, 132, 356, 272, 404, 36, 77, 173,
+    185, 176, 40, 265, 295, 254, 254, 401, 254, 339, 256, 348, 301, 341, 254, 322, 339, 96, 340, 13, 400, 23, 111, 54,
+    187, 181, 254, 386, 14, 48, 180, 201, 254, 259, 326, 404, 110, 405, 346, 403, 353, 176, 138, 86, 280, 204, 371, 404,
+    84, 185, 356, 367, 294, 254, 356, 349, 134, 151, 348, 279, 201, 132, 74, 39, 65, 204, 202, 372, 351, 10, 310, 263,
+    15, 127, 101, 50, 201, 341, 92, 341, 331, 103, 202, 351, 175, 404, 15, 374, 366, 325, 105, 392, 374, 37, 32, 58,
+    347, 372, 404, 356, 299, 341, 101, 357, 367, 138, 365, 400, 220, 9, 104, 239, 394, 134, 49, 265, 306, 374, 347, 54,
+    346, 275, 322, 92, 374, 36, 97, 277, 124, 376, 324, 348, 313, 390, 404, 322, 128, 23, 14, 88, 52, 173, 317, 361,
+    346, 404, 171, 143, 256, 193, 392, 185, 209, 247, 175, 200, 357, 404, 132, 293, 315, 84, 185, 13, 365, 287, 208, 363,
+    257, 130, 348, 132, 291, 355, 268, 357, 315, 258, 383, 410, 392, 293, 285, 179, 371, 84, 177, 48, 409, 134, 270, 32,
+    280, 355, 129, 125, 407, 346, 257, 374, 57, 299, 129, 346, 288, 134, 135, 127, 379, 50, 351, 136, 14, 59, 365, 228,
+    315, 365, 292, 356, 132, 18, 256, 167, 253, 359, 407, 254, 244, 363, 207, 171, 351, 407, 161, 370, 356, 171, 348, 32,
+    136, 185, 32, 367, 23, 269, 348, 408, 407, 188, 173, 61, 167, 171, 175, 310, 141, 371, 122, 394, 348, 98, 373, 132,
+    339, 161, 132, 272, 341, 374, 122, 47, 245, 291, 96, 211, 272, 404, 187, 87, 392, 342, 85, 395, 390, 227, 302, 348,
+    95, 351, 92, 175, 406, 298, 346, 392, 393, 394, 8, 92, 41, 295, 365, 139, 58, 9, 275, 137, 157, 270, 68, 115,
+    129, 99, 357, 135, 188, 144, 136, 330, 101, 350, 143, 355, 346, 315, 322, 132, 325, 132, 356, 180, 367, 356, 254, 86,
+    48, 294, 110, 299, 341, 201, 301, 13, 40, 322, 181, 265, 404, 386, 339, 185, 400, 403, 151, 349, 134, 201, 167, 325,
+    202, 132, 374, 129, 310, 77, 74, 15, 348, 103, 400, 127, 65, 185, 15, 204, 372, 138, 92, 277, 390, 88, 54, 97,
+    32, 173, 365, 134, 18, 247, 193, 171, 367, 317, 208, 287, 351, 177, 293, 383, 135, 256, 258, 127, 136, 407, 91, 351,
+    96, 91, 266, 91, 254, 20, 250, 349, 388, 96, 367, 367, 261, 347, 107, 409, 320, 37, 254, 343, 367, 171, 320, 185,
+    107, 340, 340, 96, 340, 114, 188, 188, 92, 298, 83, 104, 395, 142, 195, 104, 204, 96, 6, 105, 325, 143, 92, 298,
+    361, 388, 408, 105, 402, 371, 392, 3, 83, 167, 302, 310, 245, 191, 181, 6, 83, 173, 34, 341, 14, 132, 383, 39,
+    181, 132, 143, 200, 388, 188, 245, 132, 132, 186, 362, 200, 257, 57, 197, 362, 370, 370, 87, 6, 97, 362, 104, 257,
+    378, 97, 180, 365, 395, 65, 355, 257, 365, 348, 275, 267, 267, 257, 127, 317, 348, 365, 362, 257, 256, 371, 101, 137,
+    321, 372, 346, 84, 293, 87, 293, 175, 171, 101, 229, 257, 32, 371, 102, 365, 39, 343, 87, 122, 38, 38, 54, 92,
+    347, 12, 365, 165, 365, 245, 180, 181, 392, 264, 346, 351, 349, 346, 346, 151, 258, 129, 129, 350, 291, 122, 135, 65,
+    54, 86, 61, 291, 38, 395, 134, 357, 38, 246, 404, 339, 129, 123, 117, 117, 114, 5, 247, 365, 175, 123, 5, 179,
+    243, 258, 5, 84, 365, 129, 357, 61, 363, 169, 169, 150, 195, 389, 254, 103, 103, 103, 68, 68, 82, 303, 279, 212,
+    212, 74, 171, 329, 403, 101, 34, 116, 374, 6, 245, 365, 310, 264, 133, 142, 131, 41, 169, 187, 132, 321, 236, 184,
+    229, 135, 240, 384, 184, 132, 169, 131, 370, 207, 126, 82, 365, 69, 364, 57, 311, 260, 374, 38, 59, 59, 122, 101,
+    392, 239, 224, 59, 390, 35, 180, 391, 370, 337, 177, 183, 392, 226, 327, 82, 360, 328, 105, 356, 175, 116, 299, 178,
+    249, 139, 142, 14, 65, 111, 342, 356, 250, 50, 69, 220, 329, 142, 50, 162, 175, 162, 50, 175, 343, 162, 175, 175,
+    50, 5, 299, 311, 329, 162, 224, 392, 59, 226, 259, 220, 329, 329, 183, 371, 371, 388, 310, 313, 365, 313, 310, 388,
+    388, 276, 365, 170, 132, 263, 153, 26, 98, 20, 127, 128, 38, 272, 350, 277, 394, 372, 73, 96, 275, 95, 30, 344,
+    33, 104, 392, 114, 92, 86, 87, 242, 240, 134, 85, 401, 370, 211, 4, 153, 268, 102, 371, 342, 363, 254, 245, 256,
+    346, 346, 86, 153, 139, 319, 298, 393, 387, 351, 298, 341, 394, 68, 59, 86, 6, 20, 264, 326, 11, 105, 319, 403,
+    86, 392, 220, 250, 403, 92, 240, 390, 348, 410, 242, 133, 299, 392, 10, 209, 264, 124, 151, 38, 366, 356, 362, 183,
+    71, 146, 185, 139, 230, 361, 240, 158, 365, 108, 113, 98, 71, 38, 136, 354, 354, 82, 3, 120, 246, 219, 403, 109,
+    37, 327, 392, 54, 197, 351, 54, 351, 192, 192, 132, 351, 225, 159, 283, 378, 254, 215, 200, 228, 186, 339, 20, 342,
+    339, 355, 136, 139, 370, 120, 56, 178, 293, 329, 197, 47, 298, 256, 62, 143, 52, 355, 352, 336, 241, 37, 217, 253,
+    72, 336, 223, 215, 245, 104, 188, 173, 175, 387, 54, 137, 176, 307, 245, 16, 187, 246, 171, 162, 46, 59, 326, 217,
+    139, 212, 165, 364, 361, 272, 298, 48, 92, 92, 142, 86, 257, 339, 71, 245, 111, 404, 69, 344, 197, 220, 398, 38,
+    51, 188, 236, 65, 3, 353, 215, 302, 305, 213, 374, 393, 276, 78, 284, 332, 363, 134, 341, 136, 371, 133, 74, 14,
+    33, 92, 348, 220, 201, 337, 324, 334, 9, 256, 185, 337, 301, 321, 313, 400, 98, 365, 20, 177, 132, 245, 351, 97,
+    185, 18, 236, 33, 185, 111, 240, 43, 16, 135, 92, 321, 207, 346, 398, 185, 136, 367, 185, 392, 358, 55, 179, 330,
+    244, 220, 43, 177, 54, 109, 350, 324, 84, 392, 136, 293, 124, 54, 281, 349, 315, 87, 367, 293, 396, 59, 159, 228,
+    335, 175, 14, 369, 144, 41, 365, 143, 165, 175, 287, 335, 104, 254, 54, 18, 359, 215, 344, 378, 348, 16, 353, 160,
+    165, 361, 185, 131, 375, 188, 264, 378, 186, 220, 375, 36, 256, 344, 108, 378, 179, 108, 403, 136, 224, 40, 132, 97,
+    40, 201, 224, 392, 392, 98, 134, 68, 392, 355, 319, 390, 141, 348, 371, 30, 363, 371, 39, 346, 346, 141, 371, 371,
+    353, 142, 141, 352, 296, 296, 296, 141, 300, 320, 302, 300, 326, 320, 253, 253, 107, 125, 326, 44, 308, 347, 345, 394,
+    61, 44, 293, 365, 84, 237, 319, 84, 8, 44, 115, 85, 8, 14, 185, 393, 134, 25, 180, 395, 380, 77, 20, 348,
+    98, 44, 347, 185, 262, 240, 346, 158, 92, 379, 88, 173, 295, 371, 168, 329, 371, 341, 20, 199, 221, 142, 128, 301,
+    151, 15, 209, 68, 61, 9, 30, 365, 312, 25, 26, 184, 58, 358, 363, 39, 64, 60, 257, 185, 365, 132, 134, 131,
+    199, 254, 185, 185, 32, 306, 100, 176, 134, 134, 288, 361, 92, 250, 361, 361, 26, 26, 365, 170, 329, 136, 2, 212,
+    327, 136, 137, 244, 339, 365, 31, 201, 200, 95, 256, 371, 371, 295, 262, 73, 124, 254, 194, 403, 129, 315, 392, 349,
+    245, 92, 335, 341, 345, 392, 254, 293, 342, 256, 272, 92, 156, 137, 185, 356, 132, 260, 254, 361, 87, 6, 280, 352,
+    132, 125, 125, 85, 345, 144, 103, 392, 374, 260, 5, 41, 195, 360, 86, 273, 115, 50, 366, 370, 15, 365, 259, 341,
+    173, 245, 78, 348, 33, 25, 395, 313, 325, 372, 268, 180, 319, 295, 65, 202, 261, 173, 369, 151, 209, 11, 10, 103,
+    204, 365, 365, 142, 248, 282, 157, 226, 220, 20, 19, 293, 355, 363, 348, 12, 122, 367, 384, 71, 142, 68, 224, 95,
+    124, 250, 197, 92, 299, 104, 14, 341, 92, 402, 195, 84, 133, 195, 195, 6, 49, 207, 403, 392, 38, 132, 139, 183,
+    50, 223, 372, 358, 367, 262, 98, 205, 173, 275, 366, 100, 256, 31, 36, 371, 116, 403, 178, 345, 132, 109, 49, 134,
+    49, 103, 108, 194, 30, 136, 136, 92, 371, 395, 403, 135, 129, 366, 30, 83, 275, 277, 39, 194, 330, 393, 256, 395,
+    359, 127, 92, 265, 94, 57, 139, 353, 44, 26, 139, 82, 3, 258, 38, 272, 134, 325, 128, 250, 173, 138, 169, 302,
+    399, 57, 133, 270, 14, 27, 258, 129, 132, 60, 403, 275, 130, 353, 188, 367, 359, 138, 316, 366, 192, 122, 394, 363,
+    73, 341, 173, 72, 92, 272, 366, 117, 14, 21, 374, 65, 332, 315, 315, 37, 36, 345, 17, 346, 101, 173, 253, 395,
+    207, 173, 399, 410, 336, 263, 291, 317, 36, 244, 142, 197, 199, 353, 139, 35, 298, 145, 361, 329, 370, 56, 107, 114,
+    370, 56, 133, 340, 313, 227, 295, 348, 168, 92, 78, 207, 342, 137, 213, 209, 148, 166, 175, 300, 344, 332, 348, 131,
+    370, 367, 367, 102, 47, 194, 194, 49, 339, 139, 65, 264, 71, 134, 405, 104, 165, 185, 142, 341, 145, 224, 163, 117,
+    253, 376, 97, 111, 92, 187, 33, 40, 311, 46, 386, 198, 23, 6, 173, 332, 20, 114, 10, 260, 143, 346, 260, 65,
+    137, 253, 60, 138, 258, 319, 101, 125, 104, 180, 86, 260, 3, 340, 13, 394, 361, 142, 134, 179, 320, 302, 326, 61,
+    124, 254, 117, 54, 322, 47, 14, 33, 127, 86, 166, 254, 199, 250, 341, 59, 291, 127, 361, 365, 327, 254, 339, 27,
+    212, 390, 336, 141, 328, 188, 14, 365, 239, 20, 241, 69, 367, 367, 367, 350, 283, 263, 151, 349, 339, 371, 371, 92,
+    175, 357, 357, 213, 27, 344, 47, 350, 371, 15, 195, 3, 78, 188, 367, 164, 164, 135, 201, 410, 410, 406, 10, 276,
+    346, 364, 3, 264, 134, 92, 185, 139, 243, 88, 122, 122, 123, 361, 332, 389, 403, 349, 272, 98, 255, 261, 200, 128,
+    298, 253, 94, 71, 394, 134, 341, 20, 341, 237, 132, 124, 378, 133, 74, 363, 315, 50, 265, 341, 390, 162, 329, 130,
+    346, 300, 254, 167, 404, 363, 372, 197, 374, 302, 65, 398, 107, 268, 358, 32, 147, 162, 125, 135, 184, 341, 238, 370,
+    312, 366, 300, 47, 300, 374, 390, 168, 277, 199, 173, 266, 314, 372, 173, 142, 346, 9, 41, 356, 332, 181, 131, 66,
+    256, 406, 251, 56, 372, 41, 371, 159, 239, 253, 253, 211, 309, 346, 87, 374, 391, 134, 132, 282, 25, 80, 200, 116,
+    316, 390, 205, 312, 356, 181, 346, 104, 168, 275, 343, 94, 56, 300, 321, 188, 277, 317, 357, 11, 363, 109, 14, 404,
+    110, 410, 327, 27, 242, 167, 59, 132, 173, 298, 168, 371, 180, 367, 207, 67, 327, 195, 330, 41, 244, 3, 175, 50,
+    346, 250, 263, 138, 47, 137, 341, 334, 26, 371, 365, 403, 177, 14, 185, 356, 21, 387, 171, 257, 193, 361, 180, 132,
+    16, 110, 114, 65, 313, 185, 296, 294, 65, 203, 359, 193, 20, 65, 56, 389, 298, 357, 341, 124, 5, 200, 184, 52,
+    393, 23, 251, 135, 200, 50, 223, 129, 143, 366, 134, 221, 302, 366, 111, 36, 124, 291, 156, 256, 191, 378, 380, 257,
+    72, 175, 179, 156, 2, 14, 173, 341, 132, 256, 299, 84, 199, 236, 32, 66, 359, 136, 280, 280, 171, 371, 258, 41,
+    125, 134, 192, 374, 10, 370, 264, 185, 270, 129, 78, 325, 86, 144, 408, 83, 277, 87, 162, 308, 280, 360, 356, 92,
+    144, 60, 345, 71, 310, 350, 346, 183, 342, 295, 254, 134, 374, 316, 180, 371, 347, 343, 132, 122, 310, 228, 171, 357,
+    374, 371, 346, 116, 10, 116, 2, 341, 129, 129, 132, 49, 349, 339, 203, 365, 172, 135, 24, 298, 257, 175, 151, 372,
+    57, 325, 321, 358, 14, 386, 316, 348, 84, 69, 351, 104, 351, 302, 134, 116, 122, 283, 352, 359, 363, 7, 312, 302,
+    359, 75, 249, 341, 226, 40, 192, 277, 247, 319, 132, 379, 36, 390, 82, 220, 367, 97, 50, 350, 254, 83, 134, 356,
+    162, 132, 15, 67, 200, 167, 138, 25, 202, 262, 259, 348, 177, 236, 348, 313, 185, 365, 356, 351, 173, 365, 165, 171,
+    136, 65, 392, 11, 324, 363, 207, 127, 16, 84, 312, 320, 334, 262, 258, 341, 181, 129, 236, 97, 374, 10, 173, 302,
+    41, 2, 179, 379, 357, 260, 166, 131, 336, 345, 280, 280, 254, 120, 185, 313, 334, 199, 374, 250, 371, 359, 132, 140,
+    357, 207, 263, 313, 140, 244, 224, 20, 269, 365, 348, 371, 142, 175, 175, 366, 257, 367, 183, 331, 125, 373, 180, 264,
+    363, 84, 197, 114, 162, 167, 132, 60, 193, 171, 171, 129, 88, 392, 341, 162, 386, 126, 173, 132, 200, 171, 126, 188,
+    132, 162, 185, 134, 283, 324, 171, 265, 350, 365, 186, 198, 17, 124, 124, 185, 234, 185, 310, 350, 256, 41, 124, 356,
+    56, 92, 356, 356, 185, 124, 371, 116, 136, 142, 111, 10, 361, 386, 386, 162, 18, 346, 302, 39, 263, 67, 132, 263,
+    69, 300, 347, 144, 389, 296, 371, 114, 403, 122, 129, 199, 98, 315, 347, 31, 300, 365, 191, 349, 85, 78, 6, 38,
+    256, 342, 342, 280, 9, 245, 373, 373, 145, 254, 330, 366, 254, 24, 372, 144, 129, 260, 254, 393, 360, 116, 209, 340,
+    87, 87, 115, 102, 379, 92, 268, 137, 92, 38, 72, 10, 348, 220, 58, 263, 370, 384, 250, 38, 370, 117, 114, 142,
+    173, 92, 268, 384, 103, 245, 245, 348, 395, 67, 17, 19, 104, 386, 264, 296, 328, 180, 104, 59, 104, 367, 173, 37,
+    264, 208, 98, 49, 129, 129, 194, 92, 362, 337, 178, 395, 365, 348, 164, 136, 173, 365, 250, 254, 112, 296, 365, 340,
+    207, 262, 259, 109, 262, 392, 193, 169, 389, 133, 215, 310, 254, 353, 137, 263, 295, 369, 133, 334, 35, 11, 78, 114,
+    302, 357, 88, 298, 298, 92, 348, 389, 345, 92, 173, 168, 14, 41, 372, 370, 137, 59, 361, 329, 66, 334, 129, 344,
+    392, 311, 86, 142, 200, 254, 254, 371, 145, 165, 199, 257, 310, 346, 187, 173, 68, 327, 322, 163, 114, 114, 371, 9,
+    86, 245, 341, 76, 365, 372, 317, 265, 256, 280, 220, 261, 341, 176, 111, 339, 71, 78, 8, 65, 340, 24, 362, 367,
+    111, 32, 69, 165, 151, 137, 351, 329, 195, 356, 201, 371, 137, 300, 357, 128, 361, 15, 276, 341, 92, 372, 197, 341,
+    92, 277, 351, 370, 263, 195, 347, 367, 300, 39, 321, 395, 404, 325, 92, 372, 162, 199, 165, 73, 124, 263, 68, 173,
+    344, 374, 264, 213, 184, 47, 275, 367, 135, 8, 168, 240, 310, 346, 49, 346, 372, 343, 175, 312, 8, 275, 275, 132,
+    345, 355, 114, 260, 365, 14, 125, 321, 365, 73, 212, 117, 124, 109, 191, 205, 365, 342, 367, 323, 393, 25, 287, 254,
+    193, 327, 294, 300, 26, 38, 65, 5, 185, 341, 392, 321, 36, 247, 264, 245, 371, 134, 188, 184, 260, 393, 366, 135,
+    304, 342, 350, 339, 389, 389, 191, 191, 111, 181, 195, 346, 50, 173, 193, 350, 33, 387, 194, 349, 207, 408, 310, 263,
+    323, 392, 244, 244, 136, 264, 17, 177, 239, 109, 346, 132, 398, 128, 86, 169, 144, 144, 129, 366, 32, 136, 293, 215,
+    350, 345, 39, 359, 310, 41, 37, 60, 173, 351, 293, 365, 139, 57, 32, 254, 49, 349, 296, 188, 260, 367, 31, 173,
+    381, 357, 175, 395, 380, 351, 194, 351, 254, 275, 134, 199, 116, 277, 131, 402, 137, 249, 117, 203, 84, 171, 137, 165,
+    204, 173, 47, 173, 263, 224, 185, 73, 350, 395, 183, 173, 183, 88, 364, 245, 214, 104, 143, 367, 302, 346, 24, 264,
+    265, 73, 24, 193, 264, 137, 395, 402, 358, 128, 230, 242, 230, 352, 393, 192, 82, 146, 203, 346, 353, 361, 148, 372,
+    264, 180, 357, 302, 348, 330, 349, 137, 348, 360, 124, 341, 61, 39, 341, 61, 401, 120, 264, 365, 365, 21, 95, 371,
+    16, 30, 365, 293, 36, 92, 110, 87, 304, 137, 211, 393, 59, 365, 393, 393, 137, 392, 351, 268, 392, 272, 260, 138,
+    145, 372, 197, 31, 5, 223, 129, 268, 133, 336, 180, 58, 10, 241, 363, 410, 14, 295, 320, 142, 117, 358, 355, 390,
+    365, 237, 20, 65, 337, 92, 110, 392, 392, 268, 239, 365, 195, 336, 211, 103, 357, 389, 264, 11, 371, 346, 200, 20,
+    20, 92, 38, 38, 157, 272, 135, 255, 134, 20, 137, 82, 98, 277, 395, 109, 366, 23, 178, 146, 353, 399, 60, 356,
+    163, 153, 223, 302, 133, 163, 37, 173, 143, 298, 252, 98, 365, 371, 390, 181, 263, 267, 132, 365, 21, 399, 307, 291,
+    267, 173, 175, 175, 157, 134, 91, 32, 14, 163, 322, 372, 180, 38, 33, 40, 77, 16, 176, 294, 242, 242, 86, 372,
+    188, 111, 361, 73, 325, 392, 142, 365, 254, 111, 105, 153, 254, 325, 325, 92, 39, 351, 15, 68, 163, 74, 355, 355,
+    117, 372, 10, 10, 92, 371, 333, 361, 129, 11, 41, 185, 241, 59, 374, 318, 103, 57, 126, 275, 372, 277, 212, 140,
+    317, 8, 334, 38, 286, 223, 367, 137, 256, 126, 157, 175, 167, 173, 389, 300, 185, 365, 68, 351, 348, 341, 16, 26,
+    132, 257, 289, 10, 349, 14, 92, 134, 398, 134, 54, 132, 59, 375, 84, 20, 349, 352, 17, 270, 193, 167, 5, 380,
+    109, 26, 315, 228, 32, 175, 14, 138, 60, 302, 320, 14, 167, 92, 277, 392, 75, 302, 337, 300, 7, 351, 20, 36,
+    166, 183, 346, 348, 167, 389, 58, 142, 377, 300, 134, 239, 365, 167, 360, 346, 346, 363, 88, 320, 92, 89, 92, 6,
+    117, 132, 132, 134, 107, 15, 361, 109, 144, 246, 195, 200, 200, 203, 300, 310, 32, 188, 144, 200, 327, 175, 363, 392,
+    145, 346, 293, 341, 346, 326, 371, 167, 78, 73, 260, 240, 132, 205, 367, 103, 264, 386, 138, 107, 64, 134, 188, 264,
+    134, 341, 144, 264, 188, 167, 298, 65, 107, 134, 107, 361, 109, 200, 300, 32, 167, 144, 132, 346, 65, 326, 371, 103,
+    138, 264, 136, 263, 138, 52, 144, 392, 34, 132, 104, 59, 403, 65, 294, 125, 265, 98, 300, 137, 109, 102, 41, 137,
+    130, 263, 353, 313, 220, 132, 185, 392, 384, 14, 353, 124, 294, 102, 392, 358, 41, 346, 365, 173, 144, 346, 361, 346,
+    361, 361, 69, 92, 263, 263, 136, 122, 132, 84, 359, 67, 122, 31, 322, 356, 137, 365, 272, 359, 366, 293, 254, 336,
+    132, 359, 366, 78, 87, 360, 363, 311, 298, 366, 352, 144, 350, 216, 36, 370, 392, 354, 85, 352, 34, 296, 361, 283,
+    401, 356, 365, 365, 313, 38, 117, 298, 117, 356, 390, 395, 391, 103, 403, 403, 386, 104, 92, 134, 68, 180, 65, 362,
+    173, 215, 239, 394, 95, 365, 142, 363, 384, 365, 365, 264, 388, 250, 14, 354, 264, 6, 57, 406, 322, 395, 49, 389,
+    369, 356, 359, 365, 128, 117, 300, 30, 350, 300, 119, 30, 103, 109, 265, 129, 137, 125, 94, 349, 341, 298, 394, 330,
+    200, 386, 205, 78, 129, 361, 354, 105, 82, 19, 327, 365, 171, 395, 161, 158, 345, 371, 324, 132, 392, 272, 52, 168,
+    78, 161, 79, 300, 329, 59, 11, 32, 370, 154, 258, 260, 303, 3, 371, 350, 37, 137, 348, 345, 345, 97, 311, 21,
+    129, 139, 309, 390, 309, 73, 125, 33, 307, 137, 151, 264, 50, 350, 315, 340, 348, 86, 38, 318, 365, 220, 366, 67,
+    245, 402, 32, 36, 401, 132, 254, 320, 400, 341, 142, 261, 71, 391, 380, 405, 256, 402, 176, 134, 41, 116, 187, 298,
+    16, 125, 246, 371, 68, 356, 246, 300, 357, 300, 130, 125, 78, 393, 65, 351, 92, 253, 329, 134, 254, 371, 403, 398,
+    346, 129, 366, 3, 348, 213, 36, 88, 395, 362, 361, 128, 357, 98, 233, 254, 208, 364, 341, 353, 324, 394, 293, 134,
+    251, 162, 128, 131, 98, 367, 200, 350, 200, 346, 257, 36, 358, 325, 313, 9, 38, 256, 300, 135, 372, 351, 117, 322,
+    363, 363, 185, 371, 16, 50, 261, 173, 207, 207, 294, 389, 206, 134, 380, 137, 175, 184, 24, 236, 110, 346, 402, 5,
+    5, 138, 389, 365, 124, 135, 193, 34, 114, 125, 32, 356, 383, 288, 346, 384, 75, 391, 215, 167, 78, 367, 144, 132,
+    409, 136, 20, 129, 398, 345, 382, 384, 300, 258, 320, 382, 253, 299, 357, 379, 320, 60, 315, 348, 132, 136, 139, 386,
+    214, 365, 2, 386, 245, 129, 125, 365, 365, 293, 269, 229, 256, 75, 318, 124, 394, 116, 2, 367, 134, 371, 134, 129,
+    73, 389, 357, 377, 171, 298, 341, 32, 173, 365, 15, 389, 361, 78, 40, 341, 40, 363, 32, 269, 366, 167, 36, 351,
+    224, 127, 377, 365, 60, 386, 361, 73, 361, 132, 69, 92, 272, 132, 137, 122, 322, 269, 293, 254, 336, 359, 365, 359,
+    132, 272, 135, 129, 236, 142, 360, 216, 356, 78, 187, 354, 311, 88, 296, 85, 144, 391, 104, 117, 250, 406, 300, 354,
+    384, 313, 390, 65, 394, 49, 264, 388, 14, 365, 365, 161, 171, 300, 105, 300, 132, 129, 37, 395, 298, 125, 59, 103,
+    265, 109, 359, 365, 391, 94, 349, 30, 130, 356, 394, 137, 345, 371, 258, 345, 97, 370, 129, 161, 309, 311, 79, 261,
+    395, 405, 233, 73, 402, 86, 151, 341, 371, 297, 298, 67, 32, 176, 401, 315, 320, 298, 365, 208, 36, 68, 128, 134,
+    351, 358, 364, 341, 78, 371, 357, 32, 403, 3, 361, 65, 200, 246, 356, 207, 60, 313, 351, 363, 9, 300, 256, 200,
+    138, 193, 389, 134, 206, 320, 382, 258, 167, 253, 144, 361, 256, 386, 36, 104, 256, 122, 347, 132, 122, 114, 122, 346,
+    346, 131, 177, 114, 73, 183, 72, 135, 254, 300, 173, 64, 339, 14, 302, 348, 88, 392, 392, 361, 361, 300, 41, 129,
+    335, 365, 335, 365, 134, 6, 123, 78, 41, 349, 127, 134, 153, 94, 142, 92, 346, 18, 116, 371, 395, 133, 87, 346,
+    20, 342, 127, 18, 65, 404, 87, 365, 392, 10, 31, 3, 245, 211, 245, 103, 211, 370, 67, 207, 310, 355, 127, 163,
+    117, 116, 207, 3, 195, 173, 220, 14, 371, 133, 333, 195, 245, 346, 365, 142, 207, 41, 320, 127, 144, 11, 390, 372,
+    92, 23, 102, 323, 365, 115, 339, 249, 131, 84, 320, 107, 380, 392, 82, 395, 300, 14, 403, 82, 109, 246, 15, 192,
+    58, 299, 161, 86, 328, 365, 38, 195, 117, 14, 185, 179, 129, 94, 246, 403, 133, 356, 381, 136, 94, 378, 134, 367,
+    359, 390, 296, 18, 18, 263, 296, 44, 378, 394, 166, 377, 49, 36, 294, 326, 242, 101, 348, 192, 134, 315, 92, 320,
+    50, 50, 392, 132, 387, 73, 138, 354, 47, 374, 10, 376, 166, 88, 25, 132, 299, 365, 398, 92, 103, 284, 380, 177,
+    365, 7, 36, 339, 392, 400, 16, 374, 383, 59, 377, 361, 253, 293, 339, 367, 138, 95, 348, 378, 14, 73, 302, 361,
+    294, 357, 183, 95, 378, 11, 390, 92, 372, 102, 23, 380, 348, 7, 387, 131, 392, 84, 320, 249, 15, 103, 395, 107,
+    82, 134, 12, 300, 328, 109, 161, 58, 195, 86, 117, 365, 381, 392, 133, 129, 403, 179, 185, 378, 403, 94, 138, 263,
+    390, 166, 296, 92, 73, 132, 302, 294, 49, 14, 394, 101, 242, 59, 166, 88, 400, 92, 398, 284, 380, 361, 377, 374,
+    383, 293, 367, 95, 38, 346, 296, 213, 330, 346, 37, 117, 37, 389, 347, 321, 405, 405, 173, 141, 92, 388, 95, 254,
+    293, 262, 366, 348, 403, 144, 260, 38, 49, 36, 36, 68, 142, 34, 65, 346, 386, 144, 373, 264, 132, 38, 41, 105,
+    358, 403, 327, 77, 178, 95, 317, 52, 346, 388, 313, 366, 142, 134, 266, 321, 48, 54, 185, 264, 60, 263, 403, 325,
+    264, 38, 128, 258, 258, 136, 379, 325, 82, 377, 377, 406, 237, 10, 157, 151, 76, 144, 92, 36, 134, 85, 392, 318,
+    373, 6, 254, 373, 257, 336, 319, 365, 221, 180, 197, 6, 68, 157, 336, 133, 49, 241, 255, 395, 142, 66, 392, 92,
+    239, 142, 293, 20, 220, 142, 173, 100, 365, 132, 77, 348, 136, 77, 395, 265, 158, 397, 109, 262, 162, 349, 38, 185,
+    246, 392, 133, 327, 23, 134, 57, 258, 14, 348, 77, 132, 142, 132, 302, 332, 41, 139, 224, 350, 21, 358, 55, 209,
+    302, 176, 369, 136, 40, 258, 208, 318, 134, 254, 344, 341, 48, 137, 132, 224, 142, 224, 187, 185, 172, 126, 142, 38,
+    339, 265, 325, 20, 406, 259, 365, 52, 404, 23, 404, 244, 392, 391, 66, 392, 371, 77, 76, 44, 369, 393, 65, 384,
+    36, 43, 134, 105, 321, 142, 92, 406, 68, 246, 276, 233, 325, 30, 334, 134, 61, 56, 254, 318, 257, 221, 66, 325,
+    132, 224, 193, 181, 377, 14, 39, 185, 177, 52, 321, 58, 313, 346, 162, 132, 392, 257, 65, 239, 404, 175, 13, 379,
+    221, 17, 334, 142, 64, 29, 348, 84, 41, 393, 76, 20, 52, 52, 144, 144, 179, 318, 258, 144, 253, 177, 76, 53,
+    107, 379, 57, 14, 14, 395, 142, 41, 258, 76, 40, 132, 345, 373, 221, 179, 178, 392, 173, 392, 32, 41, 74, 341,
+    183, 179, 348, 341, 407, 167, 351, 269, 283, 224, 318, 264, 132, 53, 56, 346, 162, 144, 179, 298, 102, 59, 87, 264,
+    325, 77, 77, 102, 168, 272, 188, 2, 132, 142, 321, 155, 169, 361, 197, 149, 264, 184, 169, 77, 392, 361, 325, 61,
+    367, 371, 35, 360, 109, 145, 341, 373, 352, 58, 357, 84, 272, 293, 161, 302, 335, 36, 58, 78, 211, 254, 195, 279,
+    161, 256, 398, 122, 124, 264, 161, 65, 180, 58, 5, 390, 84, 161, 362, 244, 11, 104, 104, 241, 395, 275, 78, 6,
+    394, 392, 363, 151, 365, 392, 300, 250, 82, 102, 142, 136, 108, 117, 147, 265, 394, 376, 392, 296, 176, 371, 295, 370,
+    339, 366, 389, 339, 92, 261, 394, 220, 172, 389, 386, 176, 403, 129, 340, 48, 111, 148, 365, 244, 256, 110, 221, 250,
+    107, 11, 187, 238, 176, 279, 276, 132, 362, 348, 44, 51, 47, 98, 370, 122, 302, 92, 403, 92, 342, 12, 386, 371,
+    342, 322, 104, 390, 347, 372, 185, 136, 34, 398, 341, 130, 358, 389, 136, 386, 21, 169, 87, 84, 179, 98, 288, 148,
+    127, 365, 132, 400, 82, 371, 134, 122, 171, 242, 173, 173, 185, 179, 35, 360, 109, 357, 58, 272, 398, 78, 187, 279,
+    122, 104, 151, 185, 394, 392, 365, 124, 390, 173, 363, 261, 300, 376, 392, 136, 394, 265, 185, 136, 389, 92, 176, 221,
+    11, 129, 110, 340, 176, 48, 403, 51, 92, 132, 342, 302, 242, 372, 347, 221, 185, 389, 179, 352, 104, 49, 49, 245,
+    408, 15, 165, 165, 49, 358, 8, 15, 15, 15, 358, 15, 8, 49, 15, 15, 36, 277, 228, 228, 32, 48, 48, 365,
+    273, 15, 15, 300, 371, 177, 57, 32, 95, 256, 371, 371, 254, 359, 365, 111, 192, 254, 375, 340, 332, 401, 367, 57,
+    374, 138, 115, 360, 84, 345, 57, 78, 113, 389, 57, 138, 372, 341, 175, 38, 35, 220, 327, 392, 365, 140, 133, 36,
+    58, 82, 65, 251, 395, 68, 380, 322, 302, 336, 264, 139, 129, 71, 370, 200, 13, 132, 212, 365, 137, 400, 178, 359,
+    334, 311, 300, 322, 240, 123, 220, 76, 140, 357, 359, 21, 370, 350, 263, 331, 395, 263, 65, 65, 332, 139, 325, 72,
+    365, 389, 330, 108, 345, 300, 37, 313, 379, 267, 88, 175, 317, 129, 173, 104, 166, 12, 56, 144, 13, 127, 58, 185,
+    370, 394, 138, 371, 48, 162, 341, 325, 365, 57, 372, 188, 14, 233, 371, 60, 315, 76, 315, 361, 44, 38, 325, 371,
+    300, 390, 370, 374, 78, 15, 111, 78, 347, 128, 263, 61, 57, 341, 213, 365, 103, 363, 40, 181, 359, 318, 65, 38,
+    372, 313, 318, 256, 191, 363, 107, 387, 5, 300, 22, 38, 313, 379, 389, 76, 65, 184, 38, 56, 179, 409, 270, 256,
+    357, 371, 365, 78, 177, 142, 300, 14, 363, 192, 351, 315, 113, 386, 324, 82, 202, 15, 15, 165, 173, 372, 363, 188,
+    173, 365, 329, 64, 254, 369, 293, 114, 371, 194, 277, 262, 346, 161, 92, 149, 18, 85, 353, 211, 352, 298, 9, 372,
+    55, 131, 351, 9, 345, 142, 370, 114, 319, 263, 14, 245, 19, 295, 11, 337, 65, 405, 364, 179, 161, 109, 395, 300,
+    157, 371, 94, 117, 259, 392, 132, 127, 123, 353, 136, 346, 109, 233, 168, 133, 159, 391, 168, 374, 361, 37, 72, 346,
+    185, 92, 345, 92, 97, 116, 168, 133, 101, 145, 367, 20, 346, 11, 173, 374, 21, 350, 254, 245, 261, 111, 394, 320,
+    405, 250, 166, 220, 36, 370, 21, 349, 59, 142, 369, 258, 365, 72, 361, 197, 282, 11, 78, 302, 143, 371, 374, 123,
+    162, 349, 349, 312, 321, 205, 346, 277, 41, 403, 405, 364, 345, 349, 374, 116, 369, 14, 195, 34, 92, 177, 366, 398,
+    124, 258, 361, 387, 193, 258, 356, 64, 14, 359, 14, 383, 341, 391, 195, 293, 179, 251, 59, 199, 364, 26, 159, 88,
+    199, 405, 161, 175, 377, 32, 370, 132, 361, 32, 56, 180, 127, 346, 88, 377, 173, 370, 69, 263, 402, 242, 394, 365,
+    95, 371, 141, 361, 408, 195, 390, 356, 72, 390, 87, 372, 92, 374, 319, 326, 255, 336, 52, 114, 104, 313, 251, 40,
+    376, 205, 169, 48, 40, 370, 330, 392, 348, 135, 37, 366, 332, 136, 197, 157, 314, 171, 253, 408, 113, 361, 292, 222,
+    341, 185, 167, 361, 322, 242, 386, 47, 320, 408, 400, 52, 163, 325, 348, 73, 124, 356, 353, 320, 263, 47, 374, 251,
+    151, 312, 200, 265, 40, 56, 374, 369, 4, 384, 113, 321, 135, 247, 36, 371, 173, 379, 169, 365, 135, 21, 136, 346,
+    320, 83, 228, 365, 173, 142, 361, 365, 222, 277, 359, 40, 361, 180, 200, 200, 222, 352, 136, 292, 200, 361, 15, 23,
+    300, 370, 300, 300, 173, 393, 364, 176, 346, 138, 138, 263, 365, 177, 61, 388, 69, 251, 263, 6, 92, 390, 392, 6,
+    186, 92, 212, 67, 293, 258, 156, 44, 403, 84, 125, 125, 114, 96, 254, 194, 274, 65, 310, 346, 365, 31, 300, 332,
+    346, 230, 256, 263, 134, 245, 364, 138, 6, 85, 36, 353, 72, 373, 256, 92, 245, 211, 352, 78, 144, 76, 103, 366,
+    256, 8, 283, 272, 34, 227, 87, 374, 365, 260, 245, 111, 122, 366, 145, 67, 365, 393, 346, 94, 274, 131, 319, 149,
+    372, 185, 78, 260, 77, 403, 220, 332, 300, 204, 104, 151, 180, 19, 310, 104, 20, 245, 371, 310, 410, 21, 370, 326,
+    133, 390, 300, 300, 392, 142, 32, 300, 300, 357, 388, 10, 117, 14, 299, 41, 300, 20, 395, 38, 375, 251, 330, 256,
+    92, 385, 181, 256, 92, 173, 373, 245, 362, 8, 20, 137, 103, 302, 391, 209, 346, 346, 65, 133, 209, 320, 127, 365,
+    310, 161, 146, 11, 134, 330, 353, 122, 136, 38, 82, 188, 19, 300, 208, 133, 366, 145, 394, 39, 349, 330, 207, 171,
+    132, 371, 356, 272, 409, 392, 262, 293, 38, 348, 353, 265, 245, 328, 395, 349, 205, 158, 363, 348, 348, 355, 145, 30,
+    169, 132, 245, 277, 200, 365, 366, 108, 3, 70, 370, 288, 150, 256, 186, 310, 2, 67, 114, 280, 300, 154, 263, 350,
+    389, 355, 378, 325, 56, 105, 122, 393, 331, 185, 197, 168, 339, 352, 374, 11, 345, 313, 371, 32, 69, 20, 114, 133,
+    122, 53, 88, 32, 339, 392, 310, 357, 125, 371, 327, 161, 402, 189, 353, 260, 298, 114, 189, 364, 41, 383, 142, 348,
+    328, 194, 253, 173, 239, 280, 37, 97, 173, 323, 19, 395, 390, 332, 181, 408, 142, 33, 372, 134, 96, 67, 322, 33,
+    187, 111, 180, 245, 185, 173, 257, 252, 143, 204, 408, 244, 3, 245, 348, 360, 400, 171, 151, 155, 318, 163, 73, 217,
+    46, 403, 391, 12, 224, 404, 47, 320, 69, 254, 256, 400, 132, 371, 138, 107, 195, 33, 326, 346, 175, 322, 104, 56,
+    302, 390, 185, 199, 185, 125, 16, 93, 166, 153, 85, 345, 212, 339, 377, 124, 62, 348, 246, 131, 176, 83, 198, 147,
+    367, 65, 175, 111, 348, 73, 332, 341, 404, 92, 276, 132, 78, 145, 36, 325, 384, 124, 362, 74, 347, 371, 154, 299,
+    128, 341, 92, 388, 30, 259, 300, 122, 162, 326, 208, 258, 258, 123, 331, 50, 127, 364, 204, 134, 74, 134, 311, 162,
+    124, 357, 77, 137, 390, 15, 393, 403, 355, 364, 197, 238, 2, 137, 256, 197, 317, 57, 9, 347, 175, 317, 147, 181,
+    363, 364, 229, 343, 275, 321, 317, 257, 173, 309, 46, 20, 239, 57, 14, 286, 96, 403, 345, 367, 128, 327, 181, 147,
+    316, 291, 312, 339, 116, 390, 390, 168, 365, 372, 321, 224, 346, 133, 98, 191, 143, 311, 406, 317, 347, 88, 342, 211,
+    185, 317, 236, 406, 333, 355, 107, 357, 175, 301, 5, 193, 207, 188, 14, 341, 181, 65, 285, 404, 365, 185, 5, 154,
+    257, 54, 254, 33, 321, 193, 369, 32, 88, 139, 16, 302, 184, 355, 50, 183, 377, 134, 26, 173, 347, 346, 149, 306,
+    13, 387, 256, 37, 185, 125, 132, 253, 129, 257, 251, 179, 288, 355, 285, 37, 162, 310, 181, 215, 128, 248, 315, 84,
+    258, 265, 362, 321, 349, 144, 136, 409, 177, 259, 169, 75, 352, 377, 132, 134, 393, 64, 360, 367, 75, 144, 229, 377,
+    253, 328, 84, 37, 69, 293, 147, 134, 86, 315, 185, 143, 129, 371, 175, 402, 258, 134, 402, 171, 14, 328, 127, 364,
+    77, 111, 60, 142, 87, 57, 11, 365, 2, 404, 359, 67, 395, 120, 400, 132, 224, 117, 131, 261, 18, 367, 162, 226,
+    356, 134, 134, 256, 30, 392, 203, 173, 171, 132, 407, 161, 294, 244, 165, 73, 309, 48, 185, 16, 10, 185, 348, 160,
+    183, 78, 185, 352, 134, 167, 20, 134, 363, 32, 349, 134, 346, 107, 25, 224, 171, 53, 264, 239, 188, 407, 186, 379,
+    224, 144, 321, 395, 167, 138, 93, 365, 390, 69, 388, 251, 177, 332, 256, 44, 293, 283, 84, 67, 198, 230, 362, 31,
+    353, 94, 21, 319, 142, 76, 34, 393, 211, 11, 96, 8, 256, 363, 260, 145, 345, 103, 149, 85, 131, 331, 227, 6,
+    371, 256, 391, 256, 104, 20, 151, 251, 21, 20, 373, 407, 209, 320, 133, 66, 370, 328, 20, 180, 309, 256, 195, 10,
+    300, 357, 318, 14, 220, 245, 77, 353, 150, 169, 82, 194, 360, 370, 37, 133, 364, 215, 392, 60, 330, 185, 67, 366,
+    147, 384, 395, 346, 69, 70, 348, 125, 265, 291, 112, 67, 98, 205, 391, 288, 136, 365, 32, 39, 321, 3, 366, 277,
+    395, 169, 253, 345, 166, 323, 175, 154, 350, 317, 173, 383, 41, 111, 97, 78, 355, 56, 189, 88, 352, 181, 147, 134,
+    280, 325, 168, 260, 142, 1, 257, 389, 233, 56, 195, 12, 254, 62, 151, 163, 33, 346, 104, 188, 46, 400, 138, 392,
+    348, 143, 131, 242, 320, 69, 134, 142, 199, 403, 259, 367, 147, 257, 310, 78, 30, 258, 393, 74, 312, 128, 127, 2,
+    73, 197, 184, 403, 86, 197, 207, 390, 20, 98, 224, 321, 143, 224, 211, 181, 97, 9, 365, 133, 18, 275, 16, 321,
+    193, 188, 13, 369, 139, 65, 406, 357, 181, 32, 144, 177, 253, 185, 75, 167, 253, 53, 257, 64, 131, 171, 127, 402,
+    175, 365, 30, 16, 165, 32, 349, 387, 33, 141, 5, 68, 264, 177, 200, 387, 198, 191, 305, 293, 131, 198, 361, 14,
+    114, 14, 293, 147, 149, 13, 122, 281, 285, 348, 348, 134, 204, 347, 307, 72, 384, 215, 386, 244, 347, 180, 15, 14,
+    281, 2, 107, 98, 98, 83, 41, 122, 109, 204, 288, 163, 168, 185, 329, 291, 142, 373, 373, 32, 264, 179, 33, 292,
+    163, 361, 342, 361, 78, 130, 371, 342, 122, 10, 122, 264, 363, 342, 8, 3, 341, 366, 164, 266, 167, 73, 265, 88,
+    326, 224, 318, 147, 117, 266, 45, 107, 72, 254, 162, 321, 107, 247, 148, 346, 129, 32, 245, 60, 127, 318, 342, 318,
+    198, 305, 293, 361, 114, 14, 342, 45, 281, 341, 348, 122, 134, 204, 149, 198, 384, 215, 109, 342, 318, 204, 185, 147,
+    83, 98, 117, 163, 141, 373, 168, 73, 371, 361, 33, 346, 342, 130, 361, 78, 32, 167, 264, 129, 164, 266, 117, 326,
+    57, 266, 114, 127, 92, 92, 170, 75, 352, 256, 345, 94, 392, 366, 362, 72, 78, 299, 8, 242, 154, 374, 279, 392,
+    245, 139, 85, 362, 366, 390, 137, 37, 78, 264, 65, 406, 410, 66, 180, 1, 336, 336, 11, 19, 92, 132, 185, 183,
+    36, 353, 77, 184, 207, 135, 302, 77, 348, 82, 109, 371, 94, 293, 145, 258, 353, 47, 92, 14, 347, 293, 299, 392,
+    253, 72, 372, 390, 41, 348, 61, 224, 374, 348, 242, 86, 405, 365, 75, 187, 366, 142, 46, 36, 245, 180, 322, 348,
+    185, 299, 348, 366, 395, 362, 273, 347, 39, 361, 366, 302, 65, 371, 183, 341, 341, 224, 75, 315, 3, 128, 137, 315,
+    366, 94, 361, 129, 98, 374, 345, 162, 2, 346, 321, 132, 387, 61, 5, 346, 366, 283, 270, 179, 334, 64, 136, 315,
+    315, 5, 348, 87, 220, 82, 132, 61, 346, 366, 392, 129, 183, 346, 173, 173, 173, 400, 124, 392, 316, 143, 213, 365,
+    266, 361, 260, 256, 354, 360, 132, 104, 127, 392, 103, 143, 49, 369, 142, 41, 124, 375, 188, 371, 40, 67, 315, 114,
+    344, 306, 107, 41, 375, 369, 132, 346, 40, 181, 173, 213, 358, 375, 132, 132, 371, 371, 358, 211, 91, 288, 209, 342,
+    87, 240, 374, 173, 38, 362, 180, 171, 3, 10, 345, 66, 60, 124, 345, 67, 356, 132, 209, 36, 350, 384, 329, 390,
+    242, 197, 180, 254, 394, 131, 291, 86, 122, 386, 366, 220, 395, 335, 179, 180, 71, 367, 345, 180, 306, 180, 347, 122,
+    366, 192, 192, 374, 181, 199, 18, 345, 341, 164, 366, 346, 365, 2, 59, 324, 348, 371, 185, 183, 58, 132, 240, 362,
+    6, 245, 341, 88, 346, 132, 192, 199, 199, 171, 173, 131, 2, 86, 58, 183, 180, 2, 88, 173, 10, 117, 117, 117,
+    19, 261, 261, 139, 326, 390, 139, 37, 261, 139, 139, 66, 139, 326, 86, 86, 150, 200, 201, 201, 10, 364, 326, 129,
+    364, 98, 69, 30, 256, 272, 65, 73, 345, 272, 260, 138, 358, 227, 6, 366, 283, 211, 207, 406, 57, 8, 365, 363,
+    322, 11, 137, 122, 241, 362, 19, 366, 98, 322, 137, 351, 3, 3, 119, 102, 255, 57, 258, 329, 193, 367, 315, 327,
+    258, 357, 155, 13, 318, 294, 19, 164, 142, 165, 351, 276, 9, 81, 263, 263, 117, 258, 209, 142, 134, 15, 65, 134,
+    342, 322, 103, 318, 11, 351, 239, 98, 14, 164, 321, 184, 109, 258, 358, 132, 134, 135, 32, 57, 124, 348, 256, 73,
+    337, 134, 167, 341, 272, 92, 197, 265, 98, 341, 258, 114, 33, 164, 276, 374, 296, 341, 98, 7, 322, 103, 374, 97,
+    14, 341, 315, 73, 337, 73, 341, 272, 92, 114, 341, 374, 322, 141, 141, 348, 351, 348, 132, 366, 375, 374, 295, 170,
+    244, 128, 367, 374, 244, 3, 366, 349, 124, 364, 69, 261, 162, 349, 308, 114, 356, 365, 356, 78, 311, 162, 254, 115,
+    371, 339, 8, 76, 65, 59, 239, 251, 180, 35, 139, 171, 117, 258, 78, 78, 341, 351, 164, 298, 365, 365, 113, 75,
+    371, 250, 171, 92, 133, 331, 129, 162, 133, 188, 329, 37, 367, 374, 124, 114, 139, 334, 334, 249, 166, 334, 403, 403,
+    46, 69, 166, 320, 114, 256, 151, 54, 357, 260, 365, 284, 325, 78, 78, 361, 342, 148, 369, 398, 361, 348, 352, 365,
+    372, 286, 66, 66, 135, 162, 171, 169, 247, 338, 193, 52, 363, 116, 258, 104, 359, 361, 129, 32, 277, 199, 18, 348,
+    249, 185, 167, 224, 265, 364, 69, 261, 114, 349, 308, 356, 356, 339, 104, 76, 254, 8, 311, 115, 371, 185, 180, 251,
+    139, 137, 133, 329, 117, 367, 140, 151, 365, 249, 129, 334, 114, 367, 367, 151, 325, 369, 78, 398, 361, 78, 224, 193,
+    66, 286, 116, 171, 32, 277, 249, 265, 88, 16, 105, 92, 347, 386, 16, 283, 6, 319, 178, 105, 357, 295, 142, 16,
+    310, 341, 362, 363, 312, 147, 312, 84, 181, 346, 181, 247, 247, 181, 16, 16, 16, 177, 16, 288, 88, 355, 88, 362,
+    386, 16, 283, 142, 310, 312, 363, 181, 247, 16, 16, 86, 84, 86, 86, 300, 300, 24, 132, 69, 310, 336, 386, 316,
+    349, 335, 272, 371, 143, 38, 366, 84, 84, 316, 366, 331, 365, 410, 14, 137, 322, 10, 49, 328, 310, 10, 300, 77,
+    113, 272, 326, 136, 133, 19, 363, 330, 49, 349, 362, 143, 82, 361, 170, 346, 24, 20, 217, 78, 21, 145, 72, 313,
+    371, 300, 363, 130, 111, 300, 134, 400, 19, 348, 21, 364, 320, 86, 387, 341, 107, 78, 231, 374, 124, 128, 328, 129,
+    134, 123, 2, 321, 87, 341, 104, 30, 311, 321, 20, 97, 346, 162, 181, 312, 322, 364, 342, 207, 321, 193, 14, 371,
+    355, 138, 285, 162, 398, 293, 38, 59, 365, 132, 270, 37, 369, 322, 341, 349, 386, 87, 113, 199, 361, 207, 32, 349,
+    188, 377, 214, 300, 69, 132, 336, 321, 335, 346, 272, 371, 38, 84, 366, 134, 300, 10, 310, 77, 365, 82, 270, 349,
+    117, 170, 136, 346, 19, 20, 72, 78, 371, 217, 145, 111, 130, 348, 107, 30, 162, 104, 312, 32, 364, 207, 20, 181,
+    355, 138, 193, 285, 398, 214, 301, 162, 111, 349, 87, 20, 220, 14, 20, 332, 114, 86, 134, 3, 2, 92, 348, 374,
+    352, 87, 249, 352, 191, 371, 88, 114, 65, 336, 389, 38, 359, 395, 392, 242, 352, 274, 283, 374, 342, 392, 59, 185,
+    370, 20, 10, 144, 336, 365, 264, 342, 264, 140, 251, 388, 372, 242, 394, 142, 395, 230, 142, 245, 378, 133, 180, 390,
+    319, 92, 362, 300, 14, 336, 336, 310, 181, 191, 246, 322, 392, 275, 324, 71, 359, 265, 298, 140, 82, 113, 20, 395,
+    366, 188, 394, 59, 113, 181, 142, 311, 260, 194, 168, 114, 332, 357, 334, 145, 78, 37, 353, 2, 185, 400, 394, 296,
+    246, 163, 322, 166, 404, 151, 254, 254, 361, 86, 287, 361, 98, 363, 345, 246, 50, 246, 256, 86, 128, 256, 131, 371,
+    325, 265, 347, 404, 162, 276, 310, 105, 336, 109, 312, 256, 37, 392, 181, 244, 324, 346, 26, 73, 361, 372, 405, 287,
+    293, 254, 392, 306, 185, 346, 188, 387, 207, 5, 24, 16, 50, 264, 14, 392, 371, 356, 125, 20, 313, 350, 179, 386,
+    76, 181, 336, 29, 66, 136, 328, 361, 188, 386, 139, 365, 364, 336, 249, 394, 361, 183, 185, 324, 349, 132, 306, 142,
+    346, 127, 173, 16, 191, 371, 336, 359, 38, 264, 274, 20, 185, 378, 300, 310, 92, 142, 405, 395, 336, 230, 133, 365,
+    58, 350, 191, 366, 136, 125, 188, 113, 246, 16, 173, 37, 361, 353, 260, 145, 254, 254, 151, 400, 404, 313, 24, 246,
+    392, 162, 287, 345, 5, 181, 256, 293, 16, 188, 50, 32, 394, 132, 306, 349, 104, 341, 341, 341, 371, 95, 365, 4,
+    331, 137, 10, 11, 49, 325, 65, 157, 113, 258, 123, 158, 98, 334, 101, 246, 14, 151, 255, 371, 315, 184, 20, 350,
+    9, 20, 49, 160, 18, 207, 177, 184, 350, 73, 378, 315, 325, 18, 160, 185, 97, 97, 258, 150, 258, 169, 287, 16,
+    163, 163, 65, 85, 355, 268, 195, 59, 163, 18, 83, 327, 245, 403, 83, 268, 325, 10, 14, 195, 92, 82, 275, 264,
+    102, 355, 164, 132, 244, 396, 295, 317, 325, 173, 18, 404, 65, 244, 311, 391, 265, 404, 308, 134, 336, 124, 165, 141,
+    254, 175, 390, 18, 244, 191, 285, 193, 193, 290, 356, 178, 256, 256, 214, 127, 164, 226, 18, 178, 269, 72, 72, 215,
+    122, 346, 72, 114, 72, 72, 141, 33, 371, 371, 98, 361, 92, 260, 109, 404, 181, 109, 294, 371, 109, 197, 132, 254,
+    93, 162, 130, 6, 251, 197, 356, 361, 350, 176, 371, 334, 254, 340, 176, 341, 95, 38, 247, 14, 207, 132, 356, 40,
+    361, 386, 371, 61, 272, 137, 6, 122, 336, 67, 132, 356, 78, 78, 291, 115, 335, 207, 137, 298, 8, 372, 245, 185,
+    342, 124, 185, 375, 85, 87, 211, 370, 246, 207, 117, 347, 264, 114, 245, 180, 336, 20, 263, 250, 92, 14, 49, 341,
+    142, 67, 6, 370, 110, 245, 221, 353, 319, 10, 92, 384, 142, 104, 300, 71, 58, 318, 137, 302, 123, 349, 82, 3,
+    341, 388, 395, 366, 178, 188, 330, 325, 365, 19, 341, 136, 157, 109, 348, 98, 129, 169, 92, 150, 355, 77, 145, 325,
+    201, 295, 384, 317, 260, 371, 217, 389, 110, 101, 313, 345, 263, 293, 253, 127, 327, 173, 291, 291, 150, 199, 37, 173,
+    405, 346, 369, 298, 403, 254, 391, 349, 217, 47, 132, 67, 259, 104, 394, 71, 166, 86, 220, 365, 163, 185, 141, 33,
+    139, 187, 180, 405, 173, 199, 404, 392, 221, 124, 371, 65, 300, 298, 127, 325, 123, 353, 395, 165, 404, 381, 15, 15,
+    127, 265, 381, 341, 341, 371, 47, 276, 68, 128, 175, 361, 263, 263, 134, 14, 78, 362, 92, 284, 95, 347, 336, 124,
+    300, 282, 357, 342, 256, 116, 345, 85, 287, 181, 191, 300, 300, 107, 403, 324, 318, 363, 78, 369, 256, 254, 342, 282,
+    298, 175, 5, 170, 129, 204, 132, 327, 264, 134, 298, 193, 346, 263, 16, 132, 132, 395, 135, 355, 398, 369, 387, 149,
+    358, 17, 371, 264, 349, 20, 136, 359, 313, 128, 409, 293, 293, 84, 109, 179, 359, 202, 346, 383, 349, 87, 107, 123,
+    159, 381, 287, 386, 95, 109, 367, 173, 33, 171, 302, 2, 277, 132, 356, 124, 302, 173, 178, 173, 203, 390, 349, 78,
+    185, 107, 173, 348, 371, 61, 132, 370, 335, 185, 85, 6, 117, 6, 250, 221, 185, 370, 384, 92, 6, 10, 123, 245,
+    319, 109, 137, 150, 341, 82, 330, 381, 123, 159, 132, 136, 348, 384, 349, 359, 101, 173, 175, 134, 173, 300, 327, 110,
+    291, 127, 145, 132, 369, 261, 180, 254, 405, 86, 163, 33, 104, 220, 221, 67, 139, 298, 300, 403, 87, 68, 14, 33,
+    325, 342, 341, 284, 78, 263, 92, 128, 265, 135, 15, 287, 5, 254, 318, 107, 363, 240, 134, 170, 16, 358, 17, 193,
+    204, 369, 341, 346, 109, 293, 179, 409, 124, 95, 173, 386, 107, 223, 365, 92, 173, 141, 21, 361, 92, 67, 132, 88,
+    277, 95, 300, 88, 205, 10, 372, 392, 124, 260, 92, 8, 342, 134, 300, 371, 91, 363, 144, 144, 245, 127, 390, 10,
+    361, 360, 391, 85, 88, 342, 236, 58, 98, 277, 180, 203, 92, 336, 204, 173, 15, 392, 98, 372, 49, 264, 350, 38,
+    59, 142, 363, 104, 393, 371, 362, 371, 360, 328, 371, 326, 367, 75, 345, 82, 105, 2, 392, 361, 120, 350, 133, 178,
+    395, 362, 325, 122, 188, 277, 208, 98, 272, 136, 355, 394, 38, 188, 120, 221, 78, 186, 133, 132, 332, 127, 336, 21,
+    345, 143, 371, 20, 145, 145, 14, 346, 145, 142, 332, 139, 325, 78, 78, 161, 124, 345, 298, 166, 136, 239, 185, 245,
+    302, 92, 3, 402, 244, 260, 256, 11, 67, 185, 266, 134, 142, 332, 360, 372, 254, 173, 364, 400, 155, 77, 163, 299,
+    254, 139, 365, 365, 139, 403, 166, 71, 254, 47, 101, 142, 144, 365, 409, 132, 302, 367, 38, 202, 276, 3, 263, 325,
+    124, 325, 78, 137, 195, 92, 47, 332, 361, 117, 372, 246, 163, 197, 124, 367, 44, 345, 142, 71, 25, 85, 117, 367,
+    372, 348, 343, 300, 117, 41, 321, 347, 282, 181, 132, 104, 134, 316, 114, 49, 49, 365, 363, 361, 132, 173, 326, 156,
+    325, 325, 365, 332, 191, 350, 97, 326, 36, 132, 333, 389, 5, 363, 365, 236, 38, 392, 181, 369, 185, 14, 306, 402,
+    371, 345, 144, 366, 325, 310, 136, 365, 125, 14, 367, 313, 128, 84, 136, 177, 361, 97, 141, 348, 348, 332, 192, 409,
+    371, 367, 185, 333, 348, 358, 365, 245, 302, 188, 346, 365, 132, 380, 371, 386, 364, 362, 245, 226, 124, 200, 367, 199,
+    65, 373, 371, 171, 21, 185, 117, 183, 306, 373, 367, 107, 264, 173, 186, 223, 141, 132, 372, 205, 300, 236, 360, 25,
+    10, 390, 104, 71, 185, 360, 350, 362, 180, 38, 264, 372, 358, 336, 310, 392, 82, 105, 355, 120, 394, 98, 186, 122,
+    345, 20, 173, 143, 104, 78, 371, 348, 325, 345, 266, 202, 3, 163, 11, 244, 256, 47, 101, 372, 313, 124, 117, 78,
+    104, 263, 49, 197, 345, 365, 363, 343, 181, 132, 365, 134, 117, 365, 367, 389, 181, 177, 136, 141, 371, 185, 127, 386,
+    367, 124, 199, 107, 306, 185, 138, 180, 134, 348, 56, 134, 134, 361, 56, 185, 370, 52, 132, 241, 52, 241, 395, 145,
+    395, 134, 200, 200, 371, 181, 36, 145, 179, 220, 254, 185, 141, 145, 139, 173, 349, 348, 133, 200, 173, 296, 387, 179,
+    139, 254, 180, 361, 52, 192, 192, 117, 34, 92, 201, 201, 92, 241, 264, 264, 208, 92, 348, 166, 264, 201, 38, 88,
+    92, 264, 201, 191, 196, 207, 129, 207, 405, 232, 87, 128, 128, 138, 108, 326, 331, 122, 125, 161, 122, 302, 173, 221,
+    38, 118, 118, 365, 256, 59, 346, 335, 207, 207, 256, 58, 41, 370, 66, 365, 347, 361, 264, 197, 361, 261, 373, 173,
+    60, 73, 24, 361, 361, 361, 59, 3, 390, 58, 24, 365, 197, 386, 361, 73, 185, 392, 87, 92, 92, 201, 201, 372,
+    52, 264, 34, 337, 395, 392, 199, 5, 17, 336, 14, 372, 34, 336, 69, 200, 212, 69, 403, 104, 104, 71, 87, 322,
+    372, 245, 33, 97, 254, 372, 321, 324, 302, 302, 87, 86, 342, 6, 67, 336, 393, 264, 299, 300, 370, 300, 329, 345,
+    142, 139, 130, 142, 361, 332, 310, 346, 348, 361, 171, 14, 363, 263, 114, 345, 345, 123, 351, 78, 384, 355, 343, 384,
+    228, 214, 254, 385, 132, 403, 132, 132, 254, 132, 38, 36, 36, 117, 360, 366, 351, 10, 380, 351, 31, 38, 361, 142,
+    327, 180, 180, 41, 265, 351, 153, 224, 141, 363, 48, 374, 371, 41, 365, 220, 380, 405, 264, 374, 361, 236, 78, 344,
+    365, 49, 405, 66, 41, 138, 360, 38, 36, 117, 366, 142, 180, 10, 327, 403, 153, 371, 48, 264, 344, 183, 240, 102,
+    240, 361, 183, 183, 102, 148, 57, 180, 57, 183, 102, 148, 109, 263, 17, 109, 373, 46, 117, 144, 351, 371,
+};
+}
+
+const char *PinyinTable::syllable(char16_t ch)
+{
+    return (ch >= kFirst && ch <= kLast) ? kSyllables[kReadings[ch - kFirst]] : nullptr;
+}
@@ -0,0 +1,12 @@
+#ifndef PINYINTABLE_H
+#define PINYINTABLE_H
+
+#include <QtGlobal>
+
+// 汉字 → 拼音音节（小写、无声调），覆盖 CJK 基本区 U+4E00–U+9FA5
+namespace PinyinTable {
+// 非汉字或无读音时返回 nullptr
+const char *syllable(char16_t ch);
+}
+
+#endif // PINYINTABLE_H
@@ -0,0 +1,597 @@
+#include "searchengine.h"
+#include "searchquery.h"
+#include "simdfind.h"
+
+#include <QTimer>
+#include <QThread>
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr int kDebounceMs = 60;              // 连续输入时停顿多久才发起查询
+constexpr int kResultLimit = 500;            // 交给界面的结果上限（按相关度取前若干条）
+constexpr int kMinChunkDocs = 8192;          // 每个并行分段至少这么多文档，避免任务调度开销盖过扫描
+constexpr char16_t kFieldSeparator = 0x01;   // 字段 / 文档分隔符：查询词经 simplified() 不会含控制字符，
+constexpr char16_t kDocSeparator = 0x00;     // 因此命中不会跨字段或跨文档
+constexpr qint32 kNoDay = std::numeric_limits<qint32>::min();   // 没有截止日期
+}
+
+struct SearchEngine::Index {
+    struct Doc {
+        quint32 begin;                        // arena 内：标题 [begin, titleEnd)
+        quint32 titleEnd;                     //           标签 (titleEnd, tagsEnd)
+        quint32 tagsEnd;                      //           详情 (tagsEnd, end)
+        quint32 end;
+        quint32 folder;                       // folders 下标
+        quint32 item;                         // 文件夹内事项下标
+        quint8 priority;
+        bool pinned;
+    };
+
+    int version = 0;
+    QList<TodoFolder> folders;                // 建索引时的模型快照
+    QString arena;
+    std::vector<Doc> docs;
+    QHash<QString, quint32> docOf;            // 事项 id → 文档下标，拼音命中据此换算
+
+    // 过滤条件用的内存索引，文档表均按下标升序
+    QHash<QString, QList<quint32>> docsByTag;           // casefold 后的标签 → 文档
+    std::vector<quint32> folderBegin;                   // 文件夹 f 的文档为 [folderBegin[f], folderBegin[f + 1])
+    std::vector<std::pair<qint32, quint32>> byDue;      // (截止日, 文档)，按日期排序
+    QList<quint32> openDocs;
+    QList<quint32> doneDocs;
+
+    const char16_t *units() const { return reinterpret_cast<const char16_t *>(arena.utf16()); }
+
+    bool contains(quint32 begin, quint32 end, const QString &term) const
+    {
+        return SimdFind::findUnits(units() + begin, end - begin,
+                         reinterpret_cast<const char16_t *>(term.utf16()), term.size()) >= 0;
+    }
+};
+
+struct SearchEngine::Job {
+    quint64 generation = 0;
+    QString text;
+    SearchQuery query;
+    QStringList rawTerms;                     // 原文词，高亮用
+    QStringList terms;                        // casefold 后，最长的在前作为主扫描词
+    int modelVersion = 0;
+    QList<TodoFolder> folders;                // 需要重建索引时的数据来源
+    std::shared_ptr<const Index> index;
+    std::shared_ptr<PinyinIndex> pinyinIndex; // 为空时随 index 一起重建
+    bool narrowed = false;
+    QList<quint32> candidates;                // 增量收窄或过滤下推：只复查这些文档
+    int chunkCount = 1;
+    std::vector<QList<quint32>> partial;      // 各分段的命中，分段内有序
+    std::atomic_int remaining{0};
+    std::vector<QHash<quint32, bool>> pinyin; // 各词的拼音命中：文档 → 是否命中标题
+    QList<quint32> matches;                   // 全部命中（文档下标）
+    QList<SearchEngine::Hit> hits;   // 排序截断后的结果
+
+    // 第 t 个词命中文档 d：文本子串或拼音前缀
+    bool matchesTerm(quint32 d, qsizetype t) const
+    {
+        const Index::Doc &doc = index->docs[d];
+        return index->contains(doc.begin, doc.end, terms.at(t)) || pinyin[size_t(t)].contains(d);
+    }
+    bool matchesRest(quint32 d) const
+    {
+        for (qsizetype t = 1; t < terms.size(); ++t) {
+            if (!matchesTerm(d, t)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+SearchEngine::SearchEngine(QObject *parent)
+    : QObject(parent)
+{
+    // 留一个核心给 GUI 线程
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    m_pool.setObjectName(QStringLiteral("SearchEngine"));
+
+    m_debounce = new QTimer(this);
+    m_debounce->setSingleShot(true);
+    m_debounce->setInterval(kDebounceMs);
+    connect(m_debounce, &QTimer::timeout, this, &SearchEngine::dispatch);
+}
+
+SearchEngine::~SearchEngine()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+void SearchEngine::search(const QList<TodoFolder> &folders, const QString &text)
+{
+    m_pendingFolders = folders;
+    m_pendingText = text;
+    m_debounce->start();
+}
+
+void SearchEngine::cancel()
+{
+    m_debounce->stop();
+    ++m_generation;
+    m_pendingFolders.clear();
+}
+
+void SearchEngine::invalidate()
+{
+    ++m_modelVersion;
+    m_lastTerms.clear();
+    m_lastFilterKey.clear();
+    m_lastMatches.clear();
+}
+
+void SearchEngine::resetModel()
+{
+    m_pinyin.reset();
+    invalidate();
+}
+
+void SearchEngine::itemChanged(const TodoItem &item)
+{
+    if (m_pinyin) {
+        m_pinyin->upsert(item);
+    }
+    invalidate();
+}
+
+void SearchEngine::itemsRemoved(const QStringList &itemIds)
+{
+    for (const QString &itemId : itemIds) {
+        if (m_pinyin) {
+            m_pinyin->remove(itemId);
+        }
+    }
+    invalidate();
+}
+
+void SearchEngine::dispatch()
+{
+    auto job = std::make_shared<Job>();
+    job->generation = ++m_generation;
+    job->text = m_pendingText;
+    job->query = SearchQuery::parse(m_pendingText, QDate::currentDate());
+    job->rawTerms = job->query.terms;
+    for (const QString &term : std::as_const(job->rawTerms)) {
+        const QString folded = term.toCaseFolded();
+        if (!job->terms.contains(folded)) {
+            job->terms.append(folded);
+        }
+    }
+    if (job->query.isEmpty()) {
+        return;
+    }
+    // 最长的词最少命中，用它做整段扫描，其余词只在命中文档内复查
+    std::stable_sort(job->terms.begin(), job->terms.end(),
+                     [](const QString &a, const QString &b) { return a.size() > b.size(); });
+
+    job->modelVersion = m_modelVersion;
+    job->pinyinIndex = m_pinyin;
+    if (m_index && m_index->version == m_modelVersion && m_pinyin) {
+        job->index = m_index;
+        // 拼音只认音节起点，kh 的命中未必命中 h，所以拼音词只有前缀延长才能收窄
+        const bool narrows = !m_lastTerms.isEmpty() && job->query.filterKey() == m_lastFilterKey
+            && std::all_of(m_lastTerms.cbegin(), m_lastTerms.cend(), [&](const QString &previous) {
+                   const bool pinyin = PinyinIndex::isQuery(previous);
+                   return std::any_of(job->terms.cbegin(), job->terms.cend(), [&](const QString &term) {
+                       return pinyin ? term.startsWith(previous) : term.contains(previous);
+                   });
+               });
+        if (narrows) {
+            job->narrowed = true;
+            job->candidates = m_lastMatches;
+        }
+    } else {
+        job->folders = std::exchange(m_pendingFolders, {});
+    }
+    m_pendingFolders.clear();
+
+    m_pool.start([this, job]() {
+        if (job->generation != m_generation) {
+            return;
+        }
+        if (!job->index) {
+            job->index = buildIndex(job->folders, job->modelVersion);
+            if (!job->pinyinIndex) {
+                // 拼音索引与 arena 取自同一份快照；在此之后的单项改动会让版本对不上，交回时不采用
+                auto pinyin = std::make_shared<PinyinIndex>();
+                pinyin->reset(job->folders);
+                job->pinyinIndex = pinyin;
+            }
+            job->folders.clear();
+            // 即便本次查询随后被取消，新索引也留给下一次查询复用
+            QMetaObject::invokeMethod(this, [this, index = job->index, pinyin = job->pinyinIndex]() {
+                if (index->version != m_modelVersion) {
+                    return;
+                }
+                if (!m_index || m_index->version != m_modelVersion) {
+                    m_index = index;
+                }
+                if (!m_pinyin) {
+                    m_pinyin = pinyin;
+                }
+            }, Qt::QueuedConnection);
+        }
+        job->pinyin.resize(size_t(job->terms.size()));
+        for (qsizetype t = 0; t < job->terms.size(); ++t) {
+            if (!PinyinIndex::isQuery(job->terms.at(t))) {
+                continue;
+            }
+            for (const PinyinIndex::Match &match : job->pinyinIndex->match(job->terms.at(t))) {
+                const auto doc = job->index->docOf.constFind(match.itemId);
+                if (doc != job->index->docOf.constEnd()) {
+                    job->pinyin[size_t(t)].insert(doc.value(), match.inTitle);
+                }
+            }
+        }
+        if (job->query.hasFilters() && !job->narrowed) {
+            job->candidates = plan(*job->index, job->query, nullptr);
+            job->narrowed = true;
+        }
+        const qsizetype work = job->narrowed ? job->candidates.size() : qsizetype(job->index->docs.size());
+        job->chunkCount = int(qBound<qsizetype>(1, work / kMinChunkDocs, m_pool.maxThreadCount()));
+        job->partial.resize(size_t(job->chunkCount));
+        job->remaining = job->chunkCount;
+        for (int chunk = 1; chunk < job->chunkCount; ++chunk) {
+            m_pool.start([this, job, chunk]() { runChunk(job, chunk); });
+        }
+        runChunk(job, 0);
+    });
+}
+
+std::shared_ptr<const SearchEngine::Index> SearchEngine::buildIndex(const QList<TodoFolder> &folders, int version)
+{
+    auto index = std::make_shared<Index>();
+    index->version = version;
+    index->folders = folders;
+
+    qsizetype units = 0;
+    qsizetype count = 0;
+    for (const TodoFolder &folder : folders) {
+        for (const TodoItem &item : folder.getItems()) {
+            units += item.getTitle().size() + item.getDetails().size() + 16;
+            ++count;
+        }
+    }
+    index->arena.reserve(units);
+    index->docs.reserve(size_t(count));
+    index->docOf.reserve(count);
+
+    index->folderBegin.reserve(size_t(folders.size()) + 1);
+    index->byDue.reserve(size_t(count));
+
+    QString &arena = index->arena;
+    for (qsizetype f = 0; f < folders.size(); ++f) {
+        index->folderBegin.push_back(quint32(index->docs.size()));
+        const QList<TodoItem> items = folders.at(f).getItems();
+        for (qsizetype i = 0; i < items.size(); ++i) {
+            const TodoItem &item = items.at(i);
+            const quint32 d = quint32(index->docs.size());
+            Index::Doc doc;
+            doc.begin = quint32(arena.size());
+            arena += item.getTitle().toCaseFolded();
+            doc.titleEnd = quint32(arena.size());
+            arena += kFieldSeparator;
+            arena += item.getTags().join(QChar(kFieldSeparator)).toCaseFolded();
+            doc.tagsEnd = quint32(arena.size());
+            arena += kFieldSeparator;
+            arena += item.getDetails().toCaseFolded();
+            doc.end = quint32(arena.size());
+            arena += kDocSeparator;
+            doc.folder = quint32(f);
+            doc.item = quint32(i);
+            doc.priority = quint8(qBound(0, item.getPriority(), 2));
+            doc.pinned = item.isPinned();
+            index->docOf.insert(item.getId(), d);
+            index->docs.push_back(doc);
+
+            for (const QString &tag : item.getTags()) {
+                QList<quint32> &posting = index->docsByTag[tag.toCaseFolded()];
+                if (posting.isEmpty() || posting.last() != d) {
+                    posting.append(d);
+                }
+            }
+            const QDate due = item.getDueDate();
+            index->byDue.emplace_back(due.isValid() ? qint32(due.toJulianDay()) : kNoDay, d);
+            (item.isCompleted() ? index->doneDocs : index->openDocs).append(d);
+        }
+    }
+    index->folderBegin.push_back(quint32(index->docs.size()));
+    std::sort(index->byDue.begin(), index->byDue.end());
+    return index;
+}
+
+QList<quint32> SearchEngine::plan(const Index &index, const SearchQuery &query, QString *explain)
+{
+    // 每个有索引的谓词给出一张升序文档表，从最短的开始依次求交
+    struct Source {
+        QString name;
+        QList<quint32> docs;
+    };
+    QList<Source> sources;
+
+    for (const QString &tag : query.tags) {
+        sources.append({QStringLiteral("tag:") + tag, index.docsByTag.value(tag.toCaseFolded())});
+    }
+    if (!query.folders.isEmpty()) {
+        QList<quint32> docs;
+        for (qsizetype f = 0; f < index.folders.size(); ++f) {
+            const QString name = index.folders.at(f).getName();
+            const bool wanted = std::any_of(query.folders.cbegin(), query.folders.cend(), [&](const QString &part) {
+                return name.contains(part, Qt::CaseInsensitive);
+            });
+            for (quint32 d = index.folderBegin[size_t(f)]; wanted && d < index.folderBegin[size_t(f) + 1]; ++d) {
+                docs.append(d);
+            }
+        }
+        sources.append({QStringLiteral("folder"), docs});
+    }
+    if (query.dueFilter) {
+        qint32 from = kNoDay;
+        qint32 to = kNoDay;
+        if (!query.dueNone) {
+            from = query.dueFrom.isValid() ? qint32(query.dueFrom.toJulianDay()) : kNoDay + 1;
+            to = query.dueTo.isValid() ? qint32(query.dueTo.toJulianDay()) : std::numeric_limits<qint32>::max();
+        }
+        QList<quint32> docs;
+        auto it = std::lower_bound(index.byDue.cbegin(), index.byDue.cend(), std::make_pair(from, quint32(0)));
+        for (; it != index.byDue.cend() && it->first <= to; ++it) {
+            docs.append(it->second);
+        }
+        std::sort(docs.begin(), docs.end());
+        sources.append({QStringLiteral("due"), docs});
+    }
+    if (query.status != SearchQuery::Status::Any) {
+        const bool open = query.status == SearchQuery::Status::Open;
+        sources.append({open ? QStringLiteral("is:open") : QStringLiteral("is:done"),
+                        open ? index.openDocs : index.doneDocs});
+    }
+
+    QList<quint32> result;
+    QStringList steps;
+    if (sources.isEmpty()) {
+        result.resize(qsizetype(index.docs.size()));
+        std::iota(result.begin(), result.end(), quint32(0));
+    } else {
+        std::sort(sources.begin(), sources.end(),
+                  [](const Source &a, const Source &b) { return a.docs.size() < b.docs.size(); });
+        result = sources.constFirst().docs;
+        for (qsizetype i = 0; i < sources.size(); ++i) {
+            const Source &source = sources.at(i);
+            if (i > 0) {
+                QList<quint32> next;
+                next.reserve(qMin(result.size(), source.docs.size()));
+                std::set_intersection(result.cbegin(), result.cend(), source.docs.cbegin(), source.docs.cend(),
+                                      std::back_inserter(next));
+                result = std::move(next);
+            }
+            steps.append(QStringLiteral("%1[%2]").arg(source.name).arg(source.docs.size()));
+        }
+    }
+
+    // 优先级、置顶没有索引，在候选里逐个判断
+    const bool residual = query.pinnedOnly || query.minPriority > 0 || query.maxPriority < 2;
+    if (residual) {
+        result.removeIf([&](quint32 d) {
+            const Index::Doc &doc = index.docs[d];
+            return (query.pinnedOnly && !doc.pinned) || doc.priority < query.minPriority
+                || doc.priority > query.maxPriority;
+        });
+        steps.append(QStringLiteral("filter"));
+    }
+    if (explain) {
+        *explain = QStringLiteral("%1 -> %2 candidates").arg(steps.join(QStringLiteral(" & "))).arg(result.size());
+    }
+    return result;
+}
+
+void SearchEngine::runChunk(const std::shared_ptr<Job> &job, int chunk)
+{
+    const Index &index = *job->index;
+    QList<quint32> &out = job->partial[size_t(chunk)];
+    constexpr int kCancelCheckEvery = 1024;
+
+    if (job->narrowed) {
+        const qsizetype total = job->candidates.size();
+        const qsizetype begin = total * chunk / job->chunkCount;
+        const qsizetype end = total * (chunk + 1) / job->chunkCount;
+        for (qsizetype c = begin; c < end; ++c) {
+            if ((c - begin) % kCancelCheckEvery == 0 && job->generation != m_generation) {
+                return;
+            }
+            const quint32 d = job->candidates.at(c);
+            if ((job->terms.isEmpty() || job->matchesTerm(d, 0)) && job->matchesRest(d)) {
+                out.append(d);
+            }
+        }
+    } else {
+        const QString &primary = job->terms.first();
+        const auto *needle = reinterpret_cast<const char16_t *>(primary.utf16());
+        const size_t total = index.docs.size();
+        const size_t first = total * size_t(chunk) / size_t(job->chunkCount);
+        const size_t last = total * size_t(chunk + 1) / size_t(job->chunkCount);
+        if (first < last) {
+            // 整段 arena 连续扫描；命中位置二分定位到文档后，直接跳到该文档末尾继续
+            const char16_t *units = index.units();
+            quint32 pos = index.docs[first].begin;
+            const quint32 end = index.docs[last - 1].end;
+            const auto docsBegin = index.docs.begin() + qsizetype(first);
+            const auto docsEnd = index.docs.begin() + qsizetype(last);
+            int scanned = 0;
+            while (pos < end) {
+                if (++scanned % kCancelCheckEvery == 0 && job->generation != m_generation) {
+                    return;
+                }
+                const qsizetype at = SimdFind::findUnits(units + pos, end - pos, needle, primary.size());
+                if (at < 0) {
+                    break;
+                }
+                const quint32 hit = pos + quint32(at);
+                const auto doc = std::upper_bound(docsBegin, docsEnd, hit,
+                                                  [](quint32 value, const Index::Doc &d) { return value < d.begin; }) - 1;
+                const quint32 d = quint32(doc - index.docs.begin());
+                if (job->matchesRest(d)) {
+                    out.append(d);
+                }
+                pos = doc->end + 1;
+            }
+        }
+    }
+
+    if (--job->remaining == 0) {
+        finishJob(job);
+    }
+}
+
+void SearchEngine::finishJob(const std::shared_ptr<Job> &job)
+{
+    if (job->generation != m_generation) {
+        return;
+    }
+    const Index &index = *job->index;
+    for (const QList<quint32> &part : job->partial) {
+        job->matches.append(part);
+    }
+    job->partial.clear();
+
+    // 主词只按拼音命中的文档不在扫描结果里，补进来后恢复模型顺序
+    static const QHash<quint32, bool> kNoPinyin;
+    const QHash<quint32, bool> &primaryPinyin = job->pinyin.empty() ? kNoPinyin : job->pinyin.front();
+    if (!primaryPinyin.isEmpty()) {
+        const QSet<quint32> found(job->matches.cbegin(), job->matches.cend());
+        const QSet<quint32> allowed = job->narrowed ? QSet<quint32>(job->candidates.cbegin(), job->candidates.cend())
+                                                    : QSet<quint32>();
+        const qsizetype scanned = job->matches.size();
+        for (auto it = primaryPinyin.cbegin(); it != primaryPinyin.cend(); ++it) {
+            if (!found.contains(it.key()) && (!job->narrowed || allowed.contains(it.key()))
+                && job->matchesRest(it.key())) {
+                job->matches.append(it.key());
+            }
+        }
+        if (job->matches.size() > scanned) {
+            std::sort(job->matches.begin(), job->matches.end());
+        }
+    }
+
+    // 相关度：主词命中标题 > 标签 > 详情（拼音命中按所在字段计）；同档内保持模型顺序
+    const QString primary = job->terms.value(0);
+    auto rank = [&](quint32 d) {
+        if (primary.isEmpty()) {
+            return 0;                         // 只有过滤条件：保持模型顺序
+        }
+        const Index::Doc &doc = index.docs[d];
+        const auto pinyin = primaryPinyin.constFind(d);
+        if (index.contains(doc.begin, doc.titleEnd, primary)
+            || (pinyin != primaryPinyin.cend() && pinyin.value())) {
+            return 0;
+        }
+        return (index.contains(doc.titleEnd, doc.tagsEnd, primary) || pinyin != primaryPinyin.cend()) ? 1 : 2;
+    };
+    // 文本命中按原词高亮；只靠拼音命中的词，高亮对应的汉字
+    auto mark = [&](const QString &text) {
+        QString marked = markHits(text, job->rawTerms);
+        for (qsizetype t = 0; t < job->terms.size(); ++t) {
+            const QString &term = job->terms.at(t);
+            qsizetype begin = 0;
+            qsizetype length = 0;
+            if (!job->pinyin[size_t(t)].isEmpty() && !text.contains(term, Qt::CaseInsensitive)
+                && PinyinIndex::findSpan(marked, term, &begin, &length)) {
+                marked.insert(begin + length, SearchEngine::kHitEnd);
+                marked.insert(begin, SearchEngine::kHitBegin);
+            }
+        }
+        return marked;
+    };
+    QList<QPair<int, quint32>> ranked;
+    ranked.reserve(job->matches.size());
+    for (quint32 d : std::as_const(job->matches)) {
+        ranked.append({rank(d), d});
+    }
+    const qsizetype shown = qMin<qsizetype>(ranked.size(), kResultLimit);
+    std::partial_sort(ranked.begin(), ranked.begin() + shown, ranked.end());
+
+    job->hits.reserve(shown);
+    for (qsizetype n = 0; n < shown; ++n) {
+        const Index::Doc &doc = index.docs[ranked.at(n).second];
+        const TodoFolder &folder = index.folders.at(doc.folder);
+        const TodoItem item = folder.getItems().at(doc.item);
+
+        SearchEngine::Hit hit;
+        hit.itemId = item.getId();
+        hit.folderId = folder.getId();
+        hit.folderName = folder.getName();
+        hit.title = item.getTitle();
+        hit.markedTitle = mark(hit.title);
+        hit.snippet = ranked.at(n).first == 1
+            ? mark(QLatin1Char('#') + item.getTags().join(QStringLiteral(" #")))
+            : markHits(excerpt(item.getDetails(), job->rawTerms, 40), job->rawTerms);
+        hit.createdTime = item.getCreatedTime();
+        hit.tagColor = item.getTagColor();
+        hit.completed = item.isCompleted();
+        hit.pinned = item.isPinned();
+        hit.priority = item.getPriority();
+        job->hits.append(hit);
+    }
+
+    QMetaObject::invokeMethod(this, [this, job]() { deliver(job); }, Qt::QueuedConnection);
+}
+
+void SearchEngine::deliver(const std::shared_ptr<Job> &job)
+{
+    if (job->generation != m_generation) {
+        return;   // 投递途中又有新查询
+    }
+    if (job->modelVersion == m_modelVersion) {
+        m_index = job->index;
+        m_lastTerms = job->terms;
+        m_lastFilterKey = job->query.filterKey();
+        m_lastMatches = job->matches;
+    }
+    emit resultsReady(job->text, job->hits, int(job->matches.size()));
+}
+
+QString SearchEngine::markHits(const QString &text, const QStringList &terms)
+{
+    QString marked = text;
+    for (const QString &term : terms) {
+        QString next;
+        qsizetype from = 0;
+        qsizetype at = 0;
+        while ((at = marked.indexOf(term, from, Qt::CaseInsensitive)) >= 0) {
+            next += QStringView(marked).mid(from, at - from);
+            next += SearchEngine::kHitBegin + marked.mid(at, term.size()) + SearchEngine::kHitEnd;
+            from = at + term.size();
+        }
+        next += QStringView(marked).mid(from);
+        marked = next;
+    }
+    return marked;
+}
+
+QString SearchEngine::excerpt(const QString &text, const QStringList &terms, int length)
+{
+    // 从第一处命中前几个字开始截取
+    qsizetype first = -1;
+    for (const QString &term : terms) {
+        const qsizetype at = text.indexOf(term, 0, Qt::CaseInsensitive);
+        if (at >= 0 && (first < 0 || at < first)) {
+            first = at;
+        }
+    }
+    const qsizetype start = qMax<qsizetype>(0, first - 8);
+    QString part = text.mid(start, length);
+    part.replace(QLatin1Char('\n'), QLatin1Char(' '));
+    return (start > 0 ? QStringLiteral("…") : QString()) + part;
+}
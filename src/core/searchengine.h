@@ -0,0 +1,99 @@
+#ifndef SEARCHENGINE_H
+#define SEARCHENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include "todofolder.h"
+#include "pinyinindex.h"
+
+class QTimer;
+class SearchQuery;
+
+// 内存全局搜索：全部事项的标题 / 标签 / 详情经 casefold 后依次拼进一块连续的 UTF-16 arena，
+// 查询在线程池上分段并行扫描（SSE2 首尾字符预筛的子串查找）。
+// - 输入防抖：停顿 kDebounceMs 后才真正发起查询
+// - 取消：每次新查询递增代数，旧查询的分段任务发现代数变化即放弃，结果也不再投递
+// - 增量收窄：新查询的每个词都包含上一次某个词时，只在上次的命中里复查
+// - 拼音：纯字母的查询词还会按拼音 / 首字母匹配含汉字的标题与标签（见 PinyinIndex）
+// - 过滤：查询按 SearchQuery 的语法解析，标签 / 文件夹 / 截止日期 / 完成状态由 arena 旁的
+//   内存索引求交得到候选，文本词只在候选里扫描
+// 模型变化后调用 invalidate()，下一次查询在后台线程重建 arena；拼音索引随单个事项增量更新，
+// 因此单项改动走 itemChanged / itemsRemoved，整体替换模型时走 resetModel：它只作废拼音索引，
+// 由下一次查询在线程池里随 arena 一起从同一份快照重建，GUI 线程上不做整表工作。
+class SearchEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 搜索结果：命中片段在 markedTitle / snippet 中以 kHitBegin … kHitEnd 包围
+    static constexpr char16_t kHitBegin = 0x02;
+    static constexpr char16_t kHitEnd = 0x03;
+    struct Hit {
+        QString itemId;
+        QString folderId;
+        QString folderName;
+        QString title;
+        QString markedTitle;
+        QString snippet;                     // 详情中命中最集中的一段
+        QDateTime createdTime;
+        QString tagColor;
+        bool completed = false;
+        bool pinned = false;
+        int priority = 0;
+    };
+
+    explicit SearchEngine(QObject *parent = nullptr);
+    ~SearchEngine() override;
+
+    // folders 按值传入（隐式共享，近乎零拷贝），后台线程只读这份快照
+    void search(const QList<TodoFolder> &folders, const QString &text);
+    void cancel();
+    void invalidate();
+    void resetModel();
+    void itemChanged(const TodoItem &item);
+    void itemsRemoved(const QStringList &itemIds);
+
+    // 高亮与摘要：命中片段以 kHitBegin … kHitEnd 包围（大小写不敏感）
+    static QString markHits(const QString &text, const QStringList &terms);
+    static QString excerpt(const QString &text, const QStringList &terms, int length);
+
+signals:
+    // hits 已按相关度排好并截断到上限；total 为全部命中数
+    void resultsReady(const QString &text, const QList<SearchEngine::Hit> &hits, int total);
+
+private:
+    friend class tst_SearchQuery;            // 直接检验 buildIndex / plan
+    friend class tst_SearchEngine;           // 基准绕过输入防抖
+
+    struct Index;
+    struct Job;
+
+    void dispatch();
+    void runChunk(const std::shared_ptr<Job> &job, int chunk);          // 线程池内执行
+    void finishJob(const std::shared_ptr<Job> &job);                    // 最后一个分段完成后执行
+    void deliver(const std::shared_ptr<Job> &job);                      // GUI 线程
+    static std::shared_ptr<const Index> buildIndex(const QList<TodoFolder> &folders, int version);
+    // explain 非空时写入求交顺序与候选数，如 "tag:x[3] & is:open[40] -> 2 candidates"
+    static QList<quint32> plan(const Index &index, const SearchQuery &query, QString *explain);
+
+    QThreadPool m_pool;
+    QTimer *m_debounce = nullptr;
+    std::atomic<quint64> m_generation{0};
+
+    // 以下只在 GUI 线程访问
+    QList<TodoFolder> m_pendingFolders;
+    QString m_pendingText;
+    int m_modelVersion = 0;
+    std::shared_ptr<const Index> m_index;     // 与 m_modelVersion 一致时可直接复用
+    std::shared_ptr<PinyinIndex> m_pinyin;    // 空 = 待重建；自带读写锁，线程池内查询、GUI 线程增量更新
+    QStringList m_lastTerms;                  // 上一次已完成查询（casefold 后）
+    QString m_lastFilterKey;                  // 及其过滤条件（SearchQuery::filterKey）
+    QList<quint32> m_lastMatches;             // 及其全部命中（文档下标，未截断）
+};
+
+#endif // SEARCHENGINE_H
@@ -0,0 +1,243 @@
+#include "searchquery.h"
+
+#include <QRegularExpression>
+
+namespace {
+struct Token {
+    QString raw;                         // 原样文本（过滤条件无效时按文本词处理）
+    QString key;                         // key:value 的 key，已转小写；没有时为空
+    QString value;
+    bool quoted = false;
+};
+
+// 按空白切分，引号内的空白保留；第一个未加引号的冒号把 token 分成 key 与 value
+QList<Token> tokenize(const QString &text)
+{
+    QList<Token> tokens;
+    Token current;
+    QString part;
+    bool inQuote = false;
+    bool open = false;
+    auto finish = [&]() {
+        if (open) {
+            current.value = part;
+            if (!current.value.isEmpty() || !current.key.isEmpty() || current.quoted) {
+                tokens.append(current);
+            }
+        }
+        current = Token();
+        part.clear();
+        open = false;
+    };
+    for (const QChar ch : text) {
+        if (!inQuote && ch.isSpace()) {
+            finish();
+            continue;
+        }
+        open = true;
+        current.raw += ch;
+        if (ch == QLatin1Char('"')) {
+            inQuote = !inQuote;
+            current.quoted = true;
+        } else if (ch == QLatin1Char(':') && !inQuote && !current.quoted && current.key.isEmpty() && !part.isEmpty()) {
+            current.key = part.toLower();
+            part.clear();
+        } else {
+            part += ch;
+        }
+    }
+    finish();
+    return tokens;
+}
+
+bool oneOf(const QString &text, std::initializer_list<const char16_t *> names)
+{
+    for (const char16_t *name : names) {
+        if (QStringView(text) == QStringView(name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 开头的比较符：< <= > >= =，没有时返回空
+QString takeComparator(QString *value)
+{
+    static const QRegularExpression re(QStringLiteral("^(<=|>=|<|>|=)"));
+    const QRegularExpressionMatch match = re.match(*value);
+    if (!match.hasMatch()) {
+        return QString();
+    }
+    value->remove(0, match.capturedLength());
+    return match.captured(1);
+}
+
+bool parseDue(QString value, const QDate &today, SearchQuery *query)
+{
+    value = value.toLower();
+    QDate from;
+    QDate to;
+    if (oneOf(value, {u"none", u"无"})) {
+        query->dueFilter = true;
+        query->dueNone = true;
+        return true;
+    } else if (oneOf(value, {u"today", u"今天"})) {
+        from = to = today;
+    } else if (oneOf(value, {u"tomorrow", u"明天"})) {
+        from = to = today.addDays(1);
+    } else if (oneOf(value, {u"overdue", u"逾期"})) {
+        to = today.addDays(-1);
+    } else if (oneOf(value, {u"week", u"本周"})) {
+        from = today;
+        to = today.addDays(7 - today.dayOfWeek());
+    } else {
+        const QString op = takeComparator(&value);
+        static const QRegularExpression relative(QStringLiteral("^(\\d{1,4})([dw])$"));
+        const QRegularExpressionMatch match = relative.match(value);
+        QDate date;
+        if (match.hasMatch()) {
+            const int days = match.captured(1).toInt() * (match.captured(2) == QLatin1String("w") ? 7 : 1);
+            date = today.addDays(days);
+        } else {
+            date = QDate::fromString(value, Qt::ISODate);
+        }
+        if (!date.isValid()) {
+            return false;
+        }
+        if (op == QLatin1String("<")) {
+            to = date.addDays(-1);
+        } else if (op == QLatin1String("<=")) {
+            to = date;
+        } else if (op == QLatin1String(">")) {
+            from = date.addDays(1);
+        } else if (op == QLatin1String(">=")) {
+            from = date;
+        } else if (match.hasMatch() && op.isEmpty()) {
+            from = today;                // due:7d = 从今天起 7 天内
+            to = date;
+        } else {
+            from = to = date;
+        }
+    }
+    // 多个 due 条件取交集
+    query->dueFilter = true;
+    if (from.isValid() && (!query->dueFrom.isValid() || from > query->dueFrom)) {
+        query->dueFrom = from;
+    }
+    if (to.isValid() && (!query->dueTo.isValid() || to < query->dueTo)) {
+        query->dueTo = to;
+    }
+    return true;
+}
+
+bool parsePriority(QString value, SearchQuery *query)
+{
+    value = value.toLower();
+    const QString op = takeComparator(&value);
+    int level = -1;
+    if (oneOf(value, {u"high", u"高", u"2"})) {
+        level = 2;
+    } else if (oneOf(value, {u"medium", u"mid", u"中", u"1"})) {
+        level = 1;
+    } else if (oneOf(value, {u"low", u"低", u"0"})) {
+        level = 0;
+    }
+    if (level < 0) {
+        return false;
+    }
+    int low = level;
+    int high = level;
+    if (op == QLatin1String("<")) {
+        low = 0;
+        high = level - 1;
+    } else if (op == QLatin1String("<=")) {
+        low = 0;
+    } else if (op == QLatin1String(">")) {
+        low = level + 1;
+        high = 2;
+    } else if (op == QLatin1String(">=")) {
+        high = 2;
+    }
+    query->minPriority = qMax(query->minPriority, low);
+    query->maxPriority = qMin(query->maxPriority, high);
+    return true;
+}
+
+bool parseIs(const QString &value, SearchQuery *query)
+{
+    const QString v = value.toLower();
+    if (oneOf(v, {u"open", u"todo", u"未完成"})) {
+        query->status = SearchQuery::Status::Open;
+    } else if (oneOf(v, {u"done", u"completed", u"已完成"})) {
+        query->status = SearchQuery::Status::Done;
+    } else if (oneOf(v, {u"pinned", u"置顶"})) {
+        query->pinnedOnly = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+}
+
+SearchQuery SearchQuery::parse(const QString &text, const QDate &today)
+{
+    SearchQuery query;
+    for (const Token &token : tokenize(text)) {
+        const QString &key = token.key;
+        bool filter = false;
+        if (key.isEmpty()) {
+            if (!token.quoted && token.value.size() > 1 && token.value.startsWith(QLatin1Char('#'))) {
+                query.tags.append(token.value.mid(1));
+                filter = true;
+            }
+        } else if (token.value.isEmpty()) {
+            // 刚敲完 key: 还没写值，先不参与查询
+            filter = oneOf(key, {u"tag", u"标签", u"folder", u"in", u"文件夹", u"due", u"截止",
+                                 u"priority", u"p", u"优先级", u"is", u"状态"});
+        } else {
+            if (oneOf(key, {u"tag", u"标签"})) {
+                query.tags.append(token.value);
+                filter = true;
+            } else if (oneOf(key, {u"folder", u"in", u"文件夹"})) {
+                query.folders.append(token.value);
+                filter = true;
+            } else if (oneOf(key, {u"due", u"截止"})) {
+                filter = parseDue(token.value, today, &query);
+            } else if (oneOf(key, {u"priority", u"p", u"优先级"})) {
+                filter = parsePriority(token.value, &query);
+            } else if (oneOf(key, {u"is", u"状态"})) {
+                filter = parseIs(token.value, &query);
+            }
+        }
+        if (!filter) {
+            QString term = token.quoted && key.isEmpty() ? token.value : token.raw;
+            term = term.simplified();
+            if (!term.isEmpty() && !query.terms.contains(term)) {
+                query.terms.append(term);
+            }
+        }
+    }
+    return query;
+}
+
+bool SearchQuery::hasFilters() const
+{
+    return !tags.isEmpty() || !folders.isEmpty() || status != Status::Any || pinnedOnly
+        || minPriority > 0 || maxPriority < 2 || dueFilter;
+}
+
+QString SearchQuery::filterKey() const
+{
+    if (!hasFilters()) {
+        return QString();
+    }
+    QStringList sortedTags = tags;
+    sortedTags.sort(Qt::CaseInsensitive);
+    QStringList sortedFolders = folders;
+    sortedFolders.sort(Qt::CaseInsensitive);
+    return QStringLiteral("t=%1;f=%2;s=%3;p=%4;pr=%5-%6;d=%7:%8:%9")
+        .arg(sortedTags.join(QChar(0x01)).toCaseFolded(), sortedFolders.join(QChar(0x01)).toCaseFolded())
+        .arg(int(status)).arg(int(pinnedOnly)).arg(minPriority).arg(maxPriority)
+        .arg(dueFilter ? (dueNone ? QStringLiteral("none") : QStringLiteral("range")) : QString(),
+             dueFrom.toString(Qt::ISODate), dueTo.toString(Qt::ISODate));
+}
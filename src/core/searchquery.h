@@ -0,0 +1,44 @@
+#ifndef SEARCHQUERY_H
+#define SEARCHQUERY_H
+
+#include <QString>
+#include <QStringList>
+#include <QDate>
+
+// 搜索框的查询语言，解析成一组谓词交给 SearchEngine 规划执行：
+//   tag:工作  #工作                 带该标签（可写多个，需全部满足）
+//   folder:项目A                    所在文件夹名包含该词（写多个时满足任一）
+//   due:today | tomorrow | overdue | week | none
+//   due:<7d  due:>=2w  due:2026-10-20  due:<=2026-10-20
+//   priority:high | medium | low（高 / 中 / 低 / 0–2），可带 < <= > >= 比较
+//   is:open | done | pinned（未完成 / 已完成 / 置顶）
+//   "exact phrase"                  含空格的短语整体作为一个文本词
+// 值里有空格时加引号：folder:"项目 A"。其余都是自由文本词；
+// 写到一半或写错的过滤条件按普通文本处理，不会让结果突然清空。
+class SearchQuery
+{
+public:
+    enum class Status { Any, Open, Done };
+
+    QStringList terms;                   // 自由文本词与短语（原文，高亮用）
+    QStringList tags;
+    QStringList folders;
+    Status status = Status::Any;
+    bool pinnedOnly = false;
+    int minPriority = 0;
+    int maxPriority = 2;
+    bool dueFilter = false;
+    bool dueNone = false;                // 只要没有截止日期的
+    QDate dueFrom;                       // 闭区间，无效值表示该端不限
+    QDate dueTo;
+
+    // today 决定 due:<7d 等相对写法的基准日
+    static SearchQuery parse(const QString &text, const QDate &today);
+
+    bool hasFilters() const;
+    bool isEmpty() const { return terms.isEmpty() && !hasFilters(); }
+    // 过滤条件的规范写法：两次查询相同时，上一次的命中可以直接作为候选
+    QString filterKey() const;
+};
+
+#endif // SEARCHQUERY_H
@@ -0,0 +1,83 @@
+#ifndef SIMDFIND_H
+#define SIMDFIND_H
+
+#include <QtGlobal>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMDFIND_USE_SSE2
+#endif
+
+// 子串查找内核：在 [hay, hay + n) 中查找 needle[0, m)，返回下标或 -1。
+// SSE2：一次比较一整个寄存器宽度的首字符与末字符，两者都相等的位置再逐段比较中间部分
+namespace SimdFind {
+
+inline qsizetype findUnits(const char16_t *hay, qsizetype n, const char16_t *needle, qsizetype m)
+{
+    if (m == 0) {
+        return 0;
+    }
+    qsizetype i = 0;
+#ifdef SIMDFIND_USE_SSE2
+    const __m128i first = _mm_set1_epi16(short(needle[0]));
+    const __m128i last = _mm_set1_epi16(short(needle[m - 1]));
+    for (; i + m - 1 + 8 <= n; i += 8) {
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i + m - 1));
+        uint mask = uint(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(head, first),
+                                                         _mm_cmpeq_epi16(tail, last))));
+        while (mask) {
+            const qsizetype pos = i + qCountTrailingZeroBits(mask) / 2;   // 每个 16 位通道占 2 个掩码位
+            if (m <= 2 || std::memcmp(hay + pos + 1, needle + 1, size_t(m - 2) * sizeof(char16_t)) == 0) {
+                return pos;
+            }
+            mask &= mask - 1;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + m <= n; ++i) {
+        if (hay[i] == needle[0] && hay[i + m - 1] == needle[m - 1]
+            && std::memcmp(hay + i, needle, size_t(m) * sizeof(char16_t)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+inline qsizetype findBytes(const char *hay, qsizetype n, const char *needle, qsizetype m)
+{
+    if (m == 0) {
+        return 0;
+    }
+    qsizetype i = 0;
+#ifdef SIMDFIND_USE_SSE2
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i + m - 1));
+        uint mask = uint(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first),
+                                                         _mm_cmpeq_epi8(tail, last))));
+        while (mask) {
+            const qsizetype pos = i + qCountTrailingZeroBits(mask);
+            if (m <= 2 || std::memcmp(hay + pos + 1, needle + 1, size_t(m - 2)) == 0) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + m <= n; ++i) {
+        if (hay[i] == needle[0] && hay[i + m - 1] == needle[m - 1]
+            && std::memcmp(hay + i, needle, size_t(m)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+}
+
+#endif // SIMDFIND_H
@@ -0,0 +1,99 @@
+#include "stringpool.h"
+
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace {
+struct Pool {
+    QReadWriteLock lock;
+    QHash<QString, quint32> ids;
+    QList<QString> strings{QString()};          // 编号 0 = 空串
+    qsizetype bytes = 0;
+};
+
+Pool &pool()
+{
+    static Pool instance;
+    return instance;
+}
+}
+
+quint32 StringPool::intern(const QString &text)
+{
+    if (text.isEmpty()) {
+        return 0;
+    }
+    Pool &p = pool();
+    {
+        QReadLocker locker(&p.lock);
+        const auto it = p.ids.constFind(text);
+        if (it != p.ids.cend()) {
+            return it.value();
+        }
+    }
+    QWriteLocker locker(&p.lock);
+    const auto it = p.ids.constFind(text);     // 两次加锁之间可能已被别的线程插入
+    if (it != p.ids.cend()) {
+        return it.value();
+    }
+    const quint32 id = quint32(p.strings.size());
+    p.strings.append(text);
+    p.ids.insert(text, id);
+    p.bytes += qsizetype(sizeof(char16_t)) * (text.size() + 1) + 16;
+    return id;
+}
+
+bool StringPool::find(const QString &text, quint32 *id)
+{
+    if (text.isEmpty()) {
+        *id = 0;
+        return true;
+    }
+    Pool &p = pool();
+    QReadLocker locker(&p.lock);
+    const auto it = p.ids.constFind(text);
+    if (it == p.ids.cend()) {
+        return false;
+    }
+    *id = it.value();
+    return true;
+}
+
+QString StringPool::string(quint32 id)
+{
+    Pool &p = pool();
+    QReadLocker locker(&p.lock);
+    return id < quint32(p.strings.size()) ? p.strings.at(id) : QString();
+}
+
+QStringList StringPool::strings(const quint32 *ids, qsizetype count)
+{
+    QStringList result;
+    if (count == 0) {
+        return result;
+    }
+    result.reserve(count);
+    Pool &p = pool();
+    QReadLocker locker(&p.lock);
+    for (qsizetype i = 0; i < count; ++i) {
+        result.append(ids[i] < quint32(p.strings.size()) ? p.strings.at(ids[i]) : QString());
+    }
+    return result;
+}
+
+qsizetype StringPool::size()
+{
+    Pool &p = pool();
+    QReadLocker locker(&p.lock);
+    return p.strings.size() - 1;
+}
+
+qsizetype StringPool::bytes()
+{
+    Pool &p = pool();
+    QReadLocker locker(&p.lock);
+    return p.bytes;
+}
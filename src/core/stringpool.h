@@ -0,0 +1,21 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QString>
+#include <QStringList>
+
+// 进程级字符串驻留池：标签名、文件夹 id、非规范写法的颜色这类在大量事项间重复的短串只存一份，
+// 事项里只保存 32 位编号。只增不减（这些串的种类很少），任意线程均可调用；
+// 每个事项各不相同的串（如旧 id）不要放进来。
+namespace StringPool {
+
+quint32 intern(const QString &text);                 // 空串恒为 0
+bool find(const QString &text, quint32 *id);        // 只查不插入
+QString string(quint32 id);
+QStringList strings(const quint32 *ids, qsizetype count);   // 一次加锁取多个
+qsizetype size();
+qsizetype bytes();                                   // 池内字符串占用的堆内存（估算）
+
+}
+
+#endif // STRINGPOOL_H
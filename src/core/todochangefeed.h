@@ -0,0 +1,46 @@
+#ifndef TODOCHANGEFEED_H
+#define TODOCHANGEFEED_H
+
+#include <QObject>
+#include <QString>
+#include "todoitem.h"
+#include "todofolder.h"
+
+// 模型变更通知：TodoStore 每次修改后在 GUI 线程同步发出，视图订阅后只处理与自己有关的增量。
+// 信号里的事项引用指向仓库内的对象，只在槽函数执行期间有效；槽函数里不要再修改仓库。
+// 成批变化（整体替换、删除文件夹）只发 modelReset，视图整体重建。
+class TodoChangeFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    // itemChanged 携带的改动字段，由修改方声明
+    enum Field {
+        Title     = 0x001,
+        Details   = 0x002,
+        Completed = 0x004,
+        Pinned    = 0x008,
+        Priority  = 0x010,
+        Color     = 0x020,
+        Tags      = 0x040,
+        Dates     = 0x080,                   // 计划日期、截止日期
+        Reminder  = 0x100,
+        AllFields = 0x1FF
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+    Q_FLAG(Fields)
+
+    using QObject::QObject;
+
+signals:
+    void itemAdded(const TodoItem &item);
+    void itemChanged(const TodoItem &item, TodoChangeFeed::Fields fields);
+    void itemMoved(const TodoItem &item, const QString &fromFolderId);
+    void itemRemoved(const TodoItem &item);                 // 已移出仓库的副本
+    void folderChanged(const TodoFolder &folder);           // 新建、改名、置顶、颜色
+    void modelReset();
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(TodoChangeFeed::Fields)
+
+#endif // TODOCHANGEFEED_H
@@ -31,6 +31,7 @@ public:
     void setColor(const QString &color) { m_color = color; }
     void setId(const QString &id) { m_id = id; }
     void setCreatedTime(const QDateTime &time) { m_createdTime = time; }
+    void setItems(const QList<TodoItem> &items) { m_items = items; }
     
     void addItem(const TodoItem &item);
     void removeItem(const QString &itemId);
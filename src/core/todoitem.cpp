@@ -1,34 +1,46 @@
 #include "todoitem.h"
+#include "stringpool.h"
+
+#include <QColor>
+#include <algorithm>
+
+namespace {
+const QRgb kDefaultColor = qRgb(0x25, 0x63, 0xeb);
+
+// 旧 id 的键所在的名字空间（随意选定，只要固定不变）
+constexpr QUuid kLegacyIdNamespace(0x6c0b1f3a, 0x4e2d, 0x4a7b, 0x9c, 0x1e, 0x2f, 0x8d, 0x41, 0x6a, 0x93, 0x07);
+
+// id 通常是 QUuid 生成的小写无括号串，直接存 128 位。
+// 其他形式（旧数据、外部导入）的 id 原样存在 m_legacyId 里，键取该串的名字型 UUID（v5）：
+// 只由 id 本身算出，不登记任何全局状态，每个事项的旧 id 随事项一起释放
+QUuid keyFor(const QString &id, bool *canonical = nullptr)
+{
+    const QUuid uuid = QUuid::fromString(id);
+    const bool plain = !uuid.isNull() && uuid.toString(QUuid::WithoutBraces) == id;
+    if (canonical) *canonical = plain;
+    return plain ? uuid : QUuid::createUuidV5(kLegacyIdNamespace, id);
+}
+
+qsizetype stringHeap(const QString &text)
+{
+    return text.isEmpty() ? 0 : 16 + (text.capacity() + 1) * qsizetype(sizeof(char16_t));
+}
+}
 
 TodoItem::TodoItem()
-    : m_id(QUuid::createUuid().toString(QUuid::WithoutBraces))
-    , m_title("")
-    , m_details("")
-    , m_createdTime(QDateTime::currentDateTime())
-    , m_updatedTime(QDateTime::currentDateTime())
-    , m_isCompleted(false)
-    , m_folderId("")
-    , m_plannedDate(QDate::currentDate())
-    , m_dueDate(QDate::currentDate())
-    , m_priority(0)
-    , m_tagColor("#2563eb")
-    , m_isPinned(false)
+    : TodoItem(QString())
 {
 }
 
 TodoItem::TodoItem(const QString &title, const QString &details)
-    : m_id(QUuid::createUuid().toString(QUuid::WithoutBraces))
-    , m_title(title)
+    : m_title(title)
     , m_details(details)
-    , m_createdTime(QDateTime::currentDateTime())
-    , m_updatedTime(QDateTime::currentDateTime())
-    , m_isCompleted(false)
-    , m_folderId("")
-    , m_plannedDate(QDate::currentDate())
-    , m_dueDate(QDate::currentDate())
-    , m_priority(0)
-    , m_tagColor("#2563eb")
-    , m_isPinned(false)
+    , m_createdMs(QDateTime::currentMSecsSinceEpoch())
+    , m_updatedMs(m_createdMs)
+    , m_id(QUuid::createUuid())
+    , m_plannedDay(toDay(QDate::currentDate()))
+    , m_dueDay(m_plannedDay)
+    , m_tagColor(kDefaultColor)
 {
 }
 
@@ -37,74 +49,169 @@ TodoItem::TodoItem(const QJsonObject &json)
     fromJson(json);
 }
 
+QString TodoItem::getId() const
+{
+    return m_legacyId.isEmpty() ? m_id.toString(QUuid::WithoutBraces) : m_legacyId;
+}
+
+QUuid TodoItem::keyOf(const QString &id)
+{
+    return keyFor(id);
+}
+
+void TodoItem::setId(const QString &id)
+{
+    bool canonical = false;
+    m_id = keyFor(id, &canonical);
+    m_legacyId = canonical ? QString() : id;
+}
+
+QString TodoItem::getFolderId() const
+{
+    return StringPool::string(m_folderId);
+}
+
+void TodoItem::setFolderId(const QString &folderId)
+{
+    m_folderId = StringPool::intern(folderId);
+}
+
+QStringList TodoItem::getTags() const
+{
+    return StringPool::strings(m_tags.constData(), m_tags.size());
+}
+
+bool TodoItem::hasTag(const QString &tag) const
+{
+    quint32 id = 0;
+    return StringPool::find(tag, &id) && m_tags.contains(id);
+}
+
+void TodoItem::setTags(const QStringList &tags)
+{
+    m_tags.clear();
+    for (const QString &tag : tags) {
+        m_tags.append(StringPool::intern(tag));
+    }
+    touch();
+}
+
+void TodoItem::addTag(const QString &tag)
+{
+    const quint32 id = StringPool::intern(tag);
+    if (!m_tags.contains(id)) {
+        m_tags.append(id);
+        touch();
+    }
+}
+
+void TodoItem::removeTag(const QString &tag)
+{
+    quint32 id = 0;
+    if (StringPool::find(tag, &id)) {
+        m_tags.erase(std::remove(m_tags.begin(), m_tags.end(), id), m_tags.end());
+    }
+    touch();
+}
+
+QString TodoItem::getTagColor() const
+{
+    if (m_tagColorText != 0) {
+        return StringPool::string(m_tagColorText);
+    }
+    return qAlpha(m_tagColor) == 0 ? QString() : QColor(m_tagColor).name();
+}
+
+void TodoItem::setTagColor(const QString &color)
+{
+    // 只有小写 #rrggbb（或空串）能从 QRgb 原样还原；大写、颜色名、带透明度的写法
+    // 另存原串（颜色写法种类很少，驻留进 StringPool），导出时保持原样
+    const QColor parsed(color);
+    m_tagColor = parsed.isValid() ? parsed.rgba() : 0;
+    const QString restored = qAlpha(m_tagColor) == 0 ? QString() : QColor(m_tagColor).name();
+    m_tagColorText = restored == color ? 0 : StringPool::intern(color);
+}
+
 void TodoItem::setCompleted(bool completed)
 {
     m_isCompleted = completed;
-    m_updatedTime = QDateTime::currentDateTime();
-    if (completed && m_completedTime.isNull()) {
-        m_completedTime = QDateTime::currentDateTime();
+    touch();
+    if (completed && m_completedMs == kNoTime) {
+        m_completedMs = m_updatedMs;
     } else if (!completed) {
-        m_completedTime = QDateTime();
+        m_completedMs = kNoTime;
     }
 }
 
+qsizetype TodoItem::footprint() const
+{
+    qsizetype bytes = qsizetype(sizeof(TodoItem)) + stringHeap(m_title) + stringHeap(m_details)
+                      + stringHeap(m_legacyId);
+    if (m_tags.capacity() > 2) {
+        bytes += m_tags.capacity() * qsizetype(sizeof(quint32));
+    }
+    return bytes;
+}
+
 QJsonObject TodoItem::toJson() const
 {
     QJsonObject json;
-    json["id"] = m_id;
+    json["id"] = getId();
     json["title"] = m_title;
     json["details"] = m_details;
-    json["createdTime"] = m_createdTime.toString(Qt::ISODate);
-    json["completedTime"] = m_completedTime.toString(Qt::ISODate);
-    json["updatedTime"] = m_updatedTime.toString(Qt::ISODate);
+    json["createdTime"] = getCreatedTime().toString(Qt::ISODate);
+    json["completedTime"] = getCompletedTime().toString(Qt::ISODate);
+    json["updatedTime"] = getUpdatedTime().toString(Qt::ISODate);
     json["isCompleted"] = m_isCompleted;
-    json["folderId"] = m_folderId;
-    json["plannedDate"] = m_plannedDate.toString(Qt::ISODate);
-    json["dueDate"] = m_dueDate.toString(Qt::ISODate);
-    json["priority"] = m_priority;
-    json["tags"] = QJsonArray::fromStringList(m_tags);
-    json["tagColor"] = m_tagColor;
+    json["folderId"] = getFolderId();
+    json["plannedDate"] = getPlannedDate().toString(Qt::ISODate);
+    json["dueDate"] = getDueDate().toString(Qt::ISODate);
+    json["priority"] = int(m_priority);
+    json["tags"] = QJsonArray::fromStringList(getTags());
+    json["tagColor"] = getTagColor();
     json["isPinned"] = m_isPinned;
-    json["remindAt"] = m_remindAt.isValid() ? m_remindAt.toString(Qt::ISODate) : QString();
+    json["remindAt"] = m_remindMs != kNoTime ? getRemindAt().toString(Qt::ISODate) : QString();
     return json;
 }
 
 void TodoItem::fromJson(const QJsonObject &json)
 {
-    m_id = json["id"].toString();
+    const QString id = json["id"].toString();
+    if (id.isEmpty()) {
+        m_id = QUuid::createUuid();
+        m_legacyId.clear();
+    } else {
+        setId(id);
+    }
     m_title = json["title"].toString();
     m_details = json["details"].toString();
-    m_createdTime = QDateTime::fromString(json["createdTime"].toString(), Qt::ISODate);
-    m_completedTime = QDateTime::fromString(json["completedTime"].toString(), Qt::ISODate);
-    m_updatedTime = QDateTime::fromString(json["updatedTime"].toString(), Qt::ISODate);
+    m_createdMs = toMsecs(QDateTime::fromString(json["createdTime"].toString(), Qt::ISODate));
+    m_completedMs = toMsecs(QDateTime::fromString(json["completedTime"].toString(), Qt::ISODate));
+    m_updatedMs = toMsecs(QDateTime::fromString(json["updatedTime"].toString(), Qt::ISODate));
     m_isCompleted = json["isCompleted"].toBool();
-    m_folderId = json["folderId"].toString();
-    m_plannedDate = QDate::fromString(json["plannedDate"].toString(), Qt::ISODate);
-    m_dueDate = QDate::fromString(json["dueDate"].toString(), Qt::ISODate);
-    m_priority = json["priority"].toInt(0);
-    m_tagColor = json["tagColor"].toString("#2563eb");
+    m_folderId = StringPool::intern(json["folderId"].toString());
+    m_plannedDay = toDay(QDate::fromString(json["plannedDate"].toString(), Qt::ISODate));
+    m_dueDay = toDay(QDate::fromString(json["dueDate"].toString(), Qt::ISODate));
+    m_priority = qint8(json["priority"].toInt(0));
+    setTagColor(json["tagColor"].toString("#2563eb"));
     m_isPinned = json["isPinned"].toBool(false);
-    m_remindAt = QDateTime::fromString(json["remindAt"].toString(), Qt::ISODate);
+    m_remindMs = toMsecs(QDateTime::fromString(json["remindAt"].toString(), Qt::ISODate));
     
-    QJsonArray tagsArray = json["tags"].toArray();
+    const QJsonArray tagsArray = json["tags"].toArray();
     m_tags.clear();
     for (const QJsonValue &tag : tagsArray) {
-        m_tags.append(tag.toString());
-    }
-    
-    if (m_id.isEmpty()) {
-        m_id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        m_tags.append(StringPool::intern(tag.toString()));
     }
     
-    if (!m_createdTime.isValid()) {
-        m_createdTime = QDateTime::currentDateTime();
+    if (m_createdMs == kNoTime) {
+        m_createdMs = QDateTime::currentMSecsSinceEpoch();
     }
     
-    if (!m_updatedTime.isValid()) {
-        m_updatedTime = m_createdTime;
+    if (m_updatedMs == kNoTime) {
+        m_updatedMs = m_createdMs;
     }
     
-    if (!m_plannedDate.isValid()) {
-        m_plannedDate = QDate::currentDate();
+    if (m_plannedDay == kNoDay) {
+        m_plannedDay = toDay(QDate::currentDate());
     }
 }
@@ -8,70 +8,98 @@
 #include <QJsonArray>
 #include <QUuid>
 #include <QStringList>
+#include <QVarLengthArray>
+#include <QRgb>
+#include <limits>
 
+// 紧凑布局：id 存 128 位二进制，颜色存 QRgb，标签与文件夹 id 驻留在 StringPool 里只存编号，
+// 日期存儒略日、时间存毫秒时间戳。对外保持原有的 getter / setter 接口，按需还原成 Qt 类型。
 class TodoItem
 {
 public:
+    static constexpr qint64 kNoTime = std::numeric_limits<qint64>::min();
+    static constexpr qint32 kNoDay = std::numeric_limits<qint32>::min();
+
     TodoItem();
     TodoItem(const QString &title, const QString &details = "");
     TodoItem(const QJsonObject &json);
     
-    QString getId() const { return m_id; }
+    QString getId() const;
     QString getTitle() const { return m_title; }
     QString getDetails() const { return m_details; }
-    QDateTime getCreatedTime() const { return m_createdTime; }
-    QDateTime getCompletedTime() const { return m_completedTime; }
-    QDateTime getUpdatedTime() const { return m_updatedTime; }
+    QDateTime getCreatedTime() const { return toDateTime(m_createdMs); }
+    QDateTime getCompletedTime() const { return toDateTime(m_completedMs); }
+    QDateTime getUpdatedTime() const { return toDateTime(m_updatedMs); }
     bool isCompleted() const { return m_isCompleted; }
-    QString getFolderId() const { return m_folderId; }
-    QDate getPlannedDate() const { return m_plannedDate; }
-    QDate getDueDate() const { return m_dueDate; }
+    QString getFolderId() const;
+    QDate getPlannedDate() const { return toDate(m_plannedDay); }
+    QDate getDueDate() const { return toDate(m_dueDay); }
     int getPriority() const { return m_priority; }
-    QStringList getTags() const { return m_tags; }
-    QString getTagColor() const { return m_tagColor; }
+    QStringList getTags() const;
+    bool hasTag(const QString &tag) const;
+    QString getTagColor() const;
     bool isPinned() const { return m_isPinned; }
-    QDateTime getRemindAt() const { return m_remindAt; }       // 无效值 = 不提醒
+    QDateTime getRemindAt() const { return toDateTime(m_remindMs); }       // 无效值 = 不提醒
+
+    // 原始值：哈希键、排序与持久化直接用，省去 QString / QDateTime 的构造
+    QUuid getKey() const { return m_id; }
+    qint64 createdMsecs() const { return m_createdMs; }
+    qint64 updatedMsecs() const { return m_updatedMs; }
+    QRgb getTagRgb() const { return m_tagColor; }
+    // 与 getKey() 对应的键，只由 id 本身算出（不查表、不登记）
+    static QUuid keyOf(const QString &id);
     
-    void setTitle(const QString &title) { m_title = title; m_updatedTime = QDateTime::currentDateTime(); }
-    void setDetails(const QString &details) { m_details = details; m_updatedTime = QDateTime::currentDateTime(); }
+    void setTitle(const QString &title) { m_title = title; touch(); }
+    void setDetails(const QString &details) { m_details = details; touch(); }
     void setCompleted(bool completed);
-    void setFolderId(const QString &folderId) { m_folderId = folderId; }
-    void setPlannedDate(const QDate &date) { m_plannedDate = date; m_updatedTime = QDateTime::currentDateTime(); }
-    void setDueDate(const QDate &date) { m_dueDate = date; m_updatedTime = QDateTime::currentDateTime(); }
-    void setPriority(int priority) { m_priority = priority; m_updatedTime = QDateTime::currentDateTime(); }
-    void setTags(const QStringList &tags) { m_tags = tags; m_updatedTime = QDateTime::currentDateTime(); }
-    void addTag(const QString &tag) { if (!m_tags.contains(tag)) { m_tags.append(tag); m_updatedTime = QDateTime::currentDateTime(); } }
-    void removeTag(const QString &tag) { m_tags.removeAll(tag); m_updatedTime = QDateTime::currentDateTime(); }
-    void setTagColor(const QString &color) { m_tagColor = color; }
-    void setPinned(bool pinned) { m_isPinned = pinned; m_updatedTime = QDateTime::currentDateTime(); }
-    void setId(const QString &id) { m_id = id; }
-    void setCreatedTime(const QDateTime &time) { m_createdTime = time; }
-    void setCompletedTime(const QDateTime &time) { m_completedTime = time; }
-    void setUpdatedTime(const QDateTime &time) { m_updatedTime = time; }
-    void setRemindAt(const QDateTime &time) { m_remindAt = time; }
+    void setFolderId(const QString &folderId);
+    void setPlannedDate(const QDate &date) { m_plannedDay = toDay(date); touch(); }
+    void setDueDate(const QDate &date) { m_dueDay = toDay(date); touch(); }
+    void setPriority(int priority) { m_priority = qint8(priority); touch(); }
+    void setTags(const QStringList &tags);
+    void addTag(const QString &tag);
+    void removeTag(const QString &tag);
+    void setTagColor(const QString &color);
+    void setPinned(bool pinned) { m_isPinned = pinned; touch(); }
+    void setId(const QString &id);
+    void setCreatedTime(const QDateTime &time) { m_createdMs = toMsecs(time); }
+    void setCompletedTime(const QDateTime &time) { m_completedMs = toMsecs(time); }
+    void setUpdatedTime(const QDateTime &time) { m_updatedMs = toMsecs(time); }
+    void setRemindAt(const QDateTime &time) { m_remindMs = toMsecs(time); }
     
     QJsonObject toJson() const;
     void fromJson(const QJsonObject &json);
     
     bool operator==(const TodoItem &other) const { return m_id == other.m_id; }
     bool operator!=(const TodoItem &other) const { return m_id != other.m_id; }
+
+    // 本事项占用的内存（对象本身 + 标题、详情与溢出标签的堆分配），内存基准用
+    qsizetype footprint() const;
     
 private:
-    QString m_id;
+    void touch() { m_updatedMs = QDateTime::currentMSecsSinceEpoch(); }
+    static qint64 toMsecs(const QDateTime &time) { return time.isValid() ? time.toMSecsSinceEpoch() : kNoTime; }
+    static QDateTime toDateTime(qint64 ms) { return ms == kNoTime ? QDateTime() : QDateTime::fromMSecsSinceEpoch(ms); }
+    static qint32 toDay(const QDate &date) { return date.isValid() ? qint32(date.toJulianDay()) : kNoDay; }
+    static QDate toDate(qint32 day) { return day == kNoDay ? QDate() : QDate::fromJulianDay(day); }
+
     QString m_title;
     QString m_details;
-    QDateTime m_createdTime;
-    QDateTime m_completedTime;
-    QDateTime m_updatedTime;
-    bool m_isCompleted;
-    QString m_folderId;
-    QDate m_plannedDate;
-    QDate m_dueDate;
-    int m_priority;
-    QStringList m_tags;
-    QString m_tagColor;
-    bool m_isPinned;
-    QDateTime m_remindAt;   // 到期提醒时间；无效值表示不提醒
+    qint64 m_createdMs = kNoTime;
+    qint64 m_completedMs = kNoTime;
+    qint64 m_updatedMs = kNoTime;
+    qint64 m_remindMs = kNoTime;            // 到期提醒时间；kNoTime 表示不提醒
+    QVarLengthArray<quint32, 2> m_tags;      // StringPool 编号，两个以内不占堆
+    QString m_legacyId;                      // 非 UUID 形式的旧 id 原串；通常为空，见 todoitem.cpp
+    QUuid m_id;                              // 旧 id 时为其名字型 UUID
+    qint32 m_plannedDay = kNoDay;
+    qint32 m_dueDay = kNoDay;
+    QRgb m_tagColor = 0;                     // alpha 为 0 表示没有颜色
+    quint32 m_tagColorText = 0;              // 不能从 m_tagColor 原样还原的颜色原串（StringPool 编号），0 = 无
+    quint32 m_folderId = 0;                  // StringPool 编号
+    qint8 m_priority = 0;
+    bool m_isCompleted = false;
+    bool m_isPinned = false;
 };
 
 #endif // TODOITEM_H
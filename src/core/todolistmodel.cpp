@@ -0,0 +1,286 @@
+#include "todolistmodel.h"
+#include "keyeddiff.h"
+
+#include <algorithm>
+
+namespace {
+
+// 待办列表的排序：置顶 > 未完成 > 新建在前
+bool todoRowBefore(const TodoItem &a, const TodoItem &b)
+{
+    if (a.isPinned() != b.isPinned()) return a.isPinned() > b.isPinned();
+    if (a.isCompleted() != b.isCompleted()) return a.isCompleted() < b.isCompleted();
+    return a.createdMsecs() > b.createdMsecs();
+}
+
+} // namespace
+
+TodoListModel::TodoListModel(const TodoStore *store, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_store(store)
+{
+}
+
+void TodoListModel::setFolder(const QString &folderId)
+{
+    if (!m_search && folderId == m_folderId) {
+        reconcile();
+        return;
+    }
+    beginResetModel();
+    m_search = false;
+    m_hits.clear();
+    m_folderId = folderId;
+    m_rows.clear();
+    const std::vector<TodoStore::Handle> handles = m_store->handles(folderId);
+    m_rows.reserve(handles.size());
+    for (const TodoStore::Handle &handle : handles) {
+        m_rows.push_back({handle, m_store->item(handle)->getKey()});
+    }
+    m_syncedVersion = m_store->version();
+    endResetModel();
+}
+
+void TodoListModel::reconcile()
+{
+    if (m_store->version() == m_syncedVersion) {
+        return;   // 上次对齐后仓库没有任何修改
+    }
+    // 同一文件夹：按事项键与现有行对齐，只增删、挪动有变化的行，视图的选中与滚动位置不受影响
+    const std::vector<TodoStore::Handle> handles = m_store->handles(m_folderId);
+    QList<QUuid> before;
+    before.reserve(qsizetype(m_rows.size()));
+    for (const Row &row : m_rows) {
+        before.append(row.key);
+    }
+    QList<QUuid> after;
+    after.reserve(qsizetype(handles.size()));
+    for (const TodoStore::Handle &handle : handles) {
+        after.append(m_store->item(handle)->getKey());
+    }
+    // 需要刷新的行：句柄换了（整体替换后重建），或事项在上次对齐之后登记过修改
+    const auto changed = [&](int from, int item) {
+        const TodoStore::Handle was = m_rows[size_t(from)].handle;
+        const TodoStore::Handle now = handles[size_t(item)];
+        return was.slot != now.slot || was.generation != now.generation
+            || m_store->changedVersion(now) > m_syncedVersion;
+    };
+    KeyedDiff::apply(KeyedDiff::compute(before, after, changed),
+        [this](int row) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_rows.erase(m_rows.begin() + row);
+            endRemoveRows();
+        },
+        [&](int row, int item) {
+            beginInsertRows(QModelIndex(), row, row);
+            m_rows.insert(m_rows.begin() + row, {handles[item], after.at(item)});
+            endInsertRows();
+        },
+        [this](int from, int row) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row > from ? row + 1 : row);
+            const Row moved = m_rows[from];
+            m_rows.erase(m_rows.begin() + from);
+            m_rows.insert(m_rows.begin() + row, moved);
+            endMoveRows();
+        },
+        [&](int row, int item) {
+            // 不带角色：置顶、完成状态可能变了，代理据此重排该行
+            m_rows[size_t(row)].handle = handles[size_t(item)];
+            emit dataChanged(index(row), index(row));
+        });
+    m_syncedVersion = m_store->version();
+}
+
+void TodoListModel::setSearchHits(const QList<SearchEngine::Hit> &hits)
+{
+    beginResetModel();
+    m_search = true;
+    m_folderId.clear();
+    m_rows.clear();
+    m_hits = hits;
+    endResetModel();
+}
+
+const TodoItem *TodoListModel::itemAt(int row) const
+{
+    if (m_search || row < 0 || row >= int(m_rows.size())) {
+        return nullptr;
+    }
+    return m_store->item(m_rows[row].handle);
+}
+
+int TodoListModel::rowOf(const QString &itemId) const
+{
+    if (m_search) {
+        for (int row = 0; row < m_hits.size(); ++row) {
+            if (m_hits.at(row).itemId == itemId) {
+                return row;
+            }
+        }
+        return -1;
+    }
+    // 行只有 24 字节，顺序比较键即可；行序本身不重要，排序在代理里
+    const QUuid key = TodoItem::keyOf(itemId);
+    const auto it = std::find_if(m_rows.cbegin(), m_rows.cend(), [&key](const Row &r) { return r.key == key; });
+    return it == m_rows.cend() ? -1 : int(it - m_rows.cbegin());
+}
+
+void TodoListModel::insertItem(const QString &itemId)
+{
+    const TodoStore::Handle handle = m_store->handle(itemId);
+    const TodoItem *item = m_store->item(handle);
+    if (m_search || !item || rowOf(itemId) >= 0) {
+        return;
+    }
+    const int row = int(m_rows.size());
+    beginInsertRows(QModelIndex(), row, row);
+    m_rows.push_back({handle, item->getKey()});
+    endInsertRows();
+}
+
+void TodoListModel::updateItem(const QString &itemId, TodoChangeFeed::Fields fields)
+{
+    if (m_search) {
+        return;   // 搜索结果是查询当时的副本
+    }
+    const int row = rowOf(itemId);
+    if (row < 0) {
+        return;
+    }
+    // 排序键（置顶、完成）变了：不带角色列表，代理据此重排该行；否则只通知显示用到的角色
+    QList<int> roles;
+    if (!(fields & (TodoChangeFeed::Completed | TodoChangeFeed::Pinned))) {
+        if (fields & TodoChangeFeed::Title)    roles << Qt::DisplayRole << RoleTitle;
+        if (fields & TodoChangeFeed::Details)  roles << RoleSubText;
+        if (fields & TodoChangeFeed::Priority) roles << RolePriority;
+        if (fields & TodoChangeFeed::Color)    roles << RoleColor;
+        if (roles.isEmpty()) {
+            return;   // 标签、日期、提醒不在列表上显示
+        }
+    }
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, roles);
+}
+
+void TodoListModel::removeItem(const QString &itemId)
+{
+    const int row = rowOf(itemId);
+    if (m_search || row < 0) {
+        return;
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    m_rows.erase(m_rows.begin() + row);
+    endRemoveRows();
+}
+
+int TodoListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_search ? int(m_hits.size()) : int(m_rows.size());
+}
+
+QVariant TodoListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    if (m_search) {
+        return hitData(m_hits.at(index.row()), role);
+    }
+    const TodoItem *item = m_store->item(m_rows[index.row()].handle);
+    if (!item) {
+        return QVariant();
+    }
+    switch (role) {
+    case Qt::DisplayRole:
+    case RoleTitle:
+        return item->getTitle();
+    case RoleId:
+        return item->getId();
+    case RoleFolderId:
+        return item->getFolderId();
+    case RoleColor:
+        return item->getTagColor();
+    case RoleCompleted:
+        return item->isCompleted();
+    case RolePriority:
+        return item->getPriority();
+    case RolePinned:
+        return item->isPinned();
+    case RoleDate:
+        return item->getCreatedTime().toString(QStringLiteral("MM-dd"));
+    case RoleSubText: {
+        const QString details = item->getDetails();
+        QString sub = details.split('\n').first().left(40);
+        if (details.length() > 40) sub += QStringLiteral("...");
+        return sub;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+QVariant TodoListModel::hitData(const SearchEngine::Hit &hit, int role) const
+{
+    switch (role) {
+    case Qt::DisplayRole:
+    case RoleTitle:
+        return hit.title;
+    case RoleId:
+        return hit.itemId;
+    case RoleFolderId:
+        return hit.folderId;
+    case RoleTitleMarks:
+        return hit.markedTitle;
+    case RoleSubText: {
+        QString plainSnippet = hit.snippet;
+        plainSnippet.remove(QChar(SearchEngine::kHitBegin)).remove(QChar(SearchEngine::kHitEnd));
+        return QStringLiteral("%1 · %2").arg(hit.folderName, plainSnippet);
+    }
+    case RoleSnippet:
+        return QStringLiteral("%1 · %2").arg(hit.folderName, hit.snippet);
+    case RoleDate:
+        return hit.createdTime.toString(QStringLiteral("MM-dd"));
+    case RoleColor:
+        return hit.tagColor;
+    case RoleCompleted:
+        return hit.completed;
+    case RolePriority:
+        return hit.priority;
+    case RolePinned:
+        return hit.pinned;
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags TodoListModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsDragEnabled;   // 可拖到文件夹
+}
+
+TodoListProxy::TodoListProxy(TodoListModel *source, QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    setSourceModel(source);
+    setSortRole(TodoListModel::RolePinned);
+    setDynamicSortFilter(true);
+    sort(0);
+}
+
+bool TodoListProxy::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    // 直接比较仓库里的事项，不经 QVariant
+    const auto *model = static_cast<const TodoListModel *>(sourceModel());
+    const TodoItem *a = model->itemAt(left.row());
+    const TodoItem *b = model->itemAt(right.row());
+    if (!a || !b) {
+        return left.row() < right.row();   // 搜索结果：保持源顺序
+    }
+    return todoRowBefore(*a, *b);
+}
@@ -0,0 +1,85 @@
+#ifndef TODOLISTMODEL_H
+#define TODOLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include <QUuid>
+#include <QList>
+#include <vector>
+#include "todostore.h"
+#include "searchengine.h"
+
+// 待办列表模型：文件夹模式下每行只记仓库句柄与事项键，各角色在绘制时按需从仓库读取；
+// 搜索模式下每行是一条搜索命中的值副本，不随仓库变化。排序交给 TodoListProxy。
+// 仓库的增量由调用方转发（insertItem / updateItem / removeItem），单项改动只发 dataChanged。
+class TodoListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    // 与列表代理约定的数据角色
+    enum Role {
+        RoleId = Qt::UserRole,
+        RoleColor,
+        RoleCompleted,
+        RolePriority,
+        RolePinned,
+        RoleTitle,
+        RoleSubText,
+        RoleDate,
+        RoleFolderId = Qt::UserRole + 20,   // 所属文件夹
+        RoleTitleMarks,                     // 搜索结果：带命中标记的标题
+        RoleSnippet                         // 搜索结果：带命中标记的摘要行
+    };
+
+    explicit TodoListModel(const TodoStore *store, QObject *parent = nullptr);
+
+    void setFolder(const QString &folderId);     // 空 id = 清空；仍是当前文件夹时只对齐变化的行
+    void setSearchHits(const QList<SearchEngine::Hit> &hits);
+    bool isSearch() const { return m_search; }
+    QString folderId() const { return m_folderId; }
+
+    const TodoItem *itemAt(int row) const;       // 搜索模式或事项已删除时为 nullptr
+    int rowOf(const QString &itemId) const;      // -1 = 不在列表中
+
+    // 文件夹模式下的增量：调用方只转发属于当前文件夹的事项
+    void insertItem(const QString &itemId);
+    void updateItem(const QString &itemId, TodoChangeFeed::Fields fields);
+    void removeItem(const QString &itemId);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+private:
+    struct Row {
+        TodoStore::Handle handle;
+        QUuid key;                               // 事项删除后句柄失效，按键定位行
+    };
+
+    void reconcile();
+    QVariant hitData(const SearchEngine::Hit &hit, int role) const;
+
+    const TodoStore *m_store;
+    QString m_folderId;
+    std::vector<Row> m_rows;
+    QList<SearchEngine::Hit> m_hits;
+    quint64 m_syncedVersion = 0;                 // 行最后一次与仓库对齐时的版本
+    bool m_search = false;
+};
+
+// 待办列表的排序代理：置顶 > 未完成 > 新建在前；搜索结果保持引擎给出的相关度顺序。
+// 排序角色设为 RolePinned，只有置顶、完成状态变化（dataChanged 不带角色列表）才重排该行。
+class TodoListProxy : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit TodoListProxy(TodoListModel *source, QObject *parent = nullptr);
+
+protected:
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+};
+
+#endif // TODOLISTMODEL_H
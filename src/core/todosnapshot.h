@@ -0,0 +1,35 @@
+#ifndef TODOSNAPSHOT_H
+#define TODOSNAPSHOT_H
+
+#include <QList>
+#include <QSharedPointer>
+#include "todofolder.h"
+
+class TodoSnapshot;
+using TodoSnapshotPtr = QSharedPointer<const TodoSnapshot>;
+
+// 模型的不可变快照，由 TodoStore::snapshot() 发布。各视图与工作线程持有同一份，按引用计数释放。
+// 按文件夹写时复制：新版本只重建有改动的文件夹，其余文件夹的事项列表与旧版本共享。
+// 版本号随模型的任何变化（事项增删改、移动，文件夹改名、排序）递增，视图据此跳过重复推送。
+class TodoSnapshot
+{
+public:
+    TodoSnapshot(quint64 version, const QList<TodoFolder> &folders)
+        : m_version(version), m_folders(folders) {}
+
+    quint64 version() const { return m_version; }
+    const QList<TodoFolder> &folders() const { return m_folders; }
+
+    // 版本 0 的空快照，视图在收到第一份数据前持有它，省去判空
+    static TodoSnapshotPtr empty()
+    {
+        static const TodoSnapshotPtr instance(new TodoSnapshot(0, QList<TodoFolder>()));
+        return instance;
+    }
+
+private:
+    const quint64 m_version;
+    const QList<TodoFolder> m_folders;
+};
+
+#endif // TODOSNAPSHOT_H
@@ -0,0 +1,443 @@
+#include "todostore.h"
+
+#include <QDebug>
+#include <utility>
+
+namespace {
+constexpr quint32 kCompactMinHoles = 32;       // 空位少时不值得压缩
+}
+
+void TodoStore::reset(const QList<TodoFolder> &folders)
+{
+    m_slots.clear();
+    m_freeSlots.clear();
+    m_buckets.clear();
+    m_freeBuckets.clear();
+    m_rowBucket.clear();
+    m_slotOf.clear();
+    m_bucketOf.clear();
+    m_dirtyBuckets.clear();
+    m_folders.clear();
+    m_completed = 0;
+    ++m_version;
+
+    int itemTotal = 0;
+    for (const TodoFolder &folder : folders) {
+        itemTotal += folder.getItemCount();
+    }
+    m_slotOf.reserve(itemTotal);
+    for (const TodoFolder &folder : folders) {
+        insertFolder(folder);
+    }
+
+    emit m_feed.modelReset();
+}
+
+const QList<TodoFolder> &TodoStore::folders() const
+{
+    for (quint32 bucket : m_dirtyBuckets) {
+        materialize(bucket);
+    }
+    m_dirtyBuckets.clear();
+    return m_folders;
+}
+
+TodoSnapshotPtr TodoStore::snapshot() const
+{
+    if (!m_snapshot || m_snapshot->version() != m_version) {
+        m_snapshot = TodoSnapshotPtr(new TodoSnapshot(m_version, folders()));
+    }
+    return m_snapshot;
+}
+
+TodoFolder *TodoStore::folder(const QString &folderId)
+{
+    const auto it = m_bucketOf.constFind(folderId);
+    if (it == m_bucketOf.cend()) {
+        return nullptr;
+    }
+    materialize(*it);
+    return &m_folders[m_buckets[*it].row];
+}
+
+const TodoFolder *TodoStore::folder(const QString &folderId) const
+{
+    const auto it = m_bucketOf.constFind(folderId);
+    if (it == m_bucketOf.cend()) {
+        return nullptr;
+    }
+    materialize(*it);
+    return &m_folders.at(m_buckets[*it].row);
+}
+
+int TodoStore::itemCount(const QString &folderId) const
+{
+    const quint32 bucket = m_bucketOf.value(folderId, kNullSlot);
+    return bucket == kNullSlot ? 0 : int(m_buckets[bucket].order.size() - m_buckets[bucket].holes);
+}
+
+int TodoStore::completedCount(const QString &folderId) const
+{
+    const quint32 bucket = m_bucketOf.value(folderId, kNullSlot);
+    return bucket == kNullSlot ? 0 : m_buckets[bucket].completed;
+}
+
+QString TodoStore::folderIdByName(const QString &name) const
+{
+    // 文件夹数量很少，按名称线性查找即可（只读元数据，无需物化）
+    for (const TodoFolder &folder : m_folders) {
+        if (folder.getName() == name) {
+            return folder.getId();
+        }
+    }
+    return QString();
+}
+
+QString TodoStore::folderName(const QString &folderId) const
+{
+    const quint32 bucket = m_bucketOf.value(folderId, kNullSlot);
+    return bucket == kNullSlot ? QString() : m_folders.at(m_buckets[bucket].row).getName();
+}
+
+void TodoStore::markFolderChanged(const QString &folderId)
+{
+    if (const TodoFolder *changed = folder(folderId)) {
+        ++m_version;
+        const TodoFolder copy = *changed;   // 槽函数可能重排 m_folders，不能传其中元素的引用
+        emit m_feed.folderChanged(copy);
+    }
+}
+
+TodoFolder *TodoStore::addFolder(const TodoFolder &folder)
+{
+    if (m_bucketOf.contains(folder.getId())) {
+        qWarning() << "[TodoStore] duplicate folder id ignored:" << folder.getId();
+        return this->folder(folder.getId());
+    }
+    insertFolder(folder);
+    emit m_feed.folderChanged(folder);
+    return this->folder(folder.getId());   // 槽函数可能已重排 m_folders，重新取
+}
+
+TodoFolder *TodoStore::insertFolder(const TodoFolder &folder)
+{
+    if (m_bucketOf.contains(folder.getId())) {
+        qWarning() << "[TodoStore] duplicate folder id ignored:" << folder.getId();
+        return this->folder(folder.getId());
+    }
+
+    ++m_version;
+    const quint32 bucket = allocBucket(folder.getId());
+    m_buckets[bucket].row = int(m_folders.size());
+    m_rowBucket.push_back(bucket);
+    m_folders.append(folder);
+
+    const QList<TodoItem> items = folder.getItems();
+    m_buckets[bucket].order.reserve(size_t(items.size()));
+    bool consistent = true;
+    for (const TodoItem &item : items) {
+        if (m_slotOf.contains(item.getKey())) {
+            qWarning() << "[TodoStore] duplicate item id ignored:" << item.getId();
+            consistent = false;
+            continue;
+        }
+        insertSlot(bucket, item);
+        consistent = consistent && item.getFolderId() == folder.getId();
+    }
+    if (!consistent) {
+        markDirty(bucket);   // 物化时按槽位重建，去掉重复项并补上 folderId
+    }
+    return &m_folders.last();
+}
+
+QStringList TodoStore::removeFolder(const QString &folderId)
+{
+    QStringList removed;
+    const auto it = m_bucketOf.constFind(folderId);
+    if (it == m_bucketOf.cend()) {
+        return removed;
+    }
+    const quint32 bucket = *it;
+    m_bucketOf.erase(it);
+    ++m_version;
+
+    Bucket &b = m_buckets[bucket];
+    removed.reserve(qsizetype(b.order.size() - b.holes));
+    for (quint32 slot : b.order) {
+        if (slot != kNullSlot) {
+            removed.append(m_slots[slot].item->getId());
+            releaseSlot(slot);
+        }
+    }
+
+    const int row = b.row;
+    m_folders.removeAt(row);
+    m_rowBucket.erase(m_rowBucket.begin() + row);
+    for (int r = row; r < int(m_rowBucket.size()); ++r) {
+        m_buckets[m_rowBucket[size_t(r)]].row = r;
+    }
+
+    b.folderId.clear();
+    std::vector<quint32>().swap(b.order);
+    b.holes = 0;
+    b.completed = 0;
+    b.row = -1;
+    b.dirty = false;
+    m_freeBuckets.push_back(bucket);
+    emit m_feed.modelReset();
+    return removed;
+}
+
+TodoStore::Handle TodoStore::handle(const QString &itemId) const
+{
+    const quint32 slot = m_slotOf.value(TodoItem::keyOf(itemId), kNullSlot);
+    if (slot == kNullSlot) {
+        return Handle();
+    }
+    return {slot, m_slots[slot].generation};
+}
+
+TodoItem *TodoStore::item(Handle handle)
+{
+    return const_cast<TodoItem *>(std::as_const(*this).item(handle));
+}
+
+const TodoItem *TodoStore::item(Handle handle) const
+{
+    if (handle.isNull() || handle.slot >= m_slots.size()) {
+        return nullptr;
+    }
+    const Slot &slot = m_slots[handle.slot];
+    return slot.live && slot.generation == handle.generation ? &*slot.item : nullptr;
+}
+
+quint64 TodoStore::changedVersion(Handle handle) const
+{
+    return item(handle) ? m_slots[handle.slot].changed : 0;
+}
+
+QString TodoStore::folderOf(const QString &itemId) const
+{
+    const quint32 slot = m_slotOf.value(TodoItem::keyOf(itemId), kNullSlot);
+    return slot == kNullSlot ? QString() : m_buckets[m_slots[slot].bucket].folderId;
+}
+
+std::vector<TodoStore::Handle> TodoStore::handles(const QString &folderId) const
+{
+    std::vector<Handle> result;
+    const quint32 bucket = m_bucketOf.value(folderId, kNullSlot);
+    if (bucket == kNullSlot) {
+        return result;
+    }
+    const Bucket &b = m_buckets[bucket];
+    result.reserve(b.order.size() - b.holes);
+    for (quint32 slot : b.order) {
+        if (slot != kNullSlot) {
+            result.push_back({slot, m_slots[slot].generation});
+        }
+    }
+    return result;
+}
+
+void TodoStore::markChanged(const QString &itemId, TodoChangeFeed::Fields fields)
+{
+    const quint32 slot = m_slotOf.value(TodoItem::keyOf(itemId), kNullSlot);
+    if (slot == kNullSlot) {
+        return;
+    }
+    Slot &s = m_slots[slot];
+    if (s.completed != s.item->isCompleted()) {
+        const int delta = s.item->isCompleted() ? 1 : -1;
+        m_buckets[s.bucket].completed += delta;
+        m_completed += delta;
+        s.completed = s.item->isCompleted();
+    }
+    markDirty(s.bucket);
+    s.changed = m_version;
+    emit m_feed.itemChanged(*s.item, fields);
+}
+
+TodoItem *TodoStore::addItem(const QString &folderId, const TodoItem &item)
+{
+    const quint32 bucket = m_bucketOf.value(folderId, kNullSlot);
+    if (bucket == kNullSlot) {
+        return nullptr;
+    }
+    if (m_slotOf.contains(item.getKey())) {
+        qWarning() << "[TodoStore] duplicate item id ignored:" << item.getId();
+        return nullptr;
+    }
+    markDirty(bucket);
+    const quint32 slot = insertSlot(bucket, item);
+    emit m_feed.itemAdded(*m_slots[slot].item);
+    return &*m_slots[slot].item;
+}
+
+bool TodoStore::removeItem(const QString &itemId)
+{
+    const quint32 slot = m_slotOf.value(TodoItem::keyOf(itemId), kNullSlot);
+    if (slot == kNullSlot) {
+        return false;
+    }
+    const quint32 bucket = m_slots[slot].bucket;
+    const TodoItem removed = *m_slots[slot].item;
+    unlink(slot);
+    releaseSlot(slot);
+    markDirty(bucket);
+    emit m_feed.itemRemoved(removed);
+    return true;
+}
+
+TodoItem *TodoStore::moveItem(const QString &itemId, const QString &folderId)
+{
+    const quint32 slot = m_slotOf.value(TodoItem::keyOf(itemId), kNullSlot);
+    const quint32 target = m_bucketOf.value(folderId, kNullSlot);
+    if (slot == kNullSlot || target == kNullSlot) {
+        return nullptr;
+    }
+    Slot &s = m_slots[slot];
+    if (s.bucket != target) {
+        const QString from = m_buckets[s.bucket].folderId;
+        markDirty(s.bucket);
+        unlink(slot);
+        if (s.completed) {
+            --m_buckets[s.bucket].completed;
+            ++m_buckets[target].completed;
+        }
+        Bucket &b = m_buckets[target];
+        s.bucket = target;
+        s.position = quint32(b.order.size());
+        b.order.push_back(slot);
+        s.item->setFolderId(folderId);
+        markDirty(target);
+        s.changed = m_version;
+        emit m_feed.itemMoved(*s.item, from);
+    }
+    return &*s.item;
+}
+
+quint32 TodoStore::allocBucket(const QString &folderId)
+{
+    quint32 bucket;
+    if (!m_freeBuckets.empty()) {
+        bucket = m_freeBuckets.back();
+        m_freeBuckets.pop_back();
+    } else {
+        bucket = quint32(m_buckets.size());
+        m_buckets.emplace_back();
+    }
+    m_buckets[bucket].folderId = folderId;
+    m_bucketOf.insert(folderId, bucket);
+    return bucket;
+}
+
+quint32 TodoStore::insertSlot(quint32 bucket, const TodoItem &item)
+{
+    quint32 slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = quint32(m_slots.size());
+        m_slots.emplace_back();
+    }
+    Bucket &b = m_buckets[bucket];
+    Slot &s = m_slots[slot];
+    s.item = item;
+    s.item->setFolderId(b.folderId);
+    s.bucket = bucket;
+    s.position = quint32(b.order.size());
+    s.live = true;
+    s.changed = m_version;                   // 调用方已推进过版本
+    s.completed = item.isCompleted();
+    if (s.completed) {
+        ++b.completed;
+        ++m_completed;
+    }
+    b.order.push_back(slot);
+    m_slotOf.insert(item.getKey(), slot);
+    return slot;
+}
+
+void TodoStore::unlink(quint32 slot)
+{
+    Bucket &b = m_buckets[m_slots[slot].bucket];
+    const quint32 position = m_slots[slot].position;
+    if (position + 1 == b.order.size()) {
+        b.order.pop_back();   // 末尾直接弹出，最常见的“刚加又删”不留空位
+        return;
+    }
+    b.order[position] = kNullSlot;
+    if (++b.holes < kCompactMinHoles || b.holes * 2 < b.order.size()) {
+        return;
+    }
+    // 空位过半：原地压缩并更新各槽位的下标，保持原有顺序
+    quint32 kept = 0;
+    for (quint32 s : b.order) {
+        if (s != kNullSlot) {
+            m_slots[s].position = kept;
+            b.order[kept++] = s;
+        }
+    }
+    b.order.resize(kept);
+    b.holes = 0;
+}
+
+void TodoStore::releaseSlot(quint32 slot)
+{
+    Slot &s = m_slots[slot];
+    if (s.completed) {
+        --m_buckets[s.bucket].completed;
+        --m_completed;
+        s.completed = false;
+    }
+    m_slotOf.remove(s.item->getKey());
+    s.item.reset();
+    s.live = false;
+    ++s.generation;
+    m_freeSlots.push_back(slot);
+}
+
+void TodoStore::markDirty(quint32 bucket)
+{
+    ++m_version;
+    Bucket &b = m_buckets[bucket];
+    if (!b.dirty) {
+        b.dirty = true;
+        m_dirtyBuckets.push_back(bucket);
+    }
+}
+
+void TodoStore::materialize(quint32 bucket) const
+{
+    const Bucket &b = m_buckets[bucket];
+    if (!b.dirty || b.row < 0) {
+        return;
+    }
+    QList<TodoItem> items;
+    items.reserve(qsizetype(b.order.size() - b.holes));
+    for (quint32 slot : b.order) {
+        if (slot != kNullSlot) {
+            items.append(*m_slots[slot].item);
+        }
+    }
+    m_folders[b.row].setItems(items);
+    b.dirty = false;
+}
+
+void TodoStore::applyFolderOrder(const QList<int> &rows)
+{
+    QList<TodoFolder> sorted;
+    std::vector<quint32> rowBucket;
+    sorted.reserve(rows.size());
+    rowBucket.reserve(size_t(rows.size()));
+    for (int row : rows) {
+        const quint32 bucket = m_rowBucket[size_t(row)];
+        m_buckets[bucket].row = int(sorted.size());
+        sorted.append(m_folders.at(row));
+        rowBucket.push_back(bucket);
+    }
+    m_folders.swap(sorted);
+    m_rowBucket.swap(rowBucket);
+    ++m_version;
+}
@@ -0,0 +1,133 @@
+#ifndef TODOSTORE_H
+#define TODOSTORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <deque>
+#include <optional>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include "todofolder.h"
+#include "todosnapshot.h"
+#include "todochangefeed.h"
+
+// 内存模型仓库：全部事项放在槽位表里，按 id 哈希定位；每个文件夹保存一张按加入顺序排列的槽位表。
+// 查找、修改、删除、跨文件夹移动都是 O(1)（删除留空位，空位过半时压缩，均摊 O(1)）。
+//
+// 视图、搜索与快照仍然消费 QList<TodoFolder>：folders() 按需物化，只重建有改动的文件夹，
+// 其余文件夹的事项列表继续与各视图隐式共享；snapshot() 把它包成带版本号的不可变快照。
+// 代价是每条事项在槽位与物化列表里各有一个 TodoItem 对象：标题、详情与槽位隐式共享不另占，
+// 多出的是 sizeof(TodoItem) 本身，tst_todostore 的 footprint 基准给出新旧布局每条的字节数。
+// 经 item() / folder() 取得可写指针修改后须调用 markChanged / markFolderChanged，且不要跨越
+// 模态对话框等事件循环持有这些指针。每次修改都经 feed() 发出变更通知，见 TodoChangeFeed。
+class TodoStore
+{
+public:
+    static constexpr quint32 kNullSlot = 0xFFFFFFFFu;
+
+    // 稳定句柄：槽位号 + 代数。事项删除后句柄失效，槽位复用时代数递增，旧句柄不会误指新事项
+    struct Handle {
+        quint32 slot = kNullSlot;
+        quint32 generation = 0;
+        bool isNull() const { return slot == kNullSlot; }
+    };
+
+    void reset(const QList<TodoFolder> &folders);
+
+    const QList<TodoFolder> &folders() const;
+    TodoSnapshotPtr snapshot() const;              // 版本未变时返回同一份
+    quint64 version() const { return m_version; }
+    const TodoChangeFeed *feed() const { return &m_feed; }
+    int folderCount() const { return int(m_rowBucket.size()); }
+    int itemCount() const { return int(m_slotOf.size()); }
+    int completedCount() const { return m_completed; }
+    int itemCount(const QString &folderId) const;          // 计数随修改维护，不需物化
+    int completedCount(const QString &folderId) const;
+
+    // 文件夹：返回的对象已物化，可直接改名称、置顶、颜色；事项增删须走下面的接口
+    TodoFolder *folder(const QString &folderId);
+    const TodoFolder *folder(const QString &folderId) const;
+    bool containsFolder(const QString &folderId) const { return m_bucketOf.contains(folderId); }
+    QString folderIdByName(const QString &name) const;
+    QString folderName(const QString &folderId) const;        // 只读元数据，不物化
+    void markFolderChanged(const QString &folderId);           // 名称、置顶、颜色改动后调用
+    TodoFolder *addFolder(const TodoFolder &folder);          // 连同其中的事项
+    QStringList removeFolder(const QString &folderId);        // 返回随之移除的事项 id
+    template <typename LessThan>
+    void sortFolders(LessThan lessThan);
+
+    // 事项
+    Handle handle(const QString &itemId) const;
+    TodoItem *item(Handle handle);
+    const TodoItem *item(Handle handle) const;
+    TodoItem *item(const QString &itemId) { return item(handle(itemId)); }
+    const TodoItem *item(const QString &itemId) const { return item(handle(itemId)); }
+    QString folderOf(const QString &itemId) const;
+    std::vector<Handle> handles(const QString &folderId) const;   // 文件夹内事项，按加入顺序，不物化
+    quint64 changedVersion(Handle handle) const;   // 事项最后一次加入、移动或登记修改时的版本；句柄失效为 0
+    void markChanged(const QString &itemId, TodoChangeFeed::Fields fields = TodoChangeFeed::AllFields);
+
+    TodoItem *addItem(const QString &folderId, const TodoItem &item);
+    bool removeItem(const QString &itemId);
+    TodoItem *moveItem(const QString &itemId, const QString &folderId);
+
+private:
+    struct Slot {
+        std::optional<TodoItem> item;        // 空槽位不持有事项，释放其字符串
+        quint32 generation = 0;
+        quint32 bucket = 0;                  // 所在文件夹
+        quint32 position = 0;                // 在该文件夹 order 中的下标
+        bool live = false;
+        bool completed = false;              // 上次登记时的完成状态，维护完成计数用
+        quint64 changed = 0;                 // 见 changedVersion
+    };
+    struct Bucket {
+        QString folderId;
+        std::vector<quint32> order;          // 槽位号按加入顺序；kNullSlot 为已删除留下的空位
+        quint32 holes = 0;
+        int completed = 0;
+        int row = -1;                        // 在 m_folders 中的行；-1 = 已回收
+        mutable bool dirty = false;          // 事项有变化，下次物化时重建
+    };
+
+    TodoFolder *insertFolder(const TodoFolder &folder);
+    quint32 allocBucket(const QString &folderId);
+    quint32 insertSlot(quint32 bucket, const TodoItem &item);
+    void unlink(quint32 slot);
+    void releaseSlot(quint32 slot);
+    void markDirty(quint32 bucket);
+    void materialize(quint32 bucket) const;
+    void applyFolderOrder(const QList<int> &rows);
+
+    std::deque<Slot> m_slots;                // deque：扩容不搬动已有槽位，TodoItem 指针保持有效
+    std::vector<quint32> m_freeSlots;
+    std::vector<Bucket> m_buckets;
+    std::vector<quint32> m_freeBuckets;
+    std::vector<quint32> m_rowBucket;        // 行 → bucket，与 m_folders 平行
+    QHash<QUuid, quint32> m_slotOf;          // 事项键（TodoItem::getKey）→ 槽位
+    QHash<QString, quint32> m_bucketOf;      // 文件夹 id → bucket
+    mutable QList<TodoFolder> m_folders;     // 物化结果，行序即文件夹显示顺序
+    mutable std::vector<quint32> m_dirtyBuckets;
+    int m_completed = 0;
+    quint64 m_version = 0;
+    mutable TodoSnapshotPtr m_snapshot;
+    TodoChangeFeed m_feed;
+};
+
+template <typename LessThan>
+void TodoStore::sortFolders(LessThan lessThan)
+{
+    QList<int> rows(m_folders.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    const auto before = [&](int a, int b) { return lessThan(m_folders.at(a), m_folders.at(b)); };
+    if (std::is_sorted(rows.cbegin(), rows.cend(), before)) {
+        return;   // 已有序时不动 m_folders，避免与视图共享的列表被无谓分离
+    }
+    std::stable_sort(rows.begin(), rows.end(), before);
+    applyFolderOrder(rows);
+}
+
+#endif // TODOSTORE_H
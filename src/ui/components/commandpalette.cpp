@@ -0,0 +1,114 @@
+#include "commandpalette.h"
+#include "../icons.h"
+
+#include <QLineEdit>
+#include <QListWidget>
+#include <QLabel>
+#include <QKeyEvent>
+
+namespace {
+constexpr int kVisibleResults = 50;       // 列表只放前若干项，其余只计数
+}
+
+CommandPalette::CommandPalette(PaletteCorpus *corpus, QWidget *parent)
+    : StyledDialog(parent, QStringLiteral("命令面板"), Theme::primary(), 520)
+    , m_corpus(corpus)
+{
+    m_input = new QLineEdit(this);
+    m_input->setPlaceholderText(QStringLiteral("输入事项、文件夹、标签或操作…"));
+    m_input->setClearButtonEnabled(true);
+    m_input->installEventFilter(this);
+    body()->addWidget(m_input);
+
+    m_list = new QListWidget(this);
+    m_list->setMinimumHeight(320);
+    m_list->setUniformItemSizes(true);
+    body()->addWidget(m_list, 1);
+
+    m_countLabel = new QLabel(this);
+    m_countLabel->setStyleSheet(QStringLiteral("color: %1; font-size: 12px; background: transparent;")
+                                .arg(Theme::textMuted().name()));
+    body()->addWidget(m_countLabel);
+
+    // 与 Kind 一一对应
+    const Icons::Type types[] = {Icons::List, Icons::Folder, Icons::Check, Icons::Tag};
+    for (int kind = PaletteCorpus::Action; kind <= PaletteCorpus::Tag; ++kind) {
+        m_icons[kind] = Icons::icon(types[kind], 14, Theme::textSecondary());
+    }
+
+    connect(m_input, &QLineEdit::textChanged, this, &CommandPalette::refresh);
+    connect(m_list, &QListWidget::itemActivated, this, [this](QListWidgetItem *item) {
+        activate(m_list->row(item));
+    });
+}
+
+int CommandPalette::exec()
+{
+    refresh();
+    m_input->setFocus();
+    return StyledDialog::exec();
+}
+
+bool CommandPalette::eventFilter(QObject *obj, QEvent *event)
+{
+    // 焦点始终留在输入框：上下键移动列表选择，回车执行当前项
+    if (obj == m_input && event->type() == QEvent::KeyPress) {
+        auto *key = static_cast<QKeyEvent *>(event);
+        const int rows = m_list->count();
+        switch (key->key()) {
+        case Qt::Key_Down:
+        case Qt::Key_Up:
+            if (rows > 0) {
+                const int step = key->key() == Qt::Key_Down ? 1 : -1;
+                m_list->setCurrentRow((m_list->currentRow() + step + rows) % rows);
+            }
+            return true;
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+            activate(m_list->currentRow());
+            return true;
+        default:
+            break;
+        }
+    }
+    return StyledDialog::eventFilter(obj, event);
+}
+
+void CommandPalette::refresh()
+{
+    FuzzyMatcher &matcher = m_corpus->matcher();
+    const std::vector<FuzzyMatcher::Result> &results = matcher.rank(m_input->text().trimmed(), kVisibleResults);
+
+    m_list->setUpdatesEnabled(false);
+    m_list->clear();
+    for (const FuzzyMatcher::Result &result : results) {
+        const PaletteCorpus::Entry &entry = m_corpus->entry(result.candidate);
+        const QString subtitle = m_corpus->subtitle(result.candidate);
+        auto *item = new QListWidgetItem(m_icons[entry.kind], subtitle.isEmpty()
+            ? entry.title
+            : QStringLiteral("%1    · %2").arg(entry.title, subtitle));
+        item->setData(Qt::UserRole, result.candidate);
+        m_list->addItem(item);
+    }
+    if (m_list->count() > 0) {
+        m_list->setCurrentRow(0);
+    }
+    m_list->setUpdatesEnabled(true);
+
+    const int matches = matcher.matchCount();
+    m_countLabel->setText(matches > m_list->count()
+        ? QStringLiteral("%1 项匹配，显示前 %2 项").arg(matches).arg(m_list->count())
+        : QStringLiteral("%1 项匹配").arg(matches));
+}
+
+void CommandPalette::activate(int row)
+{
+    const QListWidgetItem *item = m_list->item(row);
+    if (!item) {
+        return;
+    }
+    const PaletteCorpus::Entry &entry = m_corpus->entry(item->data(Qt::UserRole).toInt());
+    m_selectedKind = entry.kind;
+    m_selectedKey = entry.key;
+    accept();
+}
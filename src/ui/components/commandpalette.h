@@ -0,0 +1,48 @@
+#ifndef COMMANDPALETTE_H
+#define COMMANDPALETTE_H
+
+#include "messageutils.h"
+#include "../../core/palettecorpus.h"
+
+#include <QList>
+#include <QIcon>
+#include <QString>
+
+class QLineEdit;
+class QListWidget;
+class QLabel;
+
+// Ctrl+K 命令面板：一个输入框 + 结果列表，对事项标题、文件夹、标签与操作做模糊匹配。
+// 每次按键在 GUI 线程同步重排（FuzzyMatcher 十万候选在 10 ms 内），上下键选择，回车执行。
+// 候选来自调用方常驻的 PaletteCorpus（打开前先 prepare），exec() 返回 Accepted 后读 selectedKind / selectedKey。
+class CommandPalette : public StyledDialog
+{
+    Q_OBJECT
+
+public:
+    using Kind = PaletteCorpus::Kind;
+
+    CommandPalette(PaletteCorpus *corpus, QWidget *parent);
+
+    int exec() override;
+
+    Kind selectedKind() const { return m_selectedKind; }
+    QString selectedKey() const { return m_selectedKey; }
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+    void refresh();
+    void activate(int row);
+
+    PaletteCorpus *m_corpus;
+    QLineEdit *m_input = nullptr;
+    QListWidget *m_list = nullptr;
+    QLabel *m_countLabel = nullptr;
+    QIcon m_icons[PaletteCorpus::Tag + 1];
+    Kind m_selectedKind = PaletteCorpus::Action;
+    QString m_selectedKey;
+};
+
+#endif // COMMANDPALETTE_H
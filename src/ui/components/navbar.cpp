@@ -138,6 +138,7 @@ void NavBar::setCurrentIndex(int index)
     if (index < 0 || index >= m_items.size() || index == m_currentIndex) {
         return;
     }
+    emit pageAboutToChange(index);
     m_currentIndex = index;
     moveIndicator(index, true);
     slideToPage(index);
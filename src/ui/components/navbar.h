@@ -29,6 +29,7 @@ public:
     void addRightWidget(QWidget *w);
 
 signals:
+    void pageAboutToChange(int index);      // 切页之前发出，接收方可在此构建或刷新目标页
     void pageSelected(int index);
 
 protected:
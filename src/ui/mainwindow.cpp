@@ -6,7 +6,17 @@
 #include "components/titlebar.h"
 #include "components/aurorabackground.h"
 #include "components/messageutils.h"
+#include "components/commandpalette.h"
 #include "../core/databasemanager.h"
+#include "../core/databasewriter.h"
+#include "../core/backupengine.h"
+#include "../core/importengine.h"
+#include "../core/exportengine.h"
+#include "../core/modelsnapshot.h"
+#include "../core/searchengine.h"
+#include "../core/todolistmodel.h"
+#include "../core/keyeddiff.h"
+#include "../core/palettecorpus.h"
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -29,37 +39,41 @@
 #include <QSettings>
 #include <QCursor>
 #include <QStatusBar>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QMenu>
 #include <QActionGroup>
 #include <QTimer>
 #include <QApplication>
 #include <QStyle>
 #include <QDesktopServices>
+#include <QProgressDialog>
+#include <QShortcut>
 #include <QUrl>
 #include <QWheelEvent>
 #include <QDragEnterEvent>
 #include <QDropEvent>
 #include <QDragMoveEvent>
 #include <QDate>
+#include <QHash>
+#include <QItemSelectionModel>
+#include <QDebug>
 #include <algorithm>
+#include <utility>
 
 namespace {
 
-// ---- 数据角色约定 ----
-constexpr int RoleId        = Qt::UserRole;
-constexpr int RoleColor     = Qt::UserRole + 1;
-constexpr int RoleCompleted = Qt::UserRole + 2;
-constexpr int RolePriority  = Qt::UserRole + 3;
-constexpr int RolePinned    = Qt::UserRole + 4;
-constexpr int RoleTitle     = Qt::UserRole + 5;
-constexpr int RoleSubText   = Qt::UserRole + 6;
-constexpr int RoleDate      = Qt::UserRole + 7;
+// ---- 数据角色约定：待办列表由 TodoListModel 提供，文件夹列表沿用同一组编号 ----
+constexpr int RoleId        = TodoListModel::RoleId;
+constexpr int RoleColor     = TodoListModel::RoleColor;
+constexpr int RoleCompleted = TodoListModel::RoleCompleted;
+constexpr int RolePriority  = TodoListModel::RolePriority;
+constexpr int RolePinned    = TodoListModel::RolePinned;
+constexpr int RoleTitle     = TodoListModel::RoleTitle;
+constexpr int RoleSubText   = TodoListModel::RoleSubText;
+constexpr int RoleDate      = TodoListModel::RoleDate;
 constexpr int RoleDoneCount = Qt::UserRole + 8;
 constexpr int RoleTotalCount= Qt::UserRole + 9;
-constexpr int RoleFolderId  = Qt::UserRole + 20;   // 搜索结果项记录所属文件夹
+constexpr int RoleTitleMarks= TodoListModel::RoleTitleMarks;
+constexpr int RoleSnippet   = TodoListModel::RoleSnippet;
 
 QPixmap coloredDot(const QColor &color, int size = 12)
 {
@@ -73,11 +87,48 @@ QPixmap coloredDot(const QColor &color, int size = 12)
     return pm;
 }
 
+// 单行绘制带命中标记（kHitBegin … kHitEnd）的文本：命中段衬底并用主题色，超宽时末尾省略
+void drawMarkedText(QPainter *painter, const QRect &rect, const QString &marked,
+                    const QFontMetrics &fm, const QColor &color)
+{
+    const QColor hitColor = Theme::primary();
+    int x = rect.left();
+    bool hit = false;
+    qsizetype from = 0;
+    while (from <= marked.size() && x < rect.right()) {
+        qsizetype next = marked.indexOf(QChar(hit ? SearchEngine::kHitEnd : SearchEngine::kHitBegin), from);
+        if (next < 0) {
+            next = marked.size();
+        }
+        QString part = marked.mid(from, next - from);
+        from = next + 1;
+        if (!part.isEmpty()) {
+            const int room = rect.right() - x;
+            int width = fm.horizontalAdvance(part);
+            if (width > room) {
+                part = fm.elidedText(part, Qt::ElideRight, room);
+                width = fm.horizontalAdvance(part);
+                from = marked.size() + 1;   // 已省略，后续不再绘制
+            }
+            const QRect partRect(x, rect.top(), width, rect.height());
+            if (hit) {
+                painter->setPen(Qt::NoPen);
+                painter->setBrush(Theme::withAlpha(hitColor, Theme::isDark() ? 60 : 40));
+                painter->drawRoundedRect(partRect.adjusted(-1, 1, 1, -1), 3, 3);
+            }
+            painter->setPen(hit ? hitColor : color);
+            painter->drawText(partRect, Qt::AlignLeft | Qt::AlignVCenter, part);
+            x += width;
+        }
+        hit = !hit;
+    }
+}
+
 // 悬停淡入动画基类：跟踪当前悬停项，背景色平滑过渡
 class AnimatedDelegate : public QStyledItemDelegate
 {
 public:
-    explicit AnimatedDelegate(QListWidget *view) : QStyledItemDelegate(view), m_view(view) {}
+    explicit AnimatedDelegate(QListView *view) : QStyledItemDelegate(view), m_view(view) {}
 
 protected:
     qreal hoverProgress(const QStyleOptionViewItem &option, const QModelIndex &index) const
@@ -110,7 +161,7 @@ protected:
         anim->start();
     }
 
-    QListWidget *m_view;
+    QListView *m_view;
     mutable QPersistentModelIndex m_hoverIndex;
     mutable qreal m_hoverProgress = 0.0;
 };
@@ -347,8 +398,14 @@ public:
         painter->setPen(completed ? Theme::textDisabled() : Theme::textPrimary());
         QFontMetrics tfm(titleFont);
         int titleMax = qMax(rightBoundary - x - 4, 20);
-        painter->drawText(QRect(x, titleY, titleMax, 20), Qt::AlignLeft | Qt::AlignVCenter,
-                          tfm.elidedText(title, Qt::ElideRight, titleMax));
+        const QString titleMarks = index.data(RoleTitleMarks).toString();
+        if (!titleMarks.isEmpty()) {
+            drawMarkedText(painter, QRect(x, titleY, titleMax, 20), titleMarks, tfm,
+                           completed ? Theme::textDisabled() : Theme::textPrimary());
+        } else {
+            painter->drawText(QRect(x, titleY, titleMax, 20), Qt::AlignLeft | Qt::AlignVCenter,
+                              tfm.elidedText(title, Qt::ElideRight, titleMax));
+        }
 
         // 摘要行
         if (!sub.isEmpty()) {
@@ -357,8 +414,13 @@ public:
             painter->setPen(Theme::textMuted());
             QFontMetrics sfm(subFont);
             QRect subRect(x, card.bottom() - 26, card.right() - x - 14, 18);
-            painter->drawText(subRect, Qt::AlignLeft | Qt::AlignVCenter,
-                              sfm.elidedText(sub, Qt::ElideRight, subRect.width()));
+            const QString snippet = index.data(RoleSnippet).toString();
+            if (!snippet.isEmpty()) {
+                drawMarkedText(painter, subRect, snippet, sfm, Theme::textMuted());
+            } else {
+                painter->drawText(subRect, Qt::AlignLeft | Qt::AlignVCenter,
+                                  sfm.elidedText(sub, Qt::ElideRight, subRect.width()));
+            }
         }
 
         painter->restore();
@@ -409,32 +471,165 @@ MainWindow::MainWindow(QWidget *parent)
         MessageUtils::showError(this, QStringLiteral("数据库错误"), db.lastError());
     }
 
-    m_folders = db.loadAll();
-    if (m_folders.isEmpty()) {
+    // 增量写入全部交给后台写线程，GUI 线程不再等待 SQLite 提交
+    m_writer = new DatabaseWriter(this);
+    connect(m_writer, &DatabaseWriter::writeFailed, this, [this](const QString &error) {
+        m_modelDiverged = true;
+        MessageUtils::showError(this, QStringLiteral("保存失败"), error);
+    });
+    if (db.isOpen()) {
+        m_writer->start(db.databasePath());
+    }
+
+    m_searchEngine = new SearchEngine(this);
+    connect(m_searchEngine, &SearchEngine::resultsReady, this, &MainWindow::showSearchResults);
+    m_paletteCorpus = new PaletteCorpus(&m_store, this);
+
+    // 备份在后台线程用独立连接完成；启动备份不再拖慢首屏
+    m_backup = new BackupEngine(this);
+    connect(m_backup, &BackupEngine::progress, this, [this](int, int percent) {
+        statusBar()->showMessage(QStringLiteral("正在备份… %1%").arg(percent));
+    });
+    connect(m_backup, &BackupEngine::finished, this,
+            [this](int jobId, bool ok, const QString &, const QString &error) {
+        statusBar()->clearMessage();
+        if (jobId == m_importBackupJob) {
+            m_importBackupJob = 0;
+            const QString fileName = std::exchange(m_pendingImportPath, {});
+            if (!ok && !MessageUtils::showConfirm(this, QStringLiteral("备份失败"),
+                    error + QStringLiteral("\n未能备份当前数据，仍要继续导入吗？"))) {
+                return;
+            }
+            startImport(fileName);
+        } else if (jobId == m_restoreBackupJob) {
+            m_restoreBackupJob = 0;
+            const QString snapshotId = std::exchange(m_restoreSnapshotId, {});
+            if (!ok && !MessageUtils::showConfirm(this, QStringLiteral("备份失败"),
+                    error + QStringLiteral("\n未能备份当前数据，仍要继续恢复吗？"))) {
+                return;
+            }
+            m_restoreJob = m_backup->restore(snapshotId);
+        } else if (jobId == m_manualBackupJob) {
+            m_manualBackupJob = 0;
+            if (ok) {
+                MessageUtils::showSuccess(this, QStringLiteral("备份完成"),
+                                          QStringLiteral("数据库快照已保存到备份目录。"));
+            } else {
+                MessageUtils::showError(this, QStringLiteral("备份失败"), error);
+            }
+        }
+    });
+    connect(m_backup, &BackupEngine::restored, this,
+            [this](int jobId, bool ok, const QList<TodoFolder> &folders, const QString &error) {
+        statusBar()->clearMessage();
+        if (jobId != m_restoreJob) {
+            return;
+        }
+        m_restoreJob = 0;
+        if (!ok) {
+            MessageUtils::showError(this, QStringLiteral("恢复失败"), error + QStringLiteral("\n现有数据未受影响。"));
+            return;
+        }
+        startRestore(folders);
+    });
+    connect(m_backup, &BackupEngine::verified, this,
+            [this](int jobId, int checked, const QStringList &problems) {
+        if (jobId != m_verifyJob) {
+            return;
+        }
+        m_verifyJob = 0;
+        if (problems.isEmpty()) {
+            MessageUtils::showSuccess(this, QStringLiteral("校验通过"),
+                                      QStringLiteral("共校验 %1 个快照，全部完好。").arg(checked));
+        } else {
+            MessageUtils::showError(this, QStringLiteral("校验发现问题"),
+                                    QStringLiteral("共校验 %1 个快照，%2 个有问题：\n").arg(checked).arg(problems.size())
+                                    + problems.join(QLatin1Char('\n')));
+        }
+    });
+    // 导入在后台两条线程上流水线执行，写入独占一条连接、整体一个事务
+    m_importer = new ImportEngine(this);
+    connect(m_importer, &ImportEngine::progress, this, [this](int percent) {
+        if (m_importProgress) {
+            m_importProgress->setValue(percent);
+        }
+    });
+    connect(m_importer, &ImportEngine::finished, this,
+            [this](bool ok, bool cancelled, const QList<TodoFolder> &folders, const QString &error) {
+        if (m_importProgress) {
+            m_importProgress->deleteLater();
+            m_importProgress = nullptr;
+        }
+        m_reminderTimer->start();
+        const QString action = std::exchange(m_importAction, {});
+        if (cancelled) {
+            MessageUtils::showInfo(this, action + QStringLiteral("已取消"), QStringLiteral("现有数据未受影响。"));
+            return;
+        }
+        if (!ok) {
+            MessageUtils::showError(this, action + QStringLiteral("失败"), error + QStringLiteral("\n现有数据未受影响。"));
+            return;
+        }
+        applyImport(folders, action);
+    });
+
+    // 导出在工作线程上按游标流式写文件，不占用 GUI 线程也不读内存模型
+    m_exporter = new ExportEngine(this);
+    connect(m_exporter, &ExportEngine::progress, this, [this](int percent) {
+        if (m_exportProgress) {
+            m_exportProgress->setValue(percent);
+        }
+    });
+    connect(m_exporter, &ExportEngine::finished, this,
+            [this](bool ok, bool cancelled, int itemCount, const QString &error) {
+        if (m_exportProgress) {
+            m_exportProgress->deleteLater();
+            m_exportProgress = nullptr;
+        }
+        if (cancelled) {
+            MessageUtils::showInfo(this, QStringLiteral("导出已取消"), QStringLiteral("未写入任何文件。"));
+        } else if (!ok) {
+            MessageUtils::showError(this, QStringLiteral("导出失败"), error);
+        } else {
+            MessageUtils::showSuccess(this, QStringLiteral("导出成功"),
+                                      QStringLiteral("已导出 %1 项待办。").arg(itemCount));
+        }
+    });
+
+    if (db.isOpen()) {
+        m_backup->start(db.databasePath(), db.backupDir());
+        m_backup->backup(QStringLiteral("startup"));
+    }
+
+    // 上次正常退出时写下的模型快照：库自那以后没有任何变更就从快照构建模型，省去 SQL 加载
+    // （仍按事项数线性拷贝，不按需水合，原因见 modelsnapshot.h）
+    QList<TodoFolder> folders;
+    if (!db.isOpen() || !ModelSnapshot::load(db.snapshotPath(), db.changeStamp(), &folders)) {
+        folders = db.loadAll();
+    }
+    if (folders.isEmpty()) {
         // 首次使用：创建默认数据
         TodoFolder defaultFolder(QStringLiteral("默认文件夹"));
         TodoItem sample(QStringLiteral("欢迎使用 Todo List"),
                         QStringLiteral("这是一个示例待办事项，可以编辑或删除它。"));
         defaultFolder.addItem(sample);
-        m_folders.append(defaultFolder);
-        db.upsertFolder(defaultFolder);
-        db.upsertItem(sample);
+        folders.append(defaultFolder);
+        m_writer->upsertFolder(defaultFolder);
+        m_writer->upsertItem(defaultFolder.getItems().first());
     }
+    m_store.reset(folders);   // 搜索索引（含拼音）在第一次搜索时于后台线程构建
 
     buildUi();
     setupSystemTray();
     setupDesktopWidget();
-    setupCalendarWidget();
-    setupTagWidget();
-
-    m_statsWidget = new StatsWidget(this);
-    m_statsWidget->setData(m_folders);
 
+    // 启动时停在列表页：日历、标签、统计页先放空占位，首次切换到时再构建（ensurePage）
     m_stack->addWidget(buildListPage());
-    m_stack->addWidget(m_calendarWidget);
-    m_stack->addWidget(m_tagWidget);
-    m_stack->addWidget(m_statsWidget);
+    for (int page = CalendarPage; page < PageCount; ++page) {
+        m_stack->addWidget(new QWidget(this));
+    }
     m_navBar->attachStack(m_stack);
+    connect(m_navBar, &NavBar::pageAboutToChange, this, &MainWindow::onPageAboutToChange);
 
     // 到期提醒扫描（每分钟）
     m_reminderTimer = new QTimer(this);
@@ -448,11 +643,9 @@ MainWindow::MainWindow(QWidget *parent)
     setupConnections();
 
     updateFolderList();
-    updateCalendarWidget();
-    updateTagWidget();
     updateStatusBar();
 
-    if (!m_folders.isEmpty()) {
+    if (m_store.folderCount() > 0) {
         m_folderList->setCurrentRow(0);
     }
 
@@ -498,6 +691,11 @@ void MainWindow::buildUi()
     m_searchEdit = new QLineEdit(this);
     m_searchEdit->setPlaceholderText(QStringLiteral("搜索待办…"));
     m_searchEdit->setClearButtonEnabled(true);
+    m_searchEdit->setToolTip(QStringLiteral(
+        "支持过滤条件，可与关键词组合：\n"
+        "tag:工作 或 #工作　folder:项目A　is:open / is:done / is:pinned\n"
+        "due:today / overdue / none / <7d / <=2026-10-20　priority:high / >=medium\n"
+        "带空格的短语用引号：\"exact phrase\""));
     m_searchEdit->setFixedWidth(190);
     m_navBar->addRightWidget(m_searchEdit);
 
@@ -514,9 +712,9 @@ void MainWindow::buildUi()
     m_navBar->addRightWidget(menuBtn);
 
     QMenu *appMenu = new QMenu(this);
-    QAction *darkAction = appMenu->addAction(QStringLiteral("深色模式"), this, &MainWindow::onToggleDarkMode);
-    darkAction->setCheckable(true);
-    darkAction->setChecked(Theme::isDark());
+    m_darkAction = appMenu->addAction(QStringLiteral("深色模式"), this, &MainWindow::onToggleDarkMode);
+    m_darkAction->setCheckable(true);
+    m_darkAction->setChecked(Theme::isDark());
 
     // 背景粒子动效选择（单选，持久化）
     QMenu *bgMenu = appMenu->addMenu(QStringLiteral("背景动效"));
@@ -545,6 +743,10 @@ void MainWindow::buildUi()
     appMenu->addSeparator();
     appMenu->addAction(Icons::icon(Icons::Folder, 14, Theme::textSecondary()),
                        QStringLiteral("打开备份目录"), this, &MainWindow::onOpenBackupDir);
+    appMenu->addAction(Icons::icon(Icons::Backup, 14, Theme::textSecondary()),
+                       QStringLiteral("从备份恢复"), this, &MainWindow::onRestoreBackupClicked);
+    appMenu->addAction(Icons::icon(Icons::Check, 14, Theme::textSecondary()),
+                       QStringLiteral("校验备份"), this, &MainWindow::onVerifyBackupsClicked);
     appMenu->addSeparator();
     appMenu->addAction(Icons::icon(Icons::Exit, 14, Theme::textSecondary()),
                        QStringLiteral("退出"), this, &MainWindow::onExitClicked);
@@ -670,8 +872,13 @@ QWidget* MainWindow::buildTodoPanel()
     addRow->addWidget(m_newTodoBtn);
     layout->addLayout(addRow);
 
-    m_todoList = new QListWidget(panel);
+    // 模型 + 排序代理：行只在绘制时取数据，单项改动只刷新该行
+    m_todoModel = new TodoListModel(&m_store, this);
+    m_todoProxy = new TodoListProxy(m_todoModel, this);
+    m_todoList = new QListView(panel);
+    m_todoList->setModel(m_todoProxy);
     m_todoList->setItemDelegate(new TodoDelegate(m_todoList));
+    m_todoList->setUniformItemSizes(true);   // 行高固定，布局不必逐行询问
     m_todoList->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
     m_todoList->setContextMenuPolicy(Qt::CustomContextMenu);
     m_todoList->setDragEnabled(true);
@@ -847,6 +1054,9 @@ void MainWindow::loadSplitterState()
 
 void MainWindow::setupConnections()
 {
+    auto *paletteShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_K), this);
+    connect(paletteShortcut, &QShortcut::activated, this, &MainWindow::onCommandPaletteRequested);
+
     // 文件夹
     connect(m_newFolderBtn, &QPushButton::clicked, this, &MainWindow::onNewFolderClicked);
     connect(m_folderList, &QListWidget::currentRowChanged, this, &MainWindow::onFolderSelectionChanged);
@@ -857,10 +1067,10 @@ void MainWindow::setupConnections()
     connect(m_newTodoBtn, &QPushButton::clicked, this, &MainWindow::onNewTodoClicked);
     connect(m_quickAddEdit, &QLineEdit::returnPressed, this, &MainWindow::onQuickAddTodo);
     connect(m_searchEdit, &QLineEdit::textChanged, this, &MainWindow::onSearchTextChanged);
-    connect(m_todoList, &QListWidget::currentRowChanged, this, &MainWindow::onTodoSelectionChanged);
-    connect(m_todoList, &QListWidget::itemClicked, this, &MainWindow::onTodoClicked);
-    connect(m_todoList, &QListWidget::itemDoubleClicked, this, &MainWindow::onTodoDoubleClicked);
-    connect(m_todoList, &QListWidget::customContextMenuRequested, this, &MainWindow::onTodoContextMenu);
+    connect(m_todoList->selectionModel(), &QItemSelectionModel::currentChanged, this, &MainWindow::onTodoSelectionChanged);
+    connect(m_todoList, &QListView::clicked, this, &MainWindow::onTodoClicked);
+    connect(m_todoList, &QListView::doubleClicked, this, &MainWindow::onTodoDoubleClicked);
+    connect(m_todoList, &QListView::customContextMenuRequested, this, &MainWindow::onTodoContextMenu);
     connect(m_saveBtn, &QPushButton::clicked, this, &MainWindow::onSaveClicked);
     connect(m_deleteBtn, &QPushButton::clicked, this, &MainWindow::onDeleteClicked);
     connect(m_completedCheck, &QCheckBox::toggled, this, &MainWindow::onCompletedToggled);
@@ -879,6 +1089,15 @@ void MainWindow::setupConnections()
         }
     });
 
+    // 模型变更：各视图按增量更新
+    const TodoChangeFeed *feed = m_store.feed();
+    connect(feed, &TodoChangeFeed::itemAdded, this, &MainWindow::onItemAdded);
+    connect(feed, &TodoChangeFeed::itemChanged, this, &MainWindow::onItemChanged);
+    connect(feed, &TodoChangeFeed::itemMoved, this, &MainWindow::onItemMoved);
+    connect(feed, &TodoChangeFeed::itemRemoved, this, &MainWindow::onItemRemoved);
+    connect(feed, &TodoChangeFeed::folderChanged, this, &MainWindow::onFolderChanged);
+    connect(feed, &TodoChangeFeed::modelReset, this, &MainWindow::onModelReset);
+
     connect(qApp, &QApplication::aboutToQuit, this, &MainWindow::onAboutToQuit);
 }
 
@@ -888,23 +1107,14 @@ void MainWindow::setupConnections()
 
 TodoFolder* MainWindow::findFolderById(const QString &folderId)
 {
-    for (TodoFolder &folder : m_folders) {
-        if (folder.getId() == folderId) {
-            return &folder;
-        }
-    }
-    return nullptr;
+    return m_store.folder(folderId);
 }
 
 TodoItem* MainWindow::findTodoItemById(const QString &itemId, QString *outFolderId)
 {
-    for (TodoFolder &folder : m_folders) {
-        if (TodoItem *item = folder.findItem(itemId)) {
-            if (outFolderId) *outFolderId = folder.getId();
-            return item;
-        }
-    }
-    return nullptr;
+    TodoItem *item = m_store.item(itemId);
+    if (item && outFolderId) *outFolderId = item->getFolderId();
+    return item;
 }
 
 TodoFolder* MainWindow::currentFolder()
@@ -914,23 +1124,28 @@ TodoFolder* MainWindow::currentFolder()
 
 TodoItem* MainWindow::currentItem()
 {
-    TodoFolder *folder = currentFolder();
-    return (folder && !m_currentItemId.isEmpty()) ? folder->findItem(m_currentItemId) : nullptr;
+    if (m_currentFolderId.isEmpty() || m_currentItemId.isEmpty()) return nullptr;
+    TodoItem *item = m_store.item(m_currentItemId);
+    return (item && item->getFolderId() == m_currentFolderId) ? item : nullptr;
 }
 
-void MainWindow::persistFolder(TodoFolder *folder)
+void MainWindow::persistFolder(TodoFolder *folder, bool changed)
 {
     if (!folder) return;
-    if (!DatabaseManager::instance().upsertFolder(*folder)) {
-        MessageUtils::showError(this, QStringLiteral("保存失败"), DatabaseManager::instance().lastError());
+    m_writer->upsertFolder(*folder);   // 失败经 writeFailed 信号提示
+    m_searchEngine->invalidate();
+    if (changed) {
+        m_store.markFolderChanged(folder->getId());   // 槽函数可能重排文件夹，folder 此后不再使用
     }
 }
 
-void MainWindow::persistItem(TodoItem *item)
+void MainWindow::persistItem(TodoItem *item, TodoChangeFeed::Fields changed)
 {
     if (!item) return;
-    if (!DatabaseManager::instance().upsertItem(*item)) {
-        MessageUtils::showError(this, QStringLiteral("保存失败"), DatabaseManager::instance().lastError());
+    m_writer->upsertItem(*item);
+    m_searchEngine->itemChanged(*item);
+    if (changed) {
+        m_store.markChanged(item->getId(), changed);
     }
 }
 
@@ -946,16 +1161,10 @@ void MainWindow::onNewFolderClicked()
     if (name.isEmpty()) return;
 
     TodoFolder folder(name);
-    m_folders.append(folder);
-    persistFolder(&m_folders.last());
-
     m_currentFolderId = folder.getId();
     m_currentItemId.clear();
-
-    updateFolderList();
-    updateTodoList();
-    clearDetailPanel();
-    updateStatusBar();
+    // folderChanged 重建文件夹列表并选中新文件夹，随后经选择变化刷新待办列表与详情
+    persistFolder(m_store.addFolder(folder), false);
 }
 
 void MainWindow::onFolderSelectionChanged()
@@ -977,20 +1186,20 @@ void MainWindow::onFolderSelectionChanged()
 void MainWindow::onFolderDoubleClicked(QListWidgetItem *item)
 {
     if (!item) return;
-    TodoFolder *folder = findFolderById(item->data(RoleId).toString());
-    if (!folder) return;
+    const QString folderId = item->data(RoleId).toString();
+    const TodoFolder *current = findFolderById(folderId);
+    if (!current) return;
 
     QString newName = MessageUtils::getText(this, QStringLiteral("重命名文件夹"),
-                                            QStringLiteral("请输入新的文件夹名称:"), folder->getName());
+                                            QStringLiteral("请输入新的文件夹名称:"), current->getName());
     newName = newName.trimmed();
     if (newName.isEmpty()) return;
 
+    // 对话框期间模型可能已发布新快照，指针须在修改前重新取
+    TodoFolder *folder = findFolderById(folderId);
+    if (!folder) return;
     folder->setName(newName);
     persistFolder(folder);
-    updateFolderList();
-    if (folder->getId() == m_currentFolderId) {
-        m_todoHeader->setTitle(newName);
-    }
 }
 
 void MainWindow::onFolderContextMenu(const QPoint &pos)
@@ -1019,7 +1228,6 @@ void MainWindow::onFolderContextMenu(const QPoint &pos)
             if (TodoFolder *f = findFolderById(folderId)) {
                 f->setColor(colorValues[i]);
                 persistFolder(f);
-                updateFolderList();
             }
         });
     }
@@ -1045,7 +1253,6 @@ void MainWindow::onPinFolderClicked()
 
     folder->setPinned(!folder->isPinned());
     persistFolder(folder);
-    updateFolderList();
 }
 
 void MainWindow::onDeleteFolderClicked()
@@ -1062,30 +1269,13 @@ void MainWindow::onDeleteFolderClicked()
         return;
     }
 
-    if (!DatabaseManager::instance().deleteFolder(folderId)) {
-        MessageUtils::showError(this, QStringLiteral("删除失败"), DatabaseManager::instance().lastError());
-        return;
-    }
-
-    for (int i = 0; i < m_folders.size(); ++i) {
-        if (m_folders[i].getId() == folderId) {
-            m_folders.removeAt(i);
-            break;
-        }
-    }
-
+    m_writer->deleteFolder(folderId);
     m_currentFolderId.clear();
     m_currentItemId.clear();
-
-    updateFolderList();
-    updateTodoList();
+    m_searchEngine->itemsRemoved(m_store.removeFolder(folderId));   // modelReset：各视图整体重建
     clearDetailPanel();
-    updateCalendarWidget();
-    updateTagWidget();
-    updateDesktopWidget();
-    updateStatusBar();
 
-    if (!m_folders.isEmpty()) {
+    if (m_store.folderCount() > 0) {
         m_folderList->setCurrentRow(0);
     }
 }
@@ -1096,8 +1286,7 @@ void MainWindow::onDeleteFolderClicked()
 
 void MainWindow::onNewTodoClicked()
 {
-    TodoFolder *folder = currentFolder();
-    if (!folder) {
+    if (m_currentFolderId.isEmpty()) {
         MessageUtils::showInfo(this, QStringLiteral("提示"), QStringLiteral("请先选择一个文件夹。"));
         return;
     }
@@ -1108,22 +1297,14 @@ void MainWindow::onNewTodoClicked()
     if (title.isEmpty()) return;
 
     TodoItem item(title);
-    folder->addItem(item);
-    persistItem(folder->findItem(item.getId()));
-
-    m_currentItemId = item.getId();
-    updateTodoList();
-    updateFolderList();
-    updateCalendarWidget();
-    updateTagWidget();
-    updateDesktopWidget();
-    updateStatusBar();
+    m_currentItemId = item.getId();   // itemAdded 插入新行时据此选中
+    persistItem(m_store.addItem(m_currentFolderId, item));
 }
 
 void MainWindow::onQuickAddTodo()
 {
-    TodoFolder *folder = currentFolder();
-    if (!folder) {
+    // 只用 id：currentFolder() 会物化整个文件夹，快速添加不需要
+    if (m_currentFolderId.isEmpty()) {
         MessageUtils::showInfo(this, QStringLiteral("提示"), QStringLiteral("请先选择一个文件夹。"));
         return;
     }
@@ -1132,23 +1313,14 @@ void MainWindow::onQuickAddTodo()
     if (title.isEmpty()) return;
 
     TodoItem item(title);
-    folder->addItem(item);
-    persistItem(folder->findItem(item.getId()));
-
     m_quickAddEdit->clear();
     m_currentItemId = item.getId();
-    updateTodoList();
-    updateFolderList();
-    updateCalendarWidget();
-    updateTagWidget();
-    updateDesktopWidget();
-    updateStatusBar();
+    persistItem(m_store.addItem(m_currentFolderId, item));
 }
 
 void MainWindow::onTodoSelectionChanged()
 {
-    QListWidgetItem *item = m_todoList->currentItem();
-    m_currentItemId = item ? item->data(RoleId).toString() : QString();
+    m_currentItemId = m_todoList->currentIndex().data(RoleId).toString();
 
     if (currentItem()) {
         updateDetailPanel();
@@ -1157,22 +1329,22 @@ void MainWindow::onTodoSelectionChanged()
     }
 }
 
-void MainWindow::onTodoClicked(QListWidgetItem *item)
+void MainWindow::onTodoClicked(const QModelIndex &index)
 {
-    if (!item) return;
+    if (!index.isValid()) return;
 
     // 点击复选框区域：直接切换完成状态
-    QRect itemRect = m_todoList->visualItemRect(item);
+    QRect itemRect = m_todoList->visualRect(index);
     if (TodoDelegate::checkRectFor(itemRect).contains(m_todoList->mapFromGlobal(QCursor::pos()))) {
-        QString itemId = item->data(RoleId).toString();
-        bool completed = item->data(RoleCompleted).toBool();
+        QString itemId = index.data(RoleId).toString();
+        bool completed = index.data(RoleCompleted).toBool();
         toggleTodoCompleted(itemId, !completed);
     }
 }
 
-void MainWindow::onTodoDoubleClicked(QListWidgetItem *item)
+void MainWindow::onTodoDoubleClicked(const QModelIndex &index)
 {
-    Q_UNUSED(item)
+    Q_UNUSED(index)
     // 双击：确保详情面板获得焦点
     if (currentItem() && m_titleEdit) {
         m_titleEdit->setFocus();
@@ -1182,14 +1354,14 @@ void MainWindow::onTodoDoubleClicked(QListWidgetItem *item)
 
 void MainWindow::onTodoContextMenu(const QPoint &pos)
 {
-    QListWidgetItem *item = m_todoList->itemAt(pos);
-    if (!item) return;
+    const QModelIndex index = m_todoList->indexAt(pos);
+    if (!index.isValid()) return;
 
-    QString itemId = item->data(RoleId).toString();
+    QString itemId = index.data(RoleId).toString();
     TodoItem *todo = findTodoItemById(itemId);
     if (!todo) return;
 
-    m_todoList->setCurrentItem(item);
+    m_todoList->setCurrentIndex(index);
 
     QMenu menu(this);
     QAction *pinAction = menu.addAction(Icons::icon(Icons::Pin, 14, Theme::warning()),
@@ -1215,8 +1387,7 @@ void MainWindow::onTodoContextMenu(const QPoint &pos)
     if (chosen == pinAction) {
         if (TodoItem *t = findTodoItemById(itemId)) {
             t->setPinned(!t->isPinned());
-            persistItem(t);
-            updateTodoList();
+            persistItem(t, TodoChangeFeed::Pinned);
         }
     } else if (chosen == deleteAction) {
         deleteTodoItem(itemId);
@@ -1238,12 +1409,8 @@ void MainWindow::onSaveClicked()
         item->setTagColor(colors[colorIndex]);
     }
 
-    persistItem(item);
-    updateTodoList();
-    updateFolderList();
-    updateCalendarWidget();
-    updateTagWidget();
-    updateDesktopWidget();
+    persistItem(item, TodoChangeFeed::Title | TodoChangeFeed::Details
+                      | TodoChangeFeed::Priority | TodoChangeFeed::Color);
 
     MessageUtils::showSuccess(this, QStringLiteral("保存"), QStringLiteral("修改已保存。"));
 }
@@ -1283,35 +1450,22 @@ void MainWindow::onRemindToggled(bool remind)
     } else {
         item->setRemindAt(QDateTime());
     }
-    persistItem(item);
+    persistItem(item, TodoChangeFeed::Reminder);
 }
 
 bool MainWindow::toggleTodoCompleted(const QString &itemId, bool completed)
 {
-    QString folderId;
-    TodoItem *item = findTodoItemById(itemId, &folderId);
+    TodoItem *item = findTodoItemById(itemId);
     if (!item) return false;
 
     item->setCompleted(completed);
-    persistItem(item);
-
-    updateFolderList();
-    updateTodoList();
-    updateCalendarWidget();
-    updateTagWidget();
-    updateDesktopWidget();
-
-    if (m_currentItemId == itemId && currentItem()) {
-        updateDetailPanel();
-    }
-    updateStatusBar();
+    persistItem(item, TodoChangeFeed::Completed);   // 各视图经 itemChanged 只更新这一项
     return true;
 }
 
 bool MainWindow::deleteTodoItem(const QString &itemId)
 {
-    QString folderId;
-    TodoItem *item = findTodoItemById(itemId, &folderId);
+    TodoItem *item = findTodoItemById(itemId);
     if (!item) return false;
 
     if (!MessageUtils::showConfirm(this, QStringLiteral("确认删除"),
@@ -1319,21 +1473,9 @@ bool MainWindow::deleteTodoItem(const QString &itemId)
         return false;
     }
 
-    if (!DatabaseManager::instance().deleteItem(itemId)) {
-        MessageUtils::showError(this, QStringLiteral("删除失败"), DatabaseManager::instance().lastError());
-        return false;
-    }
-
-    if (TodoFolder *folder = findFolderById(folderId)) {
-        folder->removeItem(itemId);
-    }
-    if (m_currentItemId == itemId) {
-        m_currentItemId.clear();
-    }
-
-    refreshAllViews();
-    clearDetailPanel();
-    updateStatusBar();
+    m_writer->deleteItem(itemId);
+    m_searchEngine->itemsRemoved({itemId});
+    m_store.removeItem(itemId);   // itemRemoved：移除所在行，是当前事项时清空详情
     return true;
 }
 
@@ -1347,10 +1489,7 @@ void MainWindow::onTodoTagAdded(const QString &todoId, const QString &tag)
     if (!item) return;
 
     item->addTag(tag);
-    persistItem(item);
-    updateTodoTags();
-    updateTodoList();
-    updateTagWidget();
+    persistItem(item, TodoChangeFeed::Tags);
 }
 
 void MainWindow::onTodoTagRemoved(const QString &todoId, const QString &tag)
@@ -1359,10 +1498,7 @@ void MainWindow::onTodoTagRemoved(const QString &todoId, const QString &tag)
     if (!item) return;
 
     item->removeTag(tag);
-    persistItem(item);
-    updateTodoTags();
-    updateTodoList();
-    updateTagWidget();
+    persistItem(item, TodoChangeFeed::Tags);
 }
 
 // ==========================================================
@@ -1371,98 +1507,87 @@ void MainWindow::onTodoTagRemoved(const QString &todoId, const QString &tag)
 
 void MainWindow::updateFolderList()
 {
-    std::sort(m_folders.begin(), m_folders.end(), [](const TodoFolder &a, const TodoFolder &b) {
+    m_store.sortFolders([](const TodoFolder &a, const TodoFolder &b) {
         if (a.isPinned() != b.isPinned()) return a.isPinned() > b.isPinned();
         return a.getCreatedTime() > b.getCreatedTime();
     });
-
+    const QList<TodoFolder> &folders = m_store.folders();
+
+    // 按文件夹 id 与现有行对齐：只增删、挪动、刷新有变化的行，其余行原样保留
+    QStringList before;
+    before.reserve(m_folderList->count());
+    for (int i = 0; i < m_folderList->count(); ++i) {
+        before.append(m_folderList->item(i)->data(RoleId).toString());
+    }
+    QStringList after;
+    after.reserve(folders.size());
+    for (const TodoFolder &folder : folders) {
+        after.append(folder.getId());
+    }
+    const QListWidgetItem *current = m_folderList->currentItem();
+    const bool wasCurrent = current && current->data(RoleId).toString() == m_currentFolderId;
+
+    const std::vector<KeyedDiff::Step> steps = KeyedDiff::compute(before, after, [&](int from, int item) {
+        const QListWidgetItem *row = m_folderList->item(from);
+        const TodoFolder &folder = folders.at(item);
+        return row->data(RoleTitle).toString() != folder.getName()
+            || row->data(RoleColor).toString() != folder.getColor()
+            || row->data(RolePinned).toBool() != folder.isPinned()
+            || row->data(RoleDoneCount).toInt() != m_store.completedCount(folder.getId())
+            || row->data(RoleTotalCount).toInt() != m_store.itemCount(folder.getId());
+    });
     m_folderList->blockSignals(true);
-    m_folderList->clear();
-
-    int selectRow = -1;
-    for (int i = 0; i < m_folders.size(); ++i) {
-        const TodoFolder &folder = m_folders[i];
-
-        auto *item = new QListWidgetItem();
-        item->setData(RoleId, folder.getId());
-        item->setData(RoleTitle, folder.getName());
-        item->setData(RoleColor, folder.getColor());
-        item->setData(RolePinned, folder.isPinned());
-        item->setData(RoleDoneCount, folder.getCompletedCount());
-        item->setData(RoleTotalCount, folder.getItemCount());
-        m_folderList->addItem(item);
-
-        if (folder.getId() == m_currentFolderId) {
-            selectRow = i;
-        }
+    KeyedDiff::apply(steps,
+        [this](int row) { delete m_folderList->takeItem(row); },
+        [&](int row, int item) {
+            auto *folderRow = new QListWidgetItem();
+            setFolderRowData(folderRow, folders.at(item));
+            m_folderList->insertItem(row, folderRow);
+        },
+        [this](int from, int row) { m_folderList->insertItem(row, m_folderList->takeItem(from)); },
+        [&](int row, int item) { setFolderRowData(m_folderList->item(row), folders.at(item)); });
+
+    const int selectRow = int(after.indexOf(m_currentFolderId));
+    if (selectRow >= 0 && wasCurrent) {
+        m_folderList->setCurrentRow(selectRow);   // 当前文件夹没变：挪动行时落到邻行的选中静默放回
     }
     m_folderList->blockSignals(false);
 
-    if (selectRow >= 0) {
+    if (selectRow >= 0 && !wasCurrent) {
         m_folderList->setCurrentRow(selectRow);
     } else if (m_currentFolderId.isEmpty() && m_folderList->count() > 0) {
         m_folderList->setCurrentRow(0);
     }
 
-    m_folderEmptyHint->setVisible(m_folders.isEmpty());
+    m_folderEmptyHint->setVisible(folders.isEmpty());
 }
 
 void MainWindow::updateTodoList()
 {
     if (m_searching) return;   // 搜索模式下列表由 showSearchResults 管理
 
-    TodoFolder *folder = currentFolder();
-
-    m_todoList->blockSignals(true);
-    m_todoList->clear();
-
-    if (!folder) {
-        m_todoList->blockSignals(false);
+    if (!m_store.containsFolder(m_currentFolderId)) {
+        m_todoModel->setFolder(QString());
         m_todoHeader->setTitle(QStringLiteral("待办事项"));
         m_todoEmptyHint->setText(QStringLiteral("选择一个文件夹查看待办事项"));
         m_todoEmptyHint->setVisible(true);
         return;
     }
 
-    m_todoHeader->setTitle(folder->getName());
-
-    QList<TodoItem> items = folder->getItems();
-    std::sort(items.begin(), items.end(), [](const TodoItem &a, const TodoItem &b) {
-        if (a.isPinned() != b.isPinned()) return a.isPinned() > b.isPinned();
-        if (a.isCompleted() != b.isCompleted()) return a.isCompleted() < b.isCompleted();
-        return a.getCreatedTime() > b.getCreatedTime();
-    });
-
-    int selectRow = -1;
-    for (int i = 0; i < items.size(); ++i) {
-        const TodoItem &todo = items[i];
-
-        QString sub = todo.getDetails().split('\n').first().left(40);
-        if (todo.getDetails().length() > 40) sub += QStringLiteral("...");
-
-        auto *item = new QListWidgetItem();
-        item->setData(RoleId, todo.getId());
-        item->setData(RoleTitle, todo.getTitle());
-        item->setData(RoleSubText, sub);
-        item->setData(RoleDate, todo.getCreatedTime().toString(QStringLiteral("MM-dd")));
-        item->setData(RoleColor, todo.getTagColor());
-        item->setData(RoleCompleted, todo.isCompleted());
-        item->setData(RolePriority, todo.getPriority());
-        item->setData(RolePinned, todo.isPinned());
-        m_todoList->addItem(item);
-
-        if (todo.getId() == m_currentItemId) {
-            selectRow = i;
-        }
-    }
-    m_todoList->blockSignals(false);
+    m_todoHeader->setTitle(m_store.folderName(m_currentFolderId));
 
-    if (selectRow >= 0) {
-        m_todoList->setCurrentRow(selectRow);
+    // 切换文件夹时模型重置，不发 currentChanged，m_currentItemId 保留，随后按它恢复选中；
+    // 同一文件夹只对齐变化的行，当前项若已不在此文件夹，先静默清掉，免得选中落到相邻行上
+    if (m_store.folderOf(m_currentItemId) != m_currentFolderId) {
+        QItemSelectionModel *selection = m_todoList->selectionModel();
+        const QSignalBlocker blocker(selection);
+        selection->clear();
     }
+    m_todoModel->setFolder(m_currentFolderId);
+    selectTodoRow(m_currentItemId);
 
     m_todoEmptyHint->setText(QStringLiteral("这个文件夹还是空的\n在上方输入框快速创建第一条待办吧"));
-    m_todoEmptyHint->setVisible(items.isEmpty());
+    m_todoEmptyHint->setVisible(m_todoModel->rowCount() == 0);
 }
 
 void MainWindow::updateDetailPanel()
@@ -1577,16 +1702,95 @@ void MainWindow::updateTodoTags()
 
 void MainWindow::updateStatusBar()
 {
-    int total = 0, done = 0;
-    for (const TodoFolder &folder : m_folders) {
-        total += folder.getItemCount();
-        done += folder.getCompletedCount();
-    }
     m_statusLabel->setText(QStringLiteral("共 %1 个文件夹 · %2 项待办 · 已完成 %3 项 · 数据已自动备份")
-                           .arg(m_folders.size()).arg(total).arg(done));
+                           .arg(m_store.folderCount()).arg(m_store.itemCount()).arg(m_store.completedCount()));
+}
+
+void MainWindow::updateStatsWidget()
+{
+    if (m_shownPage != StatsPage) {
+        m_pageStale[StatsPage] = true;   // 隐藏的页面切回时再算
+        return;
+    }
+    m_statsWidget->setData(m_store.snapshot());
+}
+
+// ==========================================================
+// 模型变更通知
+// 文件夹列表只改计数所在的行，待办列表只增删改受影响的行；日历、标签、桌面与统计页
+// 各自订阅同一通知（见各组件的 setChangeFeed）。搜索模式下待办列表由搜索结果占用，不跟随。
+// ==========================================================
+
+void MainWindow::onItemAdded(const TodoItem &item)
+{
+    updateFolderRow(item.getFolderId());
+    updateStatusBar();
+    if (m_searching || item.getFolderId() != m_currentFolderId) return;
+
+    m_todoModel->insertItem(item.getId());   // 代理按排序插到应处的行
+    m_todoEmptyHint->setVisible(false);
+    if (item.getId() == m_currentItemId) {
+        selectTodoRow(item.getId());   // 新建的事项：选中并显示详情
+    }
+}
+
+void MainWindow::onItemChanged(const TodoItem &item, TodoChangeFeed::Fields fields)
+{
+    if (fields & TodoChangeFeed::Completed) {
+        updateFolderRow(item.getFolderId());
+        updateStatusBar();
+    }
+
+    if (!m_searching && item.getFolderId() == m_currentFolderId) {
+        // 只刷新这一行；排序键变了由代理挪到新位置，选中随持久索引保持
+        m_todoModel->updateItem(item.getId(), fields);
+    }
+
+    if (item.getId() == m_currentItemId && item.getFolderId() == m_currentFolderId) {
+        if (fields & TodoChangeFeed::Completed) {
+            updateDetailPanel();
+        } else if (fields & TodoChangeFeed::Tags) {
+            updateTodoTags();
+        }
+    }
+}
+
+void MainWindow::onItemMoved(const TodoItem &item, const QString &fromFolderId)
+{
+    updateFolderRow(fromFolderId);
+    updateFolderRow(item.getFolderId());
+    if (m_searching) return;
+    if (fromFolderId == m_currentFolderId) {
+        removeTodoRow(item.getId());
+    } else if (item.getFolderId() == m_currentFolderId) {
+        onItemAdded(item);
+    }
+}
+
+void MainWindow::onItemRemoved(const TodoItem &item)
+{
+    updateFolderRow(item.getFolderId());
+    updateStatusBar();
+    if (!m_searching && item.getFolderId() == m_currentFolderId) {
+        removeTodoRow(item.getId());
+    }
+    if (item.getId() == m_currentItemId) {
+        m_currentItemId.clear();
+        clearDetailPanel();
+    }
+}
+
+void MainWindow::onFolderChanged(const TodoFolder &folder)
+{
+    // 文件夹只有几十个：名称、置顶、颜色的改动直接重建文件夹列表（含重新排序）
+    updateFolderList();
+    if (!m_searching && folder.getId() == m_currentFolderId) {
+        m_todoHeader->setTitle(folder.getName());
+    }
+    updateStatusBar();
 }
 
-void MainWindow::refreshAllViews()
+void MainWindow::onModelReset()
 {
     updateFolderList();
     updateTodoList();
@@ -1597,13 +1801,50 @@ void MainWindow::refreshAllViews()
     updateStatusBar();
 }
 
-void MainWindow::updateStatsWidget()
+void MainWindow::updateFolderRow(const QString &folderId)
+{
+    for (int i = 0; i < m_folderList->count(); ++i) {
+        QListWidgetItem *row = m_folderList->item(i);
+        if (row->data(RoleId).toString() == folderId) {
+            row->setData(RoleDoneCount, m_store.completedCount(folderId));
+            row->setData(RoleTotalCount, m_store.itemCount(folderId));
+            return;
+        }
+    }
+}
+
+void MainWindow::setFolderRowData(QListWidgetItem *row, const TodoFolder &folder) const
+{
+    row->setData(RoleId, folder.getId());
+    row->setData(RoleTitle, folder.getName());
+    row->setData(RoleColor, folder.getColor());
+    row->setData(RolePinned, folder.isPinned());
+    row->setData(RoleDoneCount, m_store.completedCount(folder.getId()));
+    row->setData(RoleTotalCount, m_store.itemCount(folder.getId()));
+}
+
+void MainWindow::selectTodoRow(const QString &itemId)
 {
-    if (m_statsWidget) {
-        m_statsWidget->setData(m_folders);
+    const int row = m_todoModel->rowOf(itemId);
+    if (row >= 0) {
+        m_todoList->setCurrentIndex(m_todoProxy->mapFromSource(m_todoModel->index(row)));
     }
 }
 
+void MainWindow::removeTodoRow(const QString &itemId)
+{
+    const int row = m_todoModel->rowOf(itemId);
+    if (row < 0) return;
+    QItemSelectionModel *selection = m_todoList->selectionModel();
+    if (m_todoProxy->mapToSource(selection->currentIndex()).row() == row) {
+        // 不让选中落到相邻行上：先静默清掉当前项再删行
+        const QSignalBlocker blocker(selection);
+        selection->clear();
+    }
+    m_todoModel->removeItem(itemId);
+    m_todoEmptyHint->setVisible(m_todoModel->rowCount() == 0);
+}
+
 // ==========================================================
 // 全局搜索
 // ==========================================================
@@ -1612,53 +1853,122 @@ void MainWindow::onSearchTextChanged(const QString &text)
 {
     const QString needle = text.trimmed();
     if (needle.isEmpty()) {
+        m_searchEngine->cancel();
         if (m_searching) {
             m_searching = false;
             updateTodoList();
         }
         return;
     }
+    // 查询在后台线程池执行（带防抖与取消），结果经 resultsReady 回到 showSearchResults
+    m_searchEngine->search(m_store.folders(), needle);
+}
+
+void MainWindow::showSearchResults(const QString &text, const QList<SearchEngine::Hit> &hits, int total)
+{
+    if (m_searchEdit->text().trimmed().isEmpty()) {
+        return;   // 结果到达前搜索框已清空
+    }
     m_searching = true;
-    showSearchResults(needle);
     // 切到列表页展示结果
     if (m_stack->currentIndex() != 0) {
         m_navBar->setCurrentIndex(0);
     }
+
+    m_todoModel->setSearchHits(hits);   // 命中的各角色在绘制时才格式化
+
+    m_todoHeader->setTitle(total > hits.size()
+        ? QStringLiteral("搜索：%1（前 %2 / 共 %3 项）").arg(text).arg(hits.size()).arg(total)
+        : QStringLiteral("搜索：%1").arg(text));
+    m_todoEmptyHint->setText(QStringLiteral("没有找到符合 \"%1\" 的待办").arg(text));
+    m_todoEmptyHint->setVisible(hits.isEmpty());
 }
 
-void MainWindow::showSearchResults(const QString &text)
-{
-    m_todoList->blockSignals(true);
-    m_todoList->clear();
-
-    int hits = 0;
-    for (const TodoFolder &folder : m_folders) {
-        for (const TodoItem &todo : folder.getItems()) {
-            const bool match = todo.getTitle().contains(text, Qt::CaseInsensitive)
-                || todo.getDetails().contains(text, Qt::CaseInsensitive)
-                || todo.getTags().contains(text, Qt::CaseInsensitive);
-            if (!match) continue;
-
-            auto *item = new QListWidgetItem();
-            item->setData(RoleId, todo.getId());
-            item->setData(RoleFolderId, folder.getId());
-            item->setData(RoleTitle, todo.getTitle());
-            item->setData(RoleSubText, QStringLiteral("%1 · %2").arg(folder.getName(),
-                          todo.getDetails().split('\n').first().left(30)));
-            item->setData(RoleDate, todo.getCreatedTime().toString(QStringLiteral("MM-dd")));
-            item->setData(RoleColor, todo.getTagColor());
-            item->setData(RoleCompleted, todo.isCompleted());
-            item->setData(RolePriority, todo.getPriority());
-            item->setData(RolePinned, todo.isPinned());
-            m_todoList->addItem(item);
-            ++hits;
+// ==========================================================
+// 命令面板
+// ==========================================================
+
+void MainWindow::onCommandPaletteRequested()
+{
+    // 操作：key 用于下方分派
+    const QList<std::pair<QString, QString>> actions = {
+        {QStringLiteral("newTodo"), QStringLiteral("新建待办")},
+        {QStringLiteral("newFolder"), QStringLiteral("新建文件夹")},
+        {QStringLiteral("import"), QStringLiteral("导入数据")},
+        {QStringLiteral("export"), QStringLiteral("导出数据")},
+        {QStringLiteral("backup"), QStringLiteral("立即备份")},
+        {QStringLiteral("restore"), QStringLiteral("从备份恢复")},
+        {QStringLiteral("verify"), QStringLiteral("校验备份")},
+        {QStringLiteral("backupDir"), QStringLiteral("打开备份目录")},
+        {QStringLiteral("trash"), QStringLiteral("回收站")},
+        {QStringLiteral("theme"), Theme::isDark() ? QStringLiteral("切换到浅色模式") : QStringLiteral("切换到深色模式")},
+        {QStringLiteral("desktop"), QStringLiteral("桌面小贴士")},
+    };
+    // 文件夹与事项候选随变更通知常驻更新，这里只同步操作与标签
+    m_paletteCorpus->prepare(actions, DatabaseManager::instance().allTagNames());
+
+    CommandPalette palette(m_paletteCorpus, this);
+    if (palette.exec() != QDialog::Accepted) {
+        return;
+    }
+    const QString key = palette.selectedKey();
+    switch (palette.selectedKind()) {
+    case PaletteCorpus::Action:
+        if (key == QLatin1String("newTodo")) {
+            m_navBar->setCurrentIndex(0);
+            onNewTodoClicked();
+        } else if (key == QLatin1String("newFolder")) {
+            m_navBar->setCurrentIndex(0);
+            onNewFolderClicked();
+        } else if (key == QLatin1String("import")) {
+            onImportClicked();
+        } else if (key == QLatin1String("export")) {
+            onExportClicked();
+        } else if (key == QLatin1String("backup")) {
+            onBackupClicked();
+        } else if (key == QLatin1String("restore")) {
+            onRestoreBackupClicked();
+        } else if (key == QLatin1String("verify")) {
+            onVerifyBackupsClicked();
+        } else if (key == QLatin1String("backupDir")) {
+            onOpenBackupDir();
+        } else if (key == QLatin1String("trash")) {
+            onTrashClicked();
+        } else if (key == QLatin1String("theme")) {
+            m_darkAction->trigger();     // 同步菜单里的勾选状态
+        } else if (key == QLatin1String("desktop")) {
+            onDesktopWidgetClicked();
+        }
+        break;
+    case PaletteCorpus::Folder:
+        m_searchEdit->clear();
+        m_navBar->setCurrentIndex(0);
+        m_currentFolderId = key;
+        m_currentItemId.clear();
+        updateFolderList();
+        updateTodoList();
+        clearDetailPanel();
+        break;
+    case PaletteCorpus::Item: {
+        QString folderId;
+        if (findTodoItemById(key, &folderId)) {
+            m_searchEdit->clear();
+            m_navBar->setCurrentIndex(0);
+            m_currentFolderId = folderId;
+            m_currentItemId = key;
+            updateFolderList();
+            updateTodoList();
+            updateDetailPanel();
         }
+        break;
+    }
+    case PaletteCorpus::Tag:
+        // 交给搜索框的查询语言：列出带该标签的全部待办
+        m_navBar->setCurrentIndex(0);
+        m_searchEdit->setText(key.contains(QLatin1Char(' ')) ? QStringLiteral("tag:\"%1\"").arg(key)
+                                                             : QLatin1Char('#') + key);
+        break;
     }
-    m_todoList->blockSignals(false);
-
-    m_todoHeader->setTitle(QStringLiteral("搜索：%1").arg(text));
-    m_todoEmptyHint->setText(QStringLiteral("没有找到包含 \"%1\" 的待办").arg(text));
-    m_todoEmptyHint->setVisible(hits == 0);
 }
 
 // ==========================================================
@@ -1666,6 +1976,12 @@ void MainWindow::showSearchResults(const QString &text)
 // ==========================================================
 
 void MainWindow::onTrashClicked()
+{
+    // 回收站直接读写主连接：等后台写队列落库后再打开，保证看到最新删除
+    m_writer->flush(this, [this]() { showTrashDialog(); });
+}
+
+void MainWindow::showTrashDialog()
 {
     auto &db = DatabaseManager::instance();
     const QList<TodoItem> deleted = db.loadDeleted();
@@ -1724,9 +2040,9 @@ void MainWindow::onTrashClicked()
                                    QStringLiteral("原文件夹已被删除，该待办无法恢复。"));
             return;
         }
-        // 重新加载内存数据并刷新
-        m_folders = db.loadAll();
-        refreshAllViews();
+        // 重新加载内存数据（modelReset：各视图整体重建）
+        m_store.reset(db.loadAll());
+        m_searchEngine->resetModel();
         clearDetailPanel();
         dlg.accept();
         MessageUtils::showSuccess(this, QStringLiteral("已恢复"), QStringLiteral("待办已恢复到原文件夹。"));
@@ -1757,19 +2073,23 @@ void MainWindow::checkReminders()
     if (!m_trayIcon || !m_trayIcon->isVisible()) return;
 
     const QDateTime now = QDateTime::currentDateTime();
-    for (TodoFolder &folder : m_folders) {
-        for (TodoItem &item : folder.getItemsRef()) {
+    QStringList dueIds;
+    for (const TodoFolder &folder : m_store.folders()) {
+        for (const TodoItem &item : folder.getItems()) {
             const QDateTime remindAt = item.getRemindAt();
-            if (!remindAt.isValid() || item.isCompleted() || remindAt > now) {
-                continue;
+            if (remindAt.isValid() && !item.isCompleted() && remindAt <= now) {
+                dueIds.append(item.getId());
             }
-            m_trayIcon->showMessage(QStringLiteral("待办提醒"),
-                                    QStringLiteral("「%1」今天到期，记得处理哦").arg(item.getTitle()),
-                                    QSystemTrayIcon::Information, 8000);
-            item.setRemindAt(QDateTime());   // 提醒一次后清除
-            persistItem(&item);
         }
     }
+    for (const QString &id : dueIds) {
+        TodoItem *item = m_store.item(id);
+        m_trayIcon->showMessage(QStringLiteral("待办提醒"),
+                                QStringLiteral("「%1」今天到期，记得处理哦").arg(item->getTitle()),
+                                QSystemTrayIcon::Information, 8000);
+        item->setRemindAt(QDateTime());   // 提醒一次后清除
+        persistItem(item, TodoChangeFeed::Reminder);
+    }
 }
 
 // ==========================================================
@@ -1826,7 +2146,6 @@ void MainWindow::onToggleDarkMode(bool dark)
     for (QWidget *w : QApplication::topLevelWidgets()) {
         w->update();
     }
-    refreshAllViews();
 }
 
 // ==========================================================
@@ -1836,7 +2155,8 @@ void MainWindow::onToggleDarkMode(bool dark)
 void MainWindow::setupDesktopWidget()
 {
     m_desktopWidget = new DesktopWidget();
-    m_desktopWidget->updateTodoData(m_folders);
+    m_desktopWidget->updateTodoData(m_store.snapshot());
+    m_desktopWidget->setChangeFeed(m_store.feed());
 
     connect(m_desktopWidget, &DesktopWidget::newTodoRequested, this, &MainWindow::onDesktopNewTodo);
     connect(m_desktopWidget, &DesktopWidget::todoItemToggled, this, &MainWindow::onDesktopTodoToggled);
@@ -1861,7 +2181,7 @@ void MainWindow::setupDesktopWidget()
 void MainWindow::updateDesktopWidget()
 {
     if (m_desktopWidget) {
-        m_desktopWidget->updateTodoData(m_folders);
+        m_desktopWidget->updateTodoData(m_store.snapshot());
     }
 }
 
@@ -1870,28 +2190,14 @@ void MainWindow::onDesktopNewTodo(const QString &title)
     // 桌面快速添加：归入以今天日期命名的文件夹
     QString todayName = QDate::currentDate().toString(QStringLiteral("yyyy-MM-dd"));
 
-    TodoFolder *target = nullptr;
-    for (TodoFolder &folder : m_folders) {
-        if (folder.getName() == todayName) {
-            target = &folder;
-            break;
-        }
-    }
-    if (!target) {
-        m_folders.append(TodoFolder(todayName));
-        target = &m_folders.last();
-        persistFolder(target);
+    QString folderId = m_store.folderIdByName(todayName);
+    if (folderId.isEmpty()) {
+        const TodoFolder target(todayName);
+        folderId = target.getId();
+        persistFolder(m_store.addFolder(target), false);
     }
 
-    TodoItem item(title);
-    QString folderId = target->getId();
-    target->addItem(item);
-    if (TodoItem *stored = target->findItem(item.getId())) {
-        persistItem(stored);
-    }
-
-    Q_UNUSED(folderId)
-    refreshAllViews();
+    persistItem(m_store.addItem(folderId, TodoItem(title)));
 }
 
 void MainWindow::onDesktopTodoToggled(const QString &itemId, bool completed)
@@ -1906,6 +2212,97 @@ void MainWindow::onShowMainWindow()
     raise();
 }
 
+// ==========================================================
+// 导航页：按需构建，隐藏时退订
+// ==========================================================
+
+void MainWindow::onPageAboutToChange(int index)
+{
+    if (index == m_shownPage) {
+        return;
+    }
+    detachPage(m_shownPage);
+    ensurePage(index);
+    m_shownPage = index;
+    attachPage(index);
+}
+
+void MainWindow::ensurePage(int index)
+{
+    QWidget *page = nullptr;
+    switch (index) {
+    case CalendarPage:
+        if (!m_calendarWidget) {
+            setupCalendarWidget();
+            page = m_calendarWidget;
+        }
+        break;
+    case TagPage:
+        if (!m_tagWidget) {
+            setupTagWidget();
+            page = m_tagWidget;
+        }
+        break;
+    case StatsPage:
+        if (!m_statsWidget) {
+            m_statsWidget = new StatsWidget(this);
+            page = m_statsWidget;
+        }
+        break;
+    default:
+        break;
+    }
+    if (!page) {
+        return;   // 列表页或已构建
+    }
+
+    // 替换占位：先插入新页再移除占位，栈的当前页不受影响
+    QWidget *placeholder = m_stack->widget(index);
+    m_stack->insertWidget(index, page);
+    m_stack->removeWidget(placeholder);
+    delete placeholder;
+    m_pageStale[index] = true;   // 新页还没有数据，attachPage 时填充
+}
+
+void MainWindow::attachPage(int index)
+{
+    // 离开后模型有过修改（版本号变了）或有模型以外的变化，才整页重算
+    const bool stale = m_pageStale[index] || m_pageVersion[index] != m_store.version();
+    m_pageStale[index] = false;
+    switch (index) {
+    case CalendarPage:
+        if (stale) {
+            updateCalendarWidget();
+        }
+        m_calendarWidget->setChangeFeed(m_store.feed());
+        break;
+    case TagPage:
+        if (stale) {
+            updateTagWidget();
+        }
+        m_tagWidget->setChangeFeed(m_store.feed());
+        break;
+    case StatsPage:
+        if (stale) {
+            updateStatsWidget();
+        }
+        m_statsWidget->setChangeFeed(m_store.feed());
+        break;
+    default:
+        break;
+    }
+}
+
+void MainWindow::detachPage(int index)
+{
+    if (index == ListPage) {
+        return;   // 列表页的增量由 MainWindow 自己处理，始终订阅
+    }
+    // 页面的订阅都以页面自身为接收者，一次断开
+    disconnect(m_store.feed(), nullptr, m_stack->widget(index), nullptr);
+    m_pageVersion[index] = m_store.version();
+}
+
 void MainWindow::setupCalendarWidget()
 {
     m_calendarWidget = new CalendarWidget(this);
@@ -1917,37 +2314,28 @@ void MainWindow::setupCalendarWidget()
 
 void MainWindow::updateCalendarWidget()
 {
-    if (m_calendarWidget) {
-        m_calendarWidget->updateTodoData(m_folders);
+    if (m_shownPage != CalendarPage) {
+        m_pageStale[CalendarPage] = true;
+        return;
     }
+    m_calendarWidget->updateTodoData(m_store.snapshot());
 }
 
 void MainWindow::onCalendarTodoAdded(const QString &title, const QDate &date)
 {
     QString folderName = date.toString(QStringLiteral("yyyy-MM-dd"));
 
-    TodoFolder *target = nullptr;
-    for (TodoFolder &folder : m_folders) {
-        if (folder.getName() == folderName) {
-            target = &folder;
-            break;
-        }
-    }
-    if (!target) {
-        m_folders.append(TodoFolder(folderName));
-        target = &m_folders.last();
-        persistFolder(target);
+    QString folderId = m_store.folderIdByName(folderName);
+    if (folderId.isEmpty()) {
+        const TodoFolder target(folderName);
+        folderId = target.getId();
+        persistFolder(m_store.addFolder(target), false);
     }
 
     TodoItem item(title);
     item.setDueDate(date);
     item.setPlannedDate(date);
-    target->addItem(item);
-    if (TodoItem *stored = target->findItem(item.getId())) {
-        persistItem(stored);
-    }
-
-    refreshAllViews();
+    persistItem(m_store.addItem(folderId, item));
 }
 
 void MainWindow::onCalendarTodoToggled(const QString &itemId, bool completed)
@@ -1982,23 +2370,35 @@ void MainWindow::setupTagWidget()
         updateTagWidget();
     });
     connect(m_tagWidget, &TagWidget::tagDeleted, this, [this](const QString &tag) {
-        DatabaseManager::instance().removeTag(tag);
-        for (TodoFolder &folder : m_folders) {
-            for (TodoItem &item : folder.getItems()) {
-                item.removeTag(tag);
+        // 排队中的事项写入可能仍引用该标签：等写队列落库后再删
+        m_writer->flush(this, [this, tag]() {
+            DatabaseManager::instance().removeTag(tag);
+            // 库里的关联已由 removeTag 清掉，这里只同步内存模型
+            QStringList tagged;
+            for (const TodoFolder &folder : m_store.folders()) {
+                for (const TodoItem &item : folder.getItems()) {
+                    if (item.hasTag(tag)) {
+                        tagged.append(item.getId());
+                    }
+                }
             }
-        }
-        updateTodoList();
-        updateTagWidget();
-        updateTodoTags();
+            for (const QString &id : tagged) {
+                m_store.item(id)->removeTag(tag);
+                m_store.markChanged(id, TodoChangeFeed::Tags);
+            }
+            m_searchEngine->resetModel();
+            updateTagWidget();   // 标签库也变了
+        });
     });
 }
 
 void MainWindow::updateTagWidget()
 {
-    if (m_tagWidget) {
-        m_tagWidget->updateData(m_folders, DatabaseManager::instance().allTagNames());
+    if (m_shownPage != TagPage) {
+        m_pageStale[TagPage] = true;
+        return;
     }
+    m_tagWidget->updateData(m_store.snapshot(), DatabaseManager::instance().allTagNames());
 }
 
 // ==========================================================
@@ -2007,94 +2407,196 @@ void MainWindow::updateTagWidget()
 
 void MainWindow::onImportClicked()
 {
+    if (!m_pendingImportPath.isEmpty() || !m_importAction.isEmpty() || m_importer->isRunning()) {
+        return;   // 上一次导入（或恢复）尚未结束
+    }
+
     QString fileName = QFileDialog::getOpenFileName(this, QStringLiteral("导入数据"), QString(),
                                                     QStringLiteral("JSON文件 (*.json)"));
     if (fileName.isEmpty()) return;
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly)) {
-        MessageUtils::showError(this, QStringLiteral("错误"), QStringLiteral("无法打开文件进行读取。"));
-        return;
-    }
-    QByteArray data = file.readAll();
-    file.close();
-
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject() || !doc.object().contains(QStringLiteral("folders"))) {
-        MessageUtils::showError(this, QStringLiteral("错误"), QStringLiteral("文件格式不正确，缺少 folders 数据。"));
+    if (!MessageUtils::showConfirm(this, QStringLiteral("确认导入"),
+            QStringLiteral("导入将替换当前全部数据。\n系统会先自动备份当前数据，确定继续吗？"))) {
         return;
     }
 
-    // 先在内存中完整解析并校验，避免半途失败损坏现有数据
-    QList<TodoFolder> imported;
-    QJsonArray foldersArray = doc.object()[QStringLiteral("folders")].toArray();
-    for (const QJsonValue &folderVal : foldersArray) {
-        if (!folderVal.isObject()) {
-            MessageUtils::showError(this, QStringLiteral("错误"), QStringLiteral("文件内容损坏，导入已取消。"));
-            return;
+    // 导入前自动备份（等后台写队列落库后再备份，备份与替换都基于最新数据）；
+    // 备份完成后在 finished 回调里开始导入
+    m_pendingImportPath = fileName;
+    m_writer->flush(this, [this]() {
+        m_importBackupJob = m_backup->backup(QStringLiteral("pre_import"));
+        if (m_importBackupJob == 0) {
+            startImport(std::exchange(m_pendingImportPath, {}));
         }
-        imported.append(TodoFolder(folderVal.toObject()));
-    }
+    });
+}
 
-    if (!MessageUtils::showConfirm(this, QStringLiteral("确认导入"),
-            QStringLiteral("导入将替换当前全部数据（%1 个文件夹）。\n系统会先自动备份当前数据，确定继续吗？").arg(imported.size()))) {
+void MainWindow::startImport(const QString &fileName)
+{
+    beginImportJob(QStringLiteral("导入"), [this, fileName]() {
+        m_importer->start(fileName, DatabaseManager::instance().databasePath());
+    });
+}
+
+void MainWindow::startRestore(const QList<TodoFolder> &folders)
+{
+    // 快照已在备份线程读出；写库同导入一样在后台单事务整体替换，GUI 线程只等结果
+    if (!m_importAction.isEmpty() || m_importer->isRunning()) {
+        MessageUtils::showError(this, QStringLiteral("恢复失败"), QStringLiteral("正在导入数据，请稍后再试。"));
         return;
     }
+    beginImportJob(QStringLiteral("恢复"), [this, folders]() {
+        m_importer->start(folders, DatabaseManager::instance().databasePath());
+    });
+}
 
-    // 导入前自动备份
-    DatabaseManager::instance().backupNow(QStringLiteral("pre_import"));
+void MainWindow::beginImportJob(const QString &action, const std::function<void()> &start)
+{
+    // 导入事务持有写锁直到提交：暂停提醒检查（它会写库），等写队列落库后再开始；
+    // 模态进度框期间不会产生新的编辑
+    m_reminderTimer->stop();
+    m_importAction = action;
 
-    if (!DatabaseManager::instance().replaceAll(imported)) {
-        MessageUtils::showError(this, QStringLiteral("导入失败"),
-                                DatabaseManager::instance().lastError() + QStringLiteral("\n现有数据未受影响。"));
-        return;
-    }
+    m_importProgress = new QProgressDialog(QStringLiteral("正在%1数据…").arg(action), QStringLiteral("取消"), 0, 100, this);
+    m_importProgress->setWindowTitle(action + QStringLiteral("数据"));
+    m_importProgress->setWindowModality(Qt::ApplicationModal);
+    m_importProgress->setMinimumDuration(0);
+    m_importProgress->setAutoClose(false);
+    m_importProgress->setAutoReset(false);
+    connect(m_importProgress, &QProgressDialog::canceled, m_importer, &ImportEngine::cancel);
+    m_importProgress->setValue(0);
 
-    m_folders = imported;
+    m_writer->flush(this, [this, start]() {
+        start();
+        if (m_importProgress && m_importProgress->wasCanceled()) {
+            m_importer->cancel();   // 等待落库期间已点取消：照常经 finished(cancelled) 收尾
+        }
+    });
+}
+
+void MainWindow::applyImport(const QList<TodoFolder> &imported, const QString &action)
+{
+    // 库已由 ImportEngine 整体替换并提交，这里只重置内存模型
+    int itemCount = 0;
+    for (const TodoFolder &folder : imported) {
+        itemCount += folder.getItemCount();
+    }
     m_currentFolderId.clear();
     m_currentItemId.clear();
-
-    refreshAllViews();
+    m_store.reset(imported);   // modelReset：各视图整体重建
+    m_searchEngine->resetModel();
     clearDetailPanel();
-    if (!m_folders.isEmpty()) {
+    if (m_store.folderCount() > 0) {
         m_folderList->setCurrentRow(0);
     }
 
-    MessageUtils::showSuccess(this, QStringLiteral("导入成功"), QStringLiteral("数据已成功导入！"));
+    MessageUtils::showSuccess(this, action + QStringLiteral("成功"),
+                              QStringLiteral("已%1 %2 个文件夹、%3 项待办。").arg(action).arg(imported.size()).arg(itemCount));
 }
 
 void MainWindow::onExportClicked()
 {
+    if (m_exporter->isRunning() || m_exportProgress) {
+        return;   // 上一次导出尚未结束
+    }
+
+    QString selectedFilter;
     QString fileName = QFileDialog::getSaveFileName(this, QStringLiteral("导出数据"),
                                                     QStringLiteral("todolist_export.json"),
-                                                    QStringLiteral("JSON文件 (*.json)"));
+                                                    QStringLiteral("JSON文件 (*.json);;NDJSON文件 (*.ndjson)"),
+                                                    &selectedFilter);
     if (fileName.isEmpty()) return;
 
-    QJsonObject root;
-    QJsonArray foldersArray;
-    for (const TodoFolder &folder : m_folders) {
-        foldersArray.append(folder.toJson());
+    const bool ndjson = fileName.endsWith(QStringLiteral(".ndjson"), Qt::CaseInsensitive)
+                        || selectedFilter.contains(QStringLiteral("ndjson"));
+
+    m_exportProgress = new QProgressDialog(QStringLiteral("正在导出数据…"), QStringLiteral("取消"), 0, 100, this);
+    m_exportProgress->setWindowTitle(QStringLiteral("导出数据"));
+    m_exportProgress->setWindowModality(Qt::WindowModal);
+    m_exportProgress->setMinimumDuration(500);
+    m_exportProgress->setAutoClose(false);
+    m_exportProgress->setAutoReset(false);
+    connect(m_exportProgress, &QProgressDialog::canceled, m_exporter, &ExportEngine::cancel);
+    m_exportProgress->setValue(0);
+
+    // 导出读的是数据库：等后台写队列落库后再开始
+    m_writer->flush(this, [this, fileName, ndjson]() {
+        m_exporter->start(fileName, ndjson ? ExportEngine::NdJson : ExportEngine::Json,
+                          DatabaseManager::instance().databasePath());
+        if (m_exportProgress && m_exportProgress->wasCanceled()) {
+            m_exporter->cancel();
+        }
+    });
+}
+
+void MainWindow::onBackupClicked()
+{
+    if (m_manualBackupJob != 0 || m_manualBackupQueued) {
+        return;   // 正在备份
+    }
+    m_manualBackupQueued = true;
+    m_writer->flush(this, [this]() {
+        m_manualBackupQueued = false;
+        m_manualBackupJob = m_backup->backup(QStringLiteral("manual"));
+        if (m_manualBackupJob == 0) {
+            MessageUtils::showError(this, QStringLiteral("备份失败"), QStringLiteral("数据库未打开"));
+        }
+    });
+}
+
+void MainWindow::onRestoreBackupClicked()
+{
+    if (!m_restoreSnapshotId.isEmpty() || m_restoreBackupJob != 0 || m_restoreJob != 0
+        || !m_importAction.isEmpty() || m_importer->isRunning()) {
+        return;   // 上一次恢复（或导入）尚未完成
     }
-    root[QStringLiteral("folders")] = foldersArray;
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly)) {
-        MessageUtils::showError(this, QStringLiteral("错误"), QStringLiteral("无法创建文件进行写入。"));
+    const QList<BackupStore::Snapshot> snapshots = m_backup->snapshots();
+    if (snapshots.isEmpty()) {
+        MessageUtils::showInfo(this, QStringLiteral("从备份恢复"), QStringLiteral("暂无可用的备份快照。"));
+        return;
+    }
+
+    const QHash<QString, QString> reasonNames = {
+        {QStringLiteral("startup"),       QStringLiteral("启动")},
+        {QStringLiteral("manual"),        QStringLiteral("手动")},
+        {QStringLiteral("pre_import"),    QStringLiteral("导入前")},
+        {QStringLiteral("pre_restore"),   QStringLiteral("恢复前")},
+        {QStringLiteral("pre_migration"), QStringLiteral("升级前")},
+    };
+    QStringList labels;
+    for (const BackupStore::Snapshot &snap : snapshots) {
+        labels.append(QStringLiteral("%1 · %2 · %3 KB")
+                      .arg(snap.created.toString(QStringLiteral("yyyy-MM-dd HH:mm:ss")),
+                           reasonNames.value(snap.reason, snap.reason))
+                      .arg((snap.size + 1023) / 1024));
+    }
+    const QString choice = MessageUtils::getItem(this, QStringLiteral("从备份恢复"),
+                                                 QStringLiteral("选择要恢复的快照："), labels, 0, false);
+    const int index = labels.indexOf(choice);
+    if (index < 0) {
+        return;
+    }
+    if (!MessageUtils::showConfirm(this, QStringLiteral("确认恢复"),
+            QStringLiteral("恢复将替换当前全部数据。\n系统会先自动备份当前数据，确定继续吗？"))) {
         return;
     }
-    file.write(QJsonDocument(root).toJson());
-    file.close();
 
-    MessageUtils::showSuccess(this, QStringLiteral("导出成功"), QStringLiteral("数据已成功导出！"));
+    // 写队列落库后先备份当前数据，备份完成后在 finished 回调里发起恢复
+    m_restoreSnapshotId = snapshots.at(index).id;
+    m_writer->flush(this, [this]() {
+        m_restoreBackupJob = m_backup->backup(QStringLiteral("pre_restore"));
+    });
 }
 
-void MainWindow::onBackupClicked()
+void MainWindow::onVerifyBackupsClicked()
 {
-    if (DatabaseManager::instance().backupNow(QStringLiteral("manual"))) {
-        MessageUtils::showSuccess(this, QStringLiteral("备份完成"),
-                                  QStringLiteral("数据库快照已保存到备份目录。"));
-    } else {
-        MessageUtils::showError(this, QStringLiteral("备份失败"), DatabaseManager::instance().lastError());
+    if (m_verifyJob != 0) {
+        return;
+    }
+    m_verifyJob = m_backup->verify();
+    if (m_verifyJob != 0) {
+        statusBar()->showMessage(QStringLiteral("正在校验备份…"));
     }
 }
 
@@ -2186,11 +2688,31 @@ void MainWindow::closeEvent(QCloseEvent *event)
 void MainWindow::onAboutToQuit()
 {
     saveSplitterState();
+    // 退出钩子：stop() 先把合并窗口内尚未提交的写入组提交，再关闭写线程
+    m_writer->stop();
+    m_backup->stop();
+    saveModelSnapshot();
     if (m_desktopWidget) {
         m_desktopWidget->close();
     }
 }
 
+void MainWindow::saveModelSnapshot()
+{
+    // 须在写线程落库并停止之后调用：此时库的版本戳恰好对应内存模型。
+    // 本次运行有写入失败时内存与库可能不一致，不留快照，下次从库加载
+    auto &db = DatabaseManager::instance();
+    const QString path = db.snapshotPath();
+    const DatabaseManager::ChangeStamp stamp = db.isOpen() ? db.changeStamp() : DatabaseManager::ChangeStamp();
+    QString error;
+    if (m_modelDiverged || !stamp.isValid() || !ModelSnapshot::save(path, m_store.folders(), stamp, &error)) {
+        if (!error.isEmpty()) {
+            qWarning() << "[MainWindow] model snapshot not saved:" << error;
+        }
+        QFile::remove(path);
+    }
+}
+
 // ==========================================================
 // 拖拽：待办事项 -> 文件夹
 // ==========================================================
@@ -2225,20 +2747,15 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
             if (target && !m_currentItemId.isEmpty() && !m_currentFolderId.isEmpty()) {
                 QString targetFolderId = target->data(RoleId).toString();
                 if (targetFolderId != m_currentFolderId) {
-                    TodoFolder *src = currentFolder();
-                    TodoFolder *dst = findFolderById(targetFolderId);
-                    TodoItem *item = src ? src->findItem(m_currentItemId) : nullptr;
-                    if (src && dst && item) {
-                        TodoItem copy = *item;
-                        src->removeItem(copy.getId());
-                        dst->addItem(copy);
-                        if (TodoItem *stored = dst->findItem(copy.getId())) {
-                            DatabaseManager::instance().moveItem(stored->getId(), targetFolderId);
-                        }
+                    // itemMoved 更新两个文件夹的计数并移走原列表中的行，随后切到目标文件夹
+                    const TodoItem *moved = currentItem() ? m_store.moveItem(m_currentItemId, targetFolderId) : nullptr;
+                    if (moved) {
+                        m_writer->moveItem(m_currentItemId, targetFolderId);
+                        m_searchEngine->itemChanged(*moved);
 
                         m_currentFolderId = targetFolderId;
-                        m_currentItemId = copy.getId();
-                        refreshAllViews();
+                        updateFolderList();
+                        updateTodoList();
                         updateDetailPanel();
                     }
                 }
@@ -4,6 +4,7 @@
 #include <QMainWindow>
 #include <QByteArray>
 #include <QListWidget>
+#include <QListView>
 #include <QListWidgetItem>
 #include <QSplitter>
 #include <QSystemTrayIcon>
@@ -19,9 +20,13 @@
 #include <QPushButton>
 #include <QScrollArea>
 #include <QTimer>
+#include <functional>
 
 #include "../core/todoitem.h"
 #include "../core/todofolder.h"
+#include "../core/databasemanager.h"
+#include "../core/searchengine.h"
+#include "../core/todostore.h"
 #include "widgets/desktopwidget.h"
 #include "widgets/calendarwidget.h"
 #include "widgets/tagwidget.h"
@@ -30,6 +35,14 @@
 class NavBar;
 class SectionHeader;
 class TitleBar;
+class DatabaseWriter;
+class BackupEngine;
+class ImportEngine;
+class ExportEngine;
+class PaletteCorpus;
+class TodoListModel;
+class TodoListProxy;
+class QProgressDialog;
 
 class MainWindow : public QMainWindow
 {
@@ -52,8 +65,8 @@ private slots:
     void onNewTodoClicked();
     void onQuickAddTodo();
     void onTodoSelectionChanged();
-    void onTodoClicked(QListWidgetItem *item);
-    void onTodoDoubleClicked(QListWidgetItem *item);
+    void onTodoClicked(const QModelIndex &index);
+    void onTodoDoubleClicked(const QModelIndex &index);
     void onTodoContextMenu(const QPoint &pos);
     void onSaveClicked();
     void onDeleteClicked();
@@ -69,6 +82,8 @@ private slots:
     void onExportClicked();
     void onBackupClicked();
     void onOpenBackupDir();
+    void onRestoreBackupClicked();
+    void onVerifyBackupsClicked();
     void onExitClicked();
     void onDesktopWidgetClicked();
 
@@ -78,6 +93,9 @@ private slots:
     // 回收站
     void onTrashClicked();
 
+    // 命令面板（Ctrl+K）
+    void onCommandPaletteRequested();
+
     // 提醒
     void checkReminders();
 
@@ -94,6 +112,9 @@ private slots:
     void onCalendarTodoToggled(const QString &itemId, bool completed);
     void onCalendarTodoDeleted(const QString &itemId);
 
+    // 导航切页
+    void onPageAboutToChange(int index);
+
     // 托盘
     void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
     void onShowFromTray();
@@ -101,6 +122,9 @@ private slots:
     void onAboutToQuit();
 
 private:
+    // 导航页顺序，与 NavBar 导航项一致
+    enum Page { ListPage, CalendarPage, TagPage, StatsPage, PageCount };
+
     // ---- UI 构建 ----
     void buildUi();
     QWidget* buildListPage();
@@ -112,6 +136,9 @@ private:
     void setupDesktopWidget();
     void setupCalendarWidget();
     void setupTagWidget();
+    void ensurePage(int index);             // 页面首次显示时才构建，替换栈中的占位
+    void attachPage(int index);             // 切入：数据有变则重算，再订阅变更通知
+    void detachPage(int index);             // 切出：退订，记下当时的模型版本
     void setupSplitter();
     void saveSplitterState();
     void loadSplitterState();
@@ -119,17 +146,28 @@ private:
     // ---- 视图刷新 ----
     void updateFolderList();
     void updateTodoList();
-    void showSearchResults(const QString &text);
+    void showSearchResults(const QString &text, const QList<SearchEngine::Hit> &hits, int total);
     void updateDetailPanel();
     void clearDetailPanel();
     void updateTodoTags();
     void updateStatusBar();
-    void refreshAllViews();
     void updateDesktopWidget();
     void updateCalendarWidget();
     void updateTagWidget();
     void updateStatsWidget();
 
+    // ---- 模型变更通知（TodoChangeFeed）：各视图只应用与自己有关的增量 ----
+    void onItemAdded(const TodoItem &item);
+    void onItemChanged(const TodoItem &item, TodoChangeFeed::Fields fields);
+    void onItemMoved(const TodoItem &item, const QString &fromFolderId);
+    void onItemRemoved(const TodoItem &item);
+    void onFolderChanged(const TodoFolder &folder);
+    void onModelReset();
+    void updateFolderRow(const QString &folderId);
+    void setFolderRowData(QListWidgetItem *row, const TodoFolder &folder) const;
+    void selectTodoRow(const QString &itemId);
+    void removeTodoRow(const QString &itemId);
+
     // ---- 数据访问（ID 驱动，杜绝悬空指针） ----
     TodoFolder* findFolderById(const QString &folderId);
     TodoItem* findTodoItemById(const QString &itemId, QString *outFolderId = nullptr);
@@ -137,17 +175,42 @@ private:
     TodoItem* currentItem();
     bool toggleTodoCompleted(const QString &itemId, bool completed);
     bool deleteTodoItem(const QString &itemId);
-    void persistFolder(TodoFolder *folder);
-    void persistItem(TodoItem *item);
+    void persistFolder(TodoFolder *folder, bool changed = true);   // changed = false：新建的文件夹已由仓库通知
+    // changed 为空：仓库已为这次修改发过通知（新增、移动），只落库与更新搜索索引
+    void persistItem(TodoItem *item, TodoChangeFeed::Fields changed = {});
+    void startImport(const QString &fileName);
+    void startRestore(const QList<TodoFolder> &folders);   // 恢复与导入共用 ImportEngine 的后台写入
+    void beginImportJob(const QString &action, const std::function<void()> &start);   // 写队列落库后调用 start
+    void applyImport(const QList<TodoFolder> &imported, const QString &action);   // 库已替换，只重置内存模型
+    void saveModelSnapshot();               // 退出时写内存模型快照，供下次启动直接加载
+    void showTrashDialog();                 // 写队列落库后由 onTrashClicked 调用
 
     void closeEvent(QCloseEvent *event) override;
     bool eventFilter(QObject *obj, QEvent *event) override;
     bool nativeEvent(const QByteArray &eventType, void *message, qintptr *result) override;
 
     // ---- 数据 ----
-    QList<TodoFolder> m_folders;
+    TodoStore m_store;                 // 内存模型：按 id 索引的事项与文件夹
     QString m_currentFolderId;
     QString m_currentItemId;
+    DatabaseWriter *m_writer = nullptr;     // 后台写线程：增量写入不阻塞 GUI
+    BackupEngine *m_backup = nullptr;       // 后台备份线程
+    int m_importBackupJob = 0;              // 导入前备份的任务号，完成后继续导入
+    int m_manualBackupJob = 0;
+    bool m_manualBackupQueued = false;      // 手动备份在等写队列落库
+    int m_restoreBackupJob = 0;             // 恢复前备份 -> 恢复任务，依次串接
+    int m_restoreJob = 0;
+    int m_verifyJob = 0;
+    QString m_pendingImportPath;
+    ImportEngine *m_importer = nullptr;     // 流水线导入（解析线程 + 写入线程）
+    QProgressDialog *m_importProgress = nullptr;
+    QString m_importAction;                 // 进行中的导入任务：“导入”或“恢复”，用于提示文案
+    ExportEngine *m_exporter = nullptr;     // 流式导出（游标读库 + 边读边写）
+    QProgressDialog *m_exportProgress = nullptr;
+    SearchEngine *m_searchEngine = nullptr; // 后台全局搜索（防抖、可取消、增量收窄）
+    PaletteCorpus *m_paletteCorpus = nullptr; // 命令面板候选，随变更通知常驻更新
+    QString m_restoreSnapshotId;
+    bool m_modelDiverged = false;           // 有写入失败：内存模型可能与库不一致，退出时不写快照
 
     // ---- 框架 ----
     TitleBar *m_titleBar = nullptr;
@@ -162,11 +225,14 @@ private:
 
     // 待办面板
     SectionHeader *m_todoHeader = nullptr;
-    QListWidget *m_todoList = nullptr;
+    QListView *m_todoList = nullptr;
+    TodoListModel *m_todoModel = nullptr;
+    TodoListProxy *m_todoProxy = nullptr;
     QLineEdit *m_quickAddEdit = nullptr;
     QPushButton *m_newTodoBtn = nullptr;
     QLabel *m_todoEmptyHint = nullptr;
     QLineEdit *m_searchEdit = nullptr;
+    QAction *m_darkAction = nullptr;
     bool m_searching = false;
 
     // 详情面板
@@ -187,7 +253,10 @@ private:
     QPushButton *m_saveBtn = nullptr;
     QPushButton *m_deleteBtn = nullptr;
 
-    // 子视图
+    // 子视图：日历、标签、统计页未显示时不订阅变更通知，切回时按版本号决定是否重算
+    int m_shownPage = ListPage;
+    quint64 m_pageVersion[PageCount] = {};
+    bool m_pageStale[PageCount] = {};       // 有模型以外的变化（标签库等）待切回时重算
     DesktopWidget *m_desktopWidget = nullptr;
     CalendarWidget *m_calendarWidget = nullptr;
     TagWidget *m_tagWidget = nullptr;
@@ -1,10 +1,12 @@
 #include "calendarwidget.h"
 #include "../theme.h"
+#include "../../core/keyeddiff.h"
 #include <QPainter>
 #include <QMouseEvent>
 #include <QFontMetrics>
 #include <QScrollBar>
 #include <QStyle>
+#include <QStringList>
 
 CalendarCell::CalendarCell(QWidget *parent)
     : QWidget(parent)
@@ -415,6 +417,20 @@ TodoListItem::TodoListItem(const TodoItem &item, QWidget *parent)
     setCursor(Qt::PointingHandCursor);
 }
 
+bool TodoListItem::shows(const TodoItem &item) const
+{
+    return m_title == item.getTitle() && m_completed == item.isCompleted() && m_tagColor == item.getTagColor();
+}
+
+void TodoListItem::setItem(const TodoItem &item)
+{
+    m_todoId = item.getId();
+    m_title = item.getTitle();
+    m_completed = item.isCompleted();
+    m_tagColor = item.getTagColor();
+    update();
+}
+
 void TodoListItem::setSelected(bool selected)
 {
     m_selected = selected;
@@ -693,22 +709,44 @@ void CalendarWidget::updateDateLabel()
     m_dateLabel->setText(m_currentDate.toString("yyyy年MM月dd日 dddd"));
 }
 
-void CalendarWidget::updateTodoData(const QList<TodoFolder> &folders)
+void CalendarWidget::updateTodoData(const TodoSnapshotPtr &snapshot)
 {
-    m_folders = folders;
+    if (snapshot->version() == m_snapshot->version()) {
+        return;   // 模型没有变化
+    }
+    m_snapshot = snapshot;
     refreshCalendarData();
     refreshTodoList();
 }
 
+void CalendarWidget::setChangeFeed(const TodoChangeFeed *feed)
+{
+    const TodoChangeFeed::Fields shown = TodoChangeFeed::Title | TodoChangeFeed::Completed
+                                       | TodoChangeFeed::Color | TodoChangeFeed::Dates;
+    connect(feed, &TodoChangeFeed::itemAdded, this, [this](const TodoItem &item) {
+        applyItem(item.getKey(), &item);
+    });
+    connect(feed, &TodoChangeFeed::itemChanged, this, [this, shown](const TodoItem &item, TodoChangeFeed::Fields fields) {
+        if (fields & shown) {
+            applyItem(item.getKey(), &item);
+        }
+    });
+    connect(feed, &TodoChangeFeed::itemRemoved, this, [this](const TodoItem &item) {
+        applyItem(item.getKey(), nullptr);
+    });
+}
+
 void CalendarWidget::refreshCalendarData()
 {
     m_dateToTodos.clear();
+    m_dueOf.clear();
     
-    for (const TodoFolder &folder : m_folders) {
+    for (const TodoFolder &folder : m_snapshot->folders()) {
         for (const TodoItem &item : folder.getItems()) {
             QDate dueDate = item.getDueDate();
             if (dueDate.isValid()) {
                 m_dateToTodos[dueDate].append(item);
+                m_dueOf.insert(item.getKey(), dueDate);
             }
         }
     }
@@ -716,13 +754,35 @@ void CalendarWidget::refreshCalendarData()
     m_calendarGrid->setTodoData(m_dateToTodos);
 }
 
-void CalendarWidget::refreshTodoList()
+void CalendarWidget::applyItem(const QUuid &key, const TodoItem *item)
 {
-    for (TodoListItem *item : m_todoItems) {
-        item->deleteLater();
+    // 改前、改后都没有截止日期的事项不在日历上
+    const QDate oldDue = m_dueOf.take(key);
+    const QDate newDue = item ? item->getDueDate() : QDate();
+    if (!oldDue.isValid() && !newDue.isValid()) {
+        return;
     }
-    m_todoItems.clear();
-    
+
+    const auto it = oldDue.isValid() ? m_dateToTodos.find(oldDue) : m_dateToTodos.end();
+    if (it != m_dateToTodos.end()) {
+        it->removeIf([&key](const TodoItem &t) { return t.getKey() == key; });
+        if (it->isEmpty()) {
+            m_dateToTodos.erase(it);
+        }
+    }
+    if (newDue.isValid()) {
+        m_dateToTodos[newDue].append(*item);
+        m_dueOf.insert(key, newDue);
+    }
+
+    m_calendarGrid->setTodoData(m_dateToTodos);
+    if (oldDue == m_currentDate || newDue == m_currentDate) {
+        refreshTodoList();
+    }
+}
+
+void CalendarWidget::refreshTodoList()
+{
     QList<TodoItem> todos;
     if (m_dateToTodos.contains(m_currentDate)) {
         todos = m_dateToTodos[m_currentDate];
@@ -732,7 +792,7 @@ void CalendarWidget::refreshTodoList()
         if (a.isCompleted() != b.isCompleted()) {
             return a.isCompleted() < b.isCompleted();
         }
-        return a.getCreatedTime() > b.getCreatedTime();
+        return a.createdMsecs() > b.createdMsecs();
     });
     
     int completedCount = 0;
@@ -744,13 +804,41 @@ void CalendarWidget::refreshTodoList()
     
     m_countLabel->setText(QString("共 %1 项，已完成 %2 项").arg(todos.size()).arg(completedCount));
     
+    // 按 id 与现有条目对齐：只增删、挪动有变化的条目，其余控件连同选中状态原样保留
+    QStringList before;
+    before.reserve(m_todoItems.size());
+    for (const TodoListItem *item : m_todoItems) {
+        before.append(item->getTodoId());
+    }
+    QStringList after;
+    after.reserve(todos.size());
     for (const TodoItem &todo : todos) {
-        TodoListItem *item = new TodoListItem(todo);
-        connect(item, &TodoListItem::clicked, this, &CalendarWidget::onTodoClicked);
-        connect(item, &TodoListItem::doubleClicked, this, &CalendarWidget::onTodoDoubleClicked);
-        m_todoListLayout->insertWidget(m_todoListLayout->count() - 1, item);
-        m_todoItems.append(item);
+        after.append(todo.getId());
     }
+
+    // 布局末尾是弹簧，条目的行号与布局下标一致
+    const auto changed = [&](int from, int item) { return !m_todoItems.at(from)->shows(todos.at(item)); };
+    KeyedDiff::apply(KeyedDiff::compute(before, after, changed),
+        [this](int row) {
+            TodoListItem *item = m_todoItems.takeAt(row);
+            m_todoListLayout->removeWidget(item);
+            item->deleteLater();
+        },
+        [&](int row, int index) {
+            TodoListItem *item = new TodoListItem(todos.at(index));
+            connect(item, &TodoListItem::clicked, this, &CalendarWidget::onTodoClicked);
+            connect(item, &TodoListItem::doubleClicked, this, &CalendarWidget::onTodoDoubleClicked);
+            item->setSelected(item->getTodoId() == m_selectedTodoId);
+            m_todoListLayout->insertWidget(row, item);
+            m_todoItems.insert(row, item);
+        },
+        [this](int from, int row) {
+            TodoListItem *item = m_todoItems.takeAt(from);
+            m_todoListLayout->removeWidget(item);
+            m_todoListLayout->insertWidget(row, item);
+            m_todoItems.insert(row, item);
+        },
+        [&](int row, int index) { m_todoItems.at(row)->setItem(todos.at(index)); });
 }
 
 void CalendarWidget::onDateClicked(const QDate &date)
@@ -809,16 +897,10 @@ void CalendarWidget::onToggleTodo()
         return;
     }
     
-    for (const TodoFolder &folder : m_folders) {
-        const TodoItem *item = nullptr;
-        for (const TodoItem &i : folder.getItems()) {
-            if (i.getId() == m_selectedTodoId) {
-                item = &i;
-                break;
-            }
-        }
-        if (item) {
-            emit todoItemToggled(m_selectedTodoId, !item->isCompleted());
+    // 选中的事项一定在当天的列表里
+    for (const TodoItem &item : m_dateToTodos.value(m_currentDate)) {
+        if (item.getId() == m_selectedTodoId) {
+            emit todoItemToggled(m_selectedTodoId, !item.isCompleted());
             break;
         }
     }
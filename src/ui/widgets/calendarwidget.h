@@ -11,11 +11,14 @@
 #include <QScrollArea>
 #include <QDate>
 #include <QMap>
+#include <QHash>
 #include <QList>
 #include <QPainter>
 #include <QMouseEvent>
 #include "todoitem.h"
 #include "todofolder.h"
+#include "todosnapshot.h"
+#include "todochangefeed.h"
 
 class CalendarCell : public QWidget
 {
@@ -111,6 +114,8 @@ class TodoListItem : public QWidget
 public:
     explicit TodoListItem(const TodoItem &item, QWidget *parent = nullptr);
     QString getTodoId() const { return m_todoId; }
+    bool shows(const TodoItem &item) const;      // 显示内容是否已与 item 一致
+    void setItem(const TodoItem &item);
     void setSelected(bool selected);
     
 signals:
@@ -138,7 +143,8 @@ public:
     explicit CalendarWidget(QWidget *parent = nullptr);
     ~CalendarWidget();
     
-    void updateTodoData(const QList<TodoFolder> &folders);
+    void updateTodoData(const TodoSnapshotPtr &snapshot);
+    void setChangeFeed(const TodoChangeFeed *feed);   // 订阅后只处理带截止日期的事项的增量
     void refreshTheme();                       // 主题切换后重建样式表
     
 signals:
@@ -161,6 +167,7 @@ private:
     void setupConnections();
     void refreshTodoList();
     void refreshCalendarData();
+    void applyItem(const QUuid &key, const TodoItem *item);   // item 为空表示已删除
     void updateDateLabel();
     
     QHBoxLayout *m_mainLayout;
@@ -183,10 +190,11 @@ private:
     QWidget *m_addPanel;
     QHBoxLayout *m_addLayout;
     
-    QList<TodoFolder> m_folders;
+    TodoSnapshotPtr m_snapshot = TodoSnapshot::empty();
     QDate m_currentDate;
     QString m_selectedTodoId;
     QMap<QDate, QList<TodoItem>> m_dateToTodos;
+    QHash<QUuid, QDate> m_dueOf;               // 事项 → 所在日期，增量更新时据此找到旧位置
     QList<TodoListItem*> m_todoItems;
 };
 
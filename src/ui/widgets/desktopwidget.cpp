@@ -2,6 +2,7 @@
 #include "../icons.h"
 #include "../theme.h"
 #include "../components/messageutils.h"
+#include "../../core/keyeddiff.h"
 
 #include <QPainter>
 #include <QPainterPath>
@@ -41,6 +42,16 @@ constexpr int RoleDueUrgent = Qt::UserRole + 5;   // 倒数日是否紧急（今
 
 constexpr int kShadowMargin = 14;   // 玻璃纸外圈阴影留白
 
+// 便签排序：置顶 > 倒数日紧迫 > 创建时间
+bool pendingBefore(const TodoItem &a, const TodoItem &b)
+{
+    if (a.isPinned() != b.isPinned()) return a.isPinned() > b.isPinned();
+    const bool aDue = a.getDueDate().isValid(), bDue = b.getDueDate().isValid();
+    if (aDue != bDue) return aDue > bDue;
+    if (aDue && bDue && a.getDueDate() != b.getDueDate()) return a.getDueDate() < b.getDueDate();
+    return a.createdMsecs() > b.createdMsecs();
+}
+
 // ---- 每日一句 ----
 const QStringList kDailyQuotes = {
     QStringLiteral("把每一件小事做好，就是不平凡。"),
@@ -266,6 +277,23 @@ public:
     }
 };
 
+// 倒数日文案：只提示未过期的（过期的不打扰）；无需提示时为空
+QString dueText(const TodoItem &item, const QDate &today, bool *urgent = nullptr)
+{
+    if (urgent) *urgent = false;
+    if (!item.getDueDate().isValid()) {
+        return QString();
+    }
+    const qint64 days = today.daysTo(item.getDueDate());
+    if (days < 0) {
+        return QString();
+    }
+    if (urgent) *urgent = days <= 1;
+    if (days == 0) return QStringLiteral("今天");
+    if (days == 1) return QStringLiteral("明天");
+    return QStringLiteral("剩 %1 天").arg(days);
+}
+
 } // namespace
 
 // ==========================================================
@@ -483,63 +511,125 @@ void DesktopWidget::setAlwaysOnTop(bool onTop)
 // 数据
 // ==========================================================
 
-void DesktopWidget::updateTodoData(const QList<TodoFolder> &folders)
+void DesktopWidget::updateTodoData(const TodoSnapshotPtr &snapshot)
 {
-    m_folders = folders;
+    // 同一版本、同一天的重复推送没有可变的内容，直接跳过
+    const QDate today = QDate::currentDate();
+    if (snapshot->version() == m_snapshot->version() && today == m_shownDay) {
+        return;
+    }
+    m_snapshot = snapshot;
+    m_shownDay = today;
     loadPendingItems();
     updateTodoList();
     updateHeader();
 }
 
+void DesktopWidget::setChangeFeed(const TodoChangeFeed *feed)
+{
+    const TodoChangeFeed::Fields shown = TodoChangeFeed::Title | TodoChangeFeed::Completed | TodoChangeFeed::Pinned
+                                       | TodoChangeFeed::Priority | TodoChangeFeed::Color | TodoChangeFeed::Dates;
+    connect(feed, &TodoChangeFeed::itemAdded, this, [this](const TodoItem &item) {
+        applyItem(item.getKey(), &item, 1);
+    });
+    connect(feed, &TodoChangeFeed::itemChanged, this, [this, shown](const TodoItem &item, TodoChangeFeed::Fields fields) {
+        if (fields & shown) {
+            applyItem(item.getKey(), &item, 0);
+        }
+    });
+    connect(feed, &TodoChangeFeed::itemRemoved, this, [this](const TodoItem &item) {
+        applyItem(item.getKey(), nullptr, -1);
+    });
+}
+
 void DesktopWidget::loadPendingItems()
 {
     m_displayItems.clear();
+    m_totalCount = 0;
 
-    for (const TodoFolder &folder : m_folders) {
+    for (const TodoFolder &folder : m_snapshot->folders()) {
+        m_totalCount += folder.getItemCount();
         for (const TodoItem &item : folder.getItems()) {
             if (!item.isCompleted()) {
                 m_displayItems.append(item);
             }
         }
     }
+    std::sort(m_displayItems.begin(), m_displayItems.end(), pendingBefore);
+}
 
-    // 置顶 > 倒数日紧迫 > 创建时间
-    std::sort(m_displayItems.begin(), m_displayItems.end(), [](const TodoItem &a, const TodoItem &b) {
-        if (a.isPinned() != b.isPinned()) return a.isPinned() > b.isPinned();
-        const bool aDue = a.getDueDate().isValid(), bDue = b.getDueDate().isValid();
-        if (aDue != bDue) return aDue > bDue;
-        if (aDue && bDue && a.getDueDate() != b.getDueDate()) return a.getDueDate() < b.getDueDate();
-        return a.getCreatedTime() > b.getCreatedTime();
-    });
+void DesktopWidget::applyItem(const QUuid &key, const TodoItem *item, int totalDelta)
+{
+    // 先移走旧行，仍未完成则按排序插回；m_displayItems 与列表行一一对应
+    m_totalCount += totalDelta;
+    const auto it = std::find_if(m_displayItems.cbegin(), m_displayItems.cend(),
+                                 [&key](const TodoItem &t) { return t.getKey() == key; });
+    if (it != m_displayItems.cend()) {
+        const int row = int(it - m_displayItems.cbegin());
+        m_displayItems.removeAt(row);
+        delete m_todoListWidget->takeItem(row);
+    }
+    if (item && !item->isCompleted()) {
+        const auto pos = std::upper_bound(m_displayItems.cbegin(), m_displayItems.cend(), *item, pendingBefore);
+        const int row = int(pos - m_displayItems.cbegin());
+        m_displayItems.insert(row, *item);
+        m_todoListWidget->insertItem(row, createRow(*item, QDate::currentDate()));
+    }
+    updateHeader();
+    update();
 }
 
-void DesktopWidget::updateTodoList()
+QListWidgetItem *DesktopWidget::createRow(const TodoItem &item, const QDate &today) const
 {
-    m_todoListWidget->clear();
+    auto *listItem = new QListWidgetItem;
+    fillRow(listItem, item, today);
+    return listItem;
+}
 
-    const QDate today = QDate::currentDate();
+void DesktopWidget::fillRow(QListWidgetItem *listItem, const TodoItem &item, const QDate &today) const
+{
+    // 值未变时 setData 不发通知，对已有的行重复调用没有额外开销
+    listItem->setText(item.getTitle());
+    listItem->setData(RoleId, item.getId());
+    listItem->setData(RoleCompleted, item.isCompleted());
+    listItem->setData(RolePriority, item.getPriority());
+    listItem->setData(RoleColor, item.getTagColor());
+
+    bool urgent = false;
+    const QString due = dueText(item, today, &urgent);
+    listItem->setData(RoleDueText, due.isEmpty() ? QVariant() : QVariant(due));
+    listItem->setData(RoleDueUrgent, due.isEmpty() ? QVariant() : QVariant(urgent));
+}
+
+void DesktopWidget::updateTodoList()
+{
+    // 按 id 与现有行对齐：只增删、挪动有变化的行，其余行原样保留后就地刷新
+    QStringList before;
+    before.reserve(m_todoListWidget->count());
+    for (int row = 0; row < m_todoListWidget->count(); ++row) {
+        before.append(m_todoListWidget->item(row)->data(RoleId).toString());
+    }
+    QStringList after;
+    after.reserve(m_displayItems.size());
     for (const TodoItem &item : m_displayItems) {
-        auto *listItem = new QListWidgetItem(item.getTitle());
-        listItem->setData(RoleId, item.getId());
-        listItem->setData(RoleCompleted, item.isCompleted());
-        listItem->setData(RolePriority, item.getPriority());
-        listItem->setData(RoleColor, item.getTagColor());
-
-        // 倒数日：只提示未过期的（过期的不打扰）
-        if (item.getDueDate().isValid()) {
-            const qint64 days = today.daysTo(item.getDueDate());
-            if (days >= 0) {
-                QString text;
-                bool urgent = false;
-                if (days == 0)      { text = QStringLiteral("今天"); urgent = true; }
-                else if (days == 1) { text = QStringLiteral("明天"); urgent = true; }
-                else                { text = QStringLiteral("剩 %1 天").arg(days); }
-                listItem->setData(RoleDueText, text);
-                listItem->setData(RoleDueUrgent, urgent);
-            }
-        }
-        m_todoListWidget->addItem(listItem);
+        after.append(item.getId());
     }
+
+    // 保留下来的行只在显示内容变了时刷新：整体重建后的标题、优先级、颜色，或跨天后的倒数日文案
+    const QDate today = QDate::currentDate();
+    const auto stale = [&](int from, int item) {
+        const QListWidgetItem *row = m_todoListWidget->item(from);
+        const TodoItem &todo = m_displayItems.at(item);
+        return row->text() != todo.getTitle()
+            || row->data(RolePriority).toInt() != todo.getPriority()
+            || row->data(RoleColor).toString() != todo.getTagColor()
+            || row->data(RoleDueText).toString() != dueText(todo, today);
+    };
+    KeyedDiff::apply(KeyedDiff::compute(before, after, stale),
+        [this](int row) { delete m_todoListWidget->takeItem(row); },
+        [&](int row, int item) { m_todoListWidget->insertItem(row, createRow(m_displayItems.at(item), today)); },
+        [this](int from, int row) { m_todoListWidget->insertItem(row, m_todoListWidget->takeItem(from)); },
+        [&](int row, int item) { fillRow(m_todoListWidget->item(row), m_displayItems.at(item), today); });
     update();
 }
 
@@ -556,11 +646,8 @@ void DesktopWidget::updateHeader()
                                 : QStringLiteral("全部完成啦"));
 
     // 进度条：已完成 / 总数
-    int total = 0, done = 0;
-    for (const TodoFolder &folder : m_folders) {
-        total += folder.getItemCount();
-        done += folder.getCompletedCount();
-    }
+    const int total = m_totalCount;
+    const int done = total - n;
     static_cast<NeonProgressBar*>(m_progressBar)
         ->setRatio(total > 0 ? qreal(done) / qreal(total) : 0.0);
 
@@ -597,7 +684,8 @@ void DesktopWidget::updateQuote()
 
 void DesktopWidget::refreshDisplay()
 {
-    loadPendingItems();
+    // 列表已随变更通知保持最新，这里只按当天日期重算倒数日文案
+    m_shownDay = QDate::currentDate();
     updateTodoList();
     updateHeader();
 }
@@ -629,6 +717,10 @@ void DesktopWidget::onTodoItemClicked(QListWidgetItem *item)
 
 void DesktopWidget::onRefreshTimer()
 {
+    if (QDate::currentDate() != m_shownDay) {
+        refreshDisplay();   // 跨过零点：倒数日文案随日期变化
+        return;
+    }
     updateHeader();
 }
 
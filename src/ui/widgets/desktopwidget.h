@@ -15,6 +15,8 @@
 #include <QElapsedTimer>
 #include "todoitem.h"
 #include "todofolder.h"
+#include "todosnapshot.h"
+#include "todochangefeed.h"
 
 class QPainter;
 class QNetworkAccessManager;
@@ -30,7 +32,8 @@ public:
     explicit DesktopWidget(QWidget *parent = nullptr);
     ~DesktopWidget();
 
-    void updateTodoData(const QList<TodoFolder> &folders);
+    void updateTodoData(const TodoSnapshotPtr &snapshot);
+    void setChangeFeed(const TodoChangeFeed *feed);   // 订阅后单个事项的增删改只调整对应的行
     void refreshDisplay();
     void refreshTheme();    // 主题切换后重新应用配色（由主窗口调用）
 
@@ -62,6 +65,9 @@ private:
     void setupConnections();
     void updateTodoList();
     void loadPendingItems();
+    void applyItem(const QUuid &key, const TodoItem *item, int totalDelta);   // item 为空表示已删除
+    QListWidgetItem *createRow(const TodoItem &item, const QDate &today) const;
+    void fillRow(QListWidgetItem *listItem, const TodoItem &item, const QDate &today) const;
     void updateHeader();
     void updateQuote();
 
@@ -103,8 +109,10 @@ private:
     QWidget *m_progressBar;
 
     // ---- 数据 ----
-    QList<TodoFolder> m_folders;
-    QList<TodoItem> m_displayItems;
+    TodoSnapshotPtr m_snapshot = TodoSnapshot::empty();
+    QDate m_shownDay;                  // 上次刷新时的日期：倒数日、进度随日期变化
+    QList<TodoItem> m_displayItems;    // 未完成事项，按便签顺序
+    int m_totalCount = 0;              // 全部事项数；已完成数 = 总数 - 未完成数
     int m_quoteOffset = 0;
 
     // ---- 外观状态 ----
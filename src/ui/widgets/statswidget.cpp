@@ -113,6 +113,13 @@ void beginCardPaint(QPainter &painter, const QRect &rect, qreal hover)
                                 Theme::radiusLg, Theme::radiusLg);
     }
 }
+
+// 完成日（儒略日）；没有完成时间的已完成事项只计入完成数
+qint32 doneDayOf(const TodoItem &item)
+{
+    const QDateTime done = item.getCompletedTime();
+    return done.isValid() ? qint32(done.date().toJulianDay()) : TodoItem::kNoDay;
+}
 } // namespace
 
 // ---------------- StatsOverviewCard ----------------
@@ -657,37 +664,90 @@ void StatsWidget::setupUI()
     outerLayout->addWidget(scrollArea);
 }
 
-void StatsWidget::setData(const QList<TodoFolder> &folders)
+void StatsWidget::setData(const TodoSnapshotPtr &snapshot)
+{
+    // 同一版本、同一天的重复推送结果不变，直接跳过
+    const QDate today = QDate::currentDate();
+    if (snapshot->version() == m_snapshot->version() && today == m_shownDay) {
+        return;
+    }
+    m_snapshot = snapshot;
+    m_shownDay = today;
+
+    m_total = 0;
+    m_doneDayOf.clear();
+    m_doneByDay.clear();
+    for (const TodoFolder &folder : m_snapshot->folders()) {
+        m_total += folder.getItemCount();
+        for (const TodoItem &item : folder.getItems()) {
+            if (!item.isCompleted())
+                continue;
+            const qint32 day = doneDayOf(item);
+            m_doneDayOf.insert(item.getKey(), day);
+            if (day != TodoItem::kNoDay)
+                ++m_doneByDay[day];
+        }
+    }
+    publish();
+}
+
+void StatsWidget::setChangeFeed(const TodoChangeFeed *feed)
+{
+    connect(feed, &TodoChangeFeed::itemAdded, this, [this](const TodoItem &item) {
+        applyItem(item.getKey(), &item, 1);
+    });
+    connect(feed, &TodoChangeFeed::itemChanged, this, [this](const TodoItem &item, TodoChangeFeed::Fields fields) {
+        if (fields & TodoChangeFeed::Completed)
+            applyItem(item.getKey(), &item, 0);
+    });
+    connect(feed, &TodoChangeFeed::itemRemoved, this, [this](const TodoItem &item) {
+        applyItem(item.getKey(), nullptr, -1);
+    });
+}
+
+void StatsWidget::applyItem(const QUuid &key, const TodoItem *item, int totalDelta)
 {
-    m_folders = folders;
+    const auto it = m_doneDayOf.constFind(key);
+    const bool wasDone = it != m_doneDayOf.cend();
+    const qint32 oldDay = wasDone ? *it : TodoItem::kNoDay;
+    const bool done = item && item->isCompleted();
+    const qint32 newDay = done ? doneDayOf(*item) : TodoItem::kNoDay;
+    if (totalDelta == 0 && wasDone == done && oldDay == newDay)
+        return;
 
-    int total = 0;
-    int completed = 0;
-    int todayCompleted = 0;
+    m_total += totalDelta;
+    if (wasDone) {
+        m_doneDayOf.erase(it);
+        if (oldDay != TodoItem::kNoDay && --m_doneByDay[oldDay] <= 0)
+            m_doneByDay.remove(oldDay);
+    }
+    if (done) {
+        m_doneDayOf.insert(key, newDay);
+        if (newDay != TodoItem::kNoDay)
+            ++m_doneByDay[newDay];
+    }
+    publish();
+}
 
+void StatsWidget::publish()
+{
     const QDate today = QDate::currentDate();
+    const qint32 todayDay = qint32(today.toJulianDay());
+    const int completed = int(m_doneDayOf.size());
+    const int todayCompleted = m_doneByDay.value(todayDay, 0);
+
     QVector<QDate> dates(kChartDays);
     QVector<int> dailyCounts(kChartDays, 0);
     QHash<QDate, int> heatMap;
 
-    for (int i = 0; i < kChartDays; ++i)
+    for (int i = 0; i < kChartDays; ++i) {
         dates[i] = today.addDays(i - (kChartDays - 1));   // 最旧的一天在最左
-
-    for (const TodoFolder &folder : m_folders) {
-        total += folder.getItemCount();
-        completed += folder.getCompletedCount();
-        for (const TodoItem &item : folder.getItems()) {
-            if (!item.isCompleted() || !item.getCompletedTime().isValid())
-                continue;
-            const QDate doneDate = item.getCompletedTime().date();
-            if (doneDate == today)
-                ++todayCompleted;
-            const int daysAgo = today.toJulianDay() - doneDate.toJulianDay();
-            if (daysAgo >= 0 && daysAgo < kChartDays)
-                ++dailyCounts[kChartDays - 1 - daysAgo];
-            if (daysAgo >= 0 && daysAgo < kHeatmapDays)
-                ++heatMap[doneDate];
-        }
+        dailyCounts[i] = m_doneByDay.value(todayDay - (kChartDays - 1 - i), 0);
+    }
+    for (int daysAgo = 0; daysAgo < kHeatmapDays; ++daysAgo) {
+        const int count = m_doneByDay.value(todayDay - daysAgo, 0);
+        if (count > 0)
+            heatMap.insert(today.addDays(-daysAgo), count);
     }
 
     // 连续完成天数：从今天往前数，今天没有则从昨天开始数
@@ -696,11 +756,11 @@ void StatsWidget::setData(const QList<TodoFolder> &folders)
     while (heatMap.value(today.addDays(-(streak + offset)), 0) > 0)
         ++streak;
 
-    m_totalCard->setValue(total);
+    m_totalCard->setValue(m_total);
     m_completedCard->setValue(completed);
     m_todayCard->setValue(todayCompleted);
     m_streakCard->setValue(streak);
-    m_ringCard->setRate(completed, total);
+    m_ringCard->setRate(completed, m_total);
     m_barChart->setDailyCounts(dates, dailyCounts);
     m_heatmap->setDailyMap(heatMap);
     update();
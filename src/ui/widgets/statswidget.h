@@ -10,6 +10,8 @@
 #include <QString>
 #include <QVariantAnimation>
 #include "todofolder.h"
+#include "todosnapshot.h"
+#include "todochangefeed.h"
 
 class QEnterEvent;
 
@@ -133,12 +135,19 @@ class StatsWidget : public QWidget
 
 public:
     explicit StatsWidget(QWidget *parent = nullptr);
-    void setData(const QList<TodoFolder> &folders);  // 由主窗口在数据变化时调用
+    void setData(const TodoSnapshotPtr &snapshot);   // 由主窗口在模型整体变化时调用
+    void setChangeFeed(const TodoChangeFeed *feed);  // 订阅后只按完成状态的增量调整计数
 
 private:
     void setupUI();
+    void applyItem(const QUuid &key, const TodoItem *item, int totalDelta);   // item 为空表示已删除
+    void publish();                    // 由计数生成卡片与图表
 
-    QList<TodoFolder> m_folders;
+    TodoSnapshotPtr m_snapshot = TodoSnapshot::empty();
+    QDate m_shownDay;                  // 今日完成数、图表窗口随日期变化
+    int m_total = 0;
+    QHash<QUuid, qint32> m_doneDayOf;  // 已完成事项 → 完成日（儒略日，无完成时间为 kNoDay）
+    QHash<qint32, int> m_doneByDay;    // 完成日 → 当天完成数
     StatsOverviewCard *m_totalCard;
     StatsOverviewCard *m_completedCard;
     StatsOverviewCard *m_todayCard;
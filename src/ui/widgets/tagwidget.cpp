@@ -5,6 +5,7 @@
 #include <QFontMetrics>
 #include <QScrollBar>
 #include <QStyle>
+#include <QTimer>
 
 namespace {
     // 标签配色：按标签名哈希取色，保证标签云/列表/待办色条颜色一致且稳定
@@ -543,9 +544,12 @@ void TagWidget::setupConnections()
     connect(m_addButton, &QPushButton::clicked, this, &TagWidget::onAddTag);
 }
 
-void TagWidget::updateData(const QList<TodoFolder> &folders, const QStringList &allTags)
+void TagWidget::updateData(const TodoSnapshotPtr &snapshot, const QStringList &allTags)
 {
-    m_folders = folders;
+    if (snapshot->version() == m_snapshot->version() && allTags == m_allTags) {
+        return;   // 模型与标签库都没有变化
+    }
+    m_snapshot = snapshot;
     m_allTags = allTags;
     collectAllTags();
     refreshTagCloud();
@@ -553,11 +557,32 @@ void TagWidget::updateData(const QList<TodoFolder> &folders, const QStringList &
     refreshTodoList();
 }
 
+void TagWidget::setChangeFeed(const TodoChangeFeed *feed)
+{
+    connect(feed, &TodoChangeFeed::itemAdded, this, [this](const TodoItem &item) {
+        applyItem(item.getKey(), &item);
+    });
+    connect(feed, &TodoChangeFeed::itemChanged, this, [this](const TodoItem &item) {
+        applyItem(item.getKey(), &item);
+    });
+    connect(feed, &TodoChangeFeed::itemMoved, this, [this](const TodoItem &item) {
+        applyItem(item.getKey(), &item);   // 待办卡片上显示所在文件夹
+    });
+    connect(feed, &TodoChangeFeed::itemRemoved, this, [this](const TodoItem &item) {
+        applyItem(item.getKey(), nullptr);
+    });
+    connect(feed, &TodoChangeFeed::folderChanged, this, [this](const TodoFolder &folder) {
+        m_folderNames.insert(folder.getId(), folder.getName());
+        scheduleRefresh(false, !m_selectedTag.isEmpty());
+    });
+}
+
 void TagWidget::collectAllTags()
 {
     m_tagCounts.clear();
     m_tagToTodos.clear();
-    m_todoToFolder.clear();
+    m_tagsOf.clear();
+    m_folderNames.clear();
 
     // 标签库（含尚未关联任何事项的标签）由调用方统一从 DatabaseManager 提供，
     // 本组件不再直接访问数据库，保证数据访问入口唯一。
@@ -567,10 +592,15 @@ void TagWidget::collectAllTags()
         }
     }
     
-    for (const TodoFolder &folder : m_folders) {
+    for (const TodoFolder &folder : m_snapshot->folders()) {
+        m_folderNames.insert(folder.getId(), folder.getName());
         for (const TodoItem &item : folder.getItems()) {
-            m_todoToFolder[item.getId()] = folder.getName();
-            for (const QString &tag : item.getTags()) {
+            const QStringList tags = item.getTags();
+            if (tags.isEmpty()) {
+                continue;
+            }
+            m_tagsOf.insert(item.getKey(), tags);
+            for (const QString &tag : tags) {
                 m_tagCounts[tag]++;
                 m_tagToTodos[tag].append(item);
             }
@@ -578,6 +608,59 @@ void TagWidget::collectAllTags()
     }
 }
 
+void TagWidget::applyItem(const QUuid &key, const TodoItem *item)
+{
+    // 改前、改后都没有标签的事项与本页无关
+    const QStringList oldTags = m_tagsOf.take(key);
+    const QStringList newTags = item ? item->getTags() : QStringList();
+    if (oldTags.isEmpty() && newTags.isEmpty()) {
+        return;
+    }
+
+    for (const QString &tag : oldTags) {
+        auto it = m_tagToTodos.find(tag);
+        if (it != m_tagToTodos.end()) {
+            it->removeIf([&key](const TodoItem &t) { return t.getKey() == key; });
+        }
+        // 计数归零且不在标签库里的标签随之消失，与整体重建的结果一致
+        if (--m_tagCounts[tag] <= 0 && !m_allTags.contains(tag)) {
+            m_tagCounts.remove(tag);
+            m_tagToTodos.remove(tag);
+        }
+    }
+    for (const QString &tag : newTags) {
+        m_tagCounts[tag]++;
+        m_tagToTodos[tag].append(*item);
+    }
+    if (!newTags.isEmpty()) {
+        m_tagsOf.insert(key, newTags);
+    }
+
+    scheduleRefresh(oldTags != newTags,
+                    oldTags.contains(m_selectedTag) || newTags.contains(m_selectedTag));
+}
+
+void TagWidget::scheduleRefresh(bool tags, bool todos)
+{
+    m_tagsStale = m_tagsStale || tags;
+    m_todosStale = m_todosStale || todos;
+    if (m_refreshPending || (!m_tagsStale && !m_todosStale)) {
+        return;
+    }
+    m_refreshPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_refreshPending = false;
+        if (m_tagsStale) {
+            refreshTagCloud();
+            refreshTagList();
+        }
+        if (m_todosStale) {
+            refreshTodoList();
+        }
+        m_tagsStale = m_todosStale = false;
+    });
+}
+
 void TagWidget::refreshTagCloud()
 {
     QLayoutItem *item;
@@ -641,11 +724,11 @@ void TagWidget::refreshTodoList()
             if (a.isCompleted() != b.isCompleted()) {
                 return a.isCompleted() < b.isCompleted();
             }
-            return a.getCreatedTime() > b.getCreatedTime();
+            return a.createdMsecs() > b.createdMsecs();
         });
         
         for (const TodoItem &item : sortedTodos) {
-            QString folderName = m_todoToFolder.value(item.getId(), "");
+            QString folderName = m_folderNames.value(item.getFolderId());
             TodoItemWidget *widget = new TodoItemWidget(item, folderName);
             connect(widget, &TodoItemWidget::clicked, this, &TagWidget::onTodoItemClicked);
             connect(widget, &TodoItemWidget::toggled, this, &TagWidget::onTodoItemToggled);
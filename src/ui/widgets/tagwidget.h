@@ -12,8 +12,11 @@
 #include <QStyle>
 #include <QPainterPath>
 #include <QMap>
+#include <QHash>
 #include "todoitem.h"
 #include "todofolder.h"
+#include "todosnapshot.h"
+#include "todochangefeed.h"
 #include "../components/flowlayout.h"
 
 class TagCloudItem : public QWidget
@@ -103,7 +106,8 @@ public:
     explicit TagWidget(QWidget *parent = nullptr);
     ~TagWidget();
 
-    void updateData(const QList<TodoFolder> &folders, const QStringList &allTags);
+    void updateData(const TodoSnapshotPtr &snapshot, const QStringList &allTags);
+    void setChangeFeed(const TodoChangeFeed *feed);   // 订阅后只处理打了标签的事项的增量
     void refreshTheme();                       // 主题切换后重建样式表
     
 signals:
@@ -128,6 +132,8 @@ private:
     void refreshTagList();
     void refreshTodoList();
     void collectAllTags();
+    void applyItem(const QUuid &key, const TodoItem *item);   // item 为空表示已删除
+    void scheduleRefresh(bool tags, bool todos);               // 合并同一轮事件里的多次增量
     
     QHBoxLayout *m_mainLayout;
     
@@ -160,12 +166,16 @@ private:
     QWidget *m_todoContainer;
     QVBoxLayout *m_todoListLayout;
     
-    QList<TodoFolder> m_folders;
+    TodoSnapshotPtr m_snapshot = TodoSnapshot::empty();
     QStringList m_allTags;
     QString m_selectedTag;
     QMap<QString, int> m_tagCounts;
     QMap<QString, QList<TodoItem>> m_tagToTodos;
-    QMap<QString, QString> m_todoToFolder;
+    QHash<QUuid, QStringList> m_tagsOf;        // 打了标签的事项 → 其标签，增量更新时据此找到旧位置
+    QHash<QString, QString> m_folderNames;     // 文件夹 id → 名称
+    bool m_refreshPending = false;
+    bool m_tagsStale = false;
+    bool m_todosStale = false;
 };
 
 #endif // TAGWIDGET_H
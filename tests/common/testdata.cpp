@@ -0,0 +1,31 @@
+#include "testdata.h"
+
+#include <QStringList>
+
+namespace {
+const QStringList &words()
+{
+    static const QStringList list = {
+        QStringLiteral("开会"), QStringLiteral("周报"), QStringLiteral("评审"), QStringLiteral("采购"),
+        QStringLiteral("报销"), QStringLiteral("客户"), QStringLiteral("需求"), QStringLiteral("发布"),
+        QStringLiteral("review"), QStringLiteral("deploy"), QStringLiteral("budget"),
+    };
+    return list;
+}
+}
+
+namespace TestData {
+
+QString title(int n)
+{
+    const QStringList &list = words();
+    return QStringLiteral("%1%2 %3").arg(list.at(n % list.size()), list.at(n / 7 % list.size())).arg(n);
+}
+
+QString details(int n)
+{
+    const QStringList &list = words();
+    return QStringLiteral("第 %1 条：%2 相关的说明").arg(n).arg(list.at(n / 3 % list.size()));
+}
+
+}
@@ -0,0 +1,15 @@
+#ifndef TESTDATA_H
+#define TESTDATA_H
+
+#include <QString>
+
+// 十万级基准共用的事项文本：十来个中英文词两两组合，标题末尾带序号保证各不相同。
+// 子串、多词、拼音与前缀逐键查询在其上都有稳定的命中比例，各基准的结果可以互相对照
+namespace TestData {
+
+QString title(int n);                    // 如 “周报评审 12”
+QString details(int n);                  // 如 “第 12 条：客户 相关的说明”
+
+}
+
+#endif // TESTDATA_H
@@ -0,0 +1,17 @@
+# 各测试共用：只链接核心代码，不依赖界面
+QT += core gui sql testlib
+QT -= widgets
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+include($$PWD/../src/core/core.pri)
+
+# 基准共用的测试数据
+INCLUDEPATH += $$PWD/common
+
+SOURCES += \
+    $$PWD/common/testdata.cpp
+
+HEADERS += \
+    $$PWD/common/testdata.h
@@ -0,0 +1,16 @@
+# 单元测试与基准：qmake tests/tests.pro && make check
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_searchquery \
+    tst_keyeddiff \
+    tst_database \
+    tst_databasewriter \
+    tst_backupstore \
+    tst_importengine \
+    tst_exportengine \
+    tst_searchengine \
+    tst_changefeed \
+    tst_modelsnapshot \
+    tst_todostore \
+    tst_palettecorpus
@@ -0,0 +1,221 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QDirIterator>
+#include <QRandomGenerator>
+#include <QSet>
+#include <memory>
+
+#include "backupstore.h"
+
+// 去重仓库：跨快照共享块、按字节还原、分层保留、GC 不删仍被引用的块、校验发现坏块、收编旧版整库备份
+class tst_BackupStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void dedupAndRestore();
+    void retention();
+    void garbageKeepsLiveChunks();
+    void verifyFindsCorruption();
+    void adoptLegacyBackups();
+
+private:
+    QString writeFile(const QString &name, const QByteArray &data) const;
+    QString restored(BackupStore &store, const QString &snapshotId) const;
+    QSet<QString> chunkFiles() const;
+    QSet<QString> ids(const BackupStore &store) const;
+
+    std::unique_ptr<QTemporaryDir> m_dir;
+    QByteArray m_base;                        // 2 MiB 伪随机内容，块边界与内容一一对应
+};
+
+void tst_BackupStore::init()
+{
+    m_dir = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_dir->isValid());
+
+    if (m_base.isEmpty()) {
+        QList<quint32> words(512 * 1024);
+        QRandomGenerator(42).fillRange(words.data(), words.size());
+        m_base = QByteArray(reinterpret_cast<const char *>(words.constData()), words.size() * 4);
+    }
+}
+
+QString tst_BackupStore::writeFile(const QString &name, const QByteArray &data) const
+{
+    const QString path = m_dir->filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size()) {
+        return QString();
+    }
+    return path;
+}
+
+// 还原到临时文件并读回；失败返回空串
+QString tst_BackupStore::restored(BackupStore &store, const QString &snapshotId) const
+{
+    const QString path = m_dir->filePath(QStringLiteral("restored.db"));
+    QString error;
+    if (!store.restoreTo(snapshotId, path, &error)) {
+        return QString();
+    }
+    return path;
+}
+
+QSet<QString> tst_BackupStore::chunkFiles() const
+{
+    QSet<QString> names;
+    QDirIterator it(m_dir->filePath(QStringLiteral("store/chunks")), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        names.insert(it.fileName());
+    }
+    return names;
+}
+
+QSet<QString> tst_BackupStore::ids(const BackupStore &store) const
+{
+    QSet<QString> result;
+    for (const BackupStore::Snapshot &snap : store.snapshots()) {
+        result.insert(snap.id);
+    }
+    return result;
+}
+
+static QByteArray readAll(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+void tst_BackupStore::dedupAndRestore()
+{
+    BackupStore store(m_dir->filePath(QStringLiteral("store")));
+    QByteArray changed = m_base;
+    changed[1000000] = char(~changed.at(1000000));   // 中间改一个字节
+
+    QString error;
+    const QString first = store.addSnapshot(writeFile(QStringLiteral("a.db"), m_base), QStringLiteral("auto"),
+                                            &error, QDateTime::currentDateTime().addSecs(-60));
+    QVERIFY2(!first.isEmpty(), qPrintable(error));
+    const int firstChunks = chunkFiles().size();
+    QVERIFY(firstChunks > 8);
+
+    const QString second = store.addSnapshot(writeFile(QStringLiteral("b.db"), changed), QStringLiteral("auto"),
+                                             &error);
+    QVERIFY2(!second.isEmpty(), qPrintable(error));
+    // 只有改动附近的块是新的，其余与第一份共用
+    const int added = chunkFiles().size() - firstChunks;
+    QVERIFY2(added >= 1 && added <= 3, qPrintable(QString::number(added)));
+
+    QCOMPARE(readAll(restored(store, first)), m_base);
+    QCOMPARE(readAll(restored(store, second)), changed);
+}
+
+void tst_BackupStore::retention()
+{
+    BackupStore store(m_dir->filePath(QStringLiteral("store")));
+    const QString source = writeFile(QStringLiteral("a.db"), m_base.left(64 * 1024));
+    const QDateTime now(QDate(2026, 6, 17), QTime(12, 0));
+    auto add = [&](qint64 ageSecs, const QString &reason) {
+        return store.addSnapshot(source, reason, nullptr, now.addSecs(-ageSecs));
+    };
+    constexpr qint64 kHour = 3600;
+    constexpr qint64 kDay = 24 * kHour;
+
+    // 同一时间桶里较旧的一份应被淘汰
+    const QSet<QString> kept = {
+        add(10 * 60, QStringLiteral("auto")),              // 最新
+        add(2 * kHour, QStringLiteral("auto")),            // 小时层
+        add(3 * kDay, QStringLiteral("auto")),             // 天层
+        add(5 * kDay, QStringLiteral("auto")),
+        add(5 * kDay + 2 * kHour, QStringLiteral("manual")),   // 同一天较旧，但手动快照保留 7 天
+        add(10 * kDay, QStringLiteral("auto")),
+        add(30 * kDay, QStringLiteral("auto")),            // 周层
+    };
+    const QSet<QString> expired = {
+        add(20 * 60, QStringLiteral("auto")),              // 与最新同一小时
+        add(3 * kDay + kHour, QStringLiteral("auto")),     // 与天层同一天
+        add(10 * kDay + kHour, QStringLiteral("manual")),  // 同一天较旧，手动保留期已过
+        add(30 * kDay + kHour, QStringLiteral("auto")),    // 与周层同一周
+        add(70 * kDay, QStringLiteral("auto")),            // 超出 8 周
+    };
+    QVERIFY(!kept.contains(QString()) && !expired.contains(QString()));
+    QCOMPARE(ids(store).size(), kept.size() + expired.size());
+
+    QCOMPARE(store.applyRetention(now), int(expired.size()));
+    QCOMPARE(ids(store), kept);
+    QCOMPARE(store.applyRetention(now), 0);   // 再跑一次不再删
+}
+
+void tst_BackupStore::garbageKeepsLiveChunks()
+{
+    BackupStore store(m_dir->filePath(QStringLiteral("store")));
+    QByteArray changed = m_base;
+    changed[1000000] = char(~changed.at(1000000));
+    const QString first = store.addSnapshot(writeFile(QStringLiteral("a.db"), m_base), QStringLiteral("auto"),
+                                            nullptr, QDateTime::currentDateTime().addSecs(-60));
+    const QString second = store.addSnapshot(writeFile(QStringLiteral("b.db"), changed), QStringLiteral("auto"),
+                                             nullptr);
+    QVERIFY(!first.isEmpty() && !second.isEmpty());
+    QCOMPARE(store.collectGarbage(), 0);   // 两份清单都在：一块都不删
+
+    const QSet<QString> before = chunkFiles();
+    QVERIFY(QFile::remove(m_dir->filePath(QStringLiteral("store/snapshots/%1.json").arg(first))));
+    const int removed = store.collectGarbage();
+    QVERIFY(removed >= 1 && removed <= 3);
+    QCOMPARE(chunkFiles().size(), before.size() - removed);
+
+    // 共用块仍在，剩下的快照完整
+    QCOMPARE(readAll(restored(store, second)), changed);
+    int checked = 0;
+    QVERIFY(store.verifyAll(&checked).isEmpty());
+    QCOMPARE(checked, 1);
+}
+
+void tst_BackupStore::verifyFindsCorruption()
+{
+    BackupStore store(m_dir->filePath(QStringLiteral("store")));
+    const QString id = store.addSnapshot(writeFile(QStringLiteral("a.db"), m_base), QStringLiteral("auto"), nullptr);
+    QVERIFY(!id.isEmpty());
+    int checked = 0;
+    QVERIFY(store.verifyAll(&checked).isEmpty());
+    QCOMPARE(checked, 1);
+
+    // 换掉一个块的内容（仍是合法的压缩数据）：文件名对应的哈希不再成立
+    QDirIterator it(m_dir->filePath(QStringLiteral("store/chunks")), QDir::Files, QDirIterator::Subdirectories);
+    QVERIFY(it.hasNext());
+    QFile chunk(it.next());
+    QVERIFY(chunk.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    chunk.write(qCompress(QByteArray(64 * 1024, 'x')));
+    chunk.close();
+
+    const QStringList problems = store.verifyAll(&checked);
+    QCOMPARE(problems.size(), 1);
+    QVERIFY(problems.constFirst().startsWith(id));
+    QVERIFY(restored(store, id).isEmpty());
+}
+
+void tst_BackupStore::adoptLegacyBackups()
+{
+    const QByteArray legacy = m_base.left(300 * 1024);
+    QVERIFY(!writeFile(QStringLiteral("todolist_20260101_093000_startup.db"), legacy).isEmpty());
+    QVERIFY(!writeFile(QStringLiteral("notes.db"), legacy).isEmpty());   // 不是旧版备份，不动
+
+    BackupStore store(m_dir->filePath(QStringLiteral("store")));
+    QCOMPARE(store.adoptLegacyBackups(m_dir->path()), 1);
+    QVERIFY(!QFile::exists(m_dir->filePath(QStringLiteral("todolist_20260101_093000_startup.db"))));
+    QVERIFY(QFile::exists(m_dir->filePath(QStringLiteral("notes.db"))));
+
+    const QList<BackupStore::Snapshot> snapshots = store.snapshots();
+    QCOMPARE(snapshots.size(), 1);
+    QCOMPARE(snapshots.constFirst().created, QDateTime(QDate(2026, 1, 1), QTime(9, 30)));
+    QCOMPARE(snapshots.constFirst().reason, QStringLiteral("startup"));
+    QCOMPARE(readAll(restored(store, snapshots.constFirst().id)), legacy);
+    QCOMPARE(store.adoptLegacyBackups(m_dir->path()), 0);
+}
+
+QTEST_GUILESS_MAIN(tst_BackupStore)
+#include "tst_backupstore.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_backupstore
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_backupstore.cpp
@@ -0,0 +1,86 @@
+#include <QtTest>
+
+#include "todostore.h"
+#include "todolistmodel.h"
+
+// 五万事项的文件夹里勾选一项完成：整体刷新（改为变更通知之前）与按通知只更新一行的对比。
+// 只计模型层：列表模型与排序代理、各页面取用的快照、状态栏等的计数扫描；不含控件绘制
+class tst_ChangeFeed : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void toggle_data();
+    void toggle();
+
+private:
+    TodoFolder m_folder;
+};
+
+void tst_ChangeFeed::initTestCase()
+{
+    m_folder = TodoFolder(QStringLiteral("收件箱"));
+    for (int n = 0; n < 50000; ++n) {
+        TodoItem item(QStringLiteral("事项 %1").arg(n));
+        item.setCompleted(n % 2 == 0);
+        item.setPinned(n % 100 == 0);
+        m_folder.addItem(item);
+    }
+}
+
+void tst_ChangeFeed::toggle_data()
+{
+    QTest::addColumn<bool>("feed");
+
+    QTest::newRow("refresh all views") << false;
+    QTest::newRow("change feed") << true;
+}
+
+void tst_ChangeFeed::toggle()
+{
+    QFETCH(bool, feed);
+
+    TodoStore store;
+    store.reset({m_folder});
+    TodoListModel model(&store);
+    TodoListProxy proxy(&model);
+    const QString folderId = m_folder.getId();
+    model.setFolder(folderId);
+    if (feed) {
+        connect(store.feed(), &TodoChangeFeed::itemChanged, &model,
+                [&model](const TodoItem &item, TodoChangeFeed::Fields fields) {
+            model.updateItem(item.getId(), fields);
+        });
+    }
+
+    const QString itemId = m_folder.getItems().at(25001).getId();
+    bool completed = false;
+    QBENCHMARK {
+        completed = !completed;
+        store.item(itemId)->setCompleted(completed);
+        store.markChanged(itemId, TodoChangeFeed::Completed);
+        if (!feed) {
+            // refreshAllViews：列表整体重建并重排，各页面取新快照（物化改动的文件夹）后全量计数
+            model.setFolder(QString());
+            model.setFolder(folderId);
+            const TodoSnapshotPtr snapshot = store.snapshot();
+            int done = 0;
+            for (const TodoFolder &folder : snapshot->folders()) {
+                for (const TodoItem &item : folder.getItems()) {
+                    done += item.isCompleted() ? 1 : 0;
+                }
+            }
+            QCOMPARE(done, store.completedCount());
+        }
+    }
+
+    QCOMPARE(proxy.rowCount(), 50000);
+    const int row = model.rowOf(itemId);
+    QVERIFY(row >= 0);
+    QCOMPARE(model.index(row).data(TodoListModel::RoleCompleted).toBool(), completed);
+}
+
+QTEST_GUILESS_MAIN(tst_ChangeFeed)
+#include "tst_changefeed.moc"
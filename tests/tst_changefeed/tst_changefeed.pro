@@ -0,0 +1,6 @@
+TARGET = tst_changefeed
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_changefeed.cpp
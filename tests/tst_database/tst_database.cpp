@@ -0,0 +1,209 @@
+#include <QtTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStandardPaths>
+#include <QDir>
+
+#include "databasemanager.h"
+
+// 在测试模式的应用数据目录里新建一份库，走完整的 initialize()（建表 + 全部迁移）
+class tst_Database : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void migrations();
+
+    void queryPlans_data();
+    void queryPlans();
+
+    void loadAll_data();
+    void loadAll();
+
+    void upsert_data();
+    void upsert();
+
+private:
+    static bool populate(int itemCount);
+
+    QString m_dataRoot;
+};
+
+void tst_Database::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_dataRoot = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir(m_dataRoot).removeRecursively();
+
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY2(db.initialize(), qPrintable(db.lastError()));
+}
+
+void tst_Database::cleanupTestCase()
+{
+    QDir(m_dataRoot).removeRecursively();
+}
+
+// 新库走完全部迁移：v5 建出的全文索引与同步触发器在 v6 里撤掉，不留残余
+void tst_Database::migrations()
+{
+    QSqlQuery query(QSqlDatabase::database());
+    QVERIFY(query.exec(QStringLiteral("PRAGMA user_version")) && query.next());
+    QCOMPARE(query.value(0).toInt(), 6);
+    QVERIFY(query.exec(QStringLiteral("SELECT COUNT(*) FROM sqlite_master "
+                                      "WHERE name = 'items_fts' OR name LIKE 'items_fts_%' "
+                                      "OR name LIKE 'trg_fts_%'")) && query.next());
+    QCOMPARE(query.value(0).toInt(), 0);
+}
+
+// 清空后写入 itemCount 条事项：每个文件夹 1000 条，每条一个标签、一段详情
+bool tst_Database::populate(int itemCount)
+{
+    DatabaseManager &db = DatabaseManager::instance();
+    QSqlQuery query(QSqlDatabase::database());
+    if (!query.exec(QStringLiteral("DELETE FROM item_tags")) || !query.exec(QStringLiteral("DELETE FROM items"))
+        || !query.exec(QStringLiteral("DELETE FROM folders")) || !db.beginBatch()) {
+        return false;
+    }
+    const QStringList tags = {QStringLiteral("工作"), QStringLiteral("生活"), QStringLiteral("学习")};
+    TodoFolder folder;
+    for (int n = 0; n < itemCount; ++n) {
+        if (n % 1000 == 0) {
+            folder = TodoFolder(QStringLiteral("文件夹 %1").arg(n / 1000));
+            if (!db.upsertFolder(folder)) {
+                db.rollbackBatch();
+                return false;
+            }
+        }
+        TodoItem item(QStringLiteral("事项 %1").arg(n), QStringLiteral("第 %1 条事项的详情").arg(n));
+        item.setFolderId(folder.getId());
+        item.setTags({tags.at(n % tags.size())});
+        item.setCompleted(n % 4 == 0);
+        if (!db.upsertItem(item)) {
+            db.rollbackBatch();
+            return false;
+        }
+    }
+    return db.commitBatch();
+}
+
+void tst_Database::queryPlans_data()
+{
+    QTest::addColumn<QString>("sql");
+
+    // 热点语句：按文件夹移入回收站、回收站列表与恢复、过期清理、按标签删除、标签同步、按截止日期筛选。
+    // 全量读取的 loadAll 不在此列
+    QTest::newRow("trash folder items")
+        << QStringLiteral("UPDATE items SET deletedTime = ? WHERE folderId = ? AND deletedTime IS NULL");
+    QTest::newRow("list trash")
+        << QStringLiteral("SELECT id FROM items WHERE deletedTime IS NOT NULL ORDER BY deletedTime DESC");
+    QTest::newRow("restore item")
+        << QStringLiteral("UPDATE items SET deletedTime = NULL WHERE id = ? AND folderId IN (SELECT id FROM folders)");
+    QTest::newRow("purge expired tags")
+        << QStringLiteral("DELETE FROM item_tags WHERE itemId IN "
+                          "(SELECT id FROM items WHERE deletedTime IS NOT NULL AND deletedTime < ?)");
+    QTest::newRow("purge expired items")
+        << QStringLiteral("DELETE FROM items WHERE deletedTime IS NOT NULL AND deletedTime < ?");
+    QTest::newRow("unlink removed tag")
+        << QStringLiteral("DELETE FROM item_tags WHERE tagId IN (SELECT id FROM tags WHERE name = ?)");
+    QTest::newRow("item tag ids")
+        << QStringLiteral("SELECT tagId FROM item_tags WHERE itemId = ?");
+    QTest::newRow("unlink tag")
+        << QStringLiteral("DELETE FROM item_tags WHERE itemId = ? AND tagId = ?");
+    QTest::newRow("due range")
+        << QStringLiteral("SELECT id FROM items WHERE dueDate >= ? AND dueDate <= ?");
+}
+
+void tst_Database::queryPlans()
+{
+    QFETCH(QString, sql);
+
+    QSqlQuery query(QSqlDatabase::database());
+    QVERIFY2(query.prepare(QStringLiteral("EXPLAIN QUERY PLAN ") + sql), qPrintable(query.lastError().text()));
+    for (int i = sql.count(QLatin1Char('?')); i > 0; --i) {
+        query.addBindValue(QVariant());
+    }
+    QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+
+    int rows = 0;
+    while (query.next()) {
+        const QString detail = query.value(3).toString();
+        QVERIFY2(!detail.contains(QLatin1String("SCAN")), qPrintable(detail));
+        ++rows;
+    }
+    QVERIFY(rows > 0);
+}
+
+void tst_Database::loadAll_data()
+{
+    QTest::addColumn<int>("itemCount");
+
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+}
+
+void tst_Database::loadAll()
+{
+    QFETCH(int, itemCount);
+    QVERIFY2(populate(itemCount), qPrintable(DatabaseManager::instance().lastError()));
+
+    // 固定三条查询：文件夹、事项、标签关联
+    QList<TodoFolder> folders;
+    QBENCHMARK {
+        folders = DatabaseManager::instance().loadAll();
+    }
+    qsizetype loaded = 0;
+    for (const TodoFolder &folder : std::as_const(folders)) {
+        loaded += folder.getItems().size();
+    }
+    QCOMPARE(loaded, qsizetype(itemCount));
+    QCOMPARE(folders.constFirst().getItems().constFirst().getTags().size(), 1);
+}
+
+void tst_Database::upsert_data()
+{
+    QTest::addColumn<bool>("cached");
+
+    // 改为语句缓存之前，每次写入都要重新 prepare：每次清空缓存即可复现
+    QTest::newRow("prepare per call") << false;
+    QTest::newRow("cached statements") << true;
+}
+
+void tst_Database::upsert()
+{
+    QFETCH(bool, cached);
+    constexpr int kUpserts = 10000;
+
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY(populate(0));
+    const TodoFolder folder(QStringLiteral("写入"));
+    QVERIFY(db.upsertFolder(folder));
+    QList<TodoItem> items;
+    items.reserve(kUpserts);
+    for (int n = 0; n < kUpserts; ++n) {
+        TodoItem item(QStringLiteral("事项 %1").arg(n));
+        item.setFolderId(folder.getId());
+        item.setTags({QStringLiteral("工作")});
+        items.append(item);
+    }
+
+    // 总耗时 / 10000 即单次 upsert（含标签同步）的开销；首轮插入，之后各轮走 ON CONFLICT 更新
+    QBENCHMARK {
+        QVERIFY(db.beginBatch());
+        for (const TodoItem &item : std::as_const(items)) {
+            if (!cached) {
+                db.m_statements.clear();
+            }
+            QVERIFY2(db.upsertItem(item), qPrintable(db.lastError()));
+        }
+        QVERIFY(db.commitBatch());
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_Database)
+#include "tst_database.moc"
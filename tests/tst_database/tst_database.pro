@@ -0,0 +1,6 @@
+TARGET = tst_database
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_database.cpp
@@ -0,0 +1,160 @@
+#include <QtTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QDir>
+#include <atomic>
+
+#include "databasemanager.h"
+#include "databasewriter.h"
+
+// 写线程的合并与顺序：同一键的连续 upsert 只写一次，删除/移动是屏障，
+// 持续投递时最大延迟仍保证落库，stop() 前投递的写入全部提交。结果经主连接读回
+class tst_DatabaseWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void coalesce();
+    void barrier();
+    void maxDelay();
+    void stopWritesPending();
+
+private:
+    void upsert(DatabaseWriter &writer, const TodoItem &item);
+    static bool flush(DatabaseWriter &writer, QObject *context);
+    static QString titleOf(const QString &itemId);
+
+    QString m_dataRoot;
+    TodoFolder m_folder;
+    std::atomic<int> m_writes{0};             // 写线程实际执行的 upsert 次数
+};
+
+void tst_DatabaseWriter::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_dataRoot = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir(m_dataRoot).removeRecursively();
+
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY2(db.initialize(), qPrintable(db.lastError()));
+    m_folder = TodoFolder(QStringLiteral("写入"));
+    QVERIFY(db.upsertFolder(m_folder));
+}
+
+void tst_DatabaseWriter::cleanupTestCase()
+{
+    QDir(m_dataRoot).removeRecursively();
+}
+
+void tst_DatabaseWriter::init()
+{
+    m_writes = 0;
+}
+
+// 与 DatabaseWriter::upsertItem 同键，执行时计数
+void tst_DatabaseWriter::upsert(DatabaseWriter &writer, const TodoItem &item)
+{
+    writer.post(QStringLiteral("item:") + item.getId(), [this, item](DatabaseManager &db) {
+        ++m_writes;
+        return db.upsertItem(item);
+    });
+}
+
+// 落库后 done 在本线程回调；超时返回 false
+bool tst_DatabaseWriter::flush(DatabaseWriter &writer, QObject *context)
+{
+    bool done = false;
+    writer.flush(context, [&done]() { done = true; });
+    return QTest::qWaitFor([&done]() { return done; });
+}
+
+QString tst_DatabaseWriter::titleOf(const QString &itemId)
+{
+    QSqlQuery query(QSqlDatabase::database());
+    query.prepare(QStringLiteral("SELECT title FROM items WHERE id = ?"));
+    query.addBindValue(itemId);
+    return query.exec() && query.next() ? query.value(0).toString() : QString();
+}
+
+void tst_DatabaseWriter::coalesce()
+{
+    DatabaseWriter writer;
+    writer.start(DatabaseManager::instance().databasePath());
+
+    TodoItem item(QStringLiteral("草稿"));
+    item.setFolderId(m_folder.getId());
+    for (int n = 1; n <= 5; ++n) {
+        item.setTitle(QStringLiteral("第 %1 版").arg(n));
+        upsert(writer, item);
+    }
+    QVERIFY(flush(writer, this));
+
+    QCOMPARE(m_writes.load(), 1);
+    QCOMPARE(titleOf(item.getId()), QStringLiteral("第 5 版"));
+}
+
+void tst_DatabaseWriter::barrier()
+{
+    DatabaseWriter writer;
+    writer.start(DatabaseManager::instance().databasePath());
+
+    TodoItem item(QStringLiteral("移动前"));
+    item.setFolderId(m_folder.getId());
+    upsert(writer, item);
+    writer.moveItem(item.getId(), m_folder.getId());
+    item.setTitle(QStringLiteral("移动后"));
+    upsert(writer, item);
+    QVERIFY(flush(writer, this));
+
+    // 屏障之后的 upsert 不并入之前那条，两次都写
+    QCOMPARE(m_writes.load(), 2);
+    QCOMPARE(titleOf(item.getId()), QStringLiteral("移动后"));
+}
+
+void tst_DatabaseWriter::maxDelay()
+{
+    DatabaseWriter writer;
+    writer.start(DatabaseManager::instance().databasePath());
+
+    // 每 50 ms 投递一次，静默窗口永远不到；最大延迟保证 1 秒左右先落库一批
+    TodoItem item(QStringLiteral("连续编辑"));
+    item.setFolderId(m_folder.getId());
+    QElapsedTimer timer;
+    timer.start();
+    while (m_writes.load() == 0 && timer.elapsed() < 3000) {
+        item.setTitle(QStringLiteral("连续编辑 %1").arg(timer.elapsed()));
+        upsert(writer, item);
+        QTest::qWait(50);
+    }
+    QCOMPARE(m_writes.load(), 1);
+    QVERIFY2(timer.elapsed() < 2000, qPrintable(QString::number(timer.elapsed())));
+}
+
+void tst_DatabaseWriter::stopWritesPending()
+{
+    QList<TodoItem> items;
+    {
+        DatabaseWriter writer;
+        writer.start(DatabaseManager::instance().databasePath());
+        for (int n = 0; n < 100; ++n) {
+            TodoItem item(QStringLiteral("退出前 %1").arg(n));
+            item.setFolderId(m_folder.getId());
+            upsert(writer, item);
+            items.append(item);
+        }
+        // 合并窗口未到即退出：收尾时提交
+        writer.stop();
+        QCOMPARE(m_writes.load(), 100);
+    }
+    for (const TodoItem &item : std::as_const(items)) {
+        QCOMPARE(titleOf(item.getId()), item.getTitle());
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_DatabaseWriter)
+#include "tst_databasewriter.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_databasewriter
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_databasewriter.cpp
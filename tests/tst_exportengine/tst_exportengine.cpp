@@ -0,0 +1,191 @@
+#include <QtTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDir>
+
+#include "databasemanager.h"
+#include "exportengine.h"
+
+// 流式导出的两种格式：逐个文件夹、事项与 loadAll 读出的模型序列化结果一致；
+// 打开库失败时不留下导出连接，也不留下目标文件
+class tst_ExportEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void json();
+    void ndjson();
+    void attachFailure();
+
+private:
+    struct Outcome {
+        bool done = false;
+        bool ok = false;
+        int itemCount = -1;
+        QString error;
+    };
+
+    bool run(const QString &filePath, ExportEngine::Format format, const QString &dbPath, Outcome *outcome);
+    static QJsonObject head(const TodoFolder &folder);
+
+    QString m_dataRoot;
+    QTemporaryDir m_files;
+    QList<TodoFolder> m_expected;             // 导出应与之一致的模型（loadAll 读回）
+    int m_itemCount = 0;
+};
+
+void tst_ExportEngine::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_dataRoot = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir(m_dataRoot).removeRecursively();
+    QVERIFY(m_files.isValid());
+
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY2(db.initialize(), qPrintable(db.lastError()));
+    QSqlQuery query(QSqlDatabase::database());
+    QVERIFY(query.exec(QStringLiteral("DELETE FROM item_tags")));
+    QVERIFY(query.exec(QStringLiteral("DELETE FROM items")));
+    QVERIFY(query.exec(QStringLiteral("DELETE FROM folders")));
+
+    // 一个文件夹带事项（含需要转义的字符、标签、日期），一个空文件夹。
+    // 两边都按 createdTime 排序，创建时间错开以免同毫秒时顺序不定
+    const QDateTime base = QDateTime::currentDateTime().addSecs(-60);
+    TodoFolder work(QStringLiteral("工作"));
+    TodoFolder empty(QStringLiteral("空"));
+    work.setCreatedTime(base);
+    empty.setCreatedTime(base.addSecs(1));
+    QVERIFY(db.upsertFolder(work));
+    QVERIFY(db.upsertFolder(empty));
+    for (int n = 0; n < 3; ++n) {
+        TodoItem item(QStringLiteral("事项 \"%1\"").arg(n), QStringLiteral("第一行\n第二行\t\\ %1").arg(n));
+        item.setFolderId(work.getId());
+        item.setCreatedTime(base.addSecs(10 + n));
+        item.setTags({QStringLiteral("标签%1").arg(n)});
+        item.setDueDate(QDate(2026, 1, 1 + n));
+        item.setCompleted(n == 1);
+        QVERIFY(db.upsertItem(item));
+    }
+    m_expected = db.loadAll();
+    QCOMPARE(m_expected.size(), 2);
+    m_itemCount = 3;
+}
+
+void tst_ExportEngine::cleanupTestCase()
+{
+    QDir(m_dataRoot).removeRecursively();
+}
+
+bool tst_ExportEngine::run(const QString &filePath, ExportEngine::Format format, const QString &dbPath,
+                           Outcome *outcome)
+{
+    ExportEngine engine;
+    connect(&engine, &ExportEngine::finished, this,
+            [outcome](bool ok, bool, int itemCount, const QString &error) {
+        outcome->done = true;
+        outcome->ok = ok;
+        outcome->itemCount = itemCount;
+        outcome->error = error;
+    });
+    if (!engine.start(filePath, format, dbPath)) {
+        return false;
+    }
+    return QTest::qWaitFor([&]() { return outcome->done && !engine.isRunning(); });
+}
+
+// 文件夹自身的字段（不含 items）
+QJsonObject tst_ExportEngine::head(const TodoFolder &folder)
+{
+    QJsonObject object = folder.toJson();
+    object.remove(QStringLiteral("items"));
+    return object;
+}
+
+void tst_ExportEngine::json()
+{
+    const QString path = m_files.filePath(QStringLiteral("export.json"));
+    Outcome outcome;
+    QVERIFY(run(path, ExportEngine::Json, DatabaseManager::instance().databasePath(), &outcome));
+    QVERIFY2(outcome.ok, qPrintable(outcome.error));
+    QCOMPARE(outcome.itemCount, m_itemCount);
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+
+    // 与原导出同一结构：逐字段等于模型的 toJson()，可被 TodoFolder(QJsonObject) 读回
+    const QJsonArray folders = doc.object().value(QStringLiteral("folders")).toArray();
+    QCOMPARE(folders.size(), m_expected.size());
+    for (qsizetype i = 0; i < folders.size(); ++i) {
+        QCOMPARE(folders.at(i).toObject(), m_expected.at(i).toJson());
+        QCOMPARE(TodoFolder(folders.at(i).toObject()).getItemCount(), m_expected.at(i).getItemCount());
+    }
+}
+
+void tst_ExportEngine::ndjson()
+{
+    const QString path = m_files.filePath(QStringLiteral("export.ndjson"));
+    Outcome outcome;
+    QVERIFY(run(path, ExportEngine::NdJson, DatabaseManager::instance().databasePath(), &outcome));
+    QVERIFY2(outcome.ok, qPrintable(outcome.error));
+    QCOMPARE(outcome.itemCount, m_itemCount);
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    QList<QJsonObject> expected;
+    for (const TodoFolder &folder : std::as_const(m_expected)) {
+        QJsonObject object = head(folder);
+        object.insert(QStringLiteral("type"), QStringLiteral("folder"));
+        expected.append(object);
+        for (const TodoItem &item : folder.getItems()) {
+            object = item.toJson();
+            object.insert(QStringLiteral("type"), QStringLiteral("item"));
+            expected.append(object);
+        }
+    }
+
+    // 每行一个紧凑对象，文件夹行后紧跟它的事项
+    qsizetype line = 0;
+    while (!file.atEnd()) {
+        const QByteArray text = file.readLine().trimmed();
+        QVERIFY(!text.isEmpty());
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(text, &error);
+        QCOMPARE(error.error, QJsonParseError::NoError);
+        QVERIFY(line < expected.size());
+        QCOMPARE(doc.object(), expected.at(line));
+        ++line;
+    }
+    QCOMPARE(line, expected.size());
+}
+
+void tst_ExportEngine::attachFailure()
+{
+    const QString path = m_files.filePath(QStringLiteral("never.json"));
+    const QStringList connections = QSqlDatabase::connectionNames();
+
+    Outcome outcome;
+    QVERIFY(run(path, ExportEngine::Json, m_files.filePath(QStringLiteral("missing/dir/todolist.db")), &outcome));
+    QVERIFY(!outcome.ok);
+    QVERIFY(!outcome.error.isEmpty());
+    QVERIFY(!QFile::exists(path));
+    QCOMPARE(QSqlDatabase::connectionNames(), connections);
+
+    // 之后的导出照常进行
+    Outcome retry;
+    QVERIFY(run(path, ExportEngine::Json, DatabaseManager::instance().databasePath(), &retry));
+    QVERIFY2(retry.ok, qPrintable(retry.error));
+    QCOMPARE(QSqlDatabase::connectionNames(), connections);
+}
+
+QTEST_GUILESS_MAIN(tst_ExportEngine)
+#include "tst_exportengine.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_exportengine
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_exportengine.cpp
@@ -0,0 +1,215 @@
+#include <QtTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDir>
+
+#include "databasemanager.h"
+#include "importengine.h"
+
+// 流水线导入的整体替换语义：坏文件与中途取消都整体回滚，库里保持导入前的内容
+// （连同整体替换期间删掉的索引与触发器）；正常导入跑满多个批次，经有界队列逐批写入
+class tst_ImportEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void malformedRollsBack();
+    void cancelRollsBack();
+    void replaces();
+
+private:
+    struct Outcome {
+        bool done = false;
+        bool ok = false;
+        bool cancelled = false;
+        QList<TodoFolder> folders;
+        QString error;
+    };
+
+    QString writeExport(int itemCount, int chop = 0) const;
+    bool run(ImportEngine &engine, const QString &jsonPath, Outcome *outcome);
+    static QStringList storedTitles();
+    static int schemaObjects();
+
+    QString m_dataRoot;
+    QTemporaryDir m_files;
+    QStringList m_previous;                   // 每个用例开始前库里的事项标题
+    int m_schemaObjects = 0;
+};
+
+void tst_ImportEngine::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_dataRoot = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir(m_dataRoot).removeRecursively();
+
+    DatabaseManager &db = DatabaseManager::instance();
+    QVERIFY2(db.initialize(), qPrintable(db.lastError()));
+    QVERIFY(m_files.isValid());
+    m_schemaObjects = schemaObjects();
+    QVERIFY(m_schemaObjects > 0);
+}
+
+void tst_ImportEngine::cleanupTestCase()
+{
+    QDir(m_dataRoot).removeRecursively();
+}
+
+// 每个用例前把库恢复成一个文件夹、三条事项
+void tst_ImportEngine::init()
+{
+    DatabaseManager &db = DatabaseManager::instance();
+    QSqlQuery query(QSqlDatabase::database());
+    QVERIFY(query.exec(QStringLiteral("DELETE FROM item_tags")));
+    QVERIFY(query.exec(QStringLiteral("DELETE FROM items")));
+    QVERIFY(query.exec(QStringLiteral("DELETE FROM folders")));
+    const TodoFolder folder(QStringLiteral("原有"));
+    QVERIFY(db.upsertFolder(folder));
+    for (const QString &title : {QStringLiteral("买菜"), QStringLiteral("交房租"), QStringLiteral("回邮件")}) {
+        TodoItem item(title);
+        item.setFolderId(folder.getId());
+        item.setTags({QStringLiteral("生活")});
+        QVERIFY(db.upsertItem(item));
+    }
+    m_previous = storedTitles();
+    QCOMPARE(m_previous.size(), 3);
+}
+
+// 与导出同格式：{"folders":[{..., "items":[...]}]}，每个文件夹 1000 条；chop > 0 时截掉末尾若干字节
+QString tst_ImportEngine::writeExport(int itemCount, int chop) const
+{
+    QJsonArray folders;
+    TodoFolder folder;
+    for (int n = 0; n < itemCount; ++n) {
+        if (n % 1000 == 0) {
+            if (n > 0) {
+                folders.append(folder.toJson());
+            }
+            folder = TodoFolder(QStringLiteral("导入 %1").arg(n / 1000));
+        }
+        TodoItem item(QStringLiteral("导入事项 %1").arg(n), QStringLiteral("第 %1 条").arg(n));
+        item.setFolderId(folder.getId());
+        folder.addItem(item);
+    }
+    folders.append(folder.toJson());
+    QByteArray json = QJsonDocument(QJsonObject{{QStringLiteral("folders"), folders}})
+                          .toJson(QJsonDocument::Compact);
+    json.chop(chop);
+
+    const QString path = m_files.filePath(QStringLiteral("import_%1_%2.json").arg(itemCount).arg(chop));
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+        return QString();
+    }
+    return path;
+}
+
+bool tst_ImportEngine::run(ImportEngine &engine, const QString &jsonPath, Outcome *outcome)
+{
+    connect(&engine, &ImportEngine::finished, this,
+            [outcome](bool ok, bool cancelled, const QList<TodoFolder> &folders, const QString &error) {
+        outcome->done = true;
+        outcome->ok = ok;
+        outcome->cancelled = cancelled;
+        outcome->folders = folders;
+        outcome->error = error;
+    });
+    if (!engine.start(jsonPath, DatabaseManager::instance().databasePath())) {
+        return false;
+    }
+    // finished 之后引擎还要回收线程：等到 isRunning 复位
+    return QTest::qWaitFor([&]() { return outcome->done && !engine.isRunning(); }, 30000);
+}
+
+QStringList tst_ImportEngine::storedTitles()
+{
+    QStringList titles;
+    QSqlQuery query(QSqlDatabase::database());
+    if (query.exec(QStringLiteral("SELECT title FROM items ORDER BY title"))) {
+        while (query.next()) {
+            titles.append(query.value(0).toString());
+        }
+    }
+    return titles;
+}
+
+int tst_ImportEngine::schemaObjects()
+{
+    QSqlQuery query(QSqlDatabase::database());
+    return query.exec(QStringLiteral("SELECT COUNT(*) FROM sqlite_master WHERE type IN ('index', 'trigger')"))
+            && query.next() ? query.value(0).toInt() : -1;
+}
+
+void tst_ImportEngine::malformedRollsBack()
+{
+    // 截断的文件：前面几批已经写入，读到末尾才发现损坏
+    const QString path = writeExport(10000, 40);
+    QVERIFY(!path.isEmpty());
+
+    ImportEngine engine;
+    Outcome outcome;
+    QVERIFY(run(engine, path, &outcome));
+    QVERIFY(!outcome.ok);
+    QVERIFY(!outcome.cancelled);
+    QVERIFY(!outcome.error.isEmpty());
+    QVERIFY(outcome.folders.isEmpty());
+
+    QCOMPARE(storedTitles(), m_previous);
+    QCOMPARE(schemaObjects(), m_schemaObjects);
+}
+
+void tst_ImportEngine::cancelRollsBack()
+{
+    const QString path = writeExport(50000);
+    QVERIFY(!path.isEmpty());
+
+    // 第一批写入后（写入线程上直接连接）立即取消
+    ImportEngine engine;
+    int batches = 0;
+    connect(&engine, &ImportEngine::progress, &engine, [&engine, &batches](int percent) {
+        if (percent < 100 && ++batches == 1) {
+            engine.cancel();
+        }
+    }, Qt::DirectConnection);
+    Outcome outcome;
+    QVERIFY(run(engine, path, &outcome));
+    QVERIFY(!outcome.ok);
+    QVERIFY(outcome.cancelled);
+    QCOMPARE(batches, 1);
+
+    QCOMPARE(storedTitles(), m_previous);
+    QCOMPARE(schemaObjects(), m_schemaObjects);
+}
+
+void tst_ImportEngine::replaces()
+{
+    // 50000 条 ≈ 25 批，远多于队列容量：解析线程要等写入线程腾出位置
+    const QString path = writeExport(50000);
+    QVERIFY(!path.isEmpty());
+
+    ImportEngine engine;
+    Outcome outcome;
+    QVERIFY(run(engine, path, &outcome));
+    QVERIFY2(outcome.ok, qPrintable(outcome.error));
+
+    qsizetype returned = 0;
+    for (const TodoFolder &folder : std::as_const(outcome.folders)) {
+        returned += folder.getItemCount();
+    }
+    QCOMPARE(returned, qsizetype(50000));
+    const QStringList titles = storedTitles();
+    QCOMPARE(titles.size(), 50000);
+    QVERIFY(!titles.contains(m_previous.constFirst()));
+    QCOMPARE(schemaObjects(), m_schemaObjects);
+}
+
+QTEST_GUILESS_MAIN(tst_ImportEngine)
+#include "tst_importengine.moc"
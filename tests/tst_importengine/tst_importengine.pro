@@ -0,0 +1,6 @@
+TARGET = tst_importengine
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_importengine.cpp
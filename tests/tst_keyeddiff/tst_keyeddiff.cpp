@@ -0,0 +1,149 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QSet>
+#include <algorithm>
+
+#include "keyeddiff.h"
+
+// 键控差异：把步骤逐一应用到旧列表上必须得到新列表，移动次数恰为保留行数减最长递增子序列，
+// 只有内容有变的保留行才出现在 Update 里。随机前后列表反复比对
+class tst_KeyedDiff : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fuzz();
+    void reversed();
+    void updates();
+
+private:
+    struct Applied {
+        QList<int> rows;
+        int moves = 0;
+        QSet<int> updated;                    // Update 步骤涉及的新下标
+        bool aligned = true;                  // 每个 Update 的行都已与新列表对齐
+    };
+
+    static Applied apply(const QList<int> &before, const QList<int> &after,
+                         const std::vector<KeyedDiff::Step> &steps);
+    static int minimumMoves(const QList<int> &before, const QList<int> &after);
+    static QList<int> randomList(QRandomGenerator &random, int universe);
+};
+
+tst_KeyedDiff::Applied tst_KeyedDiff::apply(const QList<int> &before, const QList<int> &after,
+                                            const std::vector<KeyedDiff::Step> &steps)
+{
+    Applied applied;
+    applied.rows = before;
+    KeyedDiff::apply(steps,
+        [&](int row) { applied.rows.removeAt(row); },
+        [&](int row, int item) { applied.rows.insert(row, after.at(item)); },
+        [&](int from, int row) {
+            applied.rows.insert(row, applied.rows.takeAt(from));
+            ++applied.moves;
+        },
+        [&](int row, int item) {
+            // 更新排在最后：此时行已与新列表对齐
+            applied.aligned = applied.aligned && row == item && applied.rows.at(row) == after.at(item);
+            applied.updated.insert(item);
+        });
+    return applied;
+}
+
+// 独立于被测实现：保留行按旧顺序排出其新下标，O(n²) 求最长递增子序列
+int tst_KeyedDiff::minimumMoves(const QList<int> &before, const QList<int> &after)
+{
+    QList<int> targets;
+    for (int key : before) {
+        const qsizetype target = after.indexOf(key);
+        if (target >= 0) {
+            targets.append(int(target));
+        }
+    }
+    QList<int> longest(targets.size(), 1);
+    int lis = 0;
+    for (qsizetype i = 0; i < targets.size(); ++i) {
+        for (qsizetype j = 0; j < i; ++j) {
+            if (targets.at(j) < targets.at(i)) {
+                longest[i] = qMax(longest.at(i), longest.at(j) + 1);
+            }
+        }
+        lis = qMax(lis, longest.at(i));
+    }
+    return int(targets.size()) - lis;
+}
+
+// 从 [0, universe) 中随机取一部分键，随机排列；偶尔原样保留一段有序的前缀，贴近实际的小改动
+QList<int> tst_KeyedDiff::randomList(QRandomGenerator &random, int universe)
+{
+    QList<int> keys;
+    for (int key = 0; key < universe; ++key) {
+        if (random.bounded(4) != 0) {
+            keys.append(key);
+        }
+    }
+    const int sorted = random.bounded(2) ? random.bounded(int(keys.size()) + 1) : 0;
+    for (qsizetype i = keys.size() - 1; i > sorted; --i) {
+        std::swap(keys[i], keys[sorted + random.bounded(int(i - sorted) + 1)]);
+    }
+    return keys;
+}
+
+void tst_KeyedDiff::fuzz()
+{
+    QRandomGenerator random(20260617);
+    for (int round = 0; round < 2000; ++round) {
+        const int universe = random.bounded(round < 100 ? 6 : 80);
+        const QList<int> before = randomList(random, universe);
+        const QList<int> after = randomList(random, universe);
+
+        const Applied applied = apply(before, after, KeyedDiff::compute(before, after));
+        QCOMPARE(applied.rows, after);
+        QCOMPARE(applied.moves, minimumMoves(before, after));
+        QVERIFY(applied.updated.isEmpty());
+    }
+}
+
+void tst_KeyedDiff::reversed()
+{
+    QList<int> before;
+    for (int key = 0; key < 100; ++key) {
+        before.append(key);
+    }
+    QList<int> after = before;
+    std::reverse(after.begin(), after.end());
+
+    const Applied applied = apply(before, after, KeyedDiff::compute(before, after));
+    QCOMPARE(applied.rows, after);
+    QCOMPARE(applied.moves, 99);
+    QCOMPARE(apply(before, before, KeyedDiff::compute(before, before)).moves, 0);
+}
+
+void tst_KeyedDiff::updates()
+{
+    QRandomGenerator random(7);
+    for (int round = 0; round < 200; ++round) {
+        const QList<int> before = randomList(random, 40);
+        const QList<int> after = randomList(random, 40);
+
+        // 键为 3 的倍数的保留行内容有变
+        QSet<int> expected;
+        const std::vector<KeyedDiff::Step> steps = KeyedDiff::compute(before, after, [&](int from, int item) {
+            if (before.at(from) != after.at(item)) {
+                return false;
+            }
+            if (after.at(item) % 3 == 0) {
+                expected.insert(item);
+                return true;
+            }
+            return false;
+        });
+        const Applied applied = apply(before, after, steps);
+        QCOMPARE(applied.rows, after);
+        QVERIFY(applied.aligned);
+        QCOMPARE(applied.updated, expected);
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_KeyedDiff)
+#include "tst_keyeddiff.moc"
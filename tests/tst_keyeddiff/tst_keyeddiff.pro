@@ -0,0 +1,6 @@
+TARGET = tst_keyeddiff
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_keyeddiff.cpp
@@ -0,0 +1,133 @@
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "modelsnapshot.h"
+
+// 二进制模型快照：写入再读回与原模型逐字段一致；版本戳对不上或文件残缺时一律视为无快照
+class tst_ModelSnapshot : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void roundTrip();
+    void staleStamp();
+    void truncated();
+
+private:
+    QString save(const QString &name) const;
+
+    QTemporaryDir m_dir;
+    QList<TodoFolder> m_folders;
+    DatabaseManager::ChangeStamp m_stamp;
+};
+
+void tst_ModelSnapshot::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_stamp.databaseId = 0x5eed;
+    m_stamp.counter = 42;
+
+    // 覆盖各类字段：共用的标签与颜色、多行详情、旧式 id、完成时间、提醒、未设置的日期，外加一个空文件夹
+    const QDateTime base(QDate(2026, 3, 1), QTime(8, 30, 15, 250));
+    TodoFolder work(QStringLiteral("工作"));
+    work.setColor(QStringLiteral("#e11d48"));
+    work.setPinned(true);
+    work.setCreatedTime(base);
+    for (int n = 0; n < 5; ++n) {
+        TodoItem item(QStringLiteral("事项 %1").arg(n), QStringLiteral("第一行\n第二行 %1").arg(n));
+        item.setFolderId(work.getId());
+        item.setTags(n % 2 ? QStringList{QStringLiteral("紧急"), QStringLiteral("周报")}
+                           : QStringList{QStringLiteral("周报")});
+        item.setPriority(n % 3);
+        item.setPinned(n == 4);
+        item.setTagColor(n == 3 ? QStringLiteral("Red") : QStringLiteral("#2563eb"));
+        item.setPlannedDate(n == 2 ? QDate() : QDate(2026, 3, 2 + n));
+        item.setCompleted(n == 1);
+        item.setCreatedTime(base.addSecs(n));
+        item.setRemindAt(n == 0 ? base.addDays(1) : QDateTime());
+        item.setUpdatedTime(base.addMSecs(1000 * n + 7));
+        work.addItem(item);
+    }
+    TodoItem legacy(QStringLiteral("旧数据"));
+    legacy.setId(QStringLiteral("item-0001"));
+    legacy.setFolderId(work.getId());
+    work.addItem(legacy);
+
+    TodoFolder empty(QStringLiteral("空"));
+    empty.setCreatedTime(base.addDays(-1));
+    m_folders = {work, empty};
+}
+
+QString tst_ModelSnapshot::save(const QString &name) const
+{
+    const QString path = m_dir.filePath(name);
+    QString error;
+    return ModelSnapshot::save(path, m_folders, m_stamp, &error) ? path : QString();
+}
+
+void tst_ModelSnapshot::roundTrip()
+{
+    const QString path = save(QStringLiteral("round.snap"));
+    QVERIFY(!path.isEmpty());
+
+    QList<TodoFolder> loaded;
+    QVERIFY(ModelSnapshot::load(path, m_stamp, &loaded));
+    QCOMPARE(loaded.size(), m_folders.size());
+    for (qsizetype f = 0; f < loaded.size(); ++f) {
+        QCOMPARE(loaded.at(f).toJson(), m_folders.at(f).toJson());
+        // toJson 只到秒：时间戳另按毫秒比较
+        const QList<TodoItem> expected = m_folders.at(f).getItems();
+        const QList<TodoItem> items = loaded.at(f).getItems();
+        QCOMPARE(items.size(), expected.size());
+        for (qsizetype i = 0; i < items.size(); ++i) {
+            QCOMPARE(items.at(i).getKey(), expected.at(i).getKey());
+            QCOMPARE(items.at(i).createdMsecs(), expected.at(i).createdMsecs());
+            QCOMPARE(items.at(i).updatedMsecs(), expected.at(i).updatedMsecs());
+            QCOMPARE(items.at(i).getCompletedTime(), expected.at(i).getCompletedTime());
+            QCOMPARE(items.at(i).getRemindAt(), expected.at(i).getRemindAt());
+        }
+    }
+    QCOMPARE(loaded.constFirst().getItems().constLast().getId(), QStringLiteral("item-0001"));
+}
+
+void tst_ModelSnapshot::staleStamp()
+{
+    const QString path = save(QStringLiteral("stale.snap"));
+    QVERIFY(!path.isEmpty());
+
+    // 库在快照之后又有写入（计数变了），或换成了另一份库（实例 id 变了）：都不能用
+    DatabaseManager::ChangeStamp newer = m_stamp;
+    ++newer.counter;
+    DatabaseManager::ChangeStamp other = m_stamp;
+    ++other.databaseId;
+    const QList<TodoFolder> untouched = {TodoFolder(QStringLiteral("原样"))};
+    for (const DatabaseManager::ChangeStamp &stamp : {newer, other, DatabaseManager::ChangeStamp()}) {
+        QList<TodoFolder> loaded = untouched;
+        QVERIFY(!ModelSnapshot::load(path, stamp, &loaded));
+        QCOMPARE(loaded.size(), 1);
+        QCOMPARE(loaded.constFirst().getName(), QStringLiteral("原样"));
+    }
+
+    QList<TodoFolder> loaded;
+    QVERIFY(ModelSnapshot::load(path, m_stamp, &loaded));
+    QVERIFY(!ModelSnapshot::load(m_dir.filePath(QStringLiteral("missing.snap")), m_stamp, &loaded));
+}
+
+void tst_ModelSnapshot::truncated()
+{
+    const QString path = save(QStringLiteral("cut.snap"));
+    QVERIFY(!path.isEmpty());
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() - 2));
+    file.close();
+
+    QList<TodoFolder> loaded;
+    QVERIFY(!ModelSnapshot::load(path, m_stamp, &loaded));
+    QVERIFY(loaded.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(tst_ModelSnapshot)
+#include "tst_modelsnapshot.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_modelsnapshot
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_modelsnapshot.cpp
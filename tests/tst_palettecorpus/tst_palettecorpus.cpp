@@ -0,0 +1,167 @@
+#include <QtTest>
+#include <limits>
+#include <memory>
+
+#include "palettecorpus.h"
+#include "testdata.h"
+
+// 命令面板候选：随变更通知增删改的正确性，以及十万事项的常驻候选上每次按键的重排耗时（须在 10 ms 内）
+class tst_PaletteCorpus : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void feed();
+    void weakAltMatch();
+
+    void rank_data();
+    void rank();
+
+private:
+    static int find(PaletteCorpus &corpus, const QString &query, const QString &key);
+
+    TodoStore m_store;
+    std::unique_ptr<PaletteCorpus> m_corpus;  // 声明在 m_store 之后，先于它析构
+};
+
+// 面板实际用的候选集：十万条事项经 PaletteCorpus 建成标题 + 拼音备用文本
+void tst_PaletteCorpus::initTestCase()
+{
+    constexpr int kItems = 100000;
+    TodoFolder folder(QStringLiteral("收件箱"));
+    QList<TodoItem> &items = folder.getItemsRef();
+    items.reserve(kItems);
+    for (int n = 0; n < kItems; ++n) {
+        items.append(TodoItem(TestData::title(n)));
+    }
+    m_store.reset({folder});
+    m_corpus = std::make_unique<PaletteCorpus>(&m_store);
+    m_corpus->prepare({}, {});
+    QCOMPARE(m_corpus->matcher().count(), kItems + 1);   // 事项 + 文件夹
+}
+
+// query 的命中里 key 对应的候选下标；未命中为 -1
+int tst_PaletteCorpus::find(PaletteCorpus &corpus, const QString &query, const QString &key)
+{
+    for (const FuzzyMatcher::Result &result : corpus.matcher().rank(query, 1000)) {
+        if (corpus.entry(result.candidate).key == key) {
+            return result.candidate;
+        }
+    }
+    return -1;
+}
+
+void tst_PaletteCorpus::feed()
+{
+    TodoFolder inbox(QStringLiteral("收件箱"));
+    inbox.addItem(TodoItem(QStringLiteral("写周报")));
+    TodoStore store;
+    store.reset({inbox});
+    PaletteCorpus corpus(&store);
+    const QList<std::pair<QString, QString>> actions = {{QStringLiteral("trash"), QStringLiteral("回收站")}};
+    corpus.prepare(actions, {QStringLiteral("工作")});
+    const QString inboxId = inbox.getId();
+    const QString weeklyId = inbox.getItems().constFirst().getId();
+    QVERIFY(find(corpus, QStringLiteral("zhoubao"), weeklyId) >= 0);
+    QVERIFY(find(corpus, QStringLiteral("#工作"), QStringLiteral("工作")) >= 0);
+
+    // 新增
+    const QString budgetId = store.addItem(inboxId, TodoItem(QStringLiteral("季度预算")))->getId();
+    QVERIFY(find(corpus, QStringLiteral("预算"), budgetId) >= 0);
+
+    // 改标题：旧标题不再命中，拼音随之更新
+    store.item(budgetId)->setTitle(QStringLiteral("年度采购"));
+    store.markChanged(budgetId, TodoChangeFeed::Title);
+    QCOMPARE(find(corpus, QStringLiteral("预算"), budgetId), -1);
+    QVERIFY(find(corpus, QStringLiteral("caigou"), budgetId) >= 0);
+
+    // 移动：副标题随所在文件夹
+    const QString archiveId = store.addFolder(TodoFolder(QStringLiteral("归档")))->getId();
+    QVERIFY(find(corpus, QStringLiteral("归档"), archiveId) >= 0);
+    store.moveItem(budgetId, archiveId);
+    QCOMPARE(corpus.subtitle(find(corpus, QStringLiteral("采购"), budgetId)), QStringLiteral("归档"));
+
+    // 删除后空位由下一次新增复用
+    const int slot = find(corpus, QStringLiteral("采购"), budgetId);
+    QVERIFY(store.removeItem(budgetId));
+    QCOMPARE(find(corpus, QStringLiteral("采购"), budgetId), -1);
+    const QString callId = store.addItem(archiveId, TodoItem(QStringLiteral("回电话")))->getId();
+    QCOMPARE(find(corpus, QStringLiteral("回电话"), callId), slot);
+
+    // 标签在 prepare 时按差异同步
+    corpus.prepare(actions, {QStringLiteral("生活")});
+    QCOMPARE(find(corpus, QStringLiteral("#工作"), QStringLiteral("工作")), -1);
+    QVERIFY(find(corpus, QStringLiteral("#生活"), QStringLiteral("生活")) >= 0);
+
+    // 整体替换后在下一次 prepare 时重建
+    TodoFolder other(QStringLiteral("其他"));
+    other.addItem(TodoItem(QStringLiteral("买牛奶")));
+    store.reset({other});
+    corpus.prepare(actions, {});
+    QCOMPARE(find(corpus, QStringLiteral("zhoubao"), weeklyId), -1);
+    QVERIFY(find(corpus, QStringLiteral("niunai"), other.getItems().constFirst().getId()) >= 0);
+    QCOMPARE(corpus.matcher().count(), 3);   // 操作、文件夹、事项
+}
+
+// 备用文本上得分为 0 的命中（间隔很长）仍要算命中，不能因拼音减分变成未命中
+void tst_PaletteCorpus::weakAltMatch()
+{
+    FuzzyMatcher matcher;
+    const QString alt = QStringLiteral("a") + QString(60, QLatin1Char('x')) + QStringLiteral("z");
+    const char16_t pattern[] = u"az";
+    QCOMPARE(FuzzyMatcher::score(reinterpret_cast<const char16_t *>(alt.utf16()), alt.size(), pattern, 2), 0);
+
+    const int candidate = matcher.add(QStringLiteral("无关"), alt);
+    const std::vector<FuzzyMatcher::Result> &results = matcher.rank(QStringLiteral("az"), 10);
+    QCOMPARE(results.size(), size_t(1));
+    QCOMPARE(results.front().candidate, candidate);
+    QCOMPARE(results.front().score, 0);
+}
+
+void tst_PaletteCorpus::rank_data()
+{
+    QTest::addColumn<QStringList>("keystrokes");
+
+    QTest::newRow("single char") << QStringList{QStringLiteral("b")};
+    QTest::newRow("chinese") << QStringList{QStringLiteral("周报")};
+    QTest::newRow("pinyin") << QStringList{QStringLiteral("kehu")};
+    QTest::newRow("typing") << QStringList{QStringLiteral("r"), QStringLiteral("re"), QStringLiteral("rev"),
+                                           QStringLiteral("revi"), QStringLiteral("review")};
+}
+
+void tst_PaletteCorpus::rank()
+{
+    QFETCH(QStringList, keystrokes);
+    FuzzyMatcher &matcher = m_corpus->matcher();
+
+    // 预算：从打开面板（空查询）开始逐键输入，每一次重排都须在 10 ms 内。
+    // 跑三轮取每个按键的最短耗时，排除调度抖动
+    std::vector<qint64> best(size_t(keystrokes.size()), std::numeric_limits<qint64>::max());
+    for (int round = 0; round < 3; ++round) {
+        matcher.rank(QString(), 50);
+        for (qsizetype k = 0; k < keystrokes.size(); ++k) {
+            QElapsedTimer timer;
+            timer.start();
+            matcher.rank(keystrokes.at(k), 50);
+            best[size_t(k)] = qMin(best[size_t(k)], timer.nsecsElapsed());
+        }
+    }
+    for (qsizetype k = 0; k < keystrokes.size(); ++k) {
+        QVERIFY2(best[size_t(k)] < 10 * 1000 * 1000,
+                 qPrintable(QStringLiteral("\"%1\" took %2 ms").arg(keystrokes.at(k)).arg(best[size_t(k)] / 1e6)));
+    }
+
+    // 每轮同上；总耗时 / 按键数即每次按键的重排开销
+    QBENCHMARK {
+        matcher.rank(QString(), 50);
+        for (const QString &query : keystrokes) {
+            matcher.rank(query, 50);
+        }
+    }
+    QVERIFY(matcher.matchCount() > 0);
+}
+
+QTEST_GUILESS_MAIN(tst_PaletteCorpus)
+#include "tst_palettecorpus.moc"
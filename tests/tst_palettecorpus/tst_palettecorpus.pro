@@ -0,0 +1,6 @@
+TARGET = tst_palettecorpus
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_palettecorpus.cpp
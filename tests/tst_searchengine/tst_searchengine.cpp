@@ -0,0 +1,93 @@
+#include <QtTest>
+
+#include "searchengine.h"
+#include "testdata.h"
+
+// 十万事项上的按键到结果延迟：从发起查询到 resultsReady 投递回 GUI 线程，不含 60 ms 输入防抖
+class tst_SearchEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void latency_data();
+    void latency();
+
+private:
+    QList<TodoFolder> m_folders;
+};
+
+void tst_SearchEngine::initTestCase()
+{
+    const QStringList tags = {QStringLiteral("工作"), QStringLiteral("生活"), QStringLiteral("学习")};
+    constexpr int kItems = 100000;
+    constexpr int kPerFolder = 1000;
+    for (int n = 0; n < kItems; ++n) {
+        if (n % kPerFolder == 0) {
+            m_folders.append(TodoFolder(QStringLiteral("文件夹 %1").arg(n / kPerFolder)));
+        }
+        TodoItem item(TestData::title(n), TestData::details(n));
+        item.setTags({tags.at(n % tags.size())});
+        item.setCompleted(n % 4 == 0);
+        item.setDueDate(QDate::currentDate().addDays(n % 30 - 10));
+        m_folders.last().addItem(item);
+    }
+}
+
+void tst_SearchEngine::latency_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("rebuild");           // 0 = 索引就绪；1 = 单项改动后重建 arena；2 = 整体替换后连拼音一起重建
+
+    QTest::newRow("substring") << QStringLiteral("周报") << 0;
+    QTest::newRow("two terms") << QStringLiteral("review 12") << 0;
+    QTest::newRow("pinyin") << QStringLiteral("kh") << 0;
+    QTest::newRow("filters + term") << QStringLiteral("is:open #工作 due:<7d 发布") << 0;
+    QTest::newRow("after item change") << QStringLiteral("周报") << 1;
+    QTest::newRow("after model reset") << QStringLiteral("kh") << 2;
+}
+
+void tst_SearchEngine::latency()
+{
+    QFETCH(QString, text);
+    QFETCH(int, rebuild);
+
+    SearchEngine engine;
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+    int total = -1;
+    connect(&engine, &SearchEngine::resultsReady, &loop,
+            [&](const QString &, const QList<SearchEngine::Hit> &, int count) {
+        total = count;
+        loop.quit();
+    });
+    auto run = [&]() {
+        total = -1;
+        engine.search(m_folders, text);
+        engine.m_debounce->stop();
+        engine.dispatch();
+        timeout.start(10000);
+        loop.exec();
+        return total >= 0;
+    };
+    QVERIFY(run());   // 预热：索引就绪
+
+    QBENCHMARK {
+        if (rebuild == 2) {
+            engine.resetModel();
+        } else if (rebuild == 1) {
+            engine.invalidate();
+        } else {
+            engine.m_lastTerms.clear();   // 同一查询重复执行会被当成增量收窄，每轮都从整份索引查起
+        }
+        QVERIFY(run());
+    }
+    QVERIFY(total > 0);
+    QVERIFY(engine.m_pinyin);   // 后台建好的拼音索引已交回 GUI 线程
+}
+
+QTEST_GUILESS_MAIN(tst_SearchEngine)
+#include "tst_searchengine.moc"
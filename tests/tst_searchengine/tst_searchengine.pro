@@ -0,0 +1,6 @@
+TARGET = tst_searchengine
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_searchengine.cpp
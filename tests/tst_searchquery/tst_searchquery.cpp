@@ -0,0 +1,153 @@
+#include <QtTest>
+
+#include "searchquery.h"
+#include "searchengine.h"
+
+// 查询语言的解析，以及 SearchEngine::plan 在一份小内存索引上的候选与求交顺序
+class tst_SearchQuery : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void parseRelativeDue();
+    void parseDueNone();
+    void parsePriorityRange();
+    void parseHashTag();
+    void parseQuotedPhrase();
+    void parseHalfTypedKey();
+
+    void plan_data();
+    void plan();
+
+private:
+    static TodoItem makeItem(const QString &title, const QStringList &tags, const QDate &due,
+                             bool completed, int priority, bool pinned = false);
+
+    const QDate m_today = QDate(2026, 10, 18);
+    QList<TodoFolder> m_folders;
+};
+
+TodoItem tst_SearchQuery::makeItem(const QString &title, const QStringList &tags, const QDate &due,
+                                   bool completed, int priority, bool pinned)
+{
+    TodoItem item(title);
+    item.setTags(tags);
+    item.setDueDate(due);
+    item.setCompleted(completed);
+    item.setPriority(priority);
+    item.setPinned(pinned);
+    return item;
+}
+
+void tst_SearchQuery::initTestCase()
+{
+    // 文档下标按文件夹、事项顺序：0–2 在「项目A」，3–4 在「家务」
+    TodoFolder work(QStringLiteral("项目A"));
+    work.addItem(makeItem(QStringLiteral("写周报"), {QStringLiteral("工作")}, m_today, false, 2));
+    work.addItem(makeItem(QStringLiteral("评审设计"), {QStringLiteral("工作"), QStringLiteral("设计")},
+                          m_today.addDays(3), true, 1));
+    work.addItem(makeItem(QStringLiteral("买菜"), {}, QDate(), false, 0));
+    TodoFolder home(QStringLiteral("家务"));
+    home.addItem(makeItem(QStringLiteral("打扫"), {QStringLiteral("家")}, m_today.addDays(10), false, 0));
+    home.addItem(makeItem(QStringLiteral("交电费"), {QStringLiteral("工作")}, m_today.addDays(-1), false, 2, true));
+    m_folders = {work, home};
+}
+
+void tst_SearchQuery::parseRelativeDue()
+{
+    const SearchQuery query = SearchQuery::parse(QStringLiteral("due:<7d"), m_today);
+    QVERIFY(query.dueFilter);
+    QVERIFY(!query.dueNone);
+    QVERIFY(!query.dueFrom.isValid());
+    QCOMPARE(query.dueTo, m_today.addDays(6));
+    QVERIFY(query.terms.isEmpty());
+}
+
+void tst_SearchQuery::parseDueNone()
+{
+    const SearchQuery query = SearchQuery::parse(QStringLiteral("due:none"), m_today);
+    QVERIFY(query.dueFilter);
+    QVERIFY(query.dueNone);
+    QVERIFY(query.terms.isEmpty());
+}
+
+void tst_SearchQuery::parsePriorityRange()
+{
+    const SearchQuery query = SearchQuery::parse(QStringLiteral("priority:>=medium"), m_today);
+    QCOMPARE(query.minPriority, 1);
+    QCOMPARE(query.maxPriority, 2);
+    QVERIFY(query.hasFilters());
+}
+
+void tst_SearchQuery::parseHashTag()
+{
+    const SearchQuery query = SearchQuery::parse(QStringLiteral("#工作 周报"), m_today);
+    QCOMPARE(query.tags, QStringList{QStringLiteral("工作")});
+    QCOMPARE(query.terms, QStringList{QStringLiteral("周报")});
+}
+
+void tst_SearchQuery::parseQuotedPhrase()
+{
+    const SearchQuery query = SearchQuery::parse(QStringLiteral("\"exact  phrase\" is:open"), m_today);
+    QCOMPARE(query.terms, QStringList{QStringLiteral("exact phrase")});
+    QVERIFY(query.status == SearchQuery::Status::Open);
+}
+
+void tst_SearchQuery::parseHalfTypedKey()
+{
+    // 已知的 key: 写到一半既不成为文本词也不过滤；未知的 key 按普通文本处理
+    const SearchQuery typing = SearchQuery::parse(QStringLiteral("周报 due:"), m_today);
+    QCOMPARE(typing.terms, QStringList{QStringLiteral("周报")});
+    QVERIFY(!typing.hasFilters());
+
+    const SearchQuery unknown = SearchQuery::parse(QStringLiteral("foo:"), m_today);
+    QCOMPARE(unknown.terms, QStringList{QStringLiteral("foo:")});
+    QVERIFY(!unknown.hasFilters());
+}
+
+void tst_SearchQuery::plan_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QList<quint32>>("candidates");
+    QTest::addColumn<QString>("explain");
+
+    // 各谓词的文档表按长度升序求交，与写在查询里的先后无关
+    QTest::newRow("tag and status")
+        << QStringLiteral("is:open tag:工作") << QList<quint32>{0, 4}
+        << QStringLiteral("tag:工作[3] & is:open[4] -> 2 candidates");
+    QTest::newRow("folder and status")
+        << QStringLiteral("folder:项目 is:done") << QList<quint32>{1}
+        << QStringLiteral("is:done[1] & folder[3] -> 1 candidates");
+    QTest::newRow("relative due")
+        << QStringLiteral("due:<7d") << QList<quint32>{0, 1, 4}
+        << QStringLiteral("due[3] -> 3 candidates");
+    QTest::newRow("no due date")
+        << QStringLiteral("due:none") << QList<quint32>{2}
+        << QStringLiteral("due[1] -> 1 candidates");
+    QTest::newRow("residual filter")
+        << QStringLiteral("#工作 is:pinned") << QList<quint32>{4}
+        << QStringLiteral("tag:工作[3] & filter -> 1 candidates");
+    QTest::newRow("unindexed only")
+        << QStringLiteral("priority:high") << QList<quint32>{0, 4}
+        << QStringLiteral("filter -> 2 candidates");
+    QTest::newRow("empty posting first")
+        << QStringLiteral("is:open tag:不存在 due:<7d") << QList<quint32>{}
+        << QStringLiteral("tag:不存在[0] & due[3] & is:open[4] -> 0 candidates");
+}
+
+void tst_SearchQuery::plan()
+{
+    QFETCH(QString, text);
+    QFETCH(QList<quint32>, candidates);
+    QFETCH(QString, explain);
+
+    const auto index = SearchEngine::buildIndex(m_folders, 1);
+    QString actual;
+    QCOMPARE(SearchEngine::plan(*index, SearchQuery::parse(text, m_today), &actual), candidates);
+    QCOMPARE(actual, explain);
+}
+
+QTEST_GUILESS_MAIN(tst_SearchQuery)
+#include "tst_searchquery.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_searchquery
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_searchquery.cpp
@@ -0,0 +1,185 @@
+#include <QtTest>
+
+#include "todostore.h"
+#include "stringpool.h"
+
+// 十万事项的内存占用（字节/条）：紧凑布局之前的 TodoItem、现在的 TodoItem，
+// 以及 TodoStore 实际持有的量（槽位里一份，再加 folders() 物化列表里的一份对象）
+class tst_TodoStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void footprint_data();
+    void footprint();
+    void materializedShares();
+
+private:
+    // 紧凑布局之前的 TodoItem 成员，原样照搬，只用来量大小
+    struct LegacyItem {
+        QString id;
+        QString title;
+        QString details;
+        QDateTime createdTime;
+        QDateTime completedTime;
+        QDateTime updatedTime;
+        bool isCompleted = false;
+        QString folderId;
+        QDate plannedDate;
+        QDate dueDate;
+        int priority = 0;
+        QStringList tags;
+        QString tagColor;
+        bool isPinned = false;
+        QDateTime remindAt;
+    };
+
+    enum Layout { Legacy, Compact, Store };
+
+    static qsizetype stringHeap(const QString &text);
+    static QString copyOf(const QString &text);
+    qsizetype legacyBytes() const;
+
+    QList<TodoFolder> m_folders;
+    int m_itemCount = 0;
+    qreal m_legacyPerItem = 0;               // 旧布局的字节/条，新布局与之比较
+};
+
+void tst_TodoStore::initTestCase()
+{
+    const QStringList tags = {QStringLiteral("工作"), QStringLiteral("紧急"), QStringLiteral("周报")};
+    constexpr int kItems = 100000;
+    for (int f = 0; f < 10; ++f) {
+        TodoFolder folder(QStringLiteral("文件夹 %1").arg(f));
+        QList<TodoItem> &items = folder.getItemsRef();
+        items.reserve(kItems / 10);
+        for (int n = f * kItems / 10; n < (f + 1) * kItems / 10; ++n) {
+            TodoItem item(QStringLiteral("事项 %1").arg(n), n % 4 == 0 ? QStringLiteral("详情 %1").arg(n) : QString());
+            item.setFolderId(folder.getId());
+            item.setTags({tags.at(n % 3), tags.at((n + 1) % 3)});
+            item.setCompleted(n % 2 == 0);
+            items.append(item);
+        }
+        m_folders.append(folder);
+    }
+    m_itemCount = kItems;
+    m_legacyPerItem = qreal(legacyBytes()) / m_itemCount;
+}
+
+qsizetype tst_TodoStore::stringHeap(const QString &text)
+{
+    // 与 todoitem.cpp 同一估算：数据头 + 容量（含结尾 0）
+    return text.isEmpty() ? 0 : 16 + (text.capacity() + 1) * qsizetype(sizeof(char16_t));
+}
+
+// 深拷贝：旧布局从库里逐行读出，每个事项的每个字段都是独立分配
+QString tst_TodoStore::copyOf(const QString &text)
+{
+    return QString(text.constData(), text.size());
+}
+
+qsizetype tst_TodoStore::legacyBytes() const
+{
+    QList<LegacyItem> legacy;
+    legacy.reserve(m_itemCount);
+    for (const TodoFolder &folder : m_folders) {
+        for (const TodoItem &item : folder.getItems()) {
+            LegacyItem old;
+            old.id = copyOf(item.getId());
+            old.title = copyOf(item.getTitle());
+            old.details = copyOf(item.getDetails());
+            old.createdTime = item.getCreatedTime();
+            old.completedTime = item.getCompletedTime();
+            old.updatedTime = item.getUpdatedTime();
+            old.isCompleted = item.isCompleted();
+            old.folderId = copyOf(item.getFolderId());
+            old.plannedDate = item.getPlannedDate();
+            old.dueDate = item.getDueDate();
+            old.priority = item.getPriority();
+            for (const QString &tag : item.getTags()) {
+                old.tags.append(copyOf(tag));
+            }
+            old.tagColor = copyOf(item.getTagColor());
+            old.isPinned = item.isPinned();
+            old.remindAt = item.getRemindAt();
+            legacy.append(old);
+        }
+    }
+
+    qsizetype bytes = 0;
+    for (const LegacyItem &old : std::as_const(legacy)) {
+        bytes += qsizetype(sizeof(LegacyItem)) + stringHeap(old.id) + stringHeap(old.title)
+                 + stringHeap(old.details) + stringHeap(old.folderId) + stringHeap(old.tagColor);
+        if (!old.tags.isEmpty()) {
+            bytes += 16 + old.tags.capacity() * qsizetype(sizeof(QString));
+        }
+        for (const QString &tag : old.tags) {
+            bytes += stringHeap(tag);
+        }
+    }
+    return bytes;
+}
+
+void tst_TodoStore::footprint_data()
+{
+    QTest::addColumn<int>("layout");
+
+    QTest::newRow("legacy TodoItem") << int(Legacy);
+    QTest::newRow("compact TodoItem") << int(Compact);
+    QTest::newRow("TodoStore (slots + materialized)") << int(Store);
+}
+
+void tst_TodoStore::footprint()
+{
+    QFETCH(int, layout);
+
+    // 日期、时间在 Qt 6 里都内联存放，不计堆；驻留池按条均摊
+    qsizetype bytes = 0;
+    if (layout == Legacy) {
+        bytes = qsizetype(m_legacyPerItem * m_itemCount);
+    } else {
+        TodoStore store;
+        store.reset(m_folders);
+        QCOMPARE(store.itemCount(), m_itemCount);
+        for (const TodoFolder &folder : m_folders) {
+            for (const TodoStore::Handle &handle : store.handles(folder.getId())) {
+                bytes += store.item(handle)->footprint();
+            }
+        }
+        bytes += StringPool::bytes();
+        if (layout == Store) {
+            // 物化列表里的对象本身；其中的字符串与槽位共享，见 materializedShares
+            bytes += qsizetype(store.itemCount()) * qsizetype(sizeof(TodoItem));
+        }
+    }
+
+    const qreal perItem = qreal(bytes) / m_itemCount;
+    QTest::setBenchmarkResult(perItem, QTest::BytesAllocated);
+    // 即便多持有一份物化对象，也要比旧布局省
+    QVERIFY2(layout == Legacy || perItem < m_legacyPerItem,
+             qPrintable(QStringLiteral("%1 B/item vs legacy %2 B/item").arg(perItem).arg(m_legacyPerItem)));
+}
+
+// 物化列表与槽位里的事项共享字符串数据，第二份只多出对象本身
+void tst_TodoStore::materializedShares()
+{
+    TodoStore store;
+    store.reset(m_folders);
+    const QString folderId = m_folders.constFirst().getId();
+    store.markChanged(m_folders.constFirst().getItems().constFirst().getId());   // 迫使该文件夹从槽位重建
+
+    const TodoFolder *folder = store.folder(folderId);
+    QVERIFY(folder);
+    const QList<TodoItem> items = folder->getItems();
+    QCOMPARE(items.size(), m_folders.constFirst().getItemCount());
+    for (const TodoItem &item : items) {
+        const TodoItem *stored = store.item(item.getId());
+        QVERIFY(stored);
+        QVERIFY(item.getTitle().constData() == stored->getTitle().constData());
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_TodoStore)
+#include "tst_todostore.moc"
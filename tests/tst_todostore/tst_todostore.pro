@@ -0,0 +1,6 @@
+TARGET = tst_todostore
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_todostore.cpp
@@ -6,31 +6,27 @@ CONFIG += c++17
 
 INCLUDEPATH += \
     src \
-    src/core \
     src/ui \
     src/ui/components \
     src/ui/widgets
 
+include(src/core/core.pri)
+
 SOURCES += \
     src/main.cpp \
-    src/core/todoitem.cpp \
-    src/core/todofolder.cpp \
-    src/core/databasemanager.cpp \
     src/ui/mainwindow.cpp \
     src/ui/components/navbar.cpp \
     src/ui/components/sectionheader.cpp \
     src/ui/components/titlebar.cpp \
     src/ui/components/flowlayout.cpp \
     src/ui/components/aurorabackground.cpp \
+    src/ui/components/commandpalette.cpp \
     src/ui/widgets/desktopwidget.cpp \
     src/ui/widgets/calendarwidget.cpp \
     src/ui/widgets/tagwidget.cpp \
     src/ui/widgets/statswidget.cpp
 
 HEADERS += \
-    src/core/todoitem.h \
-    src/core/todofolder.h \
-    src/core/databasemanager.h \
     src/ui/mainwindow.h \
     src/ui/theme.h \
     src/ui/icons.h \
@@ -39,6 +35,7 @@ HEADERS += \
     src/ui/components/titlebar.h \
     src/ui/components/flowlayout.h \
     src/ui/components/aurorabackground.h \
+    src/ui/components/commandpalette.h \
     src/ui/components/messageutils.h \
     src/ui/widgets/desktopwidget.h \
     src/ui/widgets/calendarwidget.h \